@@ -62,6 +62,15 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    enable_custom_split_merge),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"use_compression_dict",
+         {offsetof(struct CompressedSecondaryCacheOptions,
+                   use_compression_dict),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"compression_threads",
+         {offsetof(struct CompressedSecondaryCacheOptions, compression_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
 };
 
 Status SecondaryCache::CreateFromString(
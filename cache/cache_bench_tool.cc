@@ -83,6 +83,14 @@ static class std::shared_ptr<ROCKSDB_NAMESPACE::SecondaryCache> secondary_cache;
 
 DEFINE_string(cache_type, "lru_cache", "Type of block cache.");
 
+DEFINE_bool(tiny_lfu_admission, false,
+            "Use the TinyLFU admission policy (see "
+            "ShardedCacheOptions::tiny_lfu_admission)");
+
+DEFINE_bool(use_read_buffer, false,
+            "Record LRUCache lookup hits in a read buffer (see "
+            "LRUCacheOptions::use_read_buffer)");
+
 // ## BEGIN stress_cache_key sub-tool options ##
 // See class StressCacheKey below.
 DEFINE_bool(stress_cache_key, false,
@@ -188,6 +196,8 @@ struct ThreadState {
   SharedState* shared;
   HistogramImpl latency_ns_hist;
   uint64_t duration_us = 0;
+  uint64_t lookups = 0;
+  uint64_t hits = 0;
 
   ThreadState(uint32_t index, SharedState* _shared)
       : tid(index), rnd(1000 + index), shared(_shared) {}
@@ -295,14 +305,21 @@ class CacheBench {
     if (FLAGS_cache_type == "clock_cache") {
       fprintf(stderr, "Old clock cache implementation has been removed.\n");
       exit(1);
-    } else if (FLAGS_cache_type == "hyper_clock_cache") {
-      cache_ = HyperClockCacheOptions(FLAGS_cache_size, FLAGS_value_bytes,
-                                      FLAGS_num_shard_bits)
-                   .MakeSharedCache();
+    } else if (FLAGS_cache_type == "hyper_clock_cache" ||
+               FLAGS_cache_type == "auto_hyper_clock_cache") {
+      HyperClockCacheOptions opts(
+          FLAGS_cache_size,
+          FLAGS_cache_type == "hyper_clock_cache" ? FLAGS_value_bytes
+                                                  : 0 /*auto*/,
+          FLAGS_num_shard_bits);
+      opts.tiny_lfu_admission = FLAGS_tiny_lfu_admission;
+      cache_ = opts.MakeSharedCache();
     } else if (FLAGS_cache_type == "lru_cache") {
       LRUCacheOptions opts(FLAGS_cache_size, FLAGS_num_shard_bits,
                            false /* strict_capacity_limit */,
                            0.5 /* high_pri_pool_ratio */);
+      opts.tiny_lfu_admission = FLAGS_tiny_lfu_admission;
+      opts.use_read_buffer = FLAGS_use_read_buffer;
       if (!FLAGS_secondary_cache_uri.empty()) {
         Status s = SecondaryCache::CreateFromString(
             ConfigOptions(), FLAGS_secondary_cache_uri, &secondary_cache);
@@ -391,6 +408,15 @@ class CacheBench {
                                         FLAGS_ops_per_thread / elapsed_secs);
     printf("Thread ops/sec = %u\n", ops_per_sec);
 
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    for (uint32_t i = 0; i < FLAGS_threads; i++) {
+      lookups += threads[i]->lookups;
+      hits += threads[i]->hits;
+    }
+    printf("Lookup hit ratio = %.4f\n",
+           lookups == 0 ? 0.0 : 1.0 * hits / lookups);
+
     printf("\nOperation latency (ns):\n");
     HistogramImpl combined;
     for (uint32_t i = 0; i < FLAGS_threads; i++) {
@@ -545,7 +571,9 @@ class CacheBench {
         // do lookup
         handle = cache_->Lookup(key, &helper2, /*context*/ nullptr,
                                 Cache::Priority::LOW, true);
+        thread->lookups++;
         if (handle) {
+          thread->hits++;
           if (!FLAGS_lean) {
             // do something with the data
             result += NPHash64(static_cast<char*>(cache_->Value(handle)),
@@ -574,7 +602,9 @@ class CacheBench {
         // do lookup
         handle = cache_->Lookup(key, &helper2, /*context*/ nullptr,
                                 Cache::Priority::LOW, true);
+        thread->lookups++;
         if (handle) {
+          thread->hits++;
           if (!FLAGS_lean) {
             // do something with the data
             result += NPHash64(static_cast<char*>(cache_->Value(handle)),
@@ -625,6 +655,8 @@ class CacheBench {
     printf("Insert percentage   : %u%%\n", FLAGS_insert_percent);
     printf("Lookup percentage   : %u%%\n", FLAGS_lookup_percent);
     printf("Erase percentage    : %u%%\n", FLAGS_erase_percent);
+    printf("TinyLFU admission   : %d\n", int{FLAGS_tiny_lfu_admission});
+    printf("Read buffer         : %d\n", int{FLAGS_use_read_buffer});
     std::ostringstream stats;
     if (FLAGS_gather_stats) {
       stats << "enabled (" << FLAGS_gather_stats_sleep_ms << "ms, "
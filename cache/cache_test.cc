@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 
+#include "cache/ghost_cache.h"
 #include "cache/lru_cache.h"
 #include "cache/typed_cache.h"
 #include "port/stack_trace.h"
@@ -992,6 +993,137 @@ TEST_P(CacheTest, GetChargeAndDeleter) {
   cache_->Release(h1);
 }
 
+TEST_P(CacheTest, TinyLfuAdmission) {
+  constexpr int kCharge = 4096;
+  constexpr int kNumEntries = 100;
+  constexpr int kScanBegin = 1000;
+  constexpr int kScanEnd = 2000;
+
+  for (bool admission : {false, true}) {
+    std::shared_ptr<Cache> cache;
+    if (GetParam() == kLRU) {
+      LRUCacheOptions co;
+      co.capacity = kNumEntries * kCharge;
+      co.num_shard_bits = 0;
+      co.high_pri_pool_ratio = 0;
+      co.metadata_charge_policy = kDontChargeCacheMetadata;
+      co.tiny_lfu_admission = admission;
+      cache = NewLRUCache(co);
+    } else {
+      HyperClockCacheOptions co(kNumEntries * kCharge, kCharge,
+                                /*num_shard_bits*/ 0);
+      co.metadata_charge_policy = kDontChargeCacheMetadata;
+      co.tiny_lfu_admission = admission;
+      cache = co.MakeSharedCache();
+    }
+
+    // A working set filling the cache, looked up repeatedly
+    for (int i = 0; i < kNumEntries; i++) {
+      Insert(cache, i, i, kCharge);
+    }
+    for (int round = 0; round < 15; round++) {
+      for (int i = 0; i < kNumEntries; i++) {
+        ASSERT_EQ(i, Lookup(cache, i));
+      }
+    }
+
+    if (admission) {
+      // A rejected insert returning a handle gets a standalone one, charged
+      // until released
+      size_t usage = cache->GetUsage();
+      Cache::Handle* h = nullptr;
+      ASSERT_OK(cache->Insert(EncodeKey(kScanEnd), EncodeValue(kScanEnd),
+                              &kHelper, kCharge, &h));
+      ASSERT_NE(h, nullptr);
+      ASSERT_EQ(kScanEnd, DecodeValue(cache->Value(h)));
+      ASSERT_EQ(usage + kCharge, cache->GetUsage());
+      cache->Release(h);
+      ASSERT_EQ(usage, cache->GetUsage());
+      ASSERT_EQ(-1, Lookup(cache, kScanEnd));
+    }
+
+    // A scan, reading every key once (miss then fill)
+    for (int i = kScanBegin; i < kScanEnd; i++) {
+      ASSERT_EQ(-1, Lookup(cache, i));
+      Insert(cache, i, i, kCharge);
+    }
+    ASSERT_LE(cache->GetUsage(), cache->GetCapacity());
+
+    int hits = 0;
+    for (int i = 0; i < kNumEntries; i++) {
+      if (Lookup(cache, i) == i) {
+        hits++;
+      }
+    }
+    if (admission) {
+      // The working set survives the scan
+      ASSERT_GE(hits, kNumEntries * 9 / 10);
+    } else {
+      ASSERT_LT(hits, kNumEntries / 10);
+    }
+  }
+}
+
+TEST_P(CacheTest, GhostCache) {
+  constexpr int kNumKeys = 50;
+  constexpr int kRounds = 3;
+
+  GhostCacheOptions opts;
+  opts.sample_ratio = 1.0;
+  opts.configs = {{10, GhostCachePolicy::kLRU},
+                  {100, GhostCachePolicy::kLRU},
+                  {100, GhostCachePolicy::kTinyLFU},
+                  {100, GhostCachePolicy::kClock}};
+  ASSERT_EQ(NewGhostCache(NewCache(kCacheSize), GhostCacheOptions{{}, 0.0}),
+            nullptr);
+  std::shared_ptr<Cache> cache = NewGhostCache(NewCache(kCacheSize), opts);
+  ASSERT_NE(cache, nullptr);
+
+  std::vector<GhostCacheStats> stats;
+  ASSERT_TRUE(GetGhostCacheStats(NewCache(kCacheSize), &stats)
+                  .IsInvalidArgument());
+
+  // A cyclic workload over keys fitting in all but the smallest cache
+  for (int round = 0; round < kRounds; round++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      std::string key = EncodeKey16Bytes(i);
+      Cache::Handle* h = cache->Lookup(key);
+      if (h == nullptr) {
+        ASSERT_OK(cache->Insert(key, EncodeValue(i), &kHelper, 1));
+      } else {
+        cache->Release(h);
+      }
+    }
+  }
+
+  ASSERT_OK(GetGhostCacheStats(cache, &stats));
+  ASSERT_EQ(stats.size(), 4);
+  for (const GhostCacheStats& s : stats) {
+    ASSERT_EQ(s.lookups, kNumKeys * kRounds);
+  }
+  // LRU thrashes on a loop larger than the cache
+  ASSERT_EQ(stats[0].hits, 0);
+  ASSERT_EQ(stats[1].hits, kNumKeys * (kRounds - 1));
+  ASSERT_EQ(stats[2].hits, kNumKeys * (kRounds - 1));
+  ASSERT_DOUBLE_EQ(stats[1].MissRatio(), 1.0 / kRounds);
+  ASSERT_NE(static_cast<GhostCache*>(cache.get())->ToString().find(
+                "miss_ratio"),
+            std::string::npos);
+
+  // Only the sampled keys are simulated
+  opts.sample_ratio = 0.5;
+  opts.configs = {{100, GhostCachePolicy::kLRU}};
+  cache = NewGhostCache(NewCache(kCacheSize), opts);
+  for (int i = 0; i < 1000; i++) {
+    Cache::Handle* h = cache->Lookup(EncodeKey16Bytes(i));
+    ASSERT_EQ(h, nullptr);
+  }
+  ASSERT_OK(GetGhostCacheStats(cache, &stats));
+  ASSERT_EQ(stats.size(), 1);
+  ASSERT_GT(stats[0].lookups, 400);
+  ASSERT_LT(stats[0].lookups, 600);
+}
+
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
                         testing::Values(kLRU, kHyperClock));
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, LRUCacheTest, testing::Values(kLRU));
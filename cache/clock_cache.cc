@@ -50,6 +50,18 @@ inline uint64_t GetInitialCountdown(Cache::Priority priority) {
   }
 }
 
+// With an eviction cost policy, the priority of an entry determining its
+// initial clock countdown
+inline Cache::Priority GetPriorityForMissCost(uint32_t miss_cost) {
+  if (miss_cost >= 2 * CacheEvictionCostPolicy::kTypicalMissCost) {
+    return Cache::Priority::HIGH;
+  } else if (miss_cost >= CacheEvictionCostPolicy::kTypicalMissCost / 2) {
+    return Cache::Priority::LOW;
+  } else {
+    return Cache::Priority::BOTTOM;
+  }
+}
+
 inline void FreeDataMarkEmpty(ClockHandle& h, MemoryAllocator* allocator) {
   // NOTE: in theory there's more room for parallelism if we copy the handle
   // data and delay actions like this until after marking the entry as empty,
@@ -121,20 +133,42 @@ void ClockHandleBasicData::FreeData(MemoryAllocator* allocator) const {
   }
 }
 
+namespace {
+// With automatic sizing, the first generation is sized for entries of this
+// charge, on the high side of block sizes. Smaller entries make the table
+// grow.
+constexpr size_t kAutoInitialEstimatedValueSize = 16 * 1024;
+
+// With automatic sizing, minimum number of hash bits of a generation
+constexpr int kAutoMinLengthBits = 4;
+}  // namespace
+
 HyperClockTable::HyperClockTable(
     size_t capacity, bool /*strict_capacity_limit*/,
     CacheMetadataChargePolicy metadata_charge_policy,
     MemoryAllocator* allocator, const Opts& opts)
-    : length_bits_(CalcHashBits(capacity, opts.estimated_value_size,
-                                metadata_charge_policy)),
-      length_bits_mask_((size_t{1} << length_bits_) - 1),
-      occupancy_limit_(static_cast<size_t>((uint64_t{1} << length_bits_) *
-                                           kStrictLoadFactor)),
-      array_(new HandleImpl[size_t{1} << length_bits_]),
+    : auto_resize_(opts.estimated_value_size == 0),
+      metadata_charge_policy_(metadata_charge_policy),
       allocator_(allocator) {
-  if (metadata_charge_policy ==
-      CacheMetadataChargePolicy::kFullChargeCacheMetadata) {
-    usage_ += size_t{GetTableSize()} * sizeof(HandleImpl);
+  int length_bits;
+  if (auto_resize_) {
+    length_bits = CalcHashBits(capacity, kAutoInitialEstimatedValueSize,
+                               metadata_charge_policy);
+    // Not too small to start with, if there is room for the metadata
+    length_bits = std::max(
+        length_bits, std::min(kAutoMinLengthBits,
+                              CalcHashBits(capacity, /*estimated_value_size*/ 1,
+                                           metadata_charge_policy)));
+  } else {
+    length_bits = CalcHashBits(capacity, opts.estimated_value_size,
+                               metadata_charge_policy);
+  }
+  AddGeneration(0, length_bits, /*begin*/ 0);
+
+  if (opts.tiny_lfu_admission) {
+    // About one word per entry
+    sketch_.reset(new FrequencySketch(
+        capacity / (auto_resize_ ? 4096 : opts.estimated_value_size)));
   }
 
   static_assert(sizeof(HandleImpl) == 64U,
@@ -144,39 +178,156 @@ HyperClockTable::HyperClockTable(
 HyperClockTable::~HyperClockTable() {
   // Assumes there are no references or active operations on any slot/element
   // in the table.
-  for (size_t i = 0; i < GetTableSize(); i++) {
-    HandleImpl& h = array_[i];
-    switch (h.meta >> ClockHandle::kStateShift) {
-      case ClockHandle::kStateEmpty:
-        // noop
-        break;
-      case ClockHandle::kStateInvisible:  // rare but possible
-      case ClockHandle::kStateVisible:
-        assert(GetRefcount(h.meta) == 0);
-        h.FreeData(allocator_);
+  const int num_generations = GetNumGenerations();
+  for (int g = 0; g < num_generations; g++) {
+    const Generation& gen = generations_[g];
+    for (size_t i = 0; i < gen.Size(); i++) {
+      HandleImpl& h = gen.array[i];
+      switch (h.meta >> ClockHandle::kStateShift) {
+        case ClockHandle::kStateEmpty:
+          // noop
+          break;
+        case ClockHandle::kStateInvisible:  // rare but possible
+        case ClockHandle::kStateVisible:
+          assert(GetRefcount(h.meta) == 0);
+          h.FreeData(allocator_);
 #ifndef NDEBUG
-        Rollback(h.hashed_key, &h);
-        ReclaimEntryUsage(h.GetTotalCharge());
+          Rollback(h.hashed_key, &h);
+          ReclaimEntryUsage(h, h.GetTotalCharge());
 #endif
-        break;
-      // otherwise
-      default:
-        assert(false);
-        break;
+          break;
+        // otherwise
+        default:
+          assert(false);
+          break;
+      }
     }
   }
 
+  for (int g = 0; g < num_generations; g++) {
 #ifndef NDEBUG
-  for (size_t i = 0; i < GetTableSize(); i++) {
-    assert(array_[i].displacements.load() == 0);
-  }
+    for (size_t i = 0; i < generations_[g].Size(); i++) {
+      assert(generations_[g].array[i].displacements.load() == 0);
+    }
 #endif
+    delete[] generations_[g].array;
+  }
 
   assert(usage_.load() == 0 ||
          usage_.load() == size_t{GetTableSize()} * sizeof(HandleImpl));
   assert(occupancy_ == 0);
 }
 
+void HyperClockTable::AddGeneration(int generation, int length_bits,
+                                    size_t begin) {
+  assert(generation == GetNumGenerations());
+  assert(generation < kMaxGenerations);
+  Generation& gen = generations_[generation];
+  gen.length_bits = length_bits;
+  gen.length_bits_mask = (size_t{1} << length_bits) - 1;
+  gen.begin = begin;
+  gen.occupancy_limit =
+      static_cast<size_t>((uint64_t{1} << length_bits) * kStrictLoadFactor);
+  gen.array = new HandleImpl[gen.Size()];
+  for (size_t i = 0; i < gen.Size(); i++) {
+    gen.array[i].generation = static_cast<uint8_t>(generation);
+  }
+  if (metadata_charge_policy_ == kFullChargeCacheMetadata) {
+    usage_.fetch_add(gen.Size() * sizeof(HandleImpl),
+                     std::memory_order_relaxed);
+  }
+
+  // Publish the generation. Operations seeing the new number of generations
+  // see the generation's data.
+  table_size_.store(begin + gen.Size(), std::memory_order_relaxed);
+  num_generations_.store(generation + 1, std::memory_order_release);
+  occupancy_limit_.fetch_add(gen.occupancy_limit, std::memory_order_relaxed);
+}
+
+bool HyperClockTable::MaybeGrow(size_t total_charge, size_t capacity) {
+  assert(auto_resize_);
+  std::unique_lock<std::mutex> lock(grow_mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    // Another thread is adding a generation. Rather than waiting for it,
+    // make room by eviction.
+    return false;
+  }
+  if (GetOccupancy() <= GetOccupancyLimit()) {
+    // Another thread added a generation (or entries were freed)
+    return true;
+  }
+  const int num_generations = GetNumGenerations();
+  if (num_generations >= kMaxGenerations) {
+    return false;
+  }
+  const size_t table_size = GetTableSize();
+  const size_t metadata_usage =
+      metadata_charge_policy_ == kFullChargeCacheMetadata
+          ? table_size * sizeof(HandleImpl)
+          : 0;
+  const size_t usage = GetUsage() - GetDetachedUsage();
+  if (usage + total_charge > capacity) {
+    // The shard is at capacity, so the table is not what limits it, and
+    // eviction is needed anyway.
+    return false;
+  }
+
+  // Size the table for the average charge of the current entries
+  const size_t occupancy = std::max(GetOccupancy(), size_t{1});
+  const size_t average_charge =
+      std::max((usage - std::min(usage, metadata_usage)) / occupancy,
+               size_t{1});
+  const int target_bits =
+      CalcHashBits(capacity, average_charge, metadata_charge_policy_);
+  const size_t target_size = size_t{1} << target_bits;
+  if (target_size <= table_size) {
+    return false;
+  }
+  // Generations are at least as large as the previous one, so that the
+  // number of generations is logarithmic in the table size.
+  const Generation& newest = generations_[num_generations - 1];
+  int length_bits =
+      std::max(newest.length_bits,
+               FloorLog2(((target_size - table_size) << 1) - 1));
+  // Never more slot metadata than capacity
+  if ((table_size + (size_t{1} << length_bits)) * sizeof(HandleImpl) >
+      capacity) {
+    return false;
+  }
+  AddGeneration(num_generations, length_bits, table_size);
+  return true;
+}
+
+inline HyperClockTable::HandleImpl& HyperClockTable::GetSlot(
+    size_t index, int num_generations) {
+  for (int g = num_generations - 1; g > 0; g--) {
+    if (index >= generations_[g].begin) {
+      return generations_[g].array[index - generations_[g].begin];
+    }
+  }
+  return generations_[0].array[index];
+}
+
+inline bool HyperClockTable::ReserveGenerationOccupancy(int generation) {
+  assert(auto_resize_);
+  size_t old_occupancy = generation_occupancy_[generation].fetch_add(
+      1, std::memory_order_relaxed);
+  if (old_occupancy >= generations_[generation].occupancy_limit) {
+    generation_occupancy_[generation].fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+inline void HyperClockTable::ReleaseGenerationOccupancy(int generation) {
+  assert(auto_resize_);
+  auto old_occupancy = generation_occupancy_[generation].fetch_sub(
+      1, std::memory_order_relaxed);
+  (void)old_occupancy;
+  // No underflow
+  assert(old_occupancy > 0);
+}
+
 // If an entry doesn't receive clock updates but is repeatedly referenced &
 // released, the acquire and release counters could overflow without some
 // intervention. This is that intervention, which should be inexpensive
@@ -392,12 +543,37 @@ Status HyperClockTable::Insert(const ClockHandleBasicData& proto,
     occupancy_.fetch_sub(1, std::memory_order_relaxed);
   };
   // Whether we over-committed and need an eviction to make up for it
-  bool need_evict_for_occupancy = old_occupancy >= occupancy_limit_;
+  bool need_evict_for_occupancy = old_occupancy >= GetOccupancyLimit();
+  if (UNLIKELY(need_evict_for_occupancy) && auto_resize_ &&
+      MaybeGrow(proto.GetTotalCharge(), capacity)) {
+    // The table grew instead
+    need_evict_for_occupancy = false;
+  }
+
+  const size_t total_charge = proto.GetTotalCharge();
+  if (sketch_ &&
+      (need_evict_for_occupancy ||
+       usage_.load(std::memory_order_relaxed) + total_charge > capacity) &&
+      !AdmitByFrequency(proto.hashed_key)) {
+    // Rejected by admission policy, so don't evict anything for it
+    revert_occupancy_fn();
+    if (handle == nullptr) {
+      // As if inserted into cache and evicted immediately.
+      proto.FreeData(allocator_);
+      return Status::OK();
+    }
+    if (strict_capacity_limit) {
+      return Status::MemoryLimit(
+          "Insert rejected by cache admission policy and cache is full.");
+    }
+    usage_.fetch_add(total_charge, std::memory_order_relaxed);
+    *handle = DetachedInsert(proto);
+    return Status::OkOverwritten();
+  }
 
   // Usage/capacity handling is somewhat different depending on
   // strict_capacity_limit, but mostly pessimistic.
   bool use_detached_insert = false;
-  const size_t total_charge = proto.GetTotalCharge();
   if (strict_capacity_limit) {
     Status s = ChargeUsageMaybeEvictStrict(total_charge, capacity,
                                            need_evict_for_occupancy);
@@ -441,95 +617,118 @@ Status HyperClockTable::Insert(const ClockHandleBasicData& proto,
     uint64_t initial_countdown = GetInitialCountdown(priority);
     assert(initial_countdown > 0);
 
-    size_t probe = 0;
-    HandleImpl* e = FindSlot(
-        proto.hashed_key,
-        [&](HandleImpl* h) {
-          // Optimistically transition the slot from "empty" to
-          // "under construction" (no effect on other states)
-          uint64_t old_meta =
-              h->meta.fetch_or(uint64_t{ClockHandle::kStateOccupiedBit}
-                                   << ClockHandle::kStateShift,
-                               std::memory_order_acq_rel);
-          uint64_t old_state = old_meta >> ClockHandle::kStateShift;
-
-          if (old_state == ClockHandle::kStateEmpty) {
-            // We've started inserting into an available slot, and taken
-            // ownership Save data fields
-            ClockHandleBasicData* h_alias = h;
-            *h_alias = proto;
-
-            // Transition from "under construction" state to "visible" state
-            uint64_t new_meta = uint64_t{ClockHandle::kStateVisible}
-                                << ClockHandle::kStateShift;
-
-            // Maybe with an outstanding reference
-            new_meta |= initial_countdown << ClockHandle::kAcquireCounterShift;
-            new_meta |= (initial_countdown - (handle != nullptr))
-                        << ClockHandle::kReleaseCounterShift;
+    auto match_fn = [&](HandleImpl* h) {
+      // Optimistically transition the slot from "empty" to
+      // "under construction" (no effect on other states)
+      uint64_t old_meta =
+          h->meta.fetch_or(uint64_t{ClockHandle::kStateOccupiedBit}
+                               << ClockHandle::kStateShift,
+                           std::memory_order_acq_rel);
+      uint64_t old_state = old_meta >> ClockHandle::kStateShift;
+
+      if (old_state == ClockHandle::kStateEmpty) {
+        // We've started inserting into an available slot, and taken
+        // ownership Save data fields
+        ClockHandleBasicData* h_alias = h;
+        *h_alias = proto;
+
+        // Transition from "under construction" state to "visible" state
+        uint64_t new_meta = uint64_t{ClockHandle::kStateVisible}
+                            << ClockHandle::kStateShift;
+
+        // Maybe with an outstanding reference
+        new_meta |= initial_countdown << ClockHandle::kAcquireCounterShift;
+        new_meta |= (initial_countdown - (handle != nullptr))
+                    << ClockHandle::kReleaseCounterShift;
 
 #ifndef NDEBUG
-            // Save the state transition, with assertion
-            old_meta = h->meta.exchange(new_meta, std::memory_order_release);
-            assert(old_meta >> ClockHandle::kStateShift ==
-                   ClockHandle::kStateConstruction);
+        // Save the state transition, with assertion
+        old_meta = h->meta.exchange(new_meta, std::memory_order_release);
+        assert(old_meta >> ClockHandle::kStateShift ==
+               ClockHandle::kStateConstruction);
 #else
-            // Save the state transition
-            h->meta.store(new_meta, std::memory_order_release);
+        // Save the state transition
+        h->meta.store(new_meta, std::memory_order_release);
 #endif
-            return true;
-          } else if (old_state != ClockHandle::kStateVisible) {
-            // Slot not usable / touchable now
-            return false;
-          }
-          // Existing, visible entry, which might be a match.
-          // But first, we need to acquire a ref to read it. In fact, number of
-          // refs for initial countdown, so that we boost the clock state if
-          // this is a match.
+        return true;
+      } else if (old_state != ClockHandle::kStateVisible) {
+        // Slot not usable / touchable now
+        return false;
+      }
+      // Existing, visible entry, which might be a match.
+      // But first, we need to acquire a ref to read it. In fact, number of
+      // refs for initial countdown, so that we boost the clock state if
+      // this is a match.
+      old_meta = h->meta.fetch_add(
+          ClockHandle::kAcquireIncrement * initial_countdown,
+          std::memory_order_acq_rel);
+      // Like Lookup
+      if ((old_meta >> ClockHandle::kStateShift) ==
+          ClockHandle::kStateVisible) {
+        // Acquired a read reference
+        if (h->hashed_key == proto.hashed_key) {
+          // Match. Release in a way that boosts the clock state
           old_meta = h->meta.fetch_add(
+              ClockHandle::kReleaseIncrement * initial_countdown,
+              std::memory_order_acq_rel);
+          // Correct for possible (but rare) overflow
+          CorrectNearOverflow(old_meta, h->meta);
+          // Insert detached instead (only if return handle needed)
+          use_detached_insert = true;
+          return true;
+        } else {
+          // Mismatch. Pretend we never took the reference
+          old_meta = h->meta.fetch_sub(
               ClockHandle::kAcquireIncrement * initial_countdown,
               std::memory_order_acq_rel);
-          // Like Lookup
-          if ((old_meta >> ClockHandle::kStateShift) ==
-              ClockHandle::kStateVisible) {
-            // Acquired a read reference
-            if (h->hashed_key == proto.hashed_key) {
-              // Match. Release in a way that boosts the clock state
-              old_meta = h->meta.fetch_add(
-                  ClockHandle::kReleaseIncrement * initial_countdown,
-                  std::memory_order_acq_rel);
-              // Correct for possible (but rare) overflow
-              CorrectNearOverflow(old_meta, h->meta);
-              // Insert detached instead (only if return handle needed)
-              use_detached_insert = true;
-              return true;
-            } else {
-              // Mismatch. Pretend we never took the reference
-              old_meta = h->meta.fetch_sub(
-                  ClockHandle::kAcquireIncrement * initial_countdown,
-                  std::memory_order_acq_rel);
-            }
-          } else if (UNLIKELY((old_meta >> ClockHandle::kStateShift) ==
-                              ClockHandle::kStateInvisible)) {
-            // Pretend we never took the reference
-            // WART: there's a tiny chance we release last ref to invisible
-            // entry here. If that happens, we let eviction take care of it.
-            old_meta = h->meta.fetch_sub(
-                ClockHandle::kAcquireIncrement * initial_countdown,
-                std::memory_order_acq_rel);
-          } else {
-            // For other states, incrementing the acquire counter has no effect
-            // so we don't need to undo it.
-            // Slot not usable / touchable now.
-          }
-          (void)old_meta;
-          return false;
-        },
-        [&](HandleImpl* /*h*/) { return false; },
-        [&](HandleImpl* h) {
-          h->displacements.fetch_add(1, std::memory_order_relaxed);
-        },
-        probe);
+        }
+      } else if (UNLIKELY((old_meta >> ClockHandle::kStateShift) ==
+                          ClockHandle::kStateInvisible)) {
+        // Pretend we never took the reference
+        // WART: there's a tiny chance we release last ref to invisible
+        // entry here. If that happens, we let eviction take care of it.
+        old_meta = h->meta.fetch_sub(
+            ClockHandle::kAcquireIncrement * initial_countdown,
+            std::memory_order_acq_rel);
+      } else {
+        // For other states, incrementing the acquire counter has no effect
+        // so we don't need to undo it.
+        // Slot not usable / touchable now.
+      }
+      (void)old_meta;
+      return false;
+    };
+
+    HandleImpl* e = nullptr;
+    // Newest (largest) generation first. With a single generation (not
+    // automatic sizing), the occupancy of the table is already reserved.
+    const int num_generations =
+        num_generations_.load(std::memory_order_acquire);
+    for (int g = num_generations - 1; g >= 0; g--) {
+      if (auto_resize_ && !ReserveGenerationOccupancy(g)) {
+        continue;
+      }
+      const Generation& gen = generations_[g];
+      size_t probe = 0;
+      e = FindSlot(
+          gen, proto.hashed_key, match_fn,
+          [&](HandleImpl* /*h*/) { return false; },
+          [&](HandleImpl* h) {
+            h->displacements.fetch_add(1, std::memory_order_relaxed);
+          },
+          probe);
+      if (e == nullptr) {
+        // Probed the whole generation
+        Rollback(gen, proto.hashed_key, nullptr);
+      }
+      if (auto_resize_ && (e == nullptr || use_detached_insert)) {
+        ReleaseGenerationOccupancy(g);
+      }
+      if (e != nullptr) {
+        // Inserted, or found an existing entry
+        break;
+      }
+    }
     if (e == nullptr) {
       // Occupancy check and never abort FindSlot above should generally
       // prevent this, except it's theoretically possible for other threads
@@ -537,8 +736,10 @@ Status HyperClockTable::Insert(const ClockHandleBasicData& proto,
       // when it is populated. Assuming random hashing, the chance of that
       // should be no higher than pow(kStrictLoadFactor, n) for n slots.
       // That should be infeasible for roughly n >= 256, so if this assertion
-      // fails, that suggests something is going wrong.
-      assert(GetTableSize() < 256);
+      // fails, that suggests something is going wrong. With automatic
+      // sizing, the generations can also all be full, as their occupancies
+      // are not updated atomically with the table's.
+      assert(auto_resize_ || GetTableSize() < 256);
       use_detached_insert = true;
     }
     if (!use_detached_insert) {
@@ -549,7 +750,9 @@ Status HyperClockTable::Insert(const ClockHandleBasicData& proto,
       return Status::OK();
     }
     // Roll back table insertion
-    Rollback(proto.hashed_key, e);
+    if (e != nullptr) {
+      Rollback(proto.hashed_key, e);
+    }
     revert_occupancy_fn();
     // Maybe fall back on detached insert
     if (handle == nullptr) {
@@ -575,9 +778,25 @@ Status HyperClockTable::Insert(const ClockHandleBasicData& proto,
 
 HyperClockTable::HandleImpl* HyperClockTable::Lookup(
     const UniqueId64x2& hashed_key) {
+  if (sketch_) {
+    sketch_->Increment(hashed_key[1]);
+  }
+  const int num_generations = num_generations_.load(std::memory_order_acquire);
+  // Newest generation first, where most entries are inserted
+  for (int g = num_generations - 1; g >= 0; g--) {
+    HandleImpl* e = LookupInGeneration(generations_[g], hashed_key);
+    if (e != nullptr) {
+      return e;
+    }
+  }
+  return nullptr;
+}
+
+inline HyperClockTable::HandleImpl* HyperClockTable::LookupInGeneration(
+    const Generation& gen, const UniqueId64x2& hashed_key) {
   size_t probe = 0;
   HandleImpl* e = FindSlot(
-      hashed_key,
+      gen, hashed_key,
       [&](HandleImpl* h) {
         // Mostly branch-free version (similar performance)
         /*
@@ -705,7 +924,7 @@ bool HyperClockTable::Release(HandleImpl* h, bool useful,
     } else {
       Rollback(h->hashed_key, h);
       FreeDataMarkEmpty(*h, allocator_);
-      ReclaimEntryUsage(total_charge);
+      ReclaimEntryUsage(*h, total_charge);
     }
     return true;
   } else {
@@ -751,9 +970,17 @@ void HyperClockTable::TEST_ReleaseN(HandleImpl* h, size_t n) {
 }
 
 void HyperClockTable::Erase(const UniqueId64x2& hashed_key) {
+  const int num_generations = num_generations_.load(std::memory_order_acquire);
+  for (int g = num_generations - 1; g >= 0; g--) {
+    EraseInGeneration(generations_[g], hashed_key);
+  }
+}
+
+inline void HyperClockTable::EraseInGeneration(
+    const Generation& gen, const UniqueId64x2& hashed_key) {
   size_t probe = 0;
   (void)FindSlot(
-      hashed_key,
+      gen, hashed_key,
       [&](HandleImpl* h) {
         // Could be multiple entries in rare cases. Erase them all.
         // Optimistically increment acquire counter
@@ -790,7 +1017,7 @@ void HyperClockTable::Erase(const UniqueId64x2& hashed_key) {
                 assert(hashed_key == h->hashed_key);
                 size_t total_charge = h->GetTotalCharge();
                 FreeDataMarkEmpty(*h, allocator_);
-                ReclaimEntryUsage(total_charge);
+                ReclaimEntryUsage(*h, total_charge);
                 // We already have a copy of hashed_key in this case, so OK to
                 // delay Rollback until after releasing the entry
                 Rollback(hashed_key, h);
@@ -829,42 +1056,50 @@ void HyperClockTable::ConstApplyToEntriesRange(
     check_state_mask |= ClockHandle::kStateVisibleBit;
   }
 
-  for (size_t i = index_begin; i < index_end; i++) {
-    HandleImpl& h = array_[i];
-
-    // Note: to avoid using compare_exchange, we have to be extra careful.
-    uint64_t old_meta = h.meta.load(std::memory_order_relaxed);
-    // Check if it's an entry visible to lookups
-    if ((old_meta >> ClockHandle::kStateShift) & check_state_mask) {
-      // Increment acquire counter. Note: it's possible that the entry has
-      // completely changed since we loaded old_meta, but incrementing acquire
-      // count is always safe. (Similar to optimistic Lookup here.)
-      old_meta = h.meta.fetch_add(ClockHandle::kAcquireIncrement,
-                                  std::memory_order_acquire);
-      // Check whether we actually acquired a reference.
-      if ((old_meta >> ClockHandle::kStateShift) &
-          ClockHandle::kStateShareableBit) {
-        // Apply func if appropriate
-        if ((old_meta >> ClockHandle::kStateShift) & check_state_mask) {
-          func(h);
+  const int num_generations = num_generations_.load(std::memory_order_acquire);
+  for (int g = 0; g < num_generations; g++) {
+    const Generation& gen = generations_[g];
+    const size_t begin = std::max(index_begin, gen.begin);
+    const size_t end = std::min(index_end, gen.begin + gen.Size());
+    for (size_t i = begin; i < end; i++) {
+      HandleImpl& h = gen.array[i - gen.begin];
+
+      // Note: to avoid using compare_exchange, we have to be extra careful.
+      uint64_t old_meta = h.meta.load(std::memory_order_relaxed);
+      // Check if it's an entry visible to lookups
+      if ((old_meta >> ClockHandle::kStateShift) & check_state_mask) {
+        // Increment acquire counter. Note: it's possible that the entry has
+        // completely changed since we loaded old_meta, but incrementing
+        // acquire count is always safe. (Similar to optimistic Lookup here.)
+        old_meta = h.meta.fetch_add(ClockHandle::kAcquireIncrement,
+                                    std::memory_order_acquire);
+        // Check whether we actually acquired a reference.
+        if ((old_meta >> ClockHandle::kStateShift) &
+            ClockHandle::kStateShareableBit) {
+          // Apply func if appropriate
+          if ((old_meta >> ClockHandle::kStateShift) & check_state_mask) {
+            func(h);
+          }
+          // Pretend we never took the reference
+          h.meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                           std::memory_order_release);
+          // No net change, so don't need to check for overflow
+        } else {
+          // For other states, incrementing the acquire counter has no effect
+          // so we don't need to undo it. Furthermore, we cannot safely undo
+          // it because we did not acquire a read reference to lock the
+          // entry in a Shareable state.
         }
-        // Pretend we never took the reference
-        h.meta.fetch_sub(ClockHandle::kAcquireIncrement,
-                         std::memory_order_release);
-        // No net change, so don't need to check for overflow
-      } else {
-        // For other states, incrementing the acquire counter has no effect
-        // so we don't need to undo it. Furthermore, we cannot safely undo
-        // it because we did not acquire a read reference to lock the
-        // entry in a Shareable state.
       }
     }
   }
 }
 
 void HyperClockTable::EraseUnRefEntries() {
-  for (size_t i = 0; i <= this->length_bits_mask_; i++) {
-    HandleImpl& h = array_[i];
+  const int num_generations = num_generations_.load(std::memory_order_acquire);
+  const size_t table_size = GetTableSize();
+  for (size_t i = 0; i < table_size; i++) {
+    HandleImpl& h = GetSlot(i, num_generations);
 
     uint64_t old_meta = h.meta.load(std::memory_order_relaxed);
     if (old_meta & (uint64_t{ClockHandle::kStateShareableBit}
@@ -878,13 +1113,14 @@ void HyperClockTable::EraseUnRefEntries() {
       size_t total_charge = h.GetTotalCharge();
       Rollback(h.hashed_key, &h);
       FreeDataMarkEmpty(h, allocator_);
-      ReclaimEntryUsage(total_charge);
+      ReclaimEntryUsage(h, total_charge);
     }
   }
 }
 
 inline HyperClockTable::HandleImpl* HyperClockTable::FindSlot(
-    const UniqueId64x2& hashed_key, std::function<bool(HandleImpl*)> match_fn,
+    const Generation& gen, const UniqueId64x2& hashed_key,
+    std::function<bool(HandleImpl*)> match_fn,
     std::function<bool(HandleImpl*)> abort_fn,
     std::function<void(HandleImpl*)> update_fn, size_t& probe) {
   // NOTE: upper 32 bits of hashed_key[0] is used for sharding
@@ -900,9 +1136,9 @@ inline HyperClockTable::HandleImpl* HyperClockTable::FindSlot(
   // TODO: we could also reconsider linear probing, though locality benefits
   // are limited because each slot is a full cache line
   size_t increment = static_cast<size_t>(hashed_key[0]) | 1U;
-  size_t current = ModTableSize(base + probe * increment);
-  while (probe <= length_bits_mask_) {
-    HandleImpl* h = &array_[current];
+  size_t current = gen.ModTableSize(base + probe * increment);
+  while (probe <= gen.length_bits_mask) {
+    HandleImpl* h = &gen.array[current];
     if (match_fn(h)) {
       probe++;
       return h;
@@ -912,7 +1148,7 @@ inline HyperClockTable::HandleImpl* HyperClockTable::FindSlot(
     }
     probe++;
     update_fn(h);
-    current = ModTableSize(current + increment);
+    current = gen.ModTableSize(current + increment);
   }
   // We looped back.
   return nullptr;
@@ -920,25 +1156,89 @@ inline HyperClockTable::HandleImpl* HyperClockTable::FindSlot(
 
 inline void HyperClockTable::Rollback(const UniqueId64x2& hashed_key,
                                       const HandleImpl* h) {
-  size_t current = ModTableSize(hashed_key[1]);
+  Rollback(generations_[h->generation], hashed_key, h);
+}
+
+inline void HyperClockTable::Rollback(const Generation& gen,
+                                      const UniqueId64x2& hashed_key,
+                                      const HandleImpl* h) {
+  size_t current = gen.ModTableSize(hashed_key[1]);
   size_t increment = static_cast<size_t>(hashed_key[0]) | 1U;
-  while (&array_[current] != h) {
-    array_[current].displacements.fetch_sub(1, std::memory_order_relaxed);
-    current = ModTableSize(current + increment);
+  for (size_t i = 0; i <= gen.length_bits_mask; i++) {
+    if (&gen.array[current] == h) {
+      break;
+    }
+    gen.array[current].displacements.fetch_sub(1, std::memory_order_relaxed);
+    current = gen.ModTableSize(current + increment);
   }
 }
 
-inline void HyperClockTable::ReclaimEntryUsage(size_t total_charge) {
+inline void HyperClockTable::ReclaimEntryUsage(const HandleImpl& h,
+                                               size_t total_charge) {
   auto old_occupancy = occupancy_.fetch_sub(1U, std::memory_order_release);
   (void)old_occupancy;
   // No underflow
   assert(old_occupancy > 0);
+  if (auto_resize_) {
+    ReleaseGenerationOccupancy(h.generation);
+  }
   auto old_usage = usage_.fetch_sub(total_charge, std::memory_order_relaxed);
   (void)old_usage;
   // No underflow
   assert(old_usage >= total_charge);
 }
 
+inline bool HyperClockTable::AdmitByFrequency(
+    const UniqueId64x2& hashed_key) {
+  // Few enough to be cheap, enough to usually find an unreferenced entry
+  constexpr size_t kPeekSlots = 8;
+
+  const uint64_t clock_pointer =
+      clock_pointer_.load(std::memory_order_relaxed);
+  const int num_generations = num_generations_.load(std::memory_order_acquire);
+  const Generation& newest = generations_[num_generations - 1];
+  const size_t table_size = newest.begin + newest.Size();
+
+  bool found_victim = false;
+  uint64_t victim_countdown = 0;
+  UniqueId64x2 victim_key{};
+  for (size_t i = 0; i < kPeekSlots; i++) {
+    size_t index = Lower32of64(clock_pointer + i);
+    HandleImpl& h =
+        num_generations == 1
+            ? generations_[0].array[generations_[0].ModTableSize(index)]
+            : GetSlot(index % table_size, num_generations);
+    if ((h.meta.load(std::memory_order_relaxed) >> ClockHandle::kStateShift) !=
+        ClockHandle::kStateVisible) {
+      continue;
+    }
+    // Take a read reference (as in Lookup) to safely read the key
+    uint64_t old_meta = h.meta.fetch_add(ClockHandle::kAcquireIncrement,
+                                         std::memory_order_acquire);
+    uint64_t old_state = old_meta >> ClockHandle::kStateShift;
+    if (old_state == ClockHandle::kStateVisible) {
+      uint64_t countdown = (old_meta >> ClockHandle::kAcquireCounterShift) &
+                           ClockHandle::kCounterMask;
+      // Referenced entries cannot be evicted
+      if (GetRefcount(old_meta) == 0 &&
+          (!found_victim || countdown < victim_countdown)) {
+        found_victim = true;
+        victim_countdown = countdown;
+        victim_key = h.hashed_key;
+      }
+    }
+    if (old_state == ClockHandle::kStateVisible ||
+        old_state == ClockHandle::kStateInvisible) {
+      h.meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                       std::memory_order_release);
+    }
+  }
+  if (!found_victim) {
+    return true;
+  }
+  return sketch_->Estimate(hashed_key[1]) > sketch_->Estimate(victim_key[1]);
+}
+
 inline void HyperClockTable::Evict(size_t requested_charge,
                                    size_t* freed_charge, size_t* freed_count) {
   // precondition
@@ -951,22 +1251,34 @@ inline void HyperClockTable::Evict(size_t requested_charge,
   uint64_t old_clock_pointer =
       clock_pointer_.fetch_add(step_size, std::memory_order_relaxed);
 
+  // The clock sweeps the slots of all the generations, in order
+  const int num_generations = num_generations_.load(std::memory_order_acquire);
+  const Generation& newest = generations_[num_generations - 1];
+  const size_t table_size = newest.begin + newest.Size();
+
   // Cap the eviction effort at this thread (along with those operating in
   // parallel) circling through the whole structure kMaxCountdown times.
   // In other words, this eviction run must find something/anything that is
   // unreferenced at start of and during the eviction run that isn't reclaimed
   // by a concurrent eviction run.
   uint64_t max_clock_pointer =
-      old_clock_pointer + (ClockHandle::kMaxCountdown << length_bits_);
+      old_clock_pointer + uint64_t{ClockHandle::kMaxCountdown} * table_size;
 
   for (;;) {
     for (size_t i = 0; i < step_size; i++) {
-      HandleImpl& h = array_[ModTableSize(Lower32of64(old_clock_pointer + i))];
+      size_t index = Lower32of64(old_clock_pointer + i);
+      HandleImpl& h =
+          num_generations == 1
+              ? generations_[0].array[generations_[0].ModTableSize(index)]
+              : GetSlot(index % table_size, num_generations);
       bool evicting = ClockUpdate(h);
       if (evicting) {
         Rollback(h.hashed_key, &h);
         *freed_charge += h.GetTotalCharge();
         *freed_count += 1;
+        if (auto_resize_) {
+          ReleaseGenerationOccupancy(h.generation);
+        }
         FreeDataMarkEmpty(h, allocator_);
       }
     }
@@ -994,7 +1306,8 @@ ClockCacheShard<Table>::ClockCacheShard(
       table_(capacity, strict_capacity_limit, metadata_charge_policy, allocator,
              opts),
       capacity_(capacity),
-      strict_capacity_limit_(strict_capacity_limit) {
+      strict_capacity_limit_(strict_capacity_limit),
+      eviction_cost_policy_(opts.eviction_cost_policy) {
   // Initial charge metadata should not exceed capacity
   assert(table_.GetUsage() <= capacity_ || capacity_ < sizeof(HandleImpl));
 }
@@ -1010,25 +1323,20 @@ void ClockCacheShard<Table>::ApplyToSomeEntries(
                              size_t charge,
                              const Cache::CacheItemHelper* helper)>& callback,
     size_t average_entries_per_lock, size_t* state) {
-  // The state is essentially going to be the starting hash, which works
-  // nicely even if we resize between calls because we use upper-most
-  // hash bits for table indexes.
-  size_t length_bits = table_.GetLengthBits();
+  // The state is the number of the next slot, which works even if the table
+  // grows between calls because slots are only ever added at the end.
   size_t length = table_.GetTableSize();
 
   assert(average_entries_per_lock > 0);
-  // Assuming we are called with same average_entries_per_lock repeatedly,
-  // this simplifies some logic (index_end will not overflow).
-  assert(average_entries_per_lock < length || *state == 0);
 
-  size_t index_begin = *state >> (sizeof(size_t) * 8u - length_bits);
+  size_t index_begin = *state;
   size_t index_end = index_begin + average_entries_per_lock;
   if (index_end >= length) {
     // Going to end.
     index_end = length;
     *state = SIZE_MAX;
   } else {
-    *state = index_end << (sizeof(size_t) * 8u - length_bits);
+    *state = index_end;
   }
 
   table_.ConstApplyToEntriesRange(
@@ -1092,6 +1400,10 @@ Status ClockCacheShard<Table>::Insert(const Slice& key,
   proto.value = value;
   proto.helper = helper;
   proto.total_charge = charge;
+  if (eviction_cost_policy_) {
+    priority = GetPriorityForMissCost(
+        eviction_cost_policy_->GetMissCost(key, helper->role));
+  }
   Status s = table_.Insert(
       proto, handle, priority, capacity_.load(std::memory_order_relaxed),
       strict_capacity_limit_.load(std::memory_order_relaxed));
@@ -1216,18 +1528,22 @@ HyperClockCache::HyperClockCache(
     size_t capacity, size_t estimated_value_size, int num_shard_bits,
     bool strict_capacity_limit,
     CacheMetadataChargePolicy metadata_charge_policy,
-    std::shared_ptr<MemoryAllocator> memory_allocator)
+    std::shared_ptr<MemoryAllocator> memory_allocator, bool tiny_lfu_admission,
+    std::shared_ptr<CacheEvictionCostPolicy> eviction_cost_policy)
     : ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
-                   std::move(memory_allocator)) {
-  assert(estimated_value_size > 0 ||
-         metadata_charge_policy != kDontChargeCacheMetadata);
+                   std::move(memory_allocator),
+                   std::move(eviction_cost_policy)),
+      auto_resize_(estimated_value_size == 0) {
   // TODO: should not need to go through two levels of pointer indirection to
   // get to table entries
   size_t per_shard = GetPerShardCapacity();
   MemoryAllocator* alloc = this->memory_allocator();
+  CacheEvictionCostPolicy* cost_policy = eviction_cost_policy_.get();
   InitShards([=](Shard* cs) {
     HyperClockTable::Opts opts;
     opts.estimated_value_size = estimated_value_size;
+    opts.tiny_lfu_admission = tiny_lfu_admission;
+    opts.eviction_cost_policy = cost_policy;
     new (cs) Shard(per_shard, strict_capacity_limit, metadata_charge_policy,
                    alloc, opts);
   });
@@ -1286,6 +1602,11 @@ void AddShardEvaluation(const HyperClockCache::Shard& shard,
 
 void HyperClockCache::ReportProblems(
     const std::shared_ptr<Logger>& info_log) const {
+  if (auto_resize_) {
+    // The problems reported are about estimated_entry_charge, which is not
+    // used with automatic sizing
+    return;
+  }
   uint32_t shard_count = GetNumShards();
   std::vector<double> predicted_load_factors;
   size_t min_recommendation = SIZE_MAX;
@@ -1401,7 +1722,8 @@ std::shared_ptr<Cache> HyperClockCacheOptions::MakeSharedCache() const {
   }
   return std::make_shared<clock_cache::HyperClockCache>(
       capacity, estimated_entry_charge, my_num_shard_bits,
-      strict_capacity_limit, metadata_charge_policy, memory_allocator);
+      strict_capacity_limit, metadata_charge_policy, memory_allocator,
+      tiny_lfu_admission, eviction_cost_policy);
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -14,9 +14,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "cache/cache_key.h"
+#include "cache/frequency_sketch.h"
 #include "cache/sharded_cache.h"
 #include "port/lang.h"
 #include "port/malloc.h"
@@ -49,7 +51,9 @@ class ClockCacheTest;
 // -----
 // * Hash table is not resizable (for lock-free efficiency) so capacity is not
 // dynamically changeable. Rely on an estimated average value (block) size for
-// space+time efficiency. (See estimated_entry_charge option details.)
+// space+time efficiency. (See estimated_entry_charge option details.) With
+// estimated_entry_charge = 0, the table instead grows in "generations" (see
+// Automatic sizing below), at some cost in Lookup time.
 // * Insert usually does not (but might) overwrite a previous entry associated
 // with a cache key. This is OK for RocksDB uses of Cache.
 // * Only supports keys of exactly 16 bytes, which is what RocksDB uses for
@@ -278,6 +282,26 @@ class ClockCacheTest;
 // a best effort to immediately release an Invisible entry that reaches zero
 // refs, but there are some corner cases where it will only be freed by the
 // clock eviction process.
+//
+// Automatic sizing
+// ----------------
+// Slots cannot be moved while they might be referenced, so the table cannot
+// be rehashed into a larger array. Instead, with automatic sizing, a shard's
+// table is a list of up to kMaxGenerations power-of-two arrays of slots
+// ("generations"), each an independent open-addressing table. The table
+// starts with one generation sized for a large entry charge. When an Insert
+// finds the table at its occupancy limit while the shard is under capacity,
+// meaning that the entries are smaller than the table was sized for, it adds
+// a generation sized from the observed average charge of the entries. Only
+// one thread grows a shard at a time; others proceed without waiting (by
+// evicting, as with a fixed table). Generations are only appended and freed
+// with the table, so handles and Lookup remain lock-free.
+//
+// Insert prefers the newest (largest) generation with spare occupancy, and
+// Lookup and Erase probe the generations from newest to oldest. Thus a miss
+// costs some probes per generation, and entries in older generations are
+// found a bit more slowly, until they are evicted. The clock sweeps the
+// generations as if they were concatenated.
 
 // ----------------------------------------------------------------------- //
 
@@ -400,15 +424,26 @@ class HyperClockTable {
     // regression.
     bool detached = false;
 
+    // The generation of the table this slot belongs to (constant)
+    uint8_t generation = 0;
+
     inline bool IsDetached() const { return detached; }
 
     inline void SetDetached() { detached = true; }
   };  // struct HandleImpl
 
   struct Opts {
+    // Zero for automatic sizing (see above)
     size_t estimated_value_size;
+    // See ShardedCacheOptions::tiny_lfu_admission
+    bool tiny_lfu_admission = false;
+    // See ShardedCacheOptions::eviction_cost_policy. Used by ClockCacheShard.
+    CacheEvictionCostPolicy* eviction_cost_policy = nullptr;
   };
 
+  // Maximum number of generations with automatic sizing
+  static constexpr int kMaxGenerations = 16;
+
   HyperClockTable(size_t capacity, bool strict_capacity_limit,
                   CacheMetadataChargePolicy metadata_charge_policy,
                   MemoryAllocator* allocator, const Opts& opts);
@@ -432,15 +467,26 @@ class HyperClockTable {
 
   void EraseUnRefEntries();
 
-  size_t GetTableSize() const { return size_t{1} << length_bits_; }
+  // Total number of slots of all the generations. Slots are numbered across
+  // generations in order, so the slot numbers, as used by
+  // ConstApplyToEntriesRange, remain valid as the table grows.
+  size_t GetTableSize() const {
+    return table_size_.load(std::memory_order_relaxed);
+  }
+
+  int GetNumGenerations() const {
+    return num_generations_.load(std::memory_order_relaxed);
+  }
 
-  int GetLengthBits() const { return length_bits_; }
+  bool IsAutoResize() const { return auto_resize_; }
 
   size_t GetOccupancy() const {
     return occupancy_.load(std::memory_order_relaxed);
   }
 
-  size_t GetOccupancyLimit() const { return occupancy_limit_; }
+  size_t GetOccupancyLimit() const {
+    return occupancy_limit_.load(std::memory_order_relaxed);
+  }
 
   size_t GetUsage() const { return usage_.load(std::memory_order_relaxed); }
 
@@ -452,11 +498,54 @@ class HyperClockTable {
   void TEST_RefN(HandleImpl& handle, size_t n);
   void TEST_ReleaseN(HandleImpl* handle, size_t n);
 
+ private:  // types
+  // An array of slots, which is an open-addressing table on its own
+  struct Generation {
+    // Number of hash bits used for table index.
+    // The size of the array is 1 << length_bits.
+    int length_bits = 0;
+    // For faster computation of ModTableSize.
+    size_t length_bits_mask = 0;
+    // Number of the first slot of the generation in the whole table
+    size_t begin = 0;
+    // Maximum number of elements stored in the generation
+    size_t occupancy_limit = 0;
+    HandleImpl* array = nullptr;
+
+    size_t Size() const { return size_t{1} << length_bits; }
+
+    // Returns x mod 2^{length_bits}.
+    inline size_t ModTableSize(uint64_t x) const {
+      return static_cast<size_t>(x) & length_bits_mask;
+    }
+  };
+
  private:  // functions
-  // Returns x mod 2^{length_bits_}.
-  inline size_t ModTableSize(uint64_t x) {
-    return static_cast<size_t>(x) & length_bits_mask_;
-  }
+  // Allocates generation `generation` with 2^length_bits slots, starting at
+  // slot `begin` of the whole table, and publishes it. REQUIRES: the
+  // generation is the next one and no other thread is adding a generation.
+  void AddGeneration(int generation, int length_bits, size_t begin);
+
+  // With automatic sizing, tries to add a generation when the table is at
+  // its occupancy limit, if the entries in the shard are smaller on average
+  // than the table was sized for. Returns whether a generation was added
+  // (by this or a concurrent thread). Never waits for another thread.
+  bool MaybeGrow(size_t total_charge, size_t capacity);
+
+  // Returns the slot with number `index` in the whole table of
+  // `num_generations` generations.
+  inline HandleImpl& GetSlot(size_t index, int num_generations);
+
+  // Lookup and Erase within a single generation
+  inline HandleImpl* LookupInGeneration(const Generation& gen,
+                                        const UniqueId64x2& hashed_key);
+  inline void EraseInGeneration(const Generation& gen,
+                                const UniqueId64x2& hashed_key);
+
+  // With automatic sizing, reserves occupancy in a generation for an Insert.
+  // Returns false (without reserving) if the generation is full.
+  inline bool ReserveGenerationOccupancy(int generation);
+  inline void ReleaseGenerationOccupancy(int generation);
 
   // Runs the clock eviction algorithm trying to reclaim at least
   // requested_charge. Returns how much is evicted, which could be less
@@ -475,7 +564,9 @@ class HyperClockTable {
   // value of probe is one more than the last non-aborting probe during the
   // call. This is so that that the variable can be used to keep track of
   // progress across consecutive calls to FindSlot.
-  inline HandleImpl* FindSlot(const UniqueId64x2& hashed_key,
+  // The probe sequence is within a single generation `gen`.
+  inline HandleImpl* FindSlot(const Generation& gen,
+                              const UniqueId64x2& hashed_key,
                               std::function<bool(HandleImpl*)> match,
                               std::function<bool(HandleImpl*)> stop,
                               std::function<void(HandleImpl*)> update,
@@ -485,12 +576,18 @@ class HyperClockTable {
   // until (not including) the given handle
   inline void Rollback(const UniqueId64x2& hashed_key, const HandleImpl* h);
 
-  // Subtracts `total_charge` from `usage_` and 1 from `occupancy_`.
+  // Same, in generation `gen`, where a null `h` means the whole probe path
+  // (after FindSlot probed the whole generation without success)
+  inline void Rollback(const Generation& gen, const UniqueId64x2& hashed_key,
+                       const HandleImpl* h);
+
+  // Subtracts `total_charge` from `usage_` and 1 from `occupancy_` (and
+  // from the occupancy of the generation of `h` with automatic sizing).
   // Ideally this comes after releasing the entry itself so that we
   // actually have the available occupancy/usage that is claimed.
   // However, that means total_charge has to be saved from the handle
   // before releasing it so that it can be provided to this function.
-  inline void ReclaimEntryUsage(size_t total_charge);
+  inline void ReclaimEntryUsage(const HandleImpl& h, size_t total_charge);
 
   // Helper for updating `usage_` for new entry with given `total_charge`
   // and evicting if needed under strict_capacity_limit=true rules. This
@@ -519,6 +616,13 @@ class HyperClockTable {
   // Updates `detached_usage_` but not `usage_` nor `occupancy_`.
   inline HandleImpl* DetachedInsert(const ClockHandleBasicData& proto);
 
+  // With TinyLFU admission, decides whether an entry that requires an
+  // eviction should be inserted: only if its estimated lookup frequency is
+  // higher than that of the likely next victim, the unreferenced entry with
+  // the lowest clock countdown among the next few slots ahead of the clock
+  // pointer. Admits if no such entry is found.
+  inline bool AdmitByFrequency(const UniqueId64x2& hashed_key);
+
   MemoryAllocator* GetAllocator() const { return allocator_; }
 
   // Returns the number of bits used to hash an element in the hash
@@ -527,22 +631,35 @@ class HyperClockTable {
                           CacheMetadataChargePolicy metadata_charge_policy);
 
  private:  // data
-  // Number of hash bits used for table index.
-  // The size of the table is 1 << length_bits_.
-  const int length_bits_;
+  // Whether the table grows automatically (estimated_value_size == 0).
+  // Otherwise, the table has a single generation.
+  const bool auto_resize_;
+
+  const CacheMetadataChargePolicy metadata_charge_policy_;
+
+  // Generations of slots comprising the hash table. Entries below
+  // num_generations_ are immutable (except for the slots in the arrays),
+  // and the arrays are owned by the table.
+  std::array<Generation, kMaxGenerations> generations_;
 
-  // For faster computation of ModTableSize.
-  const size_t length_bits_mask_;
+  // Number of generations published to all operations
+  std::atomic<int> num_generations_{};
+
+  // Total number of slots of the published generations
+  std::atomic<size_t> table_size_{};
 
   // Maximum number of elements the user can store in the table.
-  const size_t occupancy_limit_;
+  std::atomic<size_t> occupancy_limit_{};
 
-  // Array of slots comprising the hash table.
-  const std::unique_ptr<HandleImpl[]> array_;
+  // Held by the thread adding a generation
+  std::mutex grow_mutex_;
 
   // From Cache, for deleter
   MemoryAllocator* const allocator_;
 
+  // Recent lookup frequencies, if tiny_lfu_admission
+  std::unique_ptr<FrequencySketch> sketch_;
+
   // We partition the following members into different cache lines
   // to avoid false sharing among Lookup, Release, Erase and Insert
   // operations in ClockCacheShard.
@@ -560,6 +677,10 @@ class HyperClockTable {
 
   // Part of usage by detached entries (not in table)
   std::atomic<size_t> detached_usage_{};
+
+  // Number of elements in each generation, only maintained with automatic
+  // sizing
+  std::array<std::atomic<size_t>, kMaxGenerations> generation_occupancy_{};
 };  // class HyperClockTable
 
 // A single shard of sharded cache.
@@ -667,6 +788,9 @@ class ALIGN_AS(CACHE_LINE_SIZE) ClockCacheShard final : public CacheShardBase {
 
   // Whether to reject insertion if cache reaches its full capacity.
   std::atomic<bool> strict_capacity_limit_;
+
+  // Owned by the cache. See ShardedCacheOptions::eviction_cost_policy.
+  CacheEvictionCostPolicy* const eviction_cost_policy_;
 };  // class ClockCacheShard
 
 class HyperClockCache
@@ -680,7 +804,10 @@ class HyperClockCache
   HyperClockCache(size_t capacity, size_t estimated_value_size,
                   int num_shard_bits, bool strict_capacity_limit,
                   CacheMetadataChargePolicy metadata_charge_policy,
-                  std::shared_ptr<MemoryAllocator> memory_allocator);
+                  std::shared_ptr<MemoryAllocator> memory_allocator,
+                  bool tiny_lfu_admission = false,
+                  std::shared_ptr<CacheEvictionCostPolicy>
+                      eviction_cost_policy = nullptr);
 
   const char* Name() const override { return "HyperClockCache"; }
 
@@ -692,6 +819,10 @@ class HyperClockCache
 
   void ReportProblems(
       const std::shared_ptr<Logger>& /*info_log*/) const override;
+
+ private:
+  // Whether the tables are automatically sized (estimated_value_size == 0)
+  const bool auto_resize_;
 };  // class HyperClockCache
 
 }  // namespace clock_cache
@@ -7,8 +7,10 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 
+#include "cache/cache_key.h"
 #include "memory/memory_allocator.h"
 #include "monitoring/perf_context_imp.h"
 #include "util/compression.h"
@@ -24,18 +26,64 @@ CompressedSecondaryCache::CompressedSecondaryCache(
     CompressionType compression_type, uint32_t compress_format_version,
     bool enable_custom_split_merge,
     const CacheEntryRoleSet& do_not_compress_roles)
-    : cache_options_(capacity, num_shard_bits, strict_capacity_limit,
-                     high_pri_pool_ratio, low_pri_pool_ratio, memory_allocator,
-                     use_adaptive_mutex, metadata_charge_policy,
-                     compression_type, compress_format_version,
-                     enable_custom_split_merge, do_not_compress_roles) {
-  cache_ =
-      NewLRUCache(capacity, num_shard_bits, strict_capacity_limit,
-                  high_pri_pool_ratio, memory_allocator, use_adaptive_mutex,
-                  metadata_charge_policy, low_pri_pool_ratio);
+    : CompressedSecondaryCache(CompressedSecondaryCacheOptions(
+          capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
+          low_pri_pool_ratio, memory_allocator, use_adaptive_mutex,
+          metadata_charge_policy, compression_type, compress_format_version,
+          enable_custom_split_merge, do_not_compress_roles)) {}
+
+CompressedSecondaryCache::CompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts)
+    : cache_options_(opts),
+      clock_(SystemClock::Default().get()),
+      role_counters_(new RoleCounters[kNumCacheEntryRoles]) {
+  cache_ = NewLRUCache(opts.capacity, opts.num_shard_bits,
+                       opts.strict_capacity_limit, opts.high_pri_pool_ratio,
+                       opts.memory_allocator, opts.use_adaptive_mutex,
+                       opts.metadata_charge_policy, opts.low_pri_pool_ratio);
+  for (uint32_t i = 0; i < kNumCacheEntryRoles; ++i) {
+    role_compression_[i].role = static_cast<CacheEntryRole>(i);
+    role_compression_[i].type = opts.compression_type;
+  }
+  for (const CacheEntryRoleCompression& rc : opts.role_compression) {
+    role_compression_[static_cast<uint32_t>(rc.role)] = rc;
+  }
+  for (CacheEntryRoleCompression& rc : role_compression_) {
+    if (opts.do_not_compress_roles.Contains(rc.role)) {
+      rc.type = kNoCompression;
+    }
+    if (rc.type == kZSTD || rc.type == kZSTDNotFinalCompression) {
+      using_zstd_ = true;
+    }
+  }
+  if (opts.compression_threads > 0) {
+    compression_pool_.reset(NewThreadPool(opts.compression_threads));
+  }
 }
 
-CompressedSecondaryCache::~CompressedSecondaryCache() { cache_.reset(); }
+CompressedSecondaryCache::~CompressedSecondaryCache() {
+  if (compression_pool_) {
+    compression_pool_->WaitForJobsAndJoinAllThreads();
+  }
+  for (auto& pinned_dict : pinned_dicts_) {
+    cache_->Release(pinned_dict.second, /*erase_if_last_ref=*/false);
+  }
+  cache_.reset();
+}
+
+Cache::Handle* CompressedSecondaryCache::LookupDict(const Slice& key) {
+  if (key.size() <= OffsetableCacheKey::kCommonPrefixSize) {
+    return nullptr;
+  }
+  Cache::Handle* dict_handle =
+      cache_->Lookup(Slice(key.data(), OffsetableCacheKey::kCommonPrefixSize));
+  if (dict_handle != nullptr &&
+      cache_->GetCacheItemHelper(dict_handle) != GetDictHelper()) {
+    cache_->Release(dict_handle, /*erase_if_last_ref=*/false);
+    return nullptr;
+  }
+  return dict_handle;
+}
 
 std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
     const Slice& key, const Cache::CacheItemHelper* helper,
@@ -55,10 +103,17 @@ std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
     return nullptr;
   }
 
+  const Cache::CacheItemHelper* internal_helper =
+      cache_->GetCacheItemHelper(lru_handle);
+  const bool pending = internal_helper == GetPendingHelper();
+  const bool with_dict =
+      internal_helper ==
+      GetHelper(cache_options_.enable_custom_split_merge, /*with_dict=*/true);
+
   CacheAllocationPtr* ptr{nullptr};
   CacheAllocationPtr merged_value;
   size_t handle_value_charge{0};
-  if (cache_options_.enable_custom_split_merge) {
+  if (cache_options_.enable_custom_split_merge && !pending) {
     CacheValueChunk* value_chunk_ptr =
         reinterpret_cast<CacheValueChunk*>(handle_value);
     merged_value = MergeChunksIntoValue(value_chunk_ptr, handle_value_charge);
@@ -72,20 +127,44 @@ std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
   Status s;
   Cache::ObjectPtr value{nullptr};
   size_t charge{0};
-  if (cache_options_.compression_type == kNoCompression ||
-      cache_options_.do_not_compress_roles.Contains(helper->role)) {
+  const CompressionType compression_type =
+      pending ? kNoCompression
+              : role_compression_[static_cast<uint32_t>(helper->role)].type;
+  if (compression_type == kNoCompression) {
     s = helper->create_cb(Slice(ptr->get(), handle_value_charge),
                           create_context, allocator, &value, &charge);
   } else {
-    UncompressionContext uncompression_context(cache_options_.compression_type);
-    UncompressionInfo uncompression_info(uncompression_context,
-                                         UncompressionDict::GetEmptyDict(),
-                                         cache_options_.compression_type);
-
+    Cache::Handle* dict_handle = nullptr;
+    if (with_dict) {
+      dict_handle = LookupDict(key);
+      if (dict_handle == nullptr) {
+        // Cannot be decompressed anymore
+        cache_->Release(lru_handle, /*erase_if_last_ref=*/true);
+        return nullptr;
+      }
+    }
+    const UncompressionDict& dict =
+        dict_handle != nullptr
+            ? static_cast<DictEntry*>(cache_->Value(dict_handle))
+                  ->uncompression_dict
+            : UncompressionDict::GetEmptyDict();
+    UncompressionContext uncompression_context(compression_type);
+    UncompressionInfo uncompression_info(uncompression_context, dict,
+                                         compression_type);
+
+    const uint64_t start_nanos = clock_->NowNanos();
     size_t uncompressed_size{0};
     CacheAllocationPtr uncompressed = UncompressData(
         uncompression_info, (char*)ptr->get(), handle_value_charge,
         &uncompressed_size, cache_options_.compress_format_version, allocator);
+    RoleCounters& counters =
+        role_counters_[static_cast<uint32_t>(helper->role)];
+    counters.decompressed_count.fetch_add(1, std::memory_order_relaxed);
+    counters.decompress_nanos.fetch_add(clock_->NowNanos() - start_nanos,
+                                        std::memory_order_relaxed);
+    if (dict_handle != nullptr) {
+      cache_->Release(dict_handle, /*erase_if_last_ref=*/false);
+    }
 
     if (!uncompressed) {
       cache_->Release(lru_handle, /*erase_if_last_ref=*/true);
@@ -144,33 +223,21 @@ Status CompressedSecondaryCache::Insert(const Slice& key,
   }
   Slice val(ptr.get(), size);
 
-  std::string compressed_val;
-  if (cache_options_.compression_type != kNoCompression &&
-      !cache_options_.do_not_compress_roles.Contains(helper->role)) {
-    PERF_COUNTER_ADD(compressed_sec_cache_uncompressed_bytes, size);
-    CompressionOptions compression_opts;
-    CompressionContext compression_context(cache_options_.compression_type);
-    uint64_t sample_for_compression{0};
-    CompressionInfo compression_info(
-        compression_opts, compression_context, CompressionDict::GetEmptyDict(),
-        cache_options_.compression_type, sample_for_compression);
-
-    bool success =
-        CompressData(val, compression_info,
-                     cache_options_.compress_format_version, &compressed_val);
-
-    if (!success) {
-      return Status::Corruption("Error compressing value.");
+  if (role_compression_[static_cast<uint32_t>(helper->role)].type !=
+      kNoCompression) {
+    if (!compression_pool_) {
+      return CompressAndInsert(key, val, helper->role);
     }
-
-    val = Slice(compressed_val);
-    size = compressed_val.size();
-    PERF_COUNTER_ADD(compressed_sec_cache_compressed_bytes, size);
-
-    if (!cache_options_.enable_custom_split_merge) {
-      ptr = AllocateBlock(size, cache_options_.memory_allocator.get());
-      memcpy(ptr.get(), compressed_val.data(), size);
+    // Cached uncompressed until compressed in the background
+    CacheAllocationPtr* buf = new CacheAllocationPtr(std::move(ptr));
+    s = cache_->Insert(key, buf, GetPendingHelper(), size);
+    if (s.ok()) {
+      compression_pool_->SubmitJob(
+          [this, key_str = key.ToString(), role = helper->role]() {
+            CompressPending(key_str, role);
+          });
     }
+    return s;
   }
 
   PERF_COUNTER_ADD(compressed_sec_cache_insert_real_count, 1);
@@ -185,7 +252,168 @@ Status CompressedSecondaryCache::Insert(const Slice& key,
   }
 }
 
-void CompressedSecondaryCache::Erase(const Slice& key) { cache_->Erase(key); }
+Status CompressedSecondaryCache::CompressAndInsert(const Slice& key,
+                                                   const Slice& value,
+                                                   CacheEntryRole role) {
+  const CacheEntryRoleCompression& rc =
+      role_compression_[static_cast<uint32_t>(role)];
+  assert(rc.type != kNoCompression);
+  Cache::Handle* dict_handle = nullptr;
+  if (cache_options_.use_compression_dict &&
+      DictCompressionTypeSupported(rc.type)) {
+    dict_handle = LookupDict(key);
+  }
+  const CompressionDict& dict =
+      dict_handle != nullptr
+          ? static_cast<DictEntry*>(cache_->Value(dict_handle))
+                ->compression_dict
+          : CompressionDict::GetEmptyDict();
+
+  PERF_COUNTER_ADD(compressed_sec_cache_uncompressed_bytes, value.size());
+  CompressionOptions compression_opts;
+  compression_opts.level = rc.level;
+  CompressionContext compression_context(rc.type);
+  uint64_t sample_for_compression{0};
+  CompressionInfo compression_info(compression_opts, compression_context, dict,
+                                   rc.type, sample_for_compression);
+
+  const uint64_t start_nanos = clock_->NowNanos();
+  std::string compressed_val;
+  bool success =
+      CompressData(value, compression_info,
+                   cache_options_.compress_format_version, &compressed_val);
+  const uint64_t compress_nanos = clock_->NowNanos() - start_nanos;
+  if (dict_handle != nullptr) {
+    cache_->Release(dict_handle, /*erase_if_last_ref=*/false);
+  }
+
+  if (!success) {
+    return Status::Corruption("Error compressing value.");
+  }
+
+  const size_t size = compressed_val.size();
+  PERF_COUNTER_ADD(compressed_sec_cache_compressed_bytes, size);
+  RoleCounters& counters = role_counters_[static_cast<uint32_t>(role)];
+  counters.compressed_count.fetch_add(1, std::memory_order_relaxed);
+  if (dict_handle != nullptr) {
+    counters.dict_compressed_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  counters.uncompressed_bytes.fetch_add(value.size(),
+                                        std::memory_order_relaxed);
+  counters.compressed_bytes.fetch_add(size, std::memory_order_relaxed);
+  counters.compress_nanos.fetch_add(compress_nanos, std::memory_order_relaxed);
+
+  auto internal_helper = GetHelper(cache_options_.enable_custom_split_merge,
+                                   /*with_dict=*/dict_handle != nullptr);
+  PERF_COUNTER_ADD(compressed_sec_cache_insert_real_count, 1);
+  if (cache_options_.enable_custom_split_merge) {
+    size_t charge{0};
+    CacheValueChunk* value_chunks_head =
+        SplitValueIntoChunks(compressed_val, rc.type, charge);
+    return cache_->Insert(key, value_chunks_head, internal_helper, charge);
+  } else {
+    CacheAllocationPtr ptr =
+        AllocateBlock(size, cache_options_.memory_allocator.get());
+    memcpy(ptr.get(), compressed_val.data(), size);
+    CacheAllocationPtr* buf = new CacheAllocationPtr(std::move(ptr));
+    return cache_->Insert(key, buf, internal_helper, size);
+  }
+}
+
+void CompressedSecondaryCache::CompressPending(const std::string& key,
+                                               CacheEntryRole role) {
+  Cache::Handle* lru_handle = cache_->Lookup(key);
+  if (lru_handle == nullptr) {
+    return;
+  }
+  // Unless erased or replaced since
+  if (cache_->GetCacheItemHelper(lru_handle) == GetPendingHelper()) {
+    auto ptr = static_cast<CacheAllocationPtr*>(cache_->Value(lru_handle));
+    // Replaces the pending entry, whose value is kept alive by lru_handle
+    CompressAndInsert(key, Slice(ptr->get(), cache_->GetCharge(lru_handle)),
+                      role)
+        .PermitUncheckedError();
+  }
+  cache_->Release(lru_handle, /*erase_if_last_ref=*/false);
+}
+
+void CompressedSecondaryCache::TEST_WaitForCompression() {
+  if (compression_pool_) {
+    compression_pool_->WaitForJobsAndJoinAllThreads();
+    compression_pool_->SetBackgroundThreads(
+        cache_options_.compression_threads);
+  }
+}
+
+void CompressedSecondaryCache::SetCompressionDict(const Slice& key_prefix,
+                                                  const Slice& dict) {
+  if (!cache_options_.use_compression_dict || dict.empty()) {
+    return;
+  }
+  Cache::Handle* dict_handle = cache_->Lookup(key_prefix);
+  if (dict_handle != nullptr) {
+    // Already known, as dictionaries do not change
+    cache_->Release(dict_handle, /*erase_if_last_ref=*/false);
+    return;
+  }
+  MutexLock l(&dict_mutex_);
+  if (pinned_dicts_.count(key_prefix.ToString()) > 0) {
+    // Pinned by a concurrent call
+    return;
+  }
+  // Pinned, as each table reader sends its dictionary only once and the
+  // blocks compressed with it cannot be read anymore without it
+  DictEntry* dict_entry = new DictEntry(dict.ToString(), using_zstd_);
+  Cache::Handle* pinned_handle = nullptr;
+  Status s = cache_->Insert(key_prefix, dict_entry, GetDictHelper(),
+                            dict.size(), &pinned_handle, Cache::Priority::HIGH);
+  if (!s.ok()) {
+    delete dict_entry;
+    return;
+  }
+  pinned_dicts_.emplace(key_prefix.ToString(), pinned_handle);
+}
+
+void CompressedSecondaryCache::GetStats(
+    std::vector<CompressedSecondaryCacheRoleStats>* stats) const {
+  stats->assign(kNumCacheEntryRoles, CompressedSecondaryCacheRoleStats());
+  for (uint32_t i = 0; i < kNumCacheEntryRoles; ++i) {
+    const RoleCounters& counters = role_counters_[i];
+    CompressedSecondaryCacheRoleStats& role_stats = (*stats)[i];
+    role_stats.compressed_count =
+        counters.compressed_count.load(std::memory_order_relaxed);
+    role_stats.dict_compressed_count =
+        counters.dict_compressed_count.load(std::memory_order_relaxed);
+    role_stats.uncompressed_bytes =
+        counters.uncompressed_bytes.load(std::memory_order_relaxed);
+    role_stats.compressed_bytes =
+        counters.compressed_bytes.load(std::memory_order_relaxed);
+    role_stats.compress_nanos =
+        counters.compress_nanos.load(std::memory_order_relaxed);
+    role_stats.decompressed_count =
+        counters.decompressed_count.load(std::memory_order_relaxed);
+    role_stats.decompress_nanos =
+        counters.decompress_nanos.load(std::memory_order_relaxed);
+  }
+}
+
+void CompressedSecondaryCache::Erase(const Slice& key) {
+  cache_->Erase(key);
+  if (key.size() != OffsetableCacheKey::kCommonPrefixSize) {
+    return;
+  }
+  Cache::Handle* pinned_handle = nullptr;
+  {
+    MutexLock l(&dict_mutex_);
+    auto it = pinned_dicts_.find(key.ToString());
+    if (it == pinned_dicts_.end()) {
+      return;
+    }
+    pinned_handle = it->second;
+    pinned_dicts_.erase(it);
+  }
+  cache_->Release(pinned_handle, /*erase_if_last_ref=*/false);
+}
 
 Status CompressedSecondaryCache::SetCapacity(size_t capacity) {
   MutexLock l(&capacity_mutex_);
@@ -212,6 +440,18 @@ std::string CompressedSecondaryCache::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "    compress_format_version : %d\n",
            cache_options_.compress_format_version);
   ret.append(buffer);
+  for (const CacheEntryRoleCompression& rc : cache_options_.role_compression) {
+    snprintf(buffer, kBufferSize, "    compression_type[%s] : %s (level %d)\n",
+             GetCacheEntryRoleName(rc.role).c_str(),
+             CompressionTypeToString(rc.type).c_str(), rc.level);
+    ret.append(buffer);
+  }
+  snprintf(buffer, kBufferSize, "    use_compression_dict : %d\n",
+           cache_options_.use_compression_dict);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    compression_threads : %d\n",
+           cache_options_.compression_threads);
+  ret.append(buffer);
   return ret;
 }
 
@@ -286,31 +526,57 @@ CacheAllocationPtr CompressedSecondaryCache::MergeChunksIntoValue(
 }
 
 const Cache::CacheItemHelper* CompressedSecondaryCache::GetHelper(
-    bool enable_custom_split_merge) const {
+    bool enable_custom_split_merge, bool with_dict) const {
+  static const Cache::DeleterFn kDeleteChunks =
+      [](Cache::ObjectPtr obj, MemoryAllocator* /*alloc*/) {
+        CacheValueChunk* chunks_head = static_cast<CacheValueChunk*>(obj);
+        while (chunks_head != nullptr) {
+          CacheValueChunk* tmp_chunk = chunks_head;
+          chunks_head = chunks_head->next;
+          tmp_chunk->Free();
+          obj = nullptr;
+        };
+      };
+  static const Cache::DeleterFn kDeleteValue =
+      [](Cache::ObjectPtr obj, MemoryAllocator* /*alloc*/) {
+        delete static_cast<CacheAllocationPtr*>(obj);
+        obj = nullptr;
+      };
+  // Values compressed with a dictionary have their own helpers, otherwise
+  // identical
   if (enable_custom_split_merge) {
-    static const Cache::CacheItemHelper kHelper{
-        CacheEntryRole::kMisc,
-        [](Cache::ObjectPtr obj, MemoryAllocator* /*alloc*/) {
-          CacheValueChunk* chunks_head = static_cast<CacheValueChunk*>(obj);
-          while (chunks_head != nullptr) {
-            CacheValueChunk* tmp_chunk = chunks_head;
-            chunks_head = chunks_head->next;
-            tmp_chunk->Free();
-            obj = nullptr;
-          };
-        }};
-    return &kHelper;
+    static const Cache::CacheItemHelper kHelper{CacheEntryRole::kMisc,
+                                                kDeleteChunks};
+    static const Cache::CacheItemHelper kDictHelper{CacheEntryRole::kMisc,
+                                                    kDeleteChunks};
+    return with_dict ? &kDictHelper : &kHelper;
   } else {
-    static const Cache::CacheItemHelper kHelper{
-        CacheEntryRole::kMisc,
-        [](Cache::ObjectPtr obj, MemoryAllocator* /*alloc*/) {
-          delete static_cast<CacheAllocationPtr*>(obj);
-          obj = nullptr;
-        }};
-    return &kHelper;
+    static const Cache::CacheItemHelper kHelper{CacheEntryRole::kMisc,
+                                                kDeleteValue};
+    static const Cache::CacheItemHelper kDictHelper{CacheEntryRole::kMisc,
+                                                    kDeleteValue};
+    return with_dict ? &kDictHelper : &kHelper;
   }
 }
 
+const Cache::CacheItemHelper* CompressedSecondaryCache::GetPendingHelper() {
+  static const Cache::CacheItemHelper kHelper{
+      CacheEntryRole::kMisc,
+      [](Cache::ObjectPtr obj, MemoryAllocator* /*alloc*/) {
+        delete static_cast<CacheAllocationPtr*>(obj);
+      }};
+  return &kHelper;
+}
+
+const Cache::CacheItemHelper* CompressedSecondaryCache::GetDictHelper() {
+  static const Cache::CacheItemHelper kHelper{
+      CacheEntryRole::kMisc,
+      [](Cache::ObjectPtr obj, MemoryAllocator* /*alloc*/) {
+        delete static_cast<DictEntry*>(obj);
+      }};
+  return &kHelper;
+}
+
 std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
     size_t capacity, int num_shard_bits, bool strict_capacity_limit,
     double high_pri_pool_ratio, double low_pri_pool_ratio,
@@ -319,23 +585,29 @@ std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
     CompressionType compression_type, uint32_t compress_format_version,
     bool enable_custom_split_merge,
     const CacheEntryRoleSet& do_not_compress_roles) {
-  return std::make_shared<CompressedSecondaryCache>(
+  return NewCompressedSecondaryCache(CompressedSecondaryCacheOptions(
       capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
       low_pri_pool_ratio, memory_allocator, use_adaptive_mutex,
       metadata_charge_policy, compression_type, compress_format_version,
-      enable_custom_split_merge, do_not_compress_roles);
+      enable_custom_split_merge, do_not_compress_roles));
 }
 
 std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
     const CompressedSecondaryCacheOptions& opts) {
   // The secondary_cache is disabled for this LRUCache instance.
   assert(opts.secondary_cache == nullptr);
-  return NewCompressedSecondaryCache(
-      opts.capacity, opts.num_shard_bits, opts.strict_capacity_limit,
-      opts.high_pri_pool_ratio, opts.low_pri_pool_ratio, opts.memory_allocator,
-      opts.use_adaptive_mutex, opts.metadata_charge_policy,
-      opts.compression_type, opts.compress_format_version,
-      opts.enable_custom_split_merge, opts.do_not_compress_roles);
+  return std::make_shared<CompressedSecondaryCache>(opts);
+}
+
+Status GetCompressedSecondaryCacheStats(
+    const std::shared_ptr<SecondaryCache>& sec_cache,
+    std::vector<CompressedSecondaryCacheRoleStats>* stats) {
+  if (!sec_cache ||
+      strcmp(sec_cache->Name(), CompressedSecondaryCache::kClassName()) != 0) {
+    return Status::InvalidArgument("Not a CompressedSecondaryCache");
+  }
+  static_cast<CompressedSecondaryCache*>(sec_cache.get())->GetStats(stats);
+  return Status::OK();
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -6,14 +6,20 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "cache/lru_cache.h"
 #include "memory/memory_allocator.h"
 #include "rocksdb/secondary_cache.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
+#include "rocksdb/system_clock.h"
+#include "rocksdb/threadpool.h"
 #include "util/compression.h"
 #include "util/mutexlock.h"
 
@@ -66,9 +72,25 @@ class CompressedSecondaryCacheResultHandle : public SecondaryCacheResultHandle {
 // std::unique_ptr<rocksdb::SecondaryCache> cache =
 //      NewCompressedSecondaryCache(opts);
 // static_cast<CompressedSecondaryCache*>(cache.get())->Erase(key);
+//
+// With CompressedSecondaryCacheOptions::use_compression_dict, the compression
+// dictionaries passed to SetCompressionDict() are kept as entries of the
+// cache, keyed by their key prefix, and blocks whose key has a dictionary are
+// compressed with it. The dictionaries are charged to the capacity but pinned,
+// so not evicted, until erased with Erase(key_prefix). Blocks that were
+// compressed with a dictionary that has since been erased are dropped on
+// lookup.
+//
+// With CompressedSecondaryCacheOptions::compression_threads, blocks are
+// inserted uncompressed and replaced by their compressed version once a
+// background thread has compressed them.
+//
+// The format of each value (compressed or not, with a dictionary or not,
+// split into chunks or not) is told by the helper it was inserted with.
 
 class CompressedSecondaryCache : public SecondaryCache {
  public:
+  explicit CompressedSecondaryCache(const CompressedSecondaryCacheOptions& opts);
   CompressedSecondaryCache(
       size_t capacity, int num_shard_bits, bool strict_capacity_limit,
       double high_pri_pool_ratio, double low_pri_pool_ratio,
@@ -83,7 +105,8 @@ class CompressedSecondaryCache : public SecondaryCache {
           CacheEntryRole::kFilterBlock});
   ~CompressedSecondaryCache() override;
 
-  const char* Name() const override { return "CompressedSecondaryCache"; }
+  static const char* kClassName() { return "CompressedSecondaryCache"; }
+  const char* Name() const override { return kClassName(); }
 
   Status Insert(const Slice& key, Cache::ObjectPtr value,
                 const Cache::CacheItemHelper* helper) override;
@@ -105,6 +128,13 @@ class CompressedSecondaryCache : public SecondaryCache {
 
   std::string GetPrintableOptions() const override;
 
+  void SetCompressionDict(const Slice& key_prefix, const Slice& dict) override;
+
+  void GetStats(std::vector<CompressedSecondaryCacheRoleStats>* stats) const;
+
+  // Waits for the background compression of the entries inserted so far
+  void TEST_WaitForCompression();
+
  private:
   friend class CompressedSecondaryCacheTest;
   static constexpr std::array<uint16_t, 8> malloc_bin_sizes_{
@@ -132,11 +162,62 @@ class CompressedSecondaryCache : public SecondaryCache {
   CacheAllocationPtr MergeChunksIntoValue(const void* chunks_head,
                                           size_t& charge);
 
+  // A compression dictionary, see SetCompressionDict()
+  struct DictEntry {
+    DictEntry(std::string dict, bool using_zstd)
+        // Not digested for a compression type, so that the level of each
+        // role applies
+        : compression_dict(std::move(dict), kNoCompression, 0 /* level */),
+          uncompression_dict(compression_dict.GetRawDict(),
+                             CacheAllocationPtr(), using_zstd) {}
+
+    CompressionDict compression_dict;
+    UncompressionDict uncompression_dict;
+  };
+
+  struct ALIGN_AS(CACHE_LINE_SIZE) RoleCounters {
+    std::atomic<uint64_t> compressed_count{0};
+    std::atomic<uint64_t> dict_compressed_count{0};
+    std::atomic<uint64_t> uncompressed_bytes{0};
+    std::atomic<uint64_t> compressed_bytes{0};
+    std::atomic<uint64_t> compress_nanos{0};
+    std::atomic<uint64_t> decompressed_count{0};
+    std::atomic<uint64_t> decompress_nanos{0};
+  };
+
+  // Compresses the value of an entry of this role, with the dictionary of
+  // its key if any, and inserts it.
+  Status CompressAndInsert(const Slice& key, const Slice& value,
+                           CacheEntryRole role);
+
+  // Compresses the value of an entry inserted uncompressed for background
+  // compression, if still cached.
+  void CompressPending(const std::string& key, CacheEntryRole role);
+
+  // Returns a handle to the dictionary of `key`, or nullptr
+  Cache::Handle* LookupDict(const Slice& key);
+
   // TODO: clean up to use cleaner interfaces in typed_cache.h
-  const Cache::CacheItemHelper* GetHelper(bool enable_custom_split_merge) const;
+  const Cache::CacheItemHelper* GetHelper(bool enable_custom_split_merge,
+                                          bool with_dict = false) const;
+  // For entries pending background compression
+  static const Cache::CacheItemHelper* GetPendingHelper();
+  // For dictionaries
+  static const Cache::CacheItemHelper* GetDictHelper();
+
   std::shared_ptr<Cache> cache_;
   CompressedSecondaryCacheOptions cache_options_;
   mutable port::Mutex capacity_mutex_;
+  // Handles pinning the dictionaries, by key prefix
+  port::Mutex dict_mutex_;
+  std::unordered_map<std::string, Cache::Handle*> pinned_dicts_;
+  // By role, kNoCompression for roles that are not compressed
+  std::array<CacheEntryRoleCompression, kNumCacheEntryRoles> role_compression_;
+  // Whether any role is compressed with ZSTD, to digest dictionaries for it
+  bool using_zstd_ = false;
+  SystemClock* const clock_;
+  std::unique_ptr<RoleCounters[]> role_counters_;
+  std::unique_ptr<ThreadPool> compression_pool_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -996,6 +996,208 @@ TEST_P(CompressedSecondaryCacheTestWithCompressionParam, EntryRoles) {
   }
 }
 
+TEST_P(CompressedSecondaryCacheTestWithCompressionParam, RoleCompression) {
+  CompressedSecondaryCacheOptions opts;
+  opts.capacity = 4096;
+  opts.num_shard_bits = 0;
+  if (sec_cache_is_compressed_) {
+    if (!LZ4_Supported()) {
+      ROCKSDB_GTEST_SKIP("This test requires LZ4 support.");
+      return;
+    }
+  } else {
+    opts.compression_type = CompressionType::kNoCompression;
+  }
+  // Index blocks are not compressed, and filter blocks are still not
+  // compressed as in do_not_compress_roles
+  opts.role_compression = {
+      {CacheEntryRole::kIndexBlock, CompressionType::kNoCompression},
+      {CacheEntryRole::kFilterBlock, CompressionType::kLZ4Compression}};
+  std::shared_ptr<SecondaryCache> sec_cache = NewCompressedSecondaryCache(opts);
+
+  std::string str(Random(301).RandomString(1000));
+  TestItem item{str.data(), str.length()};
+  for (CacheEntryRole role :
+       {CacheEntryRole::kDataBlock, CacheEntryRole::kIndexBlock,
+        CacheEntryRole::kFilterBlock}) {
+    const Cache::CacheItemHelper* helper =
+        &kHelperByRole[static_cast<uint32_t>(role)];
+    std::string key = "k" + GetCacheEntryRoleName(role);
+    ASSERT_OK(sec_cache->Insert(key, &item, helper));
+    ASSERT_OK(sec_cache->Insert(key, &item, helper));
+    bool is_in_sec_cache{false};
+    std::unique_ptr<SecondaryCacheResultHandle> handle = sec_cache->Lookup(
+        key, helper, this, true, /*advise_erase=*/false, is_in_sec_cache);
+    ASSERT_NE(handle, nullptr);
+    std::unique_ptr<TestItem> val(static_cast<TestItem*>(handle->Value()));
+    ASSERT_EQ(memcmp(val->Buf(), item.Buf(), item.Size()), 0);
+  }
+
+  std::vector<CompressedSecondaryCacheRoleStats> stats;
+  ASSERT_OK(GetCompressedSecondaryCacheStats(sec_cache, &stats));
+  ASSERT_EQ(stats.size(), kNumCacheEntryRoles);
+  const uint64_t expected_count = sec_cache_is_compressed_ ? 1 : 0;
+  const CompressedSecondaryCacheRoleStats& data_stats =
+      stats[static_cast<uint32_t>(CacheEntryRole::kDataBlock)];
+  ASSERT_EQ(data_stats.compressed_count, expected_count);
+  ASSERT_EQ(data_stats.dict_compressed_count, 0);
+  ASSERT_EQ(data_stats.uncompressed_bytes, 1000 * expected_count);
+  ASSERT_EQ(data_stats.compressed_bytes, 1007 * expected_count);
+  ASSERT_EQ(data_stats.decompressed_count, expected_count);
+  for (CacheEntryRole role :
+       {CacheEntryRole::kIndexBlock, CacheEntryRole::kFilterBlock}) {
+    ASSERT_EQ(stats[static_cast<uint32_t>(role)].compressed_count, 0);
+    ASSERT_EQ(stats[static_cast<uint32_t>(role)].decompressed_count, 0);
+  }
+
+  ASSERT_TRUE(
+      GetCompressedSecondaryCacheStats(nullptr, &stats).IsInvalidArgument());
+}
+
+TEST_P(CompressedSecondaryCacheTestWithCompressionParam, CompressionDict) {
+  CompressedSecondaryCacheOptions opts;
+  opts.capacity = 8192;
+  opts.num_shard_bits = 0;
+  opts.use_compression_dict = true;
+  if (sec_cache_is_compressed_) {
+    if (!LZ4_Supported()) {
+      ROCKSDB_GTEST_SKIP("This test requires LZ4 support.");
+      return;
+    }
+  } else {
+    opts.compression_type = CompressionType::kNoCompression;
+  }
+  std::shared_ptr<SecondaryCache> sec_cache = NewCompressedSecondaryCache(opts);
+
+  // Incompressible by itself, but not with a dictionary of similar data
+  std::string str(Random(301).RandomString(1000));
+  std::string dict = str;
+  dict[0]++;
+  TestItem item{str.data(), str.length()};
+  // Keys of two files, only the first one with a dictionary
+  const std::string key1 = std::string("prefix_1") + "00000001";
+  const std::string key2 = std::string("prefix_2") + "00000001";
+  sec_cache->SetCompressionDict("prefix_1", dict);
+
+  for (const std::string& key : {key1, key2}) {
+    ASSERT_OK(sec_cache->Insert(key, &item, &kHelper));
+    ASSERT_OK(sec_cache->Insert(key, &item, &kHelper));
+    bool is_in_sec_cache{false};
+    std::unique_ptr<SecondaryCacheResultHandle> handle = sec_cache->Lookup(
+        key, &kHelper, this, true, /*advise_erase=*/false, is_in_sec_cache);
+    ASSERT_NE(handle, nullptr);
+    std::unique_ptr<TestItem> val(static_cast<TestItem*>(handle->Value()));
+    ASSERT_EQ(memcmp(val->Buf(), item.Buf(), item.Size()), 0);
+  }
+
+  std::vector<CompressedSecondaryCacheRoleStats> stats;
+  ASSERT_OK(GetCompressedSecondaryCacheStats(sec_cache, &stats));
+  const CompressedSecondaryCacheRoleStats& role_stats =
+      stats[static_cast<uint32_t>(kHelper.role)];
+  if (sec_cache_is_compressed_) {
+    ASSERT_EQ(role_stats.compressed_count, 2);
+    ASSERT_EQ(role_stats.dict_compressed_count, 1);
+    // Much smaller with the dictionary
+    ASSERT_LT(role_stats.compressed_bytes, 1007 + 100);
+  } else {
+    ASSERT_EQ(role_stats.compressed_count, 0);
+  }
+
+  // The dictionary is pinned, so that filling the cache does not evict it
+  for (int i = 0; i < 20; i++) {
+    const std::string key = std::string("prefix_3") + std::to_string(i);
+    ASSERT_OK(sec_cache->Insert(key, &item, &kHelper));
+    ASSERT_OK(sec_cache->Insert(key, &item, &kHelper));
+  }
+  {
+    ASSERT_OK(sec_cache->Insert(key1, &item, &kHelper));
+    ASSERT_OK(sec_cache->Insert(key1, &item, &kHelper));
+    bool is_in_sec_cache{false};
+    std::unique_ptr<SecondaryCacheResultHandle> handle = sec_cache->Lookup(
+        key1, &kHelper, this, true, /*advise_erase=*/false, is_in_sec_cache);
+    ASSERT_NE(handle, nullptr);
+    delete static_cast<TestItem*>(handle->Value());
+  }
+  ASSERT_OK(GetCompressedSecondaryCacheStats(sec_cache, &stats));
+  if (sec_cache_is_compressed_) {
+    ASSERT_EQ(stats[static_cast<uint32_t>(kHelper.role)].dict_compressed_count,
+              2);
+  }
+
+  // Without their dictionary, the entries compressed with it are lost
+  sec_cache->Erase("prefix_1");
+  bool is_in_sec_cache{false};
+  std::unique_ptr<SecondaryCacheResultHandle> handle = sec_cache->Lookup(
+      key1, &kHelper, this, true, /*advise_erase=*/false, is_in_sec_cache);
+  if (sec_cache_is_compressed_) {
+    ASSERT_EQ(handle, nullptr);
+  } else {
+    ASSERT_NE(handle, nullptr);
+    delete static_cast<TestItem*>(handle->Value());
+  }
+  // Possibly evicted by the entries above
+  ASSERT_OK(sec_cache->Insert(key2, &item, &kHelper));
+  ASSERT_OK(sec_cache->Insert(key2, &item, &kHelper));
+  handle = sec_cache->Lookup(key2, &kHelper, this, true,
+                             /*advise_erase=*/false, is_in_sec_cache);
+  ASSERT_NE(handle, nullptr);
+  delete static_cast<TestItem*>(handle->Value());
+}
+
+TEST_P(CompressedSecondaryCacheTestWithCompressionParam,
+       BackgroundCompression) {
+  CompressedSecondaryCacheOptions opts;
+  opts.capacity = 4096;
+  opts.num_shard_bits = 0;
+  opts.compression_threads = 2;
+  if (sec_cache_is_compressed_) {
+    if (!LZ4_Supported()) {
+      ROCKSDB_GTEST_SKIP("This test requires LZ4 support.");
+      return;
+    }
+  } else {
+    opts.compression_type = CompressionType::kNoCompression;
+  }
+  std::shared_ptr<SecondaryCache> sec_cache = NewCompressedSecondaryCache(opts);
+  auto comp_sec_cache = static_cast<CompressedSecondaryCache*>(sec_cache.get());
+
+  std::string str(1000, 'a');
+  TestItem item{str.data(), str.length()};
+  for (int i = 0; i < 3; ++i) {
+    std::string key = "k" + std::to_string(i);
+    ASSERT_OK(sec_cache->Insert(key, &item, &kHelper));
+    ASSERT_OK(sec_cache->Insert(key, &item, &kHelper));
+  }
+  // Found whether compressed yet or not
+  bool is_in_sec_cache{false};
+  std::unique_ptr<SecondaryCacheResultHandle> handle = sec_cache->Lookup(
+      "k0", &kHelper, this, true, /*advise_erase=*/false, is_in_sec_cache);
+  ASSERT_NE(handle, nullptr);
+  std::unique_ptr<TestItem> val(static_cast<TestItem*>(handle->Value()));
+  ASSERT_EQ(memcmp(val->Buf(), item.Buf(), item.Size()), 0);
+
+  comp_sec_cache->TEST_WaitForCompression();
+  std::vector<CompressedSecondaryCacheRoleStats> stats;
+  comp_sec_cache->GetStats(&stats);
+  const CompressedSecondaryCacheRoleStats& role_stats =
+      stats[static_cast<uint32_t>(kHelper.role)];
+  ASSERT_EQ(role_stats.compressed_count, sec_cache_is_compressed_ ? 3 : 0);
+  for (int i = 0; i < 3; ++i) {
+    handle =
+        sec_cache->Lookup("k" + std::to_string(i), &kHelper, this, true,
+                          /*advise_erase=*/false, is_in_sec_cache);
+    ASSERT_NE(handle, nullptr);
+    val.reset(static_cast<TestItem*>(handle->Value()));
+    ASSERT_EQ(memcmp(val->Buf(), item.Buf(), item.Size()), 0);
+  }
+  if (sec_cache_is_compressed_) {
+    ASSERT_LT(role_stats.compressed_bytes, 3 * 100);
+    comp_sec_cache->GetStats(&stats);
+    ASSERT_GE(stats[static_cast<uint32_t>(kHelper.role)].decompressed_count,
+              3);
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(CompressedSecCacheTests,
                         CompressedSecondaryCacheTestWithCompressionParam,
                         testing::Bool());
@@ -0,0 +1,98 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+#include "cache/cache_key.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/slice.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Costs the entries of a role as a (configurable) multiple of a typical miss,
+// scaled by the read latency of the file they come from, if known.
+class RoleAndReadLatencyCostPolicy : public CacheEvictionCostPolicy {
+ public:
+  explicit RoleAndReadLatencyCostPolicy(
+      const CacheEvictionCostPolicyOptions& options)
+      : default_read_latency_us_(
+            std::max(options.default_read_latency_us, uint64_t{1})) {
+    // Bounded so that cost computations cannot overflow
+    const double meta_block_cost =
+        std::min(std::max(options.meta_block_cost_ratio, 0.0) *
+                     kTypicalMissCost,
+                 static_cast<double>(std::numeric_limits<uint32_t>::max()));
+    for (uint32_t i = 0; i < kNumCacheEntryRoles; ++i) {
+      role_costs_[i] = kTypicalMissCost;
+    }
+    for (CacheEntryRole role :
+         {CacheEntryRole::kFilterBlock, CacheEntryRole::kFilterMetaBlock,
+          CacheEntryRole::kDeprecatedFilterBlock, CacheEntryRole::kIndexBlock,
+          CacheEntryRole::kOtherBlock}) {
+      role_costs_[static_cast<uint32_t>(role)] =
+          static_cast<uint64_t>(meta_block_cost);
+    }
+    for (auto& latency : read_latencies_us_) {
+      latency.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  const char* Name() const override { return "RoleAndReadLatencyCostPolicy"; }
+
+  uint32_t GetMissCost(const Slice& key, CacheEntryRole role) override {
+    uint64_t cost = role_costs_[static_cast<uint32_t>(role)];
+    if (key.size() >= OffsetableCacheKey::kCommonPrefixSize) {
+      const uint64_t latency_us =
+          read_latencies_us_[GetSlot(key)].load(std::memory_order_relaxed);
+      if (latency_us > 0) {
+        cost = cost * latency_us / default_read_latency_us_;
+      }
+    }
+    return static_cast<uint32_t>(
+        std::min(cost, uint64_t{std::numeric_limits<uint32_t>::max()}));
+  }
+
+  void SetReadLatencyHint(const Slice& key_prefix,
+                          uint64_t latency_us) override {
+    if (key_prefix.size() < OffsetableCacheKey::kCommonPrefixSize) {
+      return;
+    }
+    // Bounded like role costs
+    read_latencies_us_[GetSlot(key_prefix)].store(
+        std::min(latency_us, uint64_t{std::numeric_limits<uint32_t>::max()}),
+        std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr size_t kNumSlots = 4096;
+
+  static size_t GetSlot(const Slice& key) {
+    return static_cast<size_t>(
+        GetSliceNPHash64(
+            Slice(key.data(), OffsetableCacheKey::kCommonPrefixSize)) %
+        kNumSlots);
+  }
+
+  const uint64_t default_read_latency_us_;
+  uint64_t role_costs_[kNumCacheEntryRoles];
+  // Read latency hints by (hashed) key prefix, 0 for none
+  std::atomic<uint64_t> read_latencies_us_[kNumSlots];
+};
+
+}  // namespace
+
+std::shared_ptr<CacheEvictionCostPolicy> NewCacheEvictionCostPolicy(
+    const CacheEvictionCostPolicyOptions& options) {
+  return std::make_shared<RoleAndReadLatencyCostPolicy>(options);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,131 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/frequency_sketch.h"
+
+#include <algorithm>
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+constexpr size_t kMinWords = 64;
+// Number of words in the block of each key, as a power of two
+constexpr int kBlockBits = 3;
+// Leaves 20 bits of the remixed hash below the block index for the counters
+constexpr int kMaxLengthBits = 64 - 20 + kBlockBits;
+// Number of increments between halvings, per word of the table
+constexpr uint64_t kSampleSizePerWord = 10;
+constexpr uint64_t kCounterMask = 0xf;
+constexpr uint64_t kHalveMask = 0x7777777777777777U;
+
+inline uint64_t Remix(uint64_t hash) {
+  // Multiplication by an odd constant pushes the entropy of every input bit
+  // into the upper bits, which are the ones used below.
+  return hash * 0x9E3779B97F4A7C15U;
+}
+}  // namespace
+
+FrequencySketch::FrequencySketch(size_t expected_entries) {
+  length_bits_ = 0;
+  while ((size_t{1} << length_bits_) < kMinWords) {
+    ++length_bits_;
+  }
+  while ((size_t{1} << length_bits_) < expected_entries &&
+         length_bits_ < kMaxLengthBits &&
+         length_bits_ < static_cast<int>(sizeof(size_t) * 8 - 2)) {
+    ++length_bits_;
+  }
+  const size_t num_words = size_t{1} << length_bits_;
+  table_.reset(new std::atomic<uint64_t>[num_words]);
+  for (size_t i = 0; i < num_words; ++i) {
+    table_[i].store(0, std::memory_order_relaxed);
+  }
+  sample_size_ = num_words * kSampleSizePerWord;
+}
+
+inline void FrequencySketch::GetCounters(uint64_t mixed, size_t words[4],
+                                         int shifts[4]) const {
+  // The top bits select the block, so take the counters from the next 20
+  // bits: for each of the four, one bit to pick one of two words (the four
+  // counters being in different words) and four bits to pick one of the
+  // sixteen counters in that word.
+  const int block_index_bits = length_bits_ - kBlockBits;
+  const size_t block = static_cast<size_t>(mixed >> (64 - block_index_bits))
+                       << kBlockBits;
+  const uint64_t bits = mixed >> (64 - block_index_bits - 20);
+  for (int i = 0; i < 4; ++i) {
+    const uint64_t counter_bits = bits >> (5 * i);
+    words[i] = block + (i * 2) + static_cast<size_t>(counter_bits & 1);
+    shifts[i] = static_cast<int>((counter_bits >> 1) & 0xf) * 4;
+  }
+}
+
+inline uint64_t FrequencySketch::GetCounter(size_t word, int shift) const {
+  return (table_[word].load(std::memory_order_relaxed) >> shift) &
+         kCounterMask;
+}
+
+void FrequencySketch::Increment(uint64_t hash) {
+  const uint64_t mixed = Remix(hash);
+  size_t words[4];
+  int shifts[4];
+  GetCounters(mixed, words, shifts);
+
+  uint64_t counts[4];
+  uint64_t min_count = kMaxCount;
+  for (int i = 0; i < 4; ++i) {
+    counts[i] = GetCounter(words[i], shifts[i]);
+    min_count = std::min(min_count, counts[i]);
+  }
+  if (min_count == kMaxCount) {
+    // Saturated. Not counted as an addition, so that a few very hot keys
+    // do not keep aging the whole table (and to save the shared writes).
+    return;
+  }
+  for (int i = 0; i < 4; ++i) {
+    if (counts[i] == min_count) {
+      // Not atomic with the other counters, but a counter is only bumped if
+      // it has not reached the maximum in the meantime.
+      std::atomic<uint64_t>& word = table_[words[i]];
+      uint64_t old_word = word.load(std::memory_order_relaxed);
+      while (((old_word >> shifts[i]) & kCounterMask) < kMaxCount &&
+             !word.compare_exchange_weak(old_word,
+                                         old_word + (uint64_t{1} << shifts[i]),
+                                         std::memory_order_relaxed)) {
+      }
+    }
+  }
+
+  if (additions_.fetch_add(1, std::memory_order_relaxed) + 1 == sample_size_) {
+    Age();
+  }
+}
+
+uint32_t FrequencySketch::Estimate(uint64_t hash) const {
+  const uint64_t mixed = Remix(hash);
+  size_t words[4];
+  int shifts[4];
+  GetCounters(mixed, words, shifts);
+  uint64_t min_count = kMaxCount;
+  for (int i = 0; i < 4; ++i) {
+    min_count = std::min(min_count, GetCounter(words[i], shifts[i]));
+  }
+  return static_cast<uint32_t>(min_count);
+}
+
+void FrequencySketch::Age() {
+  const size_t num_words = GetNumWords();
+  for (size_t i = 0; i < num_words; ++i) {
+    uint64_t old_word = table_[i].load(std::memory_order_relaxed);
+    while (!table_[i].compare_exchange_weak(old_word,
+                                            (old_word >> 1) & kHalveMask,
+                                            std::memory_order_relaxed)) {
+    }
+  }
+  // The halved counters still account for about half of the increments
+  additions_.store(sample_size_ / 2, std::memory_order_relaxed);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
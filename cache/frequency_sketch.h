@@ -0,0 +1,73 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// An approximate, bounded-memory estimator of how often keys were recently
+// accessed, for making cache admission decisions. It is a count-min sketch
+// with 4-bit counters and periodic aging, as in TinyLFU (Einziger et al.,
+// "TinyLFU: A Highly Efficient Cache Admission Policy").
+//
+// Each key (identified by a hash, which is remixed internally so that hashes
+// with few or partly fixed bits, such as those of a cache shard, still spread
+// well) maps to a block of eight 64-bit words (a cache line) of the table,
+// and to four 4-bit counters in four different words of that block, each
+// counter being one of the sixteen in its word. The estimate for a key is the
+// minimum of its four counters, and an increment only bumps the counters
+// equal to that minimum ("conservative update"). Keeping the counters of a key
+// in one cache line makes an access touch a single cache line, while picking
+// each counter independently among 16 makes it unlikely that all four are
+// shared with another (e.g. much hotter) key.
+//
+// After a number of increments proportional to the table size (the "sample
+// size", not counting increments of saturated keys), all counters are halved,
+// so that the estimates reflect recent history.
+//
+// Thread-safe; concurrent updates may occasionally be lost, which is fine for
+// an estimate.
+class FrequencySketch {
+ public:
+  // Sized for tracking about `expected_entries` distinct keys.
+  explicit FrequencySketch(size_t expected_entries);
+
+  // Records one access to the key with hash `hash`.
+  void Increment(uint64_t hash);
+
+  // Returns the estimated number of recent accesses to the key with hash
+  // `hash`, at most kMaxCount.
+  uint32_t Estimate(uint64_t hash) const;
+
+  // Halves all counters. Called automatically every sample size increments.
+  void Age();
+
+  size_t GetNumWords() const { return size_t{1} << length_bits_; }
+
+  static constexpr uint32_t kMaxCount = 15;
+
+ private:
+  // Sets the words and the shifts within them of the four counters of the
+  // key with (remixed) hash `mixed`.
+  inline void GetCounters(uint64_t mixed, size_t words[4],
+                          int shifts[4]) const;
+
+  // Returns the value of the counter at `shift` in the word at `word`.
+  inline uint64_t GetCounter(size_t word, int shift) const;
+
+  std::unique_ptr<std::atomic<uint64_t>[]> table_;
+  int length_bits_;
+  uint64_t sample_size_;
+  std::atomic<uint64_t> additions_{0};
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,154 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/ghost_cache.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "port/port.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+const char* GhostCache::GetPolicyName(GhostCachePolicy policy) {
+  switch (policy) {
+    case GhostCachePolicy::kLRU:
+      return "LRU";
+    case GhostCachePolicy::kClock:
+      return "Clock";
+    case GhostCachePolicy::kTinyLFU:
+      return "TinyLFU";
+  }
+  return "Unknown";
+}
+
+namespace {
+std::shared_ptr<Cache> NewGhost(const GhostCacheConfig& config,
+                                double sample_ratio) {
+  const size_t capacity =
+      static_cast<size_t>(static_cast<double>(config.capacity) * sample_ratio);
+  if (config.policy == GhostCachePolicy::kClock) {
+    HyperClockCacheOptions opts(capacity, 0 /* estimated_entry_charge */);
+    opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    return opts.MakeSharedCache();
+  }
+  LRUCacheOptions opts;
+  opts.capacity = capacity;
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.tiny_lfu_admission = config.policy == GhostCachePolicy::kTinyLFU;
+  return NewLRUCache(opts);
+}
+}  // namespace
+
+GhostCache::GhostCache(std::shared_ptr<Cache> target,
+                       const GhostCacheOptions& opts)
+    : CacheWrapper(std::move(target)),
+      sample_all_(opts.sample_ratio >= 1.0),
+      sample_threshold_(sample_all_ ? 0
+                                    : static_cast<uint64_t>(
+                                          opts.sample_ratio *
+                                          18446744073709551616.0 /* 2^64 */)) {
+  for (const GhostCacheConfig& config : opts.configs) {
+    ghosts_.emplace_back(new Ghost());
+    ghosts_.back()->config = config;
+    ghosts_.back()->cache = NewGhost(config, opts.sample_ratio);
+  }
+}
+
+bool GhostCache::IsSampled(const Slice& key) const {
+  return sample_all_ || GetSliceNPHash64(key) < sample_threshold_;
+}
+
+Status GhostCache::Insert(const Slice& key, ObjectPtr value,
+                          const CacheItemHelper* helper, size_t charge,
+                          Handle** handle, Priority priority) {
+  if (IsSampled(key)) {
+    for (auto& ghost : ghosts_) {
+      ghost->cache
+          ->Insert(key, nullptr, &kNoopCacheItemHelper, charge,
+                   nullptr /* handle */, priority)
+          .PermitUncheckedError();
+    }
+  }
+  return target_->Insert(key, value, helper, charge, handle, priority);
+}
+
+Cache::Handle* GhostCache::Lookup(const Slice& key,
+                                  const CacheItemHelper* helper,
+                                  CreateContext* create_context,
+                                  Priority priority, bool wait,
+                                  Statistics* stats) {
+  Handle* handle =
+      target_->Lookup(key, helper, create_context, priority, wait, stats);
+  if (IsSampled(key)) {
+    for (auto& ghost : ghosts_) {
+      ghost->lookups.fetch_add(1, std::memory_order_relaxed);
+      Handle* ghost_handle = ghost->cache->Lookup(key);
+      if (ghost_handle != nullptr) {
+        ghost->hits.fetch_add(1, std::memory_order_relaxed);
+        ghost->cache->Release(ghost_handle);
+      } else if (handle != nullptr) {
+        // Missed by the ghost cache only, so there is no insertion to follow
+        ghost->cache
+            ->Insert(key, nullptr, &kNoopCacheItemHelper,
+                     target_->GetCharge(handle), nullptr /* handle */,
+                     priority)
+            .PermitUncheckedError();
+      }
+    }
+  }
+  return handle;
+}
+
+void GhostCache::GetStats(std::vector<GhostCacheStats>* stats) const {
+  stats->clear();
+  for (const auto& ghost : ghosts_) {
+    GhostCacheStats ghost_stats;
+    ghost_stats.config = ghost->config;
+    ghost_stats.lookups = ghost->lookups.load(std::memory_order_relaxed);
+    ghost_stats.hits = ghost->hits.load(std::memory_order_relaxed);
+    stats->push_back(ghost_stats);
+  }
+}
+
+std::string GhostCache::ToString() const {
+  std::vector<GhostCacheStats> stats;
+  GetStats(&stats);
+  std::string str;
+  char buffer[200];
+  snprintf(buffer, sizeof(buffer), "%20s %8s %12s %12s %10s\n", "capacity",
+           "policy", "lookups", "hits", "miss_ratio");
+  str.append(buffer);
+  for (const GhostCacheStats& ghost_stats : stats) {
+    snprintf(buffer, sizeof(buffer),
+             "%20" ROCKSDB_PRIszt " %8s %12" PRIu64 " %12" PRIu64 " %10.4f\n",
+             ghost_stats.config.capacity,
+             GetPolicyName(ghost_stats.config.policy), ghost_stats.lookups,
+             ghost_stats.hits, ghost_stats.MissRatio());
+    str.append(buffer);
+  }
+  return str;
+}
+
+std::shared_ptr<Cache> NewGhostCache(std::shared_ptr<Cache> cache,
+                                     const GhostCacheOptions& opts) {
+  if (!cache || !(opts.sample_ratio > 0.0 && opts.sample_ratio <= 1.0)) {
+    return nullptr;
+  }
+  return std::make_shared<GhostCache>(std::move(cache), opts);
+}
+
+Status GetGhostCacheStats(const std::shared_ptr<Cache>& cache,
+                          std::vector<GhostCacheStats>* stats) {
+  if (!cache || strcmp(cache->Name(), GhostCache::kClassName()) != 0) {
+    return Status::InvalidArgument("Not a GhostCache");
+  }
+  static_cast<GhostCache*>(cache.get())->GetStats(stats);
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
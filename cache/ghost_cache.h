@@ -0,0 +1,68 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The Cache returned by NewGhostCache(). The lookups of the keys in a sample,
+// chosen by hash so that all the lookups of a sampled key are simulated
+// (spatial sampling), are replayed against a "ghost" cache for each
+// configuration, scaled down by the sampling ratio. Ghost caches are regular
+// caches of the simulated policy holding entries without values, charged as
+// the real entries.
+//
+// A ghost cache learns the charge of an entry either from a hit in the real
+// cache or from the insertion that follows a miss.
+class GhostCache : public CacheWrapper {
+ public:
+  GhostCache(std::shared_ptr<Cache> target, const GhostCacheOptions& opts);
+
+  static const char* kClassName() { return "GhostCache"; }
+  const char* Name() const override { return kClassName(); }
+
+  Status Insert(const Slice& key, ObjectPtr value,
+                const CacheItemHelper* helper, size_t charge,
+                Handle** handle = nullptr,
+                Priority priority = Priority::LOW) override;
+
+  Handle* Lookup(const Slice& key, const CacheItemHelper* helper = nullptr,
+                 CreateContext* create_context = nullptr,
+                 Priority priority = Priority::LOW, bool wait = true,
+                 Statistics* stats = nullptr) override;
+
+  void GetStats(std::vector<GhostCacheStats>* stats) const;
+
+  // A table of the miss ratio of each configuration
+  std::string ToString() const;
+
+  static const char* GetPolicyName(GhostCachePolicy policy);
+
+ private:
+  bool IsSampled(const Slice& key) const;
+
+  struct Ghost {
+    GhostCacheConfig config;
+    std::shared_ptr<Cache> cache;
+    std::atomic<uint64_t> lookups{0};
+    std::atomic<uint64_t> hits{0};
+  };
+
+  const bool sample_all_;
+  // Keys whose hash is below are sampled
+  const uint64_t sample_threshold_;
+  std::vector<std::unique_ptr<Ghost>> ghosts_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
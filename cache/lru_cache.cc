@@ -9,15 +9,20 @@
 
 #include "cache/lru_cache.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <thread>
 
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics.h"
 #include "port/lang.h"
 #include "util/distributed_mutex.h"
+#include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 namespace lru_cache {
@@ -127,7 +132,11 @@ LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                              CacheMetadataChargePolicy metadata_charge_policy,
                              int max_upper_hash_bits,
                              MemoryAllocator* allocator,
-                             SecondaryCache* secondary_cache)
+                             SecondaryCache* secondary_cache,
+                             bool tiny_lfu_admission, bool use_read_buffer,
+                             CacheEvictionCostPolicy* eviction_cost_policy,
+                             uint8_t numa_node,
+                             const std::atomic<size_t>* tenant_quotas)
     : CacheShardBase(metadata_charge_policy),
       capacity_(0),
       high_pri_pool_usage_(0),
@@ -141,7 +150,24 @@ LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
       usage_(0),
       lru_usage_(0),
       mutex_(use_adaptive_mutex),
-      secondary_cache_(secondary_cache) {
+      secondary_cache_(secondary_cache),
+      eviction_cost_policy_(eviction_cost_policy),
+      numa_node_(numa_node),
+      tenant_quotas_(tenant_quotas) {
+  if (tiny_lfu_admission) {
+    // About one word per entry for typical block sizes. Not resized by
+    // SetCapacity().
+    sketch_.reset(new FrequencySketch(capacity / 4096));
+  }
+  if (use_read_buffer) {
+    read_buffer_.reset(new CoreLocalArray<ReadStripe>());
+    for (size_t i = 0; i < read_buffer_->Size(); i++) {
+      ReadStripe* stripe = read_buffer_->AccessAtCore(i);
+      for (uint32_t j = 0; j < kReadStripeSize; j++) {
+        stripe->hits[j].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+  }
   // Make empty circular linked list.
   lru_.next = &lru_;
   lru_.prev = &lru_;
@@ -150,19 +176,102 @@ LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
   SetCapacity(capacity);
 }
 
+LRUCacheShard::ExclusiveLock::ExclusiveLock(LRUCacheShard* shard)
+    : mutex_lock_(shard->mutex_),
+      shard_(shard->read_buffer_ ? shard : nullptr) {
+  if (shard_ != nullptr) {
+    // Pairs with the increment then load of ReadSection: either the reader
+    // sees the flag, or it is counted here
+    shard_->exclusive_.store(true, std::memory_order_seq_cst);
+    for (size_t i = 0; i < shard_->read_buffer_->Size(); i++) {
+      const ReadStripe* stripe = shard_->read_buffer_->AccessAtCore(i);
+      for (int spins = 0;
+           stripe->readers.load(std::memory_order_seq_cst) != 0; spins++) {
+        // Readers only look up the hash table before leaving, unless
+        // preempted
+        if (spins < kExclusiveLockSpins) {
+          port::AsmVolatilePause();
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    }
+    shard_->ApplyReadBuffer();
+  }
+}
+
+LRUCacheShard::ExclusiveLock::~ExclusiveLock() {
+  if (shard_ != nullptr) {
+    shard_->exclusive_.store(false, std::memory_order_release);
+  }
+}
+
+LRUCacheShard::ReadSection::ReadSection(LRUCacheShard* shard)
+    : stripe_(shard->read_buffer_->Access()), counted_(true) {
+  stripe_->readers.fetch_add(1, std::memory_order_seq_cst);
+  if (shard->exclusive_.load(std::memory_order_seq_cst)) {
+    // Rather than spinning until the writer is done
+    stripe_->readers.fetch_sub(1, std::memory_order_release);
+    counted_ = false;
+    mutex_lock_.emplace(shard->mutex_);
+  }
+}
+
+LRUCacheShard::ReadSection::~ReadSection() {
+  if (counted_) {
+    // Publishes the hits recorded to the next ExclusiveLock
+    stripe_->readers.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+bool LRUCacheShard::RecordReadBufferHit(ReadStripe* stripe, LRUHandle* e) {
+  uint32_t slot = stripe->count.fetch_add(1, std::memory_order_relaxed);
+  if (slot >= kReadStripeSize) {
+    // Like the LRU list in general, the order is best effort
+    return false;
+  }
+  stripe->hits[slot].store(e, std::memory_order_relaxed);
+  return slot + 1 == kReadStripeSize;
+}
+
+void LRUCacheShard::ApplyReadBuffer() {
+  // ExclusiveLock makes all the recorded hits visible
+  for (size_t i = 0; i < read_buffer_->Size(); i++) {
+    ReadStripe* stripe = read_buffer_->AccessAtCore(i);
+    uint32_t count = std::min(stripe->count.load(std::memory_order_relaxed),
+                              kReadStripeSize);
+    for (uint32_t j = 0; j < count; j++) {
+      LRUHandle* e = stripe->hits[j].load(std::memory_order_relaxed);
+      stripe->hits[j].store(nullptr, std::memory_order_relaxed);
+      // Erased entries are not in the buffer, as it is applied before erasing
+      assert(e != nullptr && e->InCache());
+      e->SetHit();
+      if (e->InLRU()) {
+        // Referenced entries taken off the list are put back by Release()
+        LRU_Remove(e);
+        LRU_Insert(e);
+      }
+    }
+    stripe->count.store(0, std::memory_order_relaxed);
+  }
+}
+
 void LRUCacheShard::EraseUnRefEntries() {
   autovector<LRUHandle*> last_reference_list;
   {
-    DMutexLock l(mutex_);
+    ExclusiveLock l(this);
     while (lru_.next != &lru_) {
       LRUHandle* old = lru_.next;
-      // LRU list contains only elements which can be evicted.
-      assert(old->InCache() && !old->HasRefs());
       LRU_Remove(old);
+      if (old->HasRefs()) {
+        // Left in the list by a Lookup() with read buffer
+        continue;
+      }
+      assert(old->InCache());
       table_.Remove(old->key(), old->hash);
       old->SetInCache(false);
       assert(usage_ >= old->total_charge);
-      usage_ -= old->total_charge;
+      SubtractUsage(old);
       last_reference_list.push_back(old);
     }
   }
@@ -210,14 +319,14 @@ void LRUCacheShard::ApplyToSomeEntries(
 
 void LRUCacheShard::TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri,
                                     LRUHandle** lru_bottom_pri) {
-  DMutexLock l(mutex_);
+  ExclusiveLock l(this);
   *lru = &lru_;
   *lru_low_pri = lru_low_pri_;
   *lru_bottom_pri = lru_bottom_pri_;
 }
 
 size_t LRUCacheShard::TEST_GetLRUSize() {
-  DMutexLock l(mutex_);
+  ExclusiveLock l(this);
   LRUHandle* lru_handle = lru_.next;
   size_t lru_size = 0;
   while (lru_handle != &lru_) {
@@ -251,6 +360,11 @@ void LRUCacheShard::LRU_Remove(LRUHandle* e) {
   e->prev = e->next = nullptr;
   assert(lru_usage_ >= e->total_charge);
   lru_usage_ -= e->total_charge;
+  if (e->HasRefs()) {
+    assert(read_buffer_);
+    lru_referenced_usage_.fetch_sub(e->total_charge,
+                                    std::memory_order_relaxed);
+  }
   assert(!e->InHighPriPool() || !e->InLowPriPool());
   if (e->InHighPriPool()) {
     assert(high_pri_pool_usage_ >= e->total_charge);
@@ -301,6 +415,11 @@ void LRUCacheShard::LRU_Insert(LRUHandle* e) {
     lru_bottom_pri_ = e;
   }
   lru_usage_ += e->total_charge;
+  if (e->HasRefs()) {
+    assert(read_buffer_);
+    lru_referenced_usage_.fetch_add(e->total_charge,
+                                    std::memory_order_relaxed);
+  }
 }
 
 void LRUCacheShard::MaintainPoolSize() {
@@ -330,17 +449,95 @@ void LRUCacheShard::EvictFromLRU(size_t charge,
                                  autovector<LRUHandle*>* deleted) {
   while ((usage_ + charge) > capacity_ && lru_.next != &lru_) {
     LRUHandle* old = lru_.next;
-    // LRU list contains only elements which can be evicted.
-    assert(old->InCache() && !old->HasRefs());
+    if (!old->HasRefs()) {
+      LRUHandle* over_quota =
+          tenant_usage_ ? PickOverQuotaVictim(old) : nullptr;
+      if (over_quota) {
+        old = over_quota;
+      } else if (eviction_cost_policy_) {
+        old = PickEvictionVictim(old);
+      }
+    }
     LRU_Remove(old);
+    if (old->HasRefs()) {
+      // Left in the list by a Lookup() with read buffer, and not evictable
+      continue;
+    }
+    assert(old->InCache());
     table_.Remove(old->key(), old->hash);
     old->SetInCache(false);
     assert(usage_ >= old->total_charge);
-    usage_ -= old->total_charge;
+    SubtractUsage(old);
     deleted->push_back(old);
   }
 }
 
+LRUHandle* LRUCacheShard::PickEvictionVictim(LRUHandle* oldest) {
+  // The lowest miss cost per unit of charge
+  LRUHandle* victim = oldest;
+  LRUHandle* e = oldest->next;
+  for (int i = 1; i < kEvictionCandidates && e != &lru_; i++, e = e->next) {
+    if (!e->HasRefs() && uint64_t{e->miss_cost} * victim->total_charge <
+                             uint64_t{victim->miss_cost} * e->total_charge) {
+      victim = e;
+    }
+  }
+  // The candidates passed over lose half of their cost, so that costly
+  // entries are kept longer than others but not indefinitely
+  e = oldest;
+  for (int i = 0; i < kEvictionCandidates && e != &lru_; i++, e = e->next) {
+    if (e != victim) {
+      e->miss_cost = static_cast<uint16_t>(std::max(e->miss_cost >> 1, 1));
+    }
+  }
+  return victim;
+}
+
+void LRUCacheShard::SetMissCost(LRUHandle* e) {
+  e->miss_cost = 0;
+  if (eviction_cost_policy_) {
+    e->miss_cost = static_cast<uint16_t>(std::min(
+        std::max(eviction_cost_policy_->GetMissCost(e->key(), e->helper->role),
+                 uint32_t{1}),
+        uint32_t{std::numeric_limits<uint16_t>::max()}));
+  }
+}
+
+void LRUCacheShard::AddUsage(LRUHandle* e) {
+  usage_ += e->total_charge;
+  if (e->tenant != 0) {
+    if (!tenant_usage_) {
+      tenant_usage_.reset(new size_t[LRUCache::kMaxTenants]());
+    }
+    tenant_usage_[e->tenant] += e->total_charge;
+  }
+}
+
+void LRUCacheShard::SubtractUsage(LRUHandle* e) {
+  assert(usage_ >= e->total_charge);
+  usage_ -= e->total_charge;
+  if (e->tenant != 0) {
+    assert(tenant_usage_[e->tenant] >= e->total_charge);
+    tenant_usage_[e->tenant] -= e->total_charge;
+  }
+}
+
+LRUHandle* LRUCacheShard::PickOverQuotaVictim(LRUHandle* oldest) {
+  assert(tenant_quotas_ != nullptr);
+  LRUHandle* e = oldest;
+  for (int i = 0; i < kTenantEvictionCandidates && e != &lru_;
+       i++, e = e->next) {
+    if (e->tenant == 0 || e->HasRefs()) {
+      continue;
+    }
+    size_t quota = tenant_quotas_[e->tenant].load(std::memory_order_relaxed);
+    if (quota > 0 && tenant_usage_[e->tenant] > quota) {
+      return e;
+    }
+  }
+  return nullptr;
+}
+
 void LRUCacheShard::TryInsertIntoSecondaryCache(
     autovector<LRUHandle*> evicted_handles) {
   for (auto entry : evicted_handles) {
@@ -357,7 +554,7 @@ void LRUCacheShard::TryInsertIntoSecondaryCache(
 void LRUCacheShard::SetCapacity(size_t capacity) {
   autovector<LRUHandle*> last_reference_list;
   {
-    DMutexLock l(mutex_);
+    ExclusiveLock l(this);
     capacity_ = capacity;
     high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
     low_pri_pool_capacity_ = capacity_ * low_pri_pool_ratio_;
@@ -378,14 +575,35 @@ Status LRUCacheShard::InsertItem(LRUHandle* e, LRUHandle** handle,
   autovector<LRUHandle*> last_reference_list;
 
   {
-    DMutexLock l(mutex_);
+    ExclusiveLock l(this);
+
+    // With TinyLFU admission, only make room for the new entry if it was
+    // looked up (recently) more often than the LRU victim. Dummy entries for
+    // the secondary cache are exempt.
+    bool admitted = true;
+    if (sketch_ && usage_ + e->total_charge > capacity_ && lru_.next != &lru_ &&
+        e->value != &kDummyValue) {
+      admitted =
+          sketch_->Estimate(e->hash) > sketch_->Estimate(lru_.next->hash);
+    }
 
-    // Free the space following strict LRU policy until enough space
-    // is freed or the lru list is empty.
-    EvictFromLRU(e->total_charge, &last_reference_list);
+    if (admitted) {
+      // Free the space following strict LRU policy until enough space
+      // is freed or the lru list is empty.
+      EvictFromLRU(e->total_charge, &last_reference_list);
+    }
 
-    if ((usage_ + e->total_charge) > capacity_ &&
-        (strict_capacity_limit_ || handle == nullptr)) {
+    if (!admitted && !strict_capacity_limit_ && handle != nullptr) {
+      // Not cached, but the caller gets a standalone handle, charged to
+      // usage until released.
+      e->SetInCache(false);
+      if (!e->HasRefs()) {
+        e->Ref();
+      }
+      AddUsage(e);
+      *handle = e;
+    } else if (!admitted || ((usage_ + e->total_charge) > capacity_ &&
+                             (strict_capacity_limit_ || handle == nullptr))) {
       e->SetInCache(false);
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
@@ -402,7 +620,7 @@ Status LRUCacheShard::InsertItem(LRUHandle* e, LRUHandle** handle,
       // Insert into the cache. Note that the cache might get larger than its
       // capacity if not enough space was freed up.
       LRUHandle* old = table_.Insert(e);
-      usage_ += e->total_charge;
+      AddUsage(e);
       if (old != nullptr) {
         s = Status::OkOverwritten();
         assert(old->InCache());
@@ -411,8 +629,11 @@ Status LRUCacheShard::InsertItem(LRUHandle* e, LRUHandle** handle,
           // old is on LRU because it's in cache and its reference count is 0.
           LRU_Remove(old);
           assert(usage_ >= old->total_charge);
-          usage_ -= old->total_charge;
+          SubtractUsage(old);
           last_reference_list.push_back(old);
+        } else if (old->InLRU()) {
+          // Left in the list by a Lookup() with read buffer
+          LRU_Remove(old);
         }
       }
       if (handle == nullptr) {
@@ -455,7 +676,7 @@ void LRUCacheShard::Promote(LRUHandle* e) {
       autovector<LRUHandle*> last_reference_list;
       bool free_standalone_handle{false};
       {
-        DMutexLock l(mutex_);
+        ExclusiveLock l(this);
 
         // Free the space following strict LRU policy until enough space
         // is freed or the lru list is empty.
@@ -464,7 +685,7 @@ void LRUCacheShard::Promote(LRUHandle* e) {
         if ((usage_ + e->total_charge) > capacity_ && strict_capacity_limit_) {
           free_standalone_handle = true;
         } else {
-          usage_ += e->total_charge;
+          AddUsage(e);
         }
       }
 
@@ -520,7 +741,37 @@ LRUHandle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash,
                                  Statistics* stats) {
   LRUHandle* e = nullptr;
   bool found_dummy_entry{false};
-  {
+  if (sketch_) {
+    sketch_->Increment(hash);
+  }
+  if (read_buffer_) {
+    bool apply_read_buffer = false;
+    {
+      ReadSection l(this);
+      e = table_.Lookup(key, hash);
+      if (e != nullptr) {
+        assert(e->InCache());
+        if (e->value == &kDummyValue) {
+          // See below
+          found_dummy_entry = true;
+          e = nullptr;
+        } else {
+          if (e->refs.fetch_add(1, std::memory_order_relaxed) == 0) {
+            // Unreferenced entries in cache are in the LRU list, where this
+            // one stays until the hit is applied
+            assert(e->InLRU());
+            lru_referenced_usage_.fetch_add(e->total_charge,
+                                            std::memory_order_relaxed);
+          }
+          apply_read_buffer = RecordReadBufferHit(l.stripe(), e);
+        }
+      }
+    }
+    if (apply_read_buffer) {
+      // Applies the buffered hits
+      ExclusiveLock l(this);
+    }
+  } else {
     DMutexLock l(mutex_);
     e = table_.Lookup(key, hash);
     if (e != nullptr) {
@@ -564,13 +815,16 @@ LRUHandle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash,
 
       e->m_flags = 0;
       e->im_flags = 0;
+      e->numa_node = numa_node_;
+      e->tenant = 0;
       e->helper = helper;
       e->key_length = key.size();
       e->hash = hash;
-      e->refs = 0;
+      e->refs.store(0, std::memory_order_relaxed);
       e->next = e->prev = nullptr;
       e->SetPriority(priority);
       memcpy(e->key_data, key.data(), key.size());
+      SetMissCost(e);
       e->value = nullptr;
       e->sec_handle = secondary_handle.release();
       e->total_charge = 0;
@@ -633,14 +887,14 @@ bool LRUCacheShard::Ref(LRUHandle* e) {
 }
 
 void LRUCacheShard::SetHighPriorityPoolRatio(double high_pri_pool_ratio) {
-  DMutexLock l(mutex_);
+  ExclusiveLock l(this);
   high_pri_pool_ratio_ = high_pri_pool_ratio;
   high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
   MaintainPoolSize();
 }
 
 void LRUCacheShard::SetLowPriorityPoolRatio(double low_pri_pool_ratio) {
-  DMutexLock l(mutex_);
+  ExclusiveLock l(this);
   low_pri_pool_ratio_ = low_pri_pool_ratio;
   low_pri_pool_capacity_ = capacity_ * low_pri_pool_ratio_;
   MaintainPoolSize();
@@ -655,27 +909,54 @@ bool LRUCacheShard::Release(LRUHandle* e, bool /*useful*/,
   // Must Wait or WaitAll first on pending handles. Otherwise, would leak
   // a secondary cache handle.
   assert(!e->IsPending());
+  if (read_buffer_) {
+    // Without the mutex, unless the entry needs to be moved or freed
+    ReadSection l(this);
+    uint32_t refs = e->refs.load(std::memory_order_relaxed);
+    while (refs > 1 || (refs == 1 && e->InCache() && e->InLRU() &&
+                        usage_ <= capacity_ && !erase_if_last_ref)) {
+      if (e->refs.compare_exchange_weak(refs, refs - 1,
+                                        std::memory_order_acq_rel)) {
+        if (refs == 1) {
+          lru_referenced_usage_.fetch_sub(e->total_charge,
+                                          std::memory_order_relaxed);
+        }
+        return false;
+      }
+    }
+  }
   {
-    DMutexLock l(mutex_);
+    ExclusiveLock l(this);
     last_reference = e->Unref();
+    if (last_reference && e->InLRU()) {
+      // Left in the list by a Lookup() with read buffer
+      lru_referenced_usage_.fetch_sub(e->total_charge,
+                                      std::memory_order_relaxed);
+    }
     if (last_reference && e->InCache()) {
       // The item is still in cache, and nobody else holds a reference to it.
       if (usage_ > capacity_ || erase_if_last_ref) {
-        // The LRU list must be empty since the cache is full.
-        assert(lru_.next == &lru_ || erase_if_last_ref);
+        // The LRU list must be empty since the cache is full (but for
+        // referenced entries with a read buffer).
+        assert(lru_.next == &lru_ || erase_if_last_ref || read_buffer_);
         // Take this opportunity and remove the item.
+        if (e->InLRU()) {
+          LRU_Remove(e);
+        }
         table_.Remove(e->key(), e->hash);
         e->SetInCache(false);
       } else {
         // Put the item back on the LRU list, and don't free it.
-        LRU_Insert(e);
+        if (!e->InLRU()) {
+          LRU_Insert(e);
+        }
         last_reference = false;
       }
     }
     // If it was the last reference, then decrement the cache usage.
     if (last_reference) {
       assert(usage_ >= e->total_charge);
-      usage_ -= e->total_charge;
+      SubtractUsage(e);
     }
   }
 
@@ -690,8 +971,10 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash,
                              Cache::ObjectPtr value,
                              const Cache::CacheItemHelper* helper,
                              size_t charge, LRUHandle** handle,
-                             Cache::Priority priority) {
+                             Cache::Priority priority, uint8_t tenant) {
   assert(helper);
+  // Tenants need the cache's quotas
+  assert(tenant == 0 || tenant_quotas_ != nullptr);
 
   // Allocate the memory here outside of the mutex.
   // If the cache is full, we'll have to release it.
@@ -702,14 +985,17 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash,
   e->value = value;
   e->m_flags = 0;
   e->im_flags = 0;
+  e->numa_node = numa_node_;
+  e->tenant = tenant;
   e->helper = helper;
   e->key_length = key.size();
   e->hash = hash;
-  e->refs = 0;
+  e->refs.store(0, std::memory_order_relaxed);
   e->next = e->prev = nullptr;
   e->SetInCache(true);
   e->SetPriority(priority);
   memcpy(e->key_data, key.data(), key.size());
+  SetMissCost(e);
   e->CalcTotalCharge(charge, metadata_charge_policy_);
 
   // value == nullptr is reserved for indicating failure for when secondary
@@ -723,7 +1009,7 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
   LRUHandle* e;
   bool last_reference = false;
   {
-    DMutexLock l(mutex_);
+    ExclusiveLock l(this);
     e = table_.Remove(key, hash);
     if (e != nullptr) {
       assert(e->InCache());
@@ -732,8 +1018,11 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
         // The entry is in LRU since it's in hash and has no external references
         LRU_Remove(e);
         assert(usage_ >= e->total_charge);
-        usage_ -= e->total_charge;
+        SubtractUsage(e);
         last_reference = true;
+      } else if (e->InLRU()) {
+        // Left in the list by a Lookup() with read buffer
+        LRU_Remove(e);
       }
     }
   }
@@ -760,10 +1049,16 @@ size_t LRUCacheShard::GetUsage() const {
   return usage_;
 }
 
+size_t LRUCacheShard::GetTenantUsage(uint8_t tenant) const {
+  DMutexLock l(mutex_);
+  return tenant_usage_ ? tenant_usage_[tenant] : 0;
+}
+
 size_t LRUCacheShard::GetPinnedUsage() const {
   DMutexLock l(mutex_);
   assert(usage_ >= lru_usage_);
-  return usage_ - lru_usage_;
+  return usage_ - lru_usage_ +
+         lru_referenced_usage_.load(std::memory_order_relaxed);
 }
 
 size_t LRUCacheShard::GetOccupancyCount() const {
@@ -786,6 +1081,10 @@ void LRUCacheShard::AppendPrintableOptions(std::string& str) const {
     snprintf(buffer + strlen(buffer), kBufferSize - strlen(buffer),
              "    low_pri_pool_ratio: %.3lf\n", low_pri_pool_ratio_);
   }
+  snprintf(buffer + strlen(buffer), kBufferSize - strlen(buffer),
+           "    tiny_lfu_admission: %d\n", sketch_ != nullptr);
+  snprintf(buffer + strlen(buffer), kBufferSize - strlen(buffer),
+           "    use_read_buffer: %d\n", read_buffer_ != nullptr);
   str.append(buffer);
 }
 
@@ -795,18 +1094,30 @@ LRUCache::LRUCache(size_t capacity, int num_shard_bits,
                    std::shared_ptr<MemoryAllocator> allocator,
                    bool use_adaptive_mutex,
                    CacheMetadataChargePolicy metadata_charge_policy,
-                   std::shared_ptr<SecondaryCache> _secondary_cache)
+                   std::shared_ptr<SecondaryCache> _secondary_cache,
+                   bool tiny_lfu_admission, bool use_read_buffer,
+                   std::shared_ptr<CacheEvictionCostPolicy> eviction_cost_policy,
+                   uint8_t numa_node)
     : ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
-                   std::move(allocator)),
-      secondary_cache_(std::move(_secondary_cache)) {
+                   std::move(allocator), std::move(eviction_cost_policy)),
+      secondary_cache_(std::move(_secondary_cache)),
+      tenant_shard_quotas_(new std::atomic<size_t>[kMaxTenants]),
+      tenants_(1) {
+  for (int i = 0; i < kMaxTenants; i++) {
+    tenant_shard_quotas_[i].store(0, std::memory_order_relaxed);
+  }
   size_t per_shard = GetPerShardCapacity();
   SecondaryCache* secondary_cache = secondary_cache_.get();
   MemoryAllocator* alloc = memory_allocator();
+  CacheEvictionCostPolicy* cost_policy = eviction_cost_policy_.get();
+  const std::atomic<size_t>* tenant_quotas = tenant_shard_quotas_.get();
   InitShards([=](LRUCacheShard* cs) {
     new (cs) LRUCacheShard(
         per_shard, strict_capacity_limit, high_pri_pool_ratio,
         low_pri_pool_ratio, use_adaptive_mutex, metadata_charge_policy,
-        /* max_upper_hash_bits */ 32 - num_shard_bits, alloc, secondary_cache);
+        /* max_upper_hash_bits */ 32 - num_shard_bits, alloc, secondary_cache,
+        tiny_lfu_admission, use_read_buffer, cost_policy, numa_node,
+        tenant_quotas);
   });
 }
 
@@ -864,6 +1175,65 @@ void LRUCache::WaitAll(std::vector<Handle*>& handles) {
   }
 }
 
+void LRUCache::Tenant::RecordLookup(bool hit) {
+  const int cpu = port::PhysicalCoreID();
+  Counters& c = counters[cpu < 0 ? 0 : cpu % kCounterStripes];
+  c.lookups.fetch_add(1, std::memory_order_relaxed);
+  if (hit) {
+    c.hits.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+uint8_t LRUCache::RegisterTenant(const std::string& name, size_t soft_quota,
+                                 Tenant** tenant) {
+  MutexLock l(&tenants_mutex_);
+  size_t id = 1;
+  while (id < tenants_.size() && tenants_[id]->name != name) {
+    id++;
+  }
+  if (id == tenants_.size()) {
+    if (id == kMaxTenants) {
+      return 0;
+    }
+    tenants_.emplace_back(new Tenant(name));
+  }
+  tenants_[id]->soft_quota = soft_quota;
+  tenant_shard_quotas_[id].store(soft_quota / GetNumShards(),
+                                 std::memory_order_relaxed);
+  *tenant = tenants_[id].get();
+  return static_cast<uint8_t>(id);
+}
+
+Status LRUCache::InsertForTenant(const Slice& key, ObjectPtr value,
+                                 const CacheItemHelper* helper, size_t charge,
+                                 Handle** handle, Priority priority,
+                                 uint8_t tenant) {
+  assert(helper);
+  uint32_t hash = LRUCacheShard::ComputeHash(key);
+  return GetShard(hash).Insert(key, hash, value, helper, charge,
+                               reinterpret_cast<LRUHandle**>(handle),
+                               priority, tenant);
+}
+
+void LRUCache::GetTenantStats(std::vector<CacheTenantStats>* stats) {
+  stats->clear();
+  MutexLock l(&tenants_mutex_);
+  for (size_t id = 1; id < tenants_.size(); id++) {
+    const Tenant& tenant = *tenants_[id];
+    CacheTenantStats tenant_stats;
+    tenant_stats.name = tenant.name;
+    tenant_stats.soft_quota = tenant.soft_quota;
+    tenant_stats.usage = SumOverShards([id](LRUCacheShard& cs) {
+      return cs.GetTenantUsage(static_cast<uint8_t>(id));
+    });
+    for (const auto& c : tenant.counters) {
+      tenant_stats.lookups += c.lookups.load(std::memory_order_relaxed);
+      tenant_stats.hits += c.hits.load(std::memory_order_relaxed);
+    }
+    stats->push_back(std::move(tenant_stats));
+  }
+}
+
 void LRUCache::AppendPrintableOptions(std::string& str) const {
   ShardedCache::AppendPrintableOptions(str);  // options from shard
   if (secondary_cache_) {
@@ -872,15 +1242,115 @@ void LRUCache::AppendPrintableOptions(std::string& str) const {
   }
 }
 
+void LRUCache::SetCompressionDict(const Slice& key_prefix, const Slice& dict) {
+  if (secondary_cache_) {
+    secondary_cache_->SetCompressionDict(key_prefix, dict);
+  }
+}
+
+namespace {
+// A view of a shared LRUCache for a tenant, see NewCacheTenant()
+class LRUCacheTenantView : public CacheWrapper {
+ public:
+  LRUCacheTenantView(std::shared_ptr<Cache> target, uint8_t tenant_id,
+                     LRUCache::Tenant* tenant)
+      : CacheWrapper(std::move(target)),
+        tenant_id_(tenant_id),
+        tenant_(tenant) {}
+
+  static const char* kClassName() { return "LRUCacheTenantView"; }
+  const char* Name() const override { return kClassName(); }
+
+  Status Insert(const Slice& key, ObjectPtr value,
+                const CacheItemHelper* helper, size_t charge,
+                Handle** handle = nullptr,
+                Priority priority = Priority::LOW) override {
+    return static_cast<LRUCache*>(target_.get())
+        ->InsertForTenant(key, value, helper, charge, handle, priority,
+                          tenant_id_);
+  }
+
+  Handle* Lookup(const Slice& key, const CacheItemHelper* helper = nullptr,
+                 CreateContext* create_context = nullptr,
+                 Priority priority = Priority::LOW, bool wait = true,
+                 Statistics* stats = nullptr) override {
+    Handle* handle = target_->Lookup(key, helper, create_context, priority,
+                                     wait, stats);
+    tenant_->RecordLookup(handle != nullptr);
+    return handle;
+  }
+
+  LRUCache* GetLRUCache() const {
+    return static_cast<LRUCache*>(target_.get());
+  }
+
+  const std::string& GetTenantName() const { return tenant_->name; }
+
+ private:
+  const uint8_t tenant_id_;
+  LRUCache::Tenant* const tenant_;
+};
+}  // namespace
+
 }  // namespace lru_cache
 
+std::shared_ptr<Cache> NewCacheTenant(const std::shared_ptr<Cache>& cache,
+                                      const std::string& name,
+                                      size_t soft_quota) {
+  if (!cache || strcmp(cache->Name(), LRUCache::kClassName()) != 0) {
+    return nullptr;
+  }
+  LRUCache::Tenant* tenant = nullptr;
+  uint8_t tenant_id = static_cast<LRUCache*>(cache.get())
+                          ->RegisterTenant(name, soft_quota, &tenant);
+  if (tenant_id == 0) {
+    return nullptr;
+  }
+  return std::make_shared<lru_cache::LRUCacheTenantView>(cache, tenant_id,
+                                                         tenant);
+}
+
+bool GetCacheTenantViewStats(Cache* cache, CacheTenantStats* stats) {
+  if (cache == nullptr ||
+      strcmp(cache->Name(), lru_cache::LRUCacheTenantView::kClassName()) !=
+          0) {
+    return false;
+  }
+  auto view = static_cast<lru_cache::LRUCacheTenantView*>(cache);
+  std::vector<CacheTenantStats> all_stats;
+  view->GetLRUCache()->GetTenantStats(&all_stats);
+  for (auto& tenant_stats : all_stats) {
+    if (tenant_stats.name == view->GetTenantName()) {
+      *stats = std::move(tenant_stats);
+      return true;
+    }
+  }
+  assert(false);
+  return false;
+}
+
+Status GetCacheTenantStats(const std::shared_ptr<Cache>& cache,
+                           std::vector<CacheTenantStats>* stats) {
+  if (cache && strcmp(cache->Name(), LRUCache::kClassName()) == 0) {
+    static_cast<LRUCache*>(cache.get())->GetTenantStats(stats);
+    return Status::OK();
+  }
+  CacheTenantStats tenant_stats;
+  if (GetCacheTenantViewStats(cache.get(), &tenant_stats)) {
+    stats->assign(1, std::move(tenant_stats));
+    return Status::OK();
+  }
+  return Status::InvalidArgument("Not a cache with tenants");
+}
+
 std::shared_ptr<Cache> NewLRUCache(
     size_t capacity, int num_shard_bits, bool strict_capacity_limit,
     double high_pri_pool_ratio,
     std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
     CacheMetadataChargePolicy metadata_charge_policy,
     const std::shared_ptr<SecondaryCache>& secondary_cache,
-    double low_pri_pool_ratio) {
+    double low_pri_pool_ratio, bool tiny_lfu_admission, bool use_read_buffer,
+    std::shared_ptr<CacheEvictionCostPolicy> eviction_cost_policy) {
   if (num_shard_bits >= 20) {
     return nullptr;  // The cache cannot be sharded into too many fine pieces.
   }
@@ -902,7 +1372,8 @@ std::shared_ptr<Cache> NewLRUCache(
   return std::make_shared<LRUCache>(
       capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
       low_pri_pool_ratio, std::move(memory_allocator), use_adaptive_mutex,
-      metadata_charge_policy, secondary_cache);
+      metadata_charge_policy, secondary_cache, tiny_lfu_admission,
+      use_read_buffer, std::move(eviction_cost_policy));
 }
 
 std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
@@ -911,7 +1382,9 @@ std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
                      cache_opts.high_pri_pool_ratio,
                      cache_opts.memory_allocator, cache_opts.use_adaptive_mutex,
                      cache_opts.metadata_charge_policy,
-                     cache_opts.secondary_cache, cache_opts.low_pri_pool_ratio);
+                     cache_opts.secondary_cache, cache_opts.low_pri_pool_ratio,
+                     cache_opts.tiny_lfu_admission, cache_opts.use_read_buffer,
+                     cache_opts.eviction_cost_policy);
 }
 
 std::shared_ptr<Cache> NewLRUCache(
@@ -922,6 +1395,8 @@ std::shared_ptr<Cache> NewLRUCache(
     double low_pri_pool_ratio) {
   return NewLRUCache(capacity, num_shard_bits, strict_capacity_limit,
                      high_pri_pool_ratio, memory_allocator, use_adaptive_mutex,
-                     metadata_charge_policy, nullptr, low_pri_pool_ratio);
+                     metadata_charge_policy, nullptr, low_pri_pool_ratio,
+                     /*tiny_lfu_admission=*/false, /*use_read_buffer=*/false,
+                     /*eviction_cost_policy=*/nullptr);
 }
 }  // namespace ROCKSDB_NAMESPACE
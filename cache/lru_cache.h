@@ -8,9 +8,13 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include "cache/frequency_sketch.h"
 #include "cache/sharded_cache.h"
 #include "port/lang.h"
 #include "port/likely.h"
@@ -18,6 +22,7 @@
 #include "port/port.h"
 #include "rocksdb/secondary_cache.h"
 #include "util/autovector.h"
+#include "util/core_local.h"
 #include "util/distributed_mutex.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -47,6 +52,11 @@ namespace lru_cache {
 // possibly different value). To move from state 2 to state 1, use
 // LRUCacheShard::Lookup.
 // While refs > 0, public properties like value and deleter must not change.
+//
+// With a read buffer (see LRUCacheOptions::use_read_buffer), Lookup does not
+// remove entries from the LRU list, so an entry in state 1 might also be in
+// the LRU list. Such entries are taken off the list when found there by
+// eviction, and put back by the last Release if needed.
 
 struct LRUHandle {
   Cache::ObjectPtr value;
@@ -64,7 +74,8 @@ struct LRUHandle {
   // The hash of key(). Used for fast sharding and comparisons.
   uint32_t hash;
   // The number of external refs to this entry. The cache itself is not counted.
-  uint32_t refs;
+  // Atomic as lookups with a read buffer do not hold the shard's mutex.
+  std::atomic<uint32_t> refs;
 
   // Mutable flags - access controlled by mutex
   // The m_ and M_ prefixes (and im_ and IM_ later) are to hopefully avoid
@@ -97,6 +108,20 @@ struct LRUHandle {
     IM_IS_STANDALONE = (1 << 4),
   };
 
+  // The node of the cache holding this entry in a NUMA-aware cache (see
+  // NewNumaAwareCache()), to route the handle back to that cache. Immutable.
+  uint8_t numa_node;
+
+  // The tenant charged with this entry (see NewCacheTenant()), or 0 for
+  // none. Immutable.
+  uint8_t tenant;
+
+  // Estimated cost of a miss on this entry, relative to
+  // CacheEvictionCostPolicy::kTypicalMissCost, if the cache has an eviction
+  // cost policy. Halved whenever eviction passes over the entry. Access
+  // controlled by mutex.
+  uint16_t miss_cost;
+
   // Beginning of the key (MUST BE THE LAST FIELD IN THIS STRUCT!)
   char key_data[1];
 
@@ -106,17 +131,20 @@ struct LRUHandle {
   uint32_t GetHash() const { return hash; }
 
   // Increase the reference count by 1.
-  void Ref() { refs++; }
+  void Ref() { refs.fetch_add(1, std::memory_order_relaxed); }
 
   // Just reduce the reference count by 1. Return true if it was last reference.
   bool Unref() {
     assert(refs > 0);
-    refs--;
-    return refs == 0;
+    return refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
   }
 
   // Return true if there are external refs, false otherwise.
-  bool HasRefs() const { return refs > 0; }
+  bool HasRefs() const { return refs.load(std::memory_order_relaxed) > 0; }
+
+  // Whether this entry is in the LRU list. Stable while holding the shard's
+  // mutex or read lock.
+  bool InLRU() const { return next != nullptr; }
 
   bool InCache() const { return m_flags & M_IN_CACHE; }
   bool IsHighPri() const { return im_flags & IM_IS_HIGH_PRI; }
@@ -308,7 +336,11 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
                 bool use_adaptive_mutex,
                 CacheMetadataChargePolicy metadata_charge_policy,
                 int max_upper_hash_bits, MemoryAllocator* allocator,
-                SecondaryCache* secondary_cache);
+                SecondaryCache* secondary_cache,
+                bool tiny_lfu_admission = false, bool use_read_buffer = false,
+                CacheEvictionCostPolicy* eviction_cost_policy = nullptr,
+                uint8_t numa_node = 0,
+                const std::atomic<size_t>* tenant_quotas = nullptr);
 
  public:  // Type definitions expected as parameter to ShardedCache
   using HandleImpl = LRUHandle;
@@ -337,7 +369,8 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
   // Like Cache methods, but with an extra "hash" parameter.
   Status Insert(const Slice& key, uint32_t hash, Cache::ObjectPtr value,
                 const Cache::CacheItemHelper* helper, size_t charge,
-                LRUHandle** handle, Cache::Priority priority);
+                LRUHandle** handle, Cache::Priority priority,
+                uint8_t tenant = 0);
 
   LRUHandle* Lookup(const Slice& key, uint32_t hash,
                     const Cache::CacheItemHelper* helper,
@@ -356,6 +389,8 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
 
   size_t GetUsage() const;
   size_t GetPinnedUsage() const;
+  // Usage of the entries charged to a tenant
+  size_t GetTenantUsage(uint8_t tenant) const;
   size_t GetOccupancyCount() const;
   size_t GetTableAddressCount() const;
 
@@ -385,6 +420,56 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
 
  private:
   friend class LRUCache;
+
+  struct ReadStripe;
+
+  // Holds mutex_ and, with a read buffer, also waits for the ReadSections in
+  // progress to end, while new ones fall back to the mutex. The buffered hits
+  // are applied on locking, so no entry freed while the lock is held is
+  // referenced from the read buffer. Needed by anything modifying the hash
+  // table or the LRU list, or the entries in either.
+  class ExclusiveLock {
+   public:
+    explicit ExclusiveLock(LRUCacheShard* shard);
+    ~ExclusiveLock();
+    // No copying allowed
+    ExclusiveLock(const ExclusiveLock&) = delete;
+    ExclusiveLock& operator=(const ExclusiveLock&) = delete;
+
+   private:
+    DMutexLock mutex_lock_;
+    LRUCacheShard* const shard_;
+  };
+
+  // Shared side of ExclusiveLock, with a read buffer, for Lookup() and the
+  // common case of Release(). Only counts itself as a reader on the stripe
+  // of the current core, so threads on different cores do not write to the
+  // same cache line. While an ExclusiveLock is held or being taken, holds
+  // mutex_ instead.
+  class ReadSection {
+   public:
+    explicit ReadSection(LRUCacheShard* shard);
+    ~ReadSection();
+    // No copying allowed
+    ReadSection(const ReadSection&) = delete;
+    ReadSection& operator=(const ReadSection&) = delete;
+
+    ReadStripe* stripe() const { return stripe_; }
+
+   private:
+    ReadStripe* stripe_;
+    // Unless holding mutex_ instead
+    bool counted_;
+    std::optional<DMutexLock> mutex_lock_;
+  };
+
+  // Records a hit of e by Lookup() in the read buffer stripe of a
+  // ReadSection. Returns true if that filled the stripe.
+  bool RecordReadBufferHit(ReadStripe* stripe, LRUHandle* e);
+  // Moves the entries hit since the last call to the head of the LRU list.
+  // Requires ExclusiveLock.
+  void ApplyReadBuffer();
+
   // Insert an item into the hash table and, if handle is null, insert into
   // the LRU list. Older items are evicted as necessary. If the cache is full
   // and free_handle_on_fail is true, the item is deleted and handle is set to
@@ -407,12 +492,32 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
   // high-pri pool is no larger than the size specify by high_pri_pool_pct.
   void MaintainPoolSize();
 
-  // Free some space following strict LRU policy until enough space
-  // to hold (usage_ + charge) is freed or the lru list is empty
+  // Free some space following LRU policy (weighted by miss cost with an
+  // eviction cost policy) until enough space to hold (usage_ + charge) is
+  // freed or the lru list is empty
   // This function is not thread safe - it needs to be executed while
   // holding the mutex_.
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
 
+  // With an eviction cost policy, returns the entry to evict among the first
+  // few unreferenced entries of the LRU list, starting at `oldest`.
+  // Requires mutex_ held.
+  LRUHandle* PickEvictionVictim(LRUHandle* oldest);
+
+  // Sets the miss cost of a new entry `e`, if the cache has an eviction cost
+  // policy.
+  void SetMissCost(LRUHandle* e);
+
+  // Add the charge of `e` to, or subtract it from, usage_ and the usage of
+  // its tenant. Requires mutex_ held.
+  void AddUsage(LRUHandle* e);
+  void SubtractUsage(LRUHandle* e);
+
+  // Returns the first entry of a tenant over its soft quota among the first
+  // few unreferenced entries of the LRU list, starting at `oldest`, or
+  // nullptr if none. Requires mutex_ held.
+  LRUHandle* PickOverQuotaVictim(LRUHandle* oldest);
+
   // Try to insert the evicted handles into the secondary cache.
   void TryInsertIntoSecondaryCache(autovector<LRUHandle*> evicted_handles);
 
@@ -479,6 +584,54 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
 
   // Owned by LRUCache
   SecondaryCache* secondary_cache_;
+
+  // Recent lookup frequencies for admission, if tiny_lfu_admission. Updated
+  // without holding mutex_.
+  std::unique_ptr<FrequencySketch> sketch_;
+
+  // Owned by LRUCache. See ShardedCacheOptions::eviction_cost_policy.
+  CacheEvictionCostPolicy* const eviction_cost_policy_;
+
+  // Number of entries PickEvictionVictim() chooses from
+  static constexpr int kEvictionCandidates = 8;
+
+  // Stored in the entries, see LRUHandle::numa_node
+  const uint8_t numa_node_;
+
+  // Soft quota of each tenant in this shard, or 0 for none. Owned by
+  // LRUCache.
+  const std::atomic<size_t>* const tenant_quotas_;
+
+  // Usage of each tenant, allocated on the first insert charged to a tenant.
+  // Guarded by mutex_.
+  std::unique_ptr<size_t[]> tenant_usage_;
+
+  // Number of entries PickOverQuotaVictim() looks at
+  static constexpr int kTenantEvictionCandidates = 16;
+
+  // ------------------------------------
+  // Read buffer, if use_read_buffer
+  // ------------------------------------
+  static constexpr uint32_t kReadStripeSize = 16;
+  // Busy waiting of ExclusiveLock for each stripe before yielding
+  static constexpr int kExclusiveLockSpins = 100;
+
+  struct ALIGN_AS(CACHE_LINE_SIZE) ReadStripe {
+    // ReadSections in progress on this stripe, not holding mutex_
+    std::atomic<uint32_t> readers{0};
+    // Entries hit by Lookup() since the last ApplyReadBuffer(), in the first
+    // `count` slots. Hits while it is full are dropped.
+    std::atomic<uint32_t> count{0};
+    std::atomic<LRUHandle*> hits[kReadStripeSize];
+  };
+  // One stripe per core
+  std::unique_ptr<CoreLocalArray<ReadStripe>> read_buffer_;
+  // Set while an ExclusiveLock is held or being taken
+  std::atomic<bool> exclusive_{false};
+
+  // Total charge of referenced entries still in the LRU list (and so
+  // counted in lru_usage_). Only non-zero with a read buffer.
+  std::atomic<size_t> lru_referenced_usage_{0};
 };
 
 class LRUCache
@@ -493,8 +646,13 @@ class LRUCache
            bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
            CacheMetadataChargePolicy metadata_charge_policy =
                kDontChargeCacheMetadata,
-           std::shared_ptr<SecondaryCache> secondary_cache = nullptr);
-  const char* Name() const override { return "LRUCache"; }
+           std::shared_ptr<SecondaryCache> secondary_cache = nullptr,
+           bool tiny_lfu_admission = false, bool use_read_buffer = false,
+           std::shared_ptr<CacheEvictionCostPolicy> eviction_cost_policy =
+               nullptr,
+           uint8_t numa_node = 0);
+  static const char* kClassName() { return "LRUCache"; }
+  const char* Name() const override { return kClassName(); }
   ObjectPtr Value(Handle* handle) override;
   size_t GetCharge(Handle* handle) const override;
   const CacheItemHelper* GetCacheItemHelper(Handle* handle) const override;
@@ -507,8 +665,51 @@ class LRUCache
 
   void AppendPrintableOptions(std::string& str) const override;
 
+  void SetCompressionDict(const Slice& key_prefix, const Slice& dict) override;
+
+  // Tenants, see NewCacheTenant(). Tenant 0 is for entries inserted without
+  // a tenant.
+  static constexpr int kMaxTenants = 256;
+
+  struct Tenant {
+    explicit Tenant(const std::string& _name) : name(_name) {}
+
+    const std::string name;
+    // Guarded by tenants_mutex_
+    size_t soft_quota = 0;
+
+    // Lookups through the tenant's views, striped by CPU
+    struct ALIGN_AS(CACHE_LINE_SIZE) Counters {
+      std::atomic<uint64_t> lookups{0};
+      std::atomic<uint64_t> hits{0};
+    };
+    static constexpr int kCounterStripes = 8;
+    Counters counters[kCounterStripes];
+
+    void RecordLookup(bool hit);
+  };
+
+  // Returns the id of the tenant with this name, registering it if needed,
+  // and sets its soft quota and *tenant. Returns 0 if there are too many
+  // tenants.
+  uint8_t RegisterTenant(const std::string& name, size_t soft_quota,
+                         Tenant** tenant);
+
+  // Like Insert(), with the entry charged to a tenant
+  Status InsertForTenant(const Slice& key, ObjectPtr value,
+                         const CacheItemHelper* helper, size_t charge,
+                         Handle** handle, Priority priority, uint8_t tenant);
+
+  void GetTenantStats(std::vector<CacheTenantStats>* stats);
+
  private:
   std::shared_ptr<SecondaryCache> secondary_cache_;
+
+  // Quota of each tenant in each shard
+  std::unique_ptr<std::atomic<size_t>[]> tenant_shard_quotas_;
+  port::Mutex tenants_mutex_;
+  // Indexed by tenant id, nullptr for tenant 0
+  std::vector<std::unique_ptr<Tenant>> tenants_;
 };
 
 }  // namespace lru_cache
@@ -517,4 +718,8 @@ using LRUCache = lru_cache::LRUCache;
 using LRUHandle = lru_cache::LRUHandle;
 using LRUCacheShard = lru_cache::LRUCacheShard;
 
+// If `cache` is a view created by NewCacheTenant(), gets the stats of its
+// tenant and returns true.
+bool GetCacheTenantViewStats(Cache* cache, CacheTenantStats* stats);
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -5,6 +5,7 @@
 
 #include "cache/lru_cache.h"
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -43,7 +44,9 @@ class LRUCacheTest : public testing::Test {
 
   void NewCache(size_t capacity, double high_pri_pool_ratio = 0.0,
                 double low_pri_pool_ratio = 1.0,
-                bool use_adaptive_mutex = kDefaultToAdaptiveMutex) {
+                bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
+                bool use_read_buffer = false,
+                CacheEvictionCostPolicy* eviction_cost_policy = nullptr) {
     DeleteCache();
     cache_ = reinterpret_cast<LRUCacheShard*>(
         port::cacheline_aligned_alloc(sizeof(LRUCacheShard)));
@@ -52,7 +55,9 @@ class LRUCacheTest : public testing::Test {
                                use_adaptive_mutex, kDontChargeCacheMetadata,
                                /*max_upper_hash_bits=*/24,
                                /*allocator*/ nullptr,
-                               /*secondary_cache=*/nullptr);
+                               /*secondary_cache=*/nullptr,
+                               /*tiny_lfu_admission=*/false, use_read_buffer,
+                               eviction_cost_policy);
   }
 
   void Insert(const std::string& key,
@@ -78,6 +83,35 @@ class LRUCacheTest : public testing::Test {
 
   bool Lookup(char key) { return Lookup(std::string(1, key)); }
 
+  // Like Lookup(), but the caller must Release() the returned handle
+  LRUHandle* LookupAndRef(const std::string& key) {
+    return cache_->Lookup(key, 0 /*hash*/, nullptr, nullptr,
+                          Cache::Priority::LOW, true, nullptr);
+  }
+
+  void Release(LRUHandle* handle) {
+    cache_->Release(handle, true /*useful*/, false /*erase*/);
+  }
+
+  size_t GetUsage() { return cache_->GetUsage(); }
+
+  size_t GetPinnedUsage() { return cache_->GetPinnedUsage(); }
+
+  size_t GetLRUSize() { return cache_->TEST_GetLRUSize(); }
+
+  // Keys in the LRU list, from the least recently used
+  std::vector<std::string> GetLRUKeys() {
+    LRUHandle* lru;
+    LRUHandle* lru_low_pri;
+    LRUHandle* lru_bottom_pri;
+    cache_->TEST_GetLRUList(&lru, &lru_low_pri, &lru_bottom_pri);
+    std::vector<std::string> keys;
+    for (LRUHandle* e = lru->next; e != lru; e = e->next) {
+      keys.push_back(e->key().ToString());
+    }
+    return keys;
+  }
+
   void Erase(const std::string& key) { cache_->Erase(key, 0 /*hash*/); }
 
   void ValidateLRUList(std::vector<std::string> keys,
@@ -173,6 +207,121 @@ TEST_F(LRUCacheTest, BasicLRU) {
   ValidateLRUList({"e", "z", "d", "u", "v"}, 0, 5);
 }
 
+TEST_F(LRUCacheTest, ReadBuffer) {
+  NewCache(5, /* high_pri_pool_ratio */ 0.0, /* low_pri_pool_ratio */ 1.0,
+           kDefaultToAdaptiveMutex, /* use_read_buffer */ true);
+  for (char ch = 'a'; ch <= 'e'; ch++) {
+    Insert(ch);
+  }
+  ValidateLRUList({"a", "b", "c", "d", "e"}, 0, 5);
+  // Buffered hits are applied before the list is used (in order within a
+  // stripe, but the thread might move to another core in between lookups)
+  ASSERT_TRUE(Lookup("b"));
+  ValidateLRUList({"a", "c", "d", "e", "b"}, 0, 5);
+  ASSERT_TRUE(Lookup("a"));
+  ASSERT_FALSE(Lookup("x"));
+  ValidateLRUList({"c", "d", "e", "b", "a"}, 0, 5);
+  ASSERT_EQ(0, GetPinnedUsage());
+
+  // A referenced entry stays in the list until eviction reaches it
+  LRUHandle* c = LookupAndRef("c");
+  ASSERT_NE(nullptr, c);
+  ASSERT_EQ(1, GetPinnedUsage());
+  ValidateLRUList({"d", "e", "b", "a", "c"}, 0, 5);
+  for (char ch = 'v'; ch <= 'z'; ch++) {
+    Insert(ch);
+  }
+  ValidateLRUList({"w", "x", "y", "z"}, 0, 4);
+  ASSERT_EQ(5, GetUsage());
+  ASSERT_EQ(1, GetPinnedUsage());
+  // Back in the list on its last release
+  Release(c);
+  ValidateLRUList({"w", "x", "y", "z", "c"}, 0, 5);
+  ASSERT_EQ(0, GetPinnedUsage());
+
+  // An erased entry is charged until released
+  LRUHandle* x = LookupAndRef("x");
+  ASSERT_NE(nullptr, x);
+  Erase("x");
+  ValidateLRUList({"w", "y", "z", "c"}, 0, 4);
+  ASSERT_EQ(5, GetUsage());
+  ASSERT_EQ(1, GetPinnedUsage());
+  Release(x);
+  ASSERT_EQ(4, GetUsage());
+  ASSERT_EQ(0, GetPinnedUsage());
+  ASSERT_FALSE(Lookup("x"));
+}
+
+TEST_F(LRUCacheTest, ReadBufferConcurrentLookups) {
+  constexpr int kNumKeys = 100;
+  constexpr int kNumThreads = 4;
+  constexpr int kNumOps = 10000;
+  NewCache(kNumKeys / 2, /* high_pri_pool_ratio */ 0.5,
+           /* low_pri_pool_ratio */ 0.0, kDefaultToAdaptiveMutex,
+           /* use_read_buffer */ true);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      Random rnd(t + 1);
+      std::vector<LRUHandle*> handles;
+      for (int i = 0; i < kNumOps; ++i) {
+        std::string key = std::to_string(rnd.Uniform(kNumKeys));
+        if (t == 0 && i % 4 == 0) {
+          if (i % 16 == 0) {
+            Erase(key);
+          } else {
+            Insert(key);
+          }
+          continue;
+        }
+        LRUHandle* h = LookupAndRef(key);
+        if (h != nullptr) {
+          ASSERT_EQ(key, h->key().ToString());
+          handles.push_back(h);
+        }
+        // Hold a few references at a time
+        if (handles.size() > 3 || (h == nullptr && !handles.empty())) {
+          Release(handles.front());
+          handles.erase(handles.begin());
+        }
+      }
+      for (LRUHandle* h : handles) {
+        Release(h);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, GetPinnedUsage());
+  ASSERT_LE(GetUsage(), kNumKeys / 2);
+  ASSERT_EQ(GetUsage(), GetLRUSize());
+}
+
+TEST_F(LRUCacheTest, ReadBufferFullStripe) {
+  NewCache(40, /* high_pri_pool_ratio */ 0.0, /* low_pri_pool_ratio */ 1.0,
+           kDefaultToAdaptiveMutex, /* use_read_buffer */ true);
+  for (int i = 0; i < 40; i++) {
+    Insert(std::to_string(i));
+  }
+  // More hits than a stripe holds, so the lookup that fills a stripe applies
+  // the buffer. Whichever stripes were used, every hit entry ends up past the
+  // others.
+  for (int i = 0; i < 40; i += 2) {
+    ASSERT_TRUE(Lookup(std::to_string(i)));
+  }
+  int num_hit = 0;
+  for (const std::string& key : GetLRUKeys()) {
+    if (std::stoi(key) % 2 == 0) {
+      num_hit++;
+    } else {
+      // No unhit entry after a hit one
+      ASSERT_EQ(0, num_hit);
+    }
+  }
+  ASSERT_EQ(20, num_hit);
+}
+
 TEST_F(LRUCacheTest, LowPriorityMidpointInsertion) {
   // Allocate 2 cache entries to high-pri pool and 3 to low-pri pool.
   NewCache(5, /* high_pri_pool_ratio */ 0.40, /* low_pri_pool_ratio */ 0.60);
@@ -367,6 +516,186 @@ TEST_F(LRUCacheTest, EntriesWithPriority) {
   ValidateLRUList({"x", "y", "g", "z", "d", "m"}, 2, 2, 2);
 }
 
+namespace {
+// Miss costs set per key, and kTypicalMissCost for any other key
+class TestEvictionCostPolicy : public CacheEvictionCostPolicy {
+ public:
+  const char* Name() const override { return "TestEvictionCostPolicy"; }
+
+  uint32_t GetMissCost(const Slice& key, CacheEntryRole /*role*/) override {
+    auto it = costs_.find(key.ToString());
+    return it == costs_.end() ? kTypicalMissCost : it->second;
+  }
+
+  void SetCost(const std::string& key, uint32_t cost) { costs_[key] = cost; }
+
+ private:
+  std::map<std::string, uint32_t> costs_;
+};
+}  // namespace
+
+TEST_F(LRUCacheTest, EvictionCostPolicy) {
+  TestEvictionCostPolicy policy;
+  policy.SetCost("x", 4 * CacheEvictionCostPolicy::kTypicalMissCost);
+  NewCache(4, /* high_pri_pool_ratio */ 0.0, /* low_pri_pool_ratio */ 1.0,
+           kDefaultToAdaptiveMutex, /* use_read_buffer */ false, &policy);
+  for (char ch : {'a', 'x', 'b', 'c'}) {
+    Insert(ch);
+  }
+  ValidateLRUList({"a", "x", "b", "c"}, 0, 4);
+
+  // The costly entry is passed over for the cheaper ones behind it, losing
+  // half of its cost each time
+  Insert('d');
+  ValidateLRUList({"x", "b", "c", "d"}, 0, 4);
+  Insert('e');
+  ValidateLRUList({"x", "c", "d", "e"}, 0, 4);
+  Insert('f');
+  ValidateLRUList({"x", "d", "e", "f"}, 0, 4);
+  Insert('g');
+  ValidateLRUList({"x", "e", "f", "g"}, 0, 4);
+  // Until it is no more costly than the others
+  Insert('h');
+  ValidateLRUList({"e", "f", "g", "h"}, 0, 4);
+
+  // Referenced entries are not candidates, however cheap
+  policy.SetCost("i", 1);
+  Insert('i');
+  ValidateLRUList({"f", "g", "h", "i"}, 0, 4);
+  LRUHandle* handle = LookupAndRef("i");
+  ASSERT_NE(handle, nullptr);
+  Insert('j');
+  ValidateLRUList({"g", "h", "j"}, 0, 3);
+  Release(handle);
+  ValidateLRUList({"g", "h", "j", "i"}, 0, 4);
+}
+
+TEST(CacheEvictionCostPolicyTest, RoleAndReadLatency) {
+  CacheEvictionCostPolicyOptions options;
+  options.meta_block_cost_ratio = 3.0;
+  options.default_read_latency_us = 50;
+  auto policy = NewCacheEvictionCostPolicy(options);
+
+  // Keys of two files, sharing their prefix within a file
+  std::string key1(16, '\1');
+  std::string key2(16, '\2');
+  std::string key2b = key2.substr(0, 8) + std::string(8, '\3');
+
+  const uint32_t kTypical = CacheEvictionCostPolicy::kTypicalMissCost;
+  ASSERT_EQ(kTypical, policy->GetMissCost(key1, CacheEntryRole::kDataBlock));
+  ASSERT_EQ(3 * kTypical,
+            policy->GetMissCost(key1, CacheEntryRole::kIndexBlock));
+  ASSERT_EQ(3 * kTypical,
+            policy->GetMissCost(key1, CacheEntryRole::kFilterBlock));
+  ASSERT_EQ(kTypical, policy->GetMissCost(key2, CacheEntryRole::kDataBlock));
+
+  // Files reading at 10x the default latency cost 10x as much to miss
+  policy->SetReadLatencyHint(Slice(key2.data(), 8), 500);
+  ASSERT_EQ(10 * kTypical,
+            policy->GetMissCost(key2, CacheEntryRole::kDataBlock));
+  ASSERT_EQ(10 * kTypical,
+            policy->GetMissCost(key2b, CacheEntryRole::kDataBlock));
+  ASSERT_EQ(30 * kTypical,
+            policy->GetMissCost(key2b, CacheEntryRole::kIndexBlock));
+  ASSERT_EQ(kTypical, policy->GetMissCost(key1, CacheEntryRole::kDataBlock));
+
+  // Too short to have a file prefix
+  ASSERT_EQ(kTypical, policy->GetMissCost("k", CacheEntryRole::kDataBlock));
+  policy->SetReadLatencyHint("k", 500);
+  ASSERT_EQ(kTypical, policy->GetMissCost("k", CacheEntryRole::kDataBlock));
+}
+
+TEST(CacheTenantTest, SoftQuotas) {
+  LRUCacheOptions opts(10 /* capacity */, 0 /* num_shard_bits */,
+                       false /* strict_capacity_limit */,
+                       0.0 /* high_pri_pool_ratio */,
+                       nullptr /* memory_allocator */, kDefaultToAdaptiveMutex,
+                       kDontChargeCacheMetadata);
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+  std::shared_ptr<Cache> tenant_a = NewCacheTenant(cache, "a", 3);
+  std::shared_ptr<Cache> tenant_b = NewCacheTenant(cache, "b", 0);
+  ASSERT_NE(tenant_a, nullptr);
+  ASSERT_NE(tenant_b, nullptr);
+
+  auto insert = [](Cache* c, const std::string& key) {
+    ASSERT_OK(c->Insert(key, nullptr, &kNoopCacheItemHelper, 1 /*charge*/));
+  };
+  for (const char* key : {"b1", "b2", "b3"}) {
+    insert(tenant_b.get(), key);
+  }
+  for (const char* key : {"a1", "a2", "a3", "a4", "a5", "a6"}) {
+    insert(tenant_a.get(), key);
+  }
+  ASSERT_EQ(9, cache->GetUsage());
+
+  // Tenant a is over its quota, so its entries are evicted ahead of the
+  // older entries of tenant b
+  for (const char* key : {"b4", "b5", "b6"}) {
+    insert(tenant_b.get(), key);
+  }
+  ASSERT_EQ(10, cache->GetUsage());
+  for (const char* key : {"b1", "b2", "b3", "b4", "b5", "b6"}) {
+    Cache::Handle* h = tenant_b->Lookup(key);
+    ASSERT_NE(h, nullptr);
+    tenant_b->Release(h);
+  }
+  for (const char* key : {"a1", "a2"}) {
+    ASSERT_EQ(tenant_a->Lookup(key), nullptr);
+  }
+  Cache::Handle* h = tenant_a->Lookup("a3");
+  ASSERT_NE(h, nullptr);
+  tenant_a->Release(h);
+
+  std::vector<CacheTenantStats> stats;
+  ASSERT_OK(GetCacheTenantStats(cache, &stats));
+  ASSERT_EQ(2, stats.size());
+  ASSERT_EQ("a", stats[0].name);
+  ASSERT_EQ(3, stats[0].soft_quota);
+  ASSERT_EQ(4, stats[0].usage);
+  ASSERT_EQ(3, stats[0].lookups);
+  ASSERT_EQ(1, stats[0].hits);
+  ASSERT_EQ("b", stats[1].name);
+  ASSERT_EQ(0, stats[1].soft_quota);
+  ASSERT_EQ(6, stats[1].usage);
+  ASSERT_EQ(6, stats[1].lookups);
+  ASSERT_EQ(6, stats[1].hits);
+
+  // Through a view, only the stats of its tenant
+  ASSERT_OK(GetCacheTenantStats(tenant_b, &stats));
+  ASSERT_EQ(1, stats.size());
+  ASSERT_EQ("b", stats[0].name);
+  ASSERT_EQ(6, stats[0].usage);
+
+  // Registering a tenant again updates its quota
+  tenant_a = NewCacheTenant(cache, "a", 10);
+  tenant_b = NewCacheTenant(cache, "b", 2);
+  ASSERT_NE(tenant_a, nullptr);
+  ASSERT_NE(tenant_b, nullptr);
+  insert(tenant_a.get(), "a7");
+  ASSERT_EQ(tenant_b->Lookup("b1"), nullptr);
+  ASSERT_OK(GetCacheTenantStats(cache, &stats));
+  ASSERT_EQ(2, stats.size());
+  ASSERT_EQ(10, stats[0].soft_quota);
+  ASSERT_EQ(5, stats[0].usage);
+  ASSERT_EQ(2, stats[1].soft_quota);
+  ASSERT_EQ(5, stats[1].usage);
+
+  // Erasing entries releases their charge to the tenant
+  tenant_b->Erase("b2");
+  ASSERT_OK(GetCacheTenantStats(tenant_b, &stats));
+  ASSERT_EQ(4, stats[0].usage);
+
+  // Only supported on LRUCache
+  ASSERT_EQ(NewCacheTenant(HyperClockCacheOptions(1024, 1).MakeSharedCache(),
+                           "a", 0),
+            nullptr);
+  ASSERT_EQ(NewCacheTenant(tenant_a, "c", 0), nullptr);
+  ASSERT_TRUE(GetCacheTenantStats(HyperClockCacheOptions(1024, 1)
+                                      .MakeSharedCache(),
+                                  &stats)
+                  .IsInvalidArgument());
+}
+
 namespace clock_cache {
 
 class ClockCacheTest : public testing::Test {
@@ -386,13 +715,16 @@ class ClockCacheTest : public testing::Test {
     }
   }
 
-  void NewShard(size_t capacity, bool strict_capacity_limit = true) {
+  void NewShard(size_t capacity, bool strict_capacity_limit = true,
+                size_t estimated_value_size = 1,
+                CacheEvictionCostPolicy* eviction_cost_policy = nullptr) {
     DeleteShard();
     shard_ =
         reinterpret_cast<Shard*>(port::cacheline_aligned_alloc(sizeof(Shard)));
 
     Table::Opts opts;
-    opts.estimated_value_size = 1;
+    opts.estimated_value_size = estimated_value_size;
+    opts.eviction_cost_policy = eviction_cost_policy;
     new (shard_) Shard(capacity, strict_capacity_limit,
                        kDontChargeCacheMetadata, /*allocator*/ nullptr, opts);
   }
@@ -663,6 +995,45 @@ TEST_F(ClockCacheTest, ClockEvictionTest) {
   }
 }
 
+TEST_F(ClockCacheTest, EvictionCostPolicy) {
+  // Costs in place of the priorities of ClockEvictionTest, which are ignored
+  TestEvictionCostPolicy policy;
+  const uint32_t kTypical = CacheEvictionCostPolicy::kTypicalMissCost;
+  for (char ch : {'a', 'd'}) {
+    policy.SetCost(TestKey(TestHashedKey(ch)).ToString(), kTypical / 4);
+  }
+  for (char ch : {'c', 'f'}) {
+    policy.SetCost(TestKey(TestHashedKey(ch)).ToString(), kTypical * 4);
+  }
+  NewShard(6, /*strict_capacity_limit*/ false, /*estimated_value_size*/ 1,
+           &policy);
+  for (char ch = 'a'; ch <= 'f'; ch++) {
+    EXPECT_OK(Insert(ch, Cache::Priority::HIGH));
+  }
+
+  // Cheap entries are evicted first
+  EXPECT_OK(Insert('g', Cache::Priority::HIGH));
+  EXPECT_OK(Insert('h', Cache::Priority::HIGH));
+
+  EXPECT_FALSE(Lookup('a', /*use*/ false));
+  EXPECT_TRUE(Lookup('b', /*use*/ false));
+  EXPECT_TRUE(Lookup('c', /*use*/ false));
+  EXPECT_FALSE(Lookup('d', /*use*/ false));
+  EXPECT_TRUE(Lookup('e', /*use*/ false));
+  EXPECT_TRUE(Lookup('f', /*use*/ false));
+  EXPECT_TRUE(Lookup('g', /*use*/ true));
+  EXPECT_TRUE(Lookup('h', /*use*/ true));
+
+  // Then typical entries, before the costly ones
+  EXPECT_OK(Insert('i', Cache::Priority::HIGH));
+  EXPECT_OK(Insert('j', Cache::Priority::HIGH));
+
+  EXPECT_FALSE(Lookup('b', /*use*/ false));
+  EXPECT_TRUE(Lookup('c', /*use*/ false));
+  EXPECT_FALSE(Lookup('e', /*use*/ false));
+  EXPECT_TRUE(Lookup('f', /*use*/ false));
+}
+
 namespace {
 struct DeleteCounter {
   int deleted = 0;
@@ -878,6 +1249,91 @@ TEST_F(ClockCacheTest, TableSizesTest) {
   }
 }
 
+TEST_F(ClockCacheTest, AutoResizeTest) {
+  constexpr size_t kCapacity = 1 << 20;
+  constexpr size_t kCharge = 256;
+  constexpr size_t kNumKeys = kCapacity / kCharge / 2;
+  NewShard(kCapacity, /*strict_capacity_limit*/ false,
+           /*estimated_value_size*/ 0);
+  const size_t initial_table_size = shard_->GetTableAddressCount();
+  // Sized for much larger entries
+  ASSERT_LT(initial_table_size, kNumKeys);
+
+  auto hkey = [](size_t i) -> UniqueId64x2 {
+    return {i * 0x9E3779B97F4A7C15U, i * 0xC2B2AE3D27D4EB4FU + 1};
+  };
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(shard_->Insert(TestKey(hkey(i)), hkey(i), nullptr /*value*/,
+                             &kNoopCacheItemHelper, kCharge,
+                             nullptr /*handle*/, Cache::Priority::LOW));
+  }
+  // The table grew instead of evicting, since the shard is under capacity
+  EXPECT_GT(shard_->GetTableAddressCount(), kNumKeys);
+  EXPECT_LE(shard_->GetOccupancyCount(), shard_->GetOccupancyLimit());
+  EXPECT_EQ(shard_->GetOccupancyCount(), kNumKeys);
+  EXPECT_EQ(shard_->GetUsage(), kNumKeys * kCharge);
+  // Entries of all the generations are found
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    ASSERT_TRUE(Lookup(hkey(i)));
+  }
+  size_t count = 0;
+  size_t state = 0;
+  while (state != SIZE_MAX) {
+    shard_->ApplyToSomeEntries(
+        [&](const Slice&, Cache::ObjectPtr, size_t charge,
+            const Cache::CacheItemHelper*) {
+          EXPECT_EQ(charge, kCharge);
+          ++count;
+        },
+        100, &state);
+  }
+  EXPECT_EQ(count, kNumKeys);
+
+  // Erase from the first generation
+  shard_->Erase(TestKey(hkey(0)), hkey(0));
+  EXPECT_FALSE(Lookup(hkey(0)));
+
+  // Over capacity, entries are evicted rather than growing the table
+  const size_t grown_table_size = shard_->GetTableAddressCount();
+  for (size_t i = kNumKeys; i < 4 * kNumKeys; ++i) {
+    ASSERT_OK(shard_->Insert(TestKey(hkey(i)), hkey(i), nullptr /*value*/,
+                             &kNoopCacheItemHelper, kCharge,
+                             nullptr /*handle*/, Cache::Priority::LOW));
+  }
+  EXPECT_EQ(shard_->GetTableAddressCount(), grown_table_size);
+  EXPECT_LE(shard_->GetUsage(), kCapacity + kCharge);
+}
+
+TEST_F(ClockCacheTest, AutoResizeConcurrentTest) {
+  constexpr size_t kCapacity = 1 << 20;
+  constexpr size_t kNumThreads = 4;
+  constexpr size_t kNumKeysPerThread = 5000;
+  NewShard(kCapacity, /*strict_capacity_limit*/ false,
+           /*estimated_value_size*/ 0);
+  std::vector<port::Thread> threads;
+  for (size_t t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < kNumKeysPerThread; ++i) {
+        UniqueId64x2 hkey{(t * kNumKeysPerThread + i) * 0x9E3779B97F4A7C15U,
+                          i * 0xC2B2AE3D27D4EB4FU + t};
+        HandleImpl* h = nullptr;
+        // Varying charges
+        ASSERT_OK(shard_->Insert(TestKey(hkey), hkey, nullptr /*value*/,
+                                 &kNoopCacheItemHelper, 64 << (i % 5), &h,
+                                 Cache::Priority::LOW));
+        ASSERT_NE(h, nullptr);
+        shard_->Release(h);
+        Lookup(hkey);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(shard_->GetOccupancyCount(), shard_->GetOccupancyLimit());
+  EXPECT_LE(shard_->GetUsage(), kCapacity + 2 * 1024 * kNumThreads);
+}
+
 }  // namespace clock_cache
 
 class TestSecondaryCache : public SecondaryCache {
@@ -1910,6 +2366,158 @@ TEST_F(LRUCacheSecondaryCacheTest, BasicWaitAllTest) {
   secondary_cache.reset();
 }
 
+TEST_F(LRUCacheSecondaryCacheTest, NumaAwareCache) {
+  int cur_node = 0;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "NumaNodeMap::GetCurrentNode",
+      [&](void* arg) { *static_cast<int*>(arg) = cur_node; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  Random rnd(301);
+  for (bool promote_remote_hits : {false, true}) {
+    SCOPED_TRACE("promote_remote_hits = " +
+                 std::to_string(promote_remote_hits));
+    NumaAwareCacheOptions opts;
+    opts.cache_opts.capacity = 4096;
+    opts.cache_opts.num_shard_bits = 0;
+    opts.cache_opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    opts.num_nodes = 2;
+    opts.promote_remote_hits = promote_remote_hits;
+    std::shared_ptr<Cache> cache = NewNumaAwareCache(opts);
+    ASSERT_NE(cache, nullptr);
+    CacheKey k1 = CacheKey::CreateUniqueForCacheLifetime(cache.get());
+    CacheKey k2 = CacheKey::CreateUniqueForCacheLifetime(cache.get());
+
+    // Inserted into the cache of node 0
+    cur_node = 0;
+    std::string str1 = rnd.RandomString(1000);
+    ASSERT_OK(cache->Insert(k1.AsSlice(),
+                            new TestItem(str1.data(), str1.length()),
+                            &LRUCacheSecondaryCacheTest::helper_,
+                            str1.length()));
+    Cache::Handle* handle =
+        cache->Lookup(k1.AsSlice(), &LRUCacheSecondaryCacheTest::helper_,
+                      /*context*/ this, Cache::Priority::LOW, true);
+    ASSERT_NE(handle, nullptr);
+    ASSERT_EQ(static_cast<TestItem*>(cache->Value(handle))->ToString(), str1);
+    cache->Release(handle);
+
+    // Found remotely from node 1, then locally if promoted
+    cur_node = 1;
+    for (int i = 0; i < 2; i++) {
+      handle =
+          cache->Lookup(k1.AsSlice(), &LRUCacheSecondaryCacheTest::helper_,
+                        /*context*/ this, Cache::Priority::LOW, true);
+      ASSERT_NE(handle, nullptr);
+      ASSERT_EQ(static_cast<TestItem*>(cache->Value(handle))->ToString(),
+                str1);
+      ASSERT_EQ(cache->GetCharge(handle), str1.length());
+      cache->Release(handle);
+    }
+    ASSERT_EQ(cache->Lookup(k2.AsSlice(), &LRUCacheSecondaryCacheTest::helper_,
+                            /*context*/ this, Cache::Priority::LOW, true),
+              nullptr);
+
+    std::vector<NumaCacheNodeStats> stats;
+    ASSERT_OK(GetNumaAwareCacheStats(cache, &stats));
+    ASSERT_EQ(stats.size(), 2);
+    ASSERT_EQ(stats[0].local_hits, 1);
+    ASSERT_EQ(stats[0].remote_hits, 0);
+    ASSERT_EQ(stats[0].misses, 0);
+    ASSERT_EQ(stats[0].usage, str1.length());
+    ASSERT_EQ(stats[1].misses, 1);
+    if (promote_remote_hits) {
+      ASSERT_EQ(stats[1].local_hits, 1);
+      ASSERT_EQ(stats[1].remote_hits, 1);
+      ASSERT_EQ(stats[1].promotions, 1);
+      ASSERT_EQ(stats[1].usage, str1.length());
+    } else {
+      ASSERT_EQ(stats[1].local_hits, 0);
+      ASSERT_EQ(stats[1].remote_hits, 2);
+      ASSERT_EQ(stats[1].promotions, 0);
+      ASSERT_EQ(stats[1].usage, 0);
+    }
+    ASSERT_EQ(cache->GetUsage(), stats[0].usage + stats[1].usage);
+
+    // Erased from all the nodes
+    cache->Erase(k1.AsSlice());
+    ASSERT_EQ(cache->GetUsage(), 0);
+    cur_node = 0;
+    ASSERT_EQ(cache->Lookup(k1.AsSlice()), nullptr);
+
+    // The capacity is split between the nodes
+    cache->SetCapacity(2048);
+    ASSERT_EQ(cache->GetCapacity(), 2048);
+    std::string str2 = rnd.RandomString(1500);
+    ASSERT_OK(cache->Insert(k2.AsSlice(),
+                            new TestItem(str2.data(), str2.length()),
+                            &LRUCacheSecondaryCacheTest::helper_,
+                            str2.length()));
+    ASSERT_EQ(cache->GetUsage(), 0);
+  }
+
+  std::vector<NumaCacheNodeStats> stats;
+  ASSERT_TRUE(GetNumaAwareCacheStats(NewLRUCache(1024), &stats)
+                  .IsInvalidArgument());
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+namespace {
+class CountingAllocator : public MemoryAllocator {
+ public:
+  const char* Name() const override { return "CountingAllocator"; }
+  void* Allocate(size_t size) override {
+    num_allocations++;
+    return malloc(size);
+  }
+  void Deallocate(void* p) override {
+    num_allocations--;
+    free(p);
+  }
+
+  int num_allocations = 0;
+};
+}  // namespace
+
+TEST_F(LRUCacheSecondaryCacheTest, NumaAwareCacheNodeAllocators) {
+  int cur_node = 0;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "NumaNodeMap::GetCurrentNode",
+      [&](void* arg) { *static_cast<int*>(arg) = cur_node; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  NumaAwareCacheOptions opts;
+  opts.cache_opts.capacity = 4096;
+  opts.num_nodes = 2;
+  auto allocator0 = std::make_shared<CountingAllocator>();
+  auto allocator1 = std::make_shared<CountingAllocator>();
+  opts.node_memory_allocators = {allocator0};
+  // One per node
+  ASSERT_EQ(NewNumaAwareCache(opts), nullptr);
+  opts.node_memory_allocators.push_back(allocator1);
+  std::shared_ptr<Cache> cache = NewNumaAwareCache(opts);
+  ASSERT_NE(cache, nullptr);
+
+  // Allocated by the allocator of the current node, and deallocated by the
+  // same allocator from any node
+  MemoryAllocator* allocator = cache->memory_allocator();
+  cur_node = 1;
+  void* p = allocator->Allocate(100);
+  ASSERT_NE(p, nullptr);
+  memset(p, 1, 100);
+  ASSERT_EQ(allocator0->num_allocations, 0);
+  ASSERT_EQ(allocator1->num_allocations, 1);
+  ASSERT_EQ(allocator->UsableSize(p, 100), 100);
+  cur_node = 0;
+  allocator->Deallocate(p);
+  ASSERT_EQ(allocator1->num_allocations, 0);
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 // In this test, we have one KV pair per data block. We indirectly determine
 // the cache key associated with each data block (and thus each KV) by using
 // a sync point callback in TestSecondaryCache::Lookup. We then control the
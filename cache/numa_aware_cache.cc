@@ -0,0 +1,393 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/numa_aware_cache.h"
+
+#ifdef NUMA
+#include <numa.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "cache/lru_cache.h"
+#include "test_util/sync_point.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+constexpr int kMaxNumaNodes = 64;
+}  // namespace
+
+NumaNodeMap::NumaNodeMap(int num_nodes) : num_nodes_(num_nodes) {
+#ifdef NUMA
+  if (numa_available() != -1) {
+    if (num_nodes_ <= 0) {
+      num_nodes_ = std::min(numa_num_configured_nodes(), kMaxNumaNodes);
+    }
+    const int num_cpus = numa_num_configured_cpus();
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      const int node = numa_node_of_cpu(cpu);
+      node_of_cpu_.push_back(
+          static_cast<uint8_t>(node < 0 ? 0 : node % num_nodes_));
+    }
+    return;
+  }
+#endif  // NUMA
+  if (num_nodes_ <= 0) {
+    num_nodes_ = 1;
+  }
+  // Contiguous ranges of CPUs
+  const int num_cpus =
+      std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  for (int cpu = 0; cpu < num_cpus; ++cpu) {
+    node_of_cpu_.push_back(static_cast<uint8_t>(
+        static_cast<int64_t>(cpu) * num_nodes_ / num_cpus));
+  }
+}
+
+int NumaNodeMap::GetCurrentNode(int* cpu) const {
+  const int cur_cpu = port::PhysicalCoreID();
+  int node = 0;
+  if (cur_cpu >= 0 && static_cast<size_t>(cur_cpu) < node_of_cpu_.size()) {
+    node = node_of_cpu_[cur_cpu];
+  }
+  TEST_SYNC_POINT_CALLBACK("NumaNodeMap::GetCurrentNode", &node);
+  if (cpu != nullptr) {
+    *cpu = cur_cpu;
+  }
+  return node;
+}
+
+void* NumaMemoryAllocator::Allocate(size_t size) {
+  const int node = node_map_.GetCurrentNode();
+  char* p = static_cast<char*>(
+      node_allocators_[node]->Allocate(size + kPrefixSize));
+  if (p == nullptr) {
+    return nullptr;
+  }
+  *p = static_cast<char>(node);
+  return p + kPrefixSize;
+}
+
+void NumaMemoryAllocator::Deallocate(void* p) {
+  char* base = static_cast<char*>(p) - kPrefixSize;
+  node_allocators_[static_cast<uint8_t>(*base)]->Deallocate(base);
+}
+
+size_t NumaMemoryAllocator::UsableSize(void* p, size_t allocation_size) const {
+  char* base = static_cast<char*>(p) - kPrefixSize;
+  return node_allocators_[static_cast<uint8_t>(*base)]->UsableSize(
+             base, allocation_size + kPrefixSize) -
+         kPrefixSize;
+}
+
+NumaAwareCache::NumaAwareCache(const NumaAwareCacheOptions& opts,
+                               NumaNodeMap node_map,
+                               std::shared_ptr<MemoryAllocator> allocator)
+    : Cache(allocator),
+      node_map_(std::move(node_map)),
+      promote_remote_hits_(opts.promote_remote_hits),
+      defer_secondary_cache_(opts.cache_opts.secondary_cache != nullptr &&
+                             node_map_.GetNumNodes() > 1),
+      clock_(SystemClock::Default().get()),
+      counters_(new LookupCounters[node_map_.GetNumNodes() * kCounterStripes]),
+      capacity_(opts.cache_opts.capacity) {
+  const LRUCacheOptions& cache_opts = opts.cache_opts;
+  const int num_nodes = node_map_.GetNumNodes();
+  const size_t per_node = cache_opts.capacity / num_nodes;
+  int num_shard_bits = cache_opts.num_shard_bits;
+  if (num_shard_bits < 0) {
+    num_shard_bits = GetDefaultCacheShardBits(per_node);
+  }
+  for (int node = 0; node < num_nodes; ++node) {
+    caches_.push_back(std::make_shared<lru_cache::LRUCache>(
+        per_node, num_shard_bits, cache_opts.strict_capacity_limit,
+        cache_opts.high_pri_pool_ratio, cache_opts.low_pri_pool_ratio,
+        allocator, cache_opts.use_adaptive_mutex,
+        cache_opts.metadata_charge_policy, cache_opts.secondary_cache,
+        cache_opts.tiny_lfu_admission, cache_opts.use_read_buffer,
+        cache_opts.eviction_cost_policy, static_cast<uint8_t>(node)));
+  }
+}
+
+Cache& NumaAwareCache::GetCache(Handle* handle) const {
+  return *caches_[reinterpret_cast<lru_cache::LRUHandle*>(handle)->numa_node];
+}
+
+NumaAwareCache::LookupCounters& NumaAwareCache::GetCounters(int node,
+                                                            int cpu) const {
+  const int stripe = cpu < 0 ? 0 : cpu % kCounterStripes;
+  return counters_[node * kCounterStripes + stripe];
+}
+
+Status NumaAwareCache::Insert(const Slice& key, ObjectPtr obj,
+                              const CacheItemHelper* helper, size_t charge,
+                              Handle** handle, Priority priority) {
+  return caches_[node_map_.GetCurrentNode()]->Insert(key, obj, helper, charge,
+                                                     handle, priority);
+}
+
+Cache::Handle* NumaAwareCache::Lookup(const Slice& key,
+                                      const CacheItemHelper* helper,
+                                      CreateContext* create_context,
+                                      Priority priority, bool wait,
+                                      Statistics* stats) {
+  int cpu;
+  const int node = node_map_.GetCurrentNode(&cpu);
+  LookupCounters& counters = GetCounters(node, cpu);
+  Cache& local = *caches_[node];
+
+  Handle* handle =
+      defer_secondary_cache_
+          ? local.Lookup(key, /*helper=*/nullptr, /*create_context=*/nullptr,
+                         priority, wait, stats)
+          : local.Lookup(key, helper, create_context, priority, wait, stats);
+  if (handle != nullptr) {
+    counters.local_hits.fetch_add(1, std::memory_order_relaxed);
+    return handle;
+  }
+
+  const int num_nodes = node_map_.GetNumNodes();
+  if (num_nodes > 1) {
+    const uint64_t start_nanos = clock_->NowNanos();
+    for (int i = 1; i < num_nodes && handle == nullptr; ++i) {
+      // Remote misses must not go to the secondary cache
+      handle = caches_[(node + i) % num_nodes]->Lookup(
+          key, /*helper=*/nullptr, /*create_context=*/nullptr, priority,
+          /*wait=*/true, stats);
+    }
+    counters.remote_lookup_nanos.fetch_add(clock_->NowNanos() - start_nanos,
+                                           std::memory_order_relaxed);
+    if (handle != nullptr) {
+      counters.remote_hits.fetch_add(1, std::memory_order_relaxed);
+      if (promote_remote_hits_) {
+        handle = PromoteRemoteHit(node, key, handle, helper, create_context,
+                                  priority, counters);
+      }
+      return handle;
+    }
+  }
+
+  if (defer_secondary_cache_ && helper != nullptr) {
+    handle = local.Lookup(key, helper, create_context, priority, wait, stats);
+    if (handle != nullptr) {
+      counters.local_hits.fetch_add(1, std::memory_order_relaxed);
+      return handle;
+    }
+  }
+  counters.misses.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+Cache::Handle* NumaAwareCache::PromoteRemoteHit(
+    int node, const Slice& key, Handle* remote, const CacheItemHelper* helper,
+    CreateContext* create_context, Priority priority,
+    LookupCounters& counters) {
+  Cache& remote_cache = GetCache(remote);
+  // The object can only be recreated by the helper it was saved with
+  if (helper == nullptr || !helper->IsSecondaryCacheCompatible() ||
+      remote_cache.GetCacheItemHelper(remote) != helper) {
+    return remote;
+  }
+  ObjectPtr remote_obj = remote_cache.Value(remote);
+  const size_t size = helper->size_cb(remote_obj);
+  std::unique_ptr<char[]> buf(new char[size]);
+  Status s = helper->saveto_cb(remote_obj, 0, size, buf.get());
+  ObjectPtr obj = nullptr;
+  size_t charge = 0;
+  if (s.ok()) {
+    // Allocated on this node, by the calling thread
+    s = helper->create_cb(Slice(buf.get(), size), create_context,
+                          memory_allocator(), &obj, &charge);
+  }
+  if (!s.ok()) {
+    return remote;
+  }
+  Handle* handle = nullptr;
+  s = caches_[node]->Insert(key, obj, helper, charge, &handle, priority);
+  if (!s.ok()) {
+    helper->del_cb(obj, memory_allocator());
+    return remote;
+  }
+  remote_cache.Release(remote, /*useful=*/true, /*erase_if_last_ref=*/false);
+  counters.promotions.fetch_add(1, std::memory_order_relaxed);
+  return handle;
+}
+
+void NumaAwareCache::Erase(const Slice& key) {
+  for (auto& cache : caches_) {
+    cache->Erase(key);
+  }
+}
+
+void NumaAwareCache::SetCapacity(size_t capacity) {
+  capacity_.store(capacity, std::memory_order_relaxed);
+  for (auto& cache : caches_) {
+    cache->SetCapacity(capacity / caches_.size());
+  }
+}
+
+void NumaAwareCache::SetStrictCapacityLimit(bool strict_capacity_limit) {
+  for (auto& cache : caches_) {
+    cache->SetStrictCapacityLimit(strict_capacity_limit);
+  }
+}
+
+size_t NumaAwareCache::GetCapacity() const {
+  return capacity_.load(std::memory_order_relaxed);
+}
+
+size_t NumaAwareCache::GetUsage() const {
+  size_t usage = 0;
+  for (auto& cache : caches_) {
+    usage += cache->GetUsage();
+  }
+  return usage;
+}
+
+size_t NumaAwareCache::GetOccupancyCount() const {
+  size_t count = 0;
+  for (auto& cache : caches_) {
+    count += cache->GetOccupancyCount();
+  }
+  return count;
+}
+
+size_t NumaAwareCache::GetTableAddressCount() const {
+  size_t count = 0;
+  for (auto& cache : caches_) {
+    count += cache->GetTableAddressCount();
+  }
+  return count;
+}
+
+size_t NumaAwareCache::GetPinnedUsage() const {
+  size_t usage = 0;
+  for (auto& cache : caches_) {
+    usage += cache->GetPinnedUsage();
+  }
+  return usage;
+}
+
+void NumaAwareCache::DisownData() {
+  for (auto& cache : caches_) {
+    cache->DisownData();
+  }
+}
+
+void NumaAwareCache::ApplyToAllEntries(
+    const std::function<void(const Slice& key, ObjectPtr obj, size_t charge,
+                             const CacheItemHelper* helper)>& callback,
+    const ApplyToAllEntriesOptions& opts) {
+  for (auto& cache : caches_) {
+    cache->ApplyToAllEntries(callback, opts);
+  }
+}
+
+void NumaAwareCache::EraseUnRefEntries() {
+  for (auto& cache : caches_) {
+    cache->EraseUnRefEntries();
+  }
+}
+
+std::string NumaAwareCache::GetPrintableOptions() const {
+  std::string ret;
+  ret.append("    num_nodes: " + std::to_string(caches_.size()) + "\n");
+  ret.append("    promote_remote_hits: " +
+             std::to_string(promote_remote_hits_) + "\n");
+  ret.append("  node_cache:\n");
+  ret.append(caches_[0]->GetPrintableOptions());
+  return ret;
+}
+
+void NumaAwareCache::WaitAll(std::vector<Handle*>& handles) {
+  // Only the local caches consult their secondary cache, so the pending
+  // handles are normally all of the same node
+  std::vector<std::vector<Handle*>> node_handles(caches_.size());
+  for (Handle* handle : handles) {
+    if (handle != nullptr) {
+      node_handles[reinterpret_cast<lru_cache::LRUHandle*>(handle)->numa_node]
+          .push_back(handle);
+    }
+  }
+  for (size_t node = 0; node < caches_.size(); ++node) {
+    if (!node_handles[node].empty()) {
+      caches_[node]->WaitAll(node_handles[node]);
+    }
+  }
+}
+
+void NumaAwareCache::SetReadLatencyHint(const Slice& key_prefix,
+                                        uint64_t latency_us) {
+  // The caches share their eviction cost policy
+  caches_[0]->SetReadLatencyHint(key_prefix, latency_us);
+}
+
+void NumaAwareCache::SetCompressionDict(const Slice& key_prefix,
+                                        const Slice& dict) {
+  // And their secondary cache
+  caches_[0]->SetCompressionDict(key_prefix, dict);
+}
+
+void NumaAwareCache::GetStats(std::vector<NumaCacheNodeStats>* stats) const {
+  stats->assign(caches_.size(), NumaCacheNodeStats());
+  for (size_t node = 0; node < caches_.size(); ++node) {
+    NumaCacheNodeStats& node_stats = (*stats)[node];
+    for (int stripe = 0; stripe < kCounterStripes; ++stripe) {
+      const LookupCounters& counters =
+          counters_[node * kCounterStripes + stripe];
+      node_stats.local_hits +=
+          counters.local_hits.load(std::memory_order_relaxed);
+      node_stats.remote_hits +=
+          counters.remote_hits.load(std::memory_order_relaxed);
+      node_stats.misses += counters.misses.load(std::memory_order_relaxed);
+      node_stats.promotions +=
+          counters.promotions.load(std::memory_order_relaxed);
+      node_stats.remote_lookup_nanos +=
+          counters.remote_lookup_nanos.load(std::memory_order_relaxed);
+    }
+    node_stats.usage = caches_[node]->GetUsage();
+  }
+}
+
+std::shared_ptr<Cache> NewNumaAwareCache(const NumaAwareCacheOptions& opts) {
+  const LRUCacheOptions& cache_opts = opts.cache_opts;
+  if (opts.num_nodes < 0 || opts.num_nodes > kMaxNumaNodes ||
+      cache_opts.num_shard_bits >= 20 || cache_opts.high_pri_pool_ratio < 0.0 ||
+      cache_opts.low_pri_pool_ratio < 0.0 ||
+      cache_opts.low_pri_pool_ratio + cache_opts.high_pri_pool_ratio > 1.0) {
+    return nullptr;
+  }
+  NumaNodeMap node_map(opts.num_nodes);
+  std::shared_ptr<MemoryAllocator> allocator = cache_opts.memory_allocator;
+  if (!opts.node_memory_allocators.empty()) {
+    if (opts.node_memory_allocators.size() !=
+        static_cast<size_t>(node_map.GetNumNodes())) {
+      return nullptr;
+    }
+    for (auto& node_allocator : opts.node_memory_allocators) {
+      if (node_allocator == nullptr) {
+        return nullptr;
+      }
+    }
+    allocator = std::make_shared<NumaMemoryAllocator>(
+        node_map, opts.node_memory_allocators);
+  }
+  return std::make_shared<NumaAwareCache>(opts, std::move(node_map),
+                                          std::move(allocator));
+}
+
+Status GetNumaAwareCacheStats(const std::shared_ptr<Cache>& cache,
+                              std::vector<NumaCacheNodeStats>* stats) {
+  if (!cache || strcmp(cache->Name(), NumaAwareCache::kClassName()) != 0) {
+    return Status::InvalidArgument("Not a NUMA-aware cache");
+  }
+  static_cast<NumaAwareCache*>(cache.get())->GetStats(stats);
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
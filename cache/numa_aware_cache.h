@@ -0,0 +1,187 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/memory_allocator.h"
+#include "rocksdb/system_clock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The NUMA node of each CPU, from libnuma if RocksDB is built with it.
+class NumaNodeMap {
+ public:
+  // num_nodes = 0 for the number of nodes of the host
+  explicit NumaNodeMap(int num_nodes);
+
+  int GetNumNodes() const { return num_nodes_; }
+
+  // The node of the CPU the calling thread runs on (as of the call), and
+  // that CPU in *cpu if not nullptr (-1 if unknown).
+  int GetCurrentNode(int* cpu = nullptr) const;
+
+ private:
+  int num_nodes_;
+  std::vector<uint8_t> node_of_cpu_;
+};
+
+// A MemoryAllocator allocating from the allocator of the node of the calling
+// thread, see NumaAwareCacheOptions::node_memory_allocators. Each allocation
+// is prefixed with its node, so that it is deallocated by the same allocator.
+class NumaMemoryAllocator : public MemoryAllocator {
+ public:
+  NumaMemoryAllocator(
+      NumaNodeMap node_map,
+      std::vector<std::shared_ptr<MemoryAllocator>> node_allocators)
+      : node_map_(std::move(node_map)),
+        node_allocators_(std::move(node_allocators)) {}
+
+  static const char* kClassName() { return "NumaMemoryAllocator"; }
+  const char* Name() const override { return kClassName(); }
+
+  void* Allocate(size_t size) override;
+  void Deallocate(void* p) override;
+  size_t UsableSize(void* p, size_t allocation_size) const override;
+
+ private:
+  // Keeps the alignment of the underlying allocators
+  static constexpr size_t kPrefixSize = 16;
+
+  const NumaNodeMap node_map_;
+  const std::vector<std::shared_ptr<MemoryAllocator>> node_allocators_;
+};
+
+// The Cache returned by NewNumaAwareCache(): one LRUCache per NUMA node.
+// The handles are those of the caches of the nodes, routed back to their
+// cache by LRUHandle::numa_node.
+//
+// Lookup() probes the cache of the local node, then the caches of the other
+// nodes, starting with the next node so that the remote probes of different
+// nodes are spread. With a secondary cache, the secondary cache of the local
+// node is only consulted after all the nodes missed.
+class NumaAwareCache : public Cache {
+ public:
+  NumaAwareCache(const NumaAwareCacheOptions& opts, NumaNodeMap node_map,
+                 std::shared_ptr<MemoryAllocator> allocator);
+
+  static const char* kClassName() { return "NumaAwareCache"; }
+  const char* Name() const override { return kClassName(); }
+
+  Status Insert(const Slice& key, ObjectPtr obj, const CacheItemHelper* helper,
+                size_t charge, Handle** handle = nullptr,
+                Priority priority = Priority::LOW) override;
+
+  Handle* Lookup(const Slice& key, const CacheItemHelper* helper = nullptr,
+                 CreateContext* create_context = nullptr,
+                 Priority priority = Priority::LOW, bool wait = true,
+                 Statistics* stats = nullptr) override;
+
+  bool Ref(Handle* handle) override { return GetCache(handle).Ref(handle); }
+
+  bool Release(Handle* handle, bool erase_if_last_ref = false) override {
+    return GetCache(handle).Release(handle, erase_if_last_ref);
+  }
+
+  bool Release(Handle* handle, bool useful, bool erase_if_last_ref) override {
+    return GetCache(handle).Release(handle, useful, erase_if_last_ref);
+  }
+
+  ObjectPtr Value(Handle* handle) override {
+    return GetCache(handle).Value(handle);
+  }
+
+  void Erase(const Slice& key) override;
+
+  uint64_t NewId() override { return caches_[0]->NewId(); }
+
+  void SetCapacity(size_t capacity) override;
+  void SetStrictCapacityLimit(bool strict_capacity_limit) override;
+  bool HasStrictCapacityLimit() const override {
+    return caches_[0]->HasStrictCapacityLimit();
+  }
+  size_t GetCapacity() const override;
+
+  size_t GetUsage() const override;
+  size_t GetOccupancyCount() const override;
+  size_t GetTableAddressCount() const override;
+  size_t GetUsage(Handle* handle) const override {
+    return GetCache(handle).GetUsage(handle);
+  }
+  size_t GetPinnedUsage() const override;
+  size_t GetCharge(Handle* handle) const override {
+    return GetCache(handle).GetCharge(handle);
+  }
+  const CacheItemHelper* GetCacheItemHelper(Handle* handle) const override {
+    return GetCache(handle).GetCacheItemHelper(handle);
+  }
+
+  void DisownData() override;
+
+  void ApplyToAllEntries(
+      const std::function<void(const Slice& key, ObjectPtr obj, size_t charge,
+                               const CacheItemHelper* helper)>& callback,
+      const ApplyToAllEntriesOptions& opts) override;
+
+  void EraseUnRefEntries() override;
+
+  std::string GetPrintableOptions() const override;
+
+  bool IsReady(Handle* handle) override {
+    return GetCache(handle).IsReady(handle);
+  }
+  void Wait(Handle* handle) override { GetCache(handle).Wait(handle); }
+  void WaitAll(std::vector<Handle*>& handles) override;
+
+  void SetReadLatencyHint(const Slice& key_prefix,
+                          uint64_t latency_us) override;
+
+  void SetCompressionDict(const Slice& key_prefix, const Slice& dict) override;
+
+  void GetStats(std::vector<NumaCacheNodeStats>* stats) const;
+
+ private:
+  // Counters of the lookups from a node, striped by CPU so that the threads
+  // of a node do not all update the same cache line
+  struct ALIGN_AS(CACHE_LINE_SIZE) LookupCounters {
+    std::atomic<uint64_t> local_hits{0};
+    std::atomic<uint64_t> remote_hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> promotions{0};
+    std::atomic<uint64_t> remote_lookup_nanos{0};
+  };
+  static constexpr int kCounterStripes = 16;
+
+  Cache& GetCache(Handle* handle) const;
+
+  LookupCounters& GetCounters(int node, int cpu) const;
+
+  // Copies the entry of a remote hit into the cache of `node`, returning
+  // the handle of the copy, or the remote handle if it could not be copied.
+  Handle* PromoteRemoteHit(int node, const Slice& key, Handle* remote,
+                           const CacheItemHelper* helper,
+                           CreateContext* create_context, Priority priority,
+                           LookupCounters& counters);
+
+  const NumaNodeMap node_map_;
+  const bool promote_remote_hits_;
+  // Whether remote nodes are probed before the secondary cache
+  const bool defer_secondary_cache_;
+  SystemClock* const clock_;
+  // The LRUCache of each node
+  std::vector<std::shared_ptr<Cache>> caches_;
+  std::unique_ptr<LookupCounters[]> counters_;
+  std::atomic<size_t> capacity_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -21,10 +21,13 @@ namespace ROCKSDB_NAMESPACE {
 
 ShardedCacheBase::ShardedCacheBase(size_t capacity, int num_shard_bits,
                                    bool strict_capacity_limit,
-                                   std::shared_ptr<MemoryAllocator> allocator)
+                                   std::shared_ptr<MemoryAllocator> allocator,
+                                   std::shared_ptr<CacheEvictionCostPolicy>
+                                       eviction_cost_policy)
     : Cache(std::move(allocator)),
       last_id_(1),
       shard_mask_((uint32_t{1} << num_shard_bits) - 1),
+      eviction_cost_policy_(std::move(eviction_cost_policy)),
       strict_capacity_limit_(strict_capacity_limit),
       capacity_(capacity) {}
 
@@ -55,6 +58,13 @@ size_t ShardedCacheBase::GetUsage(Handle* handle) const {
   return GetCharge(handle);
 }
 
+void ShardedCacheBase::SetReadLatencyHint(const Slice& key_prefix,
+                                          uint64_t latency_us) {
+  if (eviction_cost_policy_) {
+    eviction_cost_policy_->SetReadLatencyHint(key_prefix, latency_us);
+  }
+}
+
 std::string ShardedCacheBase::GetPrintableOptions() const {
   std::string ret;
   ret.reserve(20000);
@@ -75,6 +85,9 @@ std::string ShardedCacheBase::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "    memory_allocator : %s\n",
            memory_allocator() ? memory_allocator()->Name() : "None");
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    eviction_cost_policy : %s\n",
+           eviction_cost_policy_ ? eviction_cost_policy_->Name() : "None");
+  ret.append(buffer);
   AppendPrintableOptions(ret);
   return ret;
 }
@@ -89,7 +89,9 @@ class ShardedCacheBase : public Cache {
  public:
   ShardedCacheBase(size_t capacity, int num_shard_bits,
                    bool strict_capacity_limit,
-                   std::shared_ptr<MemoryAllocator> memory_allocator);
+                   std::shared_ptr<MemoryAllocator> memory_allocator,
+                   std::shared_ptr<CacheEvictionCostPolicy>
+                       eviction_cost_policy = nullptr);
   virtual ~ShardedCacheBase() = default;
 
   int GetNumShardBits() const;
@@ -104,6 +106,9 @@ class ShardedCacheBase : public Cache {
   size_t GetUsage(Handle* handle) const override;
   std::string GetPrintableOptions() const override;
 
+  void SetReadLatencyHint(const Slice& key_prefix,
+                          uint64_t latency_us) override;
+
  protected:  // fns
   virtual void AppendPrintableOptions(std::string& str) const = 0;
   size_t GetPerShardCapacity() const;
@@ -112,6 +117,9 @@ class ShardedCacheBase : public Cache {
  protected:                        // data
   std::atomic<uint64_t> last_id_;  // For NewId
   const uint32_t shard_mask_;
+  // See ShardedCacheOptions::eviction_cost_policy. Shards use it through a
+  // raw pointer.
+  const std::shared_ptr<CacheEvictionCostPolicy> eviction_cost_policy_;
 
   // Dynamic configuration parameters, guarded by config_mutex_
   bool strict_capacity_limit_;
@@ -133,9 +141,11 @@ class ShardedCache : public ShardedCacheBase {
   using HandleImpl = typename CacheShard::HandleImpl;
 
   ShardedCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-               std::shared_ptr<MemoryAllocator> allocator)
+               std::shared_ptr<MemoryAllocator> allocator,
+               std::shared_ptr<CacheEvictionCostPolicy> eviction_cost_policy =
+                   nullptr)
       : ShardedCacheBase(capacity, num_shard_bits, strict_capacity_limit,
-                         allocator),
+                         allocator, std::move(eviction_cost_policy)),
         shards_(reinterpret_cast<CacheShard*>(port::cacheline_aligned_alloc(
             sizeof(CacheShard) * GetNumShards()))),
         destroy_shards_in_dtor_(false) {}
@@ -0,0 +1,392 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/tiered_secondary_cache.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "monitoring/statistics.h"
+#include "rocksdb/cache.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Typical size of a block cache entry, for sizing the frequency sketch from
+// the memory budget
+constexpr size_t kSketchBytesPerEntry = 4096;
+
+class ReadyResultHandle : public SecondaryCacheResultHandle {
+ public:
+  ReadyResultHandle(Cache::ObjectPtr value, size_t size)
+      : value_(value), size_(size) {}
+
+  bool IsReady() override { return true; }
+
+  void Wait() override {}
+
+  Cache::ObjectPtr Value() override { return value_; }
+
+  size_t Size() override { return size_; }
+
+ private:
+  Cache::ObjectPtr value_;
+  size_t size_;
+};
+
+}  // namespace
+
+// Wraps the handle of a tier. For NVM tier hits, promotes the entry to the
+// compressed tier once the handle is ready (and before the primary cache
+// takes the value).
+class TieredSecondaryCache::ResultHandle : public SecondaryCacheResultHandle {
+ public:
+  ResultHandle(TieredSecondaryCache* cache, const Slice& key,
+               const Cache::CacheItemHelper* helper, bool from_nvm,
+               std::unique_ptr<SecondaryCacheResultHandle>&& target)
+      : cache_(cache),
+        key_(key.ToString()),
+        helper_(helper),
+        from_nvm_(from_nvm),
+        completed_(!from_nvm),
+        target_(std::move(target)) {}
+
+  bool IsReady() override {
+    MaybeComplete();
+    return target_->IsReady();
+  }
+
+  void Wait() override {
+    target_->Wait();
+    MaybeComplete();
+  }
+
+  Cache::ObjectPtr Value() override {
+    MaybeComplete();
+    return target_->Value();
+  }
+
+  size_t Size() override { return target_->Size(); }
+
+  bool from_nvm() const { return from_nvm_; }
+
+  SecondaryCacheResultHandle* target() { return target_.get(); }
+
+ private:
+  void MaybeComplete() {
+    if (completed_ || !target_->IsReady()) {
+      return;
+    }
+    completed_ = true;
+    Cache::ObjectPtr value = target_->Value();
+    if (value != nullptr && cache_->comp_sec_cache_) {
+      // Subject to the compressed tier's admission policy
+      cache_->comp_sec_cache_->Insert(key_, value, helper_)
+          .PermitUncheckedError();
+      RecordTick(cache_->stats_.get(), TIERED_CACHE_PROMOTIONS);
+    }
+  }
+
+  TieredSecondaryCache* const cache_;
+  const std::string key_;
+  const Cache::CacheItemHelper* const helper_;
+  const bool from_nvm_;
+  bool completed_;
+  std::unique_ptr<SecondaryCacheResultHandle> target_;
+};
+
+TieredSecondaryCache::TieredSecondaryCache(
+    std::shared_ptr<SecondaryCache> comp_sec_cache,
+    std::shared_ptr<SecondaryCache> nvm_sec_cache,
+    uint32_t nvm_admission_min_frequency, size_t expected_entries,
+    std::shared_ptr<Statistics> stats)
+    : comp_sec_cache_(std::move(comp_sec_cache)),
+      nvm_sec_cache_(std::move(nvm_sec_cache)),
+      nvm_admission_min_frequency_(nvm_admission_min_frequency),
+      sketch_(expected_entries),
+      stats_(std::move(stats)) {}
+
+Status TieredSecondaryCache::Insert(const Slice& key, Cache::ObjectPtr obj,
+                                    const Cache::CacheItemHelper* helper) {
+  Status s;
+  if (comp_sec_cache_) {
+    s = comp_sec_cache_->Insert(key, obj, helper);
+  }
+  if (nvm_sec_cache_) {
+    if (sketch_.Estimate(GetSliceNPHash64(key)) >=
+        nvm_admission_min_frequency_) {
+      RecordTick(stats_.get(), TIERED_CACHE_NVM_ADMITS);
+      // Best effort, like the compressed tier's
+      nvm_sec_cache_->Insert(key, obj, helper).PermitUncheckedError();
+    } else {
+      RecordTick(stats_.get(), TIERED_CACHE_NVM_REJECTS);
+    }
+  }
+  return s;
+}
+
+std::unique_ptr<SecondaryCacheResultHandle> TieredSecondaryCache::Lookup(
+    const Slice& key, const Cache::CacheItemHelper* helper,
+    Cache::CreateContext* create_context, bool wait, bool advise_erase,
+    bool& is_in_sec_cache) {
+  is_in_sec_cache = false;
+  // Lookups come from misses in the primary cache, so they are the accesses
+  // that NVM tier admission is based on.
+  sketch_.Increment(GetSliceNPHash64(key));
+
+  std::unique_ptr<SecondaryCacheResultHandle> handle;
+  if (comp_sec_cache_) {
+    handle = comp_sec_cache_->Lookup(key, helper, create_context, wait,
+                                     advise_erase, is_in_sec_cache);
+    if (handle) {
+      RecordTick(stats_.get(), TIERED_CACHE_COMPRESSED_HITS);
+      if (!nvm_sec_cache_) {
+        return handle;
+      }
+      // Wrapped so that WaitAll() can tell the tiers' handles apart
+      return std::make_unique<ResultHandle>(this, key, helper,
+                                            /*from_nvm=*/false,
+                                            std::move(handle));
+    }
+  }
+  if (nvm_sec_cache_) {
+    handle = nvm_sec_cache_->Lookup(key, helper, create_context, wait,
+                                    advise_erase, is_in_sec_cache);
+    if (handle) {
+      RecordTick(stats_.get(), TIERED_CACHE_NVM_HITS);
+      return std::make_unique<ResultHandle>(this, key, helper,
+                                            /*from_nvm=*/true,
+                                            std::move(handle));
+    }
+  }
+  return nullptr;
+}
+
+void TieredSecondaryCache::Erase(const Slice& key) {
+  if (comp_sec_cache_) {
+    comp_sec_cache_->Erase(key);
+  }
+  if (nvm_sec_cache_) {
+    nvm_sec_cache_->Erase(key);
+  }
+}
+
+void TieredSecondaryCache::WaitAll(
+    std::vector<SecondaryCacheResultHandle*> handles) {
+  if (!nvm_sec_cache_) {
+    // Handles are the compressed tier's own
+    if (comp_sec_cache_) {
+      comp_sec_cache_->WaitAll(std::move(handles));
+    }
+    return;
+  }
+  std::vector<SecondaryCacheResultHandle*> comp_handles;
+  std::vector<SecondaryCacheResultHandle*> nvm_handles;
+  for (SecondaryCacheResultHandle* handle : handles) {
+    auto h = static_cast<ResultHandle*>(handle);
+    if (h->from_nvm()) {
+      nvm_handles.push_back(h->target());
+    } else {
+      comp_handles.push_back(h->target());
+    }
+  }
+  if (!comp_handles.empty()) {
+    comp_sec_cache_->WaitAll(std::move(comp_handles));
+  }
+  if (!nvm_handles.empty()) {
+    nvm_sec_cache_->WaitAll(std::move(nvm_handles));
+  }
+  // Promote the NVM tier hits
+  for (SecondaryCacheResultHandle* handle : handles) {
+    handle->Wait();
+  }
+}
+
+Status TieredSecondaryCache::SetCapacity(size_t capacity) {
+  if (!comp_sec_cache_) {
+    return Status::NotSupported();
+  }
+  return comp_sec_cache_->SetCapacity(capacity);
+}
+
+Status TieredSecondaryCache::GetCapacity(size_t& capacity) {
+  if (!comp_sec_cache_) {
+    return Status::NotSupported();
+  }
+  return comp_sec_cache_->GetCapacity(capacity);
+}
+
+std::string TieredSecondaryCache::GetPrintableOptions() const {
+  std::string ret;
+  const int kBufferSize{200};
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    nvm_admission_min_frequency : %" PRIu32
+           "\n", nvm_admission_min_frequency_);
+  ret.append(buffer);
+  if (comp_sec_cache_) {
+    ret.append("    compressed_tier:\n");
+    ret.append(comp_sec_cache_->GetPrintableOptions());
+  }
+  if (nvm_sec_cache_) {
+    ret.append("    nvm_tier:\n");
+    ret.append(nvm_sec_cache_->GetPrintableOptions());
+  }
+  return ret;
+}
+
+TieredCache::TieredCache(std::shared_ptr<Cache> primary,
+                         std::shared_ptr<SecondaryCache> sec_cache,
+                         size_t total_capacity,
+                         double compressed_secondary_ratio)
+    : CacheWrapper(std::move(primary)),
+      sec_cache_(std::move(sec_cache)),
+      total_capacity_(total_capacity),
+      compressed_secondary_ratio_(compressed_secondary_ratio) {
+  MutexLock l(&mutex_);
+  ApplyCapacity();
+}
+
+void TieredCache::ApplyCapacity() {
+  mutex_.AssertHeld();
+  const size_t comp_capacity = static_cast<size_t>(
+      static_cast<double>(total_capacity_) * compressed_secondary_ratio_);
+  // When shrinking, shrink the primary tier first so that its evictions
+  // are not pushed into a compressed tier that is about to shrink too, and
+  // vice versa when growing.
+  size_t old_comp_capacity = 0;
+  sec_cache_->GetCapacity(old_comp_capacity).PermitUncheckedError();
+  if (comp_capacity < old_comp_capacity) {
+    sec_cache_->SetCapacity(comp_capacity).PermitUncheckedError();
+    target_->SetCapacity(total_capacity_ - comp_capacity);
+  } else {
+    target_->SetCapacity(total_capacity_ - comp_capacity);
+    sec_cache_->SetCapacity(comp_capacity).PermitUncheckedError();
+  }
+}
+
+void TieredCache::SetCapacity(size_t capacity) {
+  MutexLock l(&mutex_);
+  total_capacity_ = capacity;
+  ApplyCapacity();
+}
+
+size_t TieredCache::GetCapacity() const {
+  MutexLock l(&mutex_);
+  return total_capacity_;
+}
+
+Status TieredCache::Update(int64_t total_capacity,
+                           double compressed_secondary_ratio) {
+  if (compressed_secondary_ratio > 1.0) {
+    return Status::InvalidArgument("Invalid compressed_secondary_ratio");
+  }
+  MutexLock l(&mutex_);
+  if (total_capacity >= 0) {
+    total_capacity_ = static_cast<size_t>(total_capacity);
+  }
+  if (compressed_secondary_ratio >= 0.0) {
+    compressed_secondary_ratio_ = compressed_secondary_ratio;
+  }
+  ApplyCapacity();
+  return Status::OK();
+}
+
+std::string TieredCache::GetPrintableOptions() const {
+  std::string ret;
+  const int kBufferSize{200};
+  char buffer[kBufferSize];
+  {
+    MutexLock l(&mutex_);
+    snprintf(buffer, kBufferSize, "    total_capacity : %" ROCKSDB_PRIszt "\n",
+             total_capacity_);
+    ret.append(buffer);
+    snprintf(buffer, kBufferSize, "    compressed_secondary_ratio : %.3lf\n",
+             compressed_secondary_ratio_);
+    ret.append(buffer);
+  }
+  ret.append(target_->GetPrintableOptions());
+  return ret;
+}
+
+Status PersistentSecondaryCache::Insert(const Slice& key, Cache::ObjectPtr obj,
+                                        const Cache::CacheItemHelper* helper) {
+  const size_t size = helper->size_cb(obj);
+  std::unique_ptr<char[]> buf(new char[size]);
+  Status s = helper->saveto_cb(obj, 0, size, buf.get());
+  if (!s.ok()) {
+    return s;
+  }
+  return cache_->Insert(key, buf.get(), size);
+}
+
+std::unique_ptr<SecondaryCacheResultHandle> PersistentSecondaryCache::Lookup(
+    const Slice& key, const Cache::CacheItemHelper* helper,
+    Cache::CreateContext* create_context, bool /*wait*/,
+    bool /*advise_erase*/, bool& is_in_sec_cache) {
+  is_in_sec_cache = false;
+  std::unique_ptr<char[]> data;
+  size_t size = 0;
+  if (!cache_->Lookup(key, &data, &size).ok()) {
+    return nullptr;
+  }
+  Cache::ObjectPtr value = nullptr;
+  size_t charge = 0;
+  Status s = helper->create_cb(Slice(data.get(), size), create_context,
+                               /*allocator=*/nullptr, &value, &charge);
+  if (!s.ok()) {
+    return nullptr;
+  }
+  is_in_sec_cache = true;
+  return std::make_unique<ReadyResultHandle>(value, charge);
+}
+
+std::shared_ptr<SecondaryCache> NewPersistentSecondaryCache(
+    const std::shared_ptr<PersistentCache>& cache) {
+  return std::make_shared<PersistentSecondaryCache>(cache);
+}
+
+std::shared_ptr<Cache> NewTieredCache(const TieredCacheOptions& opts) {
+  if (opts.compressed_secondary_ratio < 0.0 ||
+      opts.compressed_secondary_ratio > 1.0) {
+    // Invalid compressed_secondary_ratio
+    return nullptr;
+  }
+  // Sized by TieredCache
+  CompressedSecondaryCacheOptions comp_cache_opts = opts.comp_cache_opts;
+  comp_cache_opts.capacity = 0;
+  comp_cache_opts.secondary_cache = nullptr;
+  auto sec_cache = std::make_shared<TieredSecondaryCache>(
+      NewCompressedSecondaryCache(comp_cache_opts), opts.nvm_sec_cache,
+      opts.nvm_admission_min_frequency,
+      opts.total_capacity / kSketchBytesPerEntry, opts.statistics);
+
+  LRUCacheOptions cache_opts = opts.cache_opts;
+  // The whole budget, for choosing the number of shards
+  cache_opts.capacity = opts.total_capacity;
+  cache_opts.secondary_cache = sec_cache;
+  std::shared_ptr<Cache> primary = NewLRUCache(cache_opts);
+  if (!primary) {
+    return nullptr;
+  }
+  return std::make_shared<TieredCache>(std::move(primary), std::move(sec_cache),
+                                       opts.total_capacity,
+                                       opts.compressed_secondary_ratio);
+}
+
+Status UpdateTieredCache(const std::shared_ptr<Cache>& cache,
+                         int64_t total_capacity,
+                         double compressed_secondary_ratio) {
+  if (!cache || strcmp(cache->Name(), TieredCache::kClassName()) != 0) {
+    return Status::InvalidArgument("Not a tiered cache");
+  }
+  return static_cast<TieredCache*>(cache.get())
+      ->Update(total_capacity, compressed_secondary_ratio);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
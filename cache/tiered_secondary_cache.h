@@ -0,0 +1,153 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cache/frequency_sketch.h"
+#include "port/port.h"
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/persistent_cache.h"
+#include "rocksdb/secondary_cache.h"
+#include "rocksdb/statistics.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A SecondaryCache made of a compressed in-memory tier above an optional
+// NVM (e.g. local flash) tier, used by NewTieredCache().
+//
+// Entries evicted from the primary cache are offered to the compressed tier,
+// which applies its own admission policy, and to the NVM tier if the
+// frequency sketch estimates that they were looked up at least
+// nvm_admission_min_frequency times recently. Every Lookup() from the primary
+// cache counts as an access in the sketch, so that entries that are read only
+// once (e.g. by scans) do not wear the flash.
+//
+// Lookup() tries the compressed tier, then the NVM tier. An NVM tier hit is
+// "promoted" by offering the entry to the compressed tier once its handle is
+// ready, so that the promotion happens in the caller's Wait()/WaitAll() for
+// asynchronous lookups rather than on the lookup path.
+class TieredSecondaryCache : public SecondaryCache {
+ public:
+  // Either tier may be nullptr.
+  TieredSecondaryCache(std::shared_ptr<SecondaryCache> comp_sec_cache,
+                       std::shared_ptr<SecondaryCache> nvm_sec_cache,
+                       uint32_t nvm_admission_min_frequency,
+                       size_t expected_entries,
+                       std::shared_ptr<Statistics> stats);
+  ~TieredSecondaryCache() override = default;
+
+  const char* Name() const override { return "TieredSecondaryCache"; }
+
+  Status Insert(const Slice& key, Cache::ObjectPtr obj,
+                const Cache::CacheItemHelper* helper) override;
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CacheItemHelper* helper,
+      Cache::CreateContext* create_context, bool wait, bool advise_erase,
+      bool& is_in_sec_cache) override;
+
+  bool SupportForceErase() const override {
+    return comp_sec_cache_ && comp_sec_cache_->SupportForceErase();
+  }
+
+  void Erase(const Slice& key) override;
+
+  void WaitAll(std::vector<SecondaryCacheResultHandle*> handles) override;
+
+  // The capacity of the compressed tier. The NVM tier is sized separately.
+  Status SetCapacity(size_t capacity) override;
+
+  Status GetCapacity(size_t& capacity) override;
+
+  std::string GetPrintableOptions() const override;
+
+  void SetCompressionDict(const Slice& key_prefix, const Slice& dict) override {
+    if (comp_sec_cache_) {
+      comp_sec_cache_->SetCompressionDict(key_prefix, dict);
+    }
+  }
+
+ private:
+  class ResultHandle;
+
+  std::shared_ptr<SecondaryCache> comp_sec_cache_;
+  std::shared_ptr<SecondaryCache> nvm_sec_cache_;
+  const uint32_t nvm_admission_min_frequency_;
+  FrequencySketch sketch_;
+  std::shared_ptr<Statistics> stats_;
+};
+
+// The Cache returned by NewTieredCache(): the primary cache, whose capacity
+// and the compressed tier's capacity are kept in proportion to one budget.
+class TieredCache : public CacheWrapper {
+ public:
+  TieredCache(std::shared_ptr<Cache> primary,
+              std::shared_ptr<SecondaryCache> sec_cache, size_t total_capacity,
+              double compressed_secondary_ratio);
+
+  static const char* kClassName() { return "TieredCache"; }
+  const char* Name() const override { return kClassName(); }
+
+  // Sets the total budget of the primary and compressed tiers.
+  void SetCapacity(size_t capacity) override;
+
+  size_t GetCapacity() const override;
+
+  Status Update(int64_t total_capacity, double compressed_secondary_ratio);
+
+  size_t GetPrimaryCapacity() const { return target_->GetCapacity(); }
+
+  SecondaryCache* GetSecondaryCache() const { return sec_cache_.get(); }
+
+  std::string GetPrintableOptions() const override;
+
+ private:
+  // REQUIRES: mutex_ held
+  void ApplyCapacity();
+
+  std::shared_ptr<SecondaryCache> sec_cache_;
+  mutable port::Mutex mutex_;
+  size_t total_capacity_;
+  double compressed_secondary_ratio_;
+};
+
+// A SecondaryCache storing the persistable data of entries in a
+// PersistentCache. See NewPersistentSecondaryCache().
+class PersistentSecondaryCache : public SecondaryCache {
+ public:
+  explicit PersistentSecondaryCache(std::shared_ptr<PersistentCache> cache)
+      : cache_(std::move(cache)) {}
+
+  const char* Name() const override { return "PersistentSecondaryCache"; }
+
+  Status Insert(const Slice& key, Cache::ObjectPtr obj,
+                const Cache::CacheItemHelper* helper) override;
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CacheItemHelper* helper,
+      Cache::CreateContext* create_context, bool wait, bool advise_erase,
+      bool& is_in_sec_cache) override;
+
+  // PersistentCache has no erase
+  bool SupportForceErase() const override { return false; }
+
+  void Erase(const Slice& /*key*/) override {}
+
+  void WaitAll(std::vector<SecondaryCacheResultHandle*> /*handles*/) override {
+  }
+
+  std::string GetPrintableOptions() const override {
+    return cache_->GetPrintableOptions();
+  }
+
+ private:
+  std::shared_ptr<PersistentCache> cache_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
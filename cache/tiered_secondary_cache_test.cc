@@ -0,0 +1,340 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/tiered_secondary_cache.h"
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "cache/frequency_sketch.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/statistics.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/mutexlock.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+TEST(FrequencySketchTest, Basic) {
+  FrequencySketch sketch(1000);
+  ASSERT_GE(sketch.GetNumWords(), 1000U);
+  Random64 rnd(301);
+  const uint64_t hot = rnd.Next();
+  const uint64_t cold = rnd.Next();
+  ASSERT_EQ(sketch.Estimate(hot), 0U);
+  for (uint32_t i = 1; i <= 20; ++i) {
+    sketch.Increment(hot);
+    ASSERT_EQ(sketch.Estimate(hot), std::min(i, FrequencySketch::kMaxCount));
+  }
+  sketch.Increment(cold);
+  // Counters may be shared with other keys, so estimates can only be high
+  ASSERT_GE(sketch.Estimate(cold), 1U);
+
+  sketch.Age();
+  ASSERT_EQ(sketch.Estimate(hot), FrequencySketch::kMaxCount / 2);
+  ASSERT_EQ(sketch.Estimate(cold), 0U);
+}
+
+TEST(FrequencySketchTest, Aging) {
+  FrequencySketch sketch(64);
+  const uint64_t key = 0x1234567890abcdefU;
+  for (int i = 0; i < 4; ++i) {
+    sketch.Increment(key);
+  }
+  ASSERT_EQ(sketch.Estimate(key), 4U);
+  // Accesses to other keys eventually age the counters
+  Random64 rnd(302);
+  for (size_t i = 0; i < sketch.GetNumWords() * 10; ++i) {
+    sketch.Increment(rnd.Next());
+  }
+  ASSERT_LT(sketch.Estimate(key), 4U);
+}
+
+class TieredSecondaryCacheTest : public testing::Test,
+                                 public Cache::CreateContext {
+ public:
+  TieredSecondaryCacheTest() = default;
+
+ protected:
+  // An in-memory PersistentCache, standing in for a flash tier
+  class TestPersistentCache : public PersistentCache {
+   public:
+    Status Insert(const Slice& key, const char* data,
+                  const size_t size) override {
+      MutexLock l(&mutex_);
+      ++num_inserts_;
+      map_[key.ToString()] = std::string(data, size);
+      return Status::OK();
+    }
+
+    Status Lookup(const Slice& key, std::unique_ptr<char[]>* data,
+                  size_t* size) override {
+      MutexLock l(&mutex_);
+      auto it = map_.find(key.ToString());
+      if (it == map_.end()) {
+        return Status::NotFound();
+      }
+      data->reset(new char[it->second.size()]);
+      memcpy(data->get(), it->second.data(), it->second.size());
+      *size = it->second.size();
+      return Status::OK();
+    }
+
+    bool IsCompressed() override { return false; }
+
+    StatsType Stats() override { return StatsType(); }
+
+    std::string GetPrintableOptions() const override { return ""; }
+
+    uint64_t NewId() override { return 0; }
+
+    size_t num_inserts() {
+      MutexLock l(&mutex_);
+      return num_inserts_;
+    }
+
+   private:
+    port::Mutex mutex_;
+    std::map<std::string, std::string> map_;
+    size_t num_inserts_ = 0;
+  };
+
+  class TestItem {
+   public:
+    explicit TestItem(const std::string& data) : data_(data) {}
+    const std::string& data() const { return data_; }
+
+   private:
+    std::string data_;
+  };
+
+  static size_t SizeCallback(Cache::ObjectPtr obj) {
+    return static_cast<TestItem*>(obj)->data().size();
+  }
+
+  static Status SaveToCallback(Cache::ObjectPtr from_obj, size_t from_offset,
+                               size_t length, char* out) {
+    const std::string& data = static_cast<TestItem*>(from_obj)->data();
+    memcpy(out, data.data() + from_offset, length);
+    return Status::OK();
+  }
+
+  static void DeletionCallback(Cache::ObjectPtr obj,
+                               MemoryAllocator* /*alloc*/) {
+    delete static_cast<TestItem*>(obj);
+  }
+
+  static Status CreateCallback(const Slice& data,
+                               Cache::CreateContext* /*context*/,
+                               MemoryAllocator* /*allocator*/,
+                               Cache::ObjectPtr* out_obj, size_t* out_charge) {
+    *out_obj = new TestItem(data.ToString());
+    *out_charge = data.size();
+    return Status::OK();
+  }
+
+  static constexpr Cache::CacheItemHelper kHelper{
+      CacheEntryRole::kDataBlock, &DeletionCallback, &SizeCallback,
+      &SaveToCallback, &CreateCallback};
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(SecondaryCache* cache,
+                                                     const std::string& key,
+                                                     bool* is_in_sec_cache) {
+    bool in_sec_cache = false;
+    auto handle = cache->Lookup(key, &kHelper, this, /*wait=*/true,
+                                /*advise_erase=*/false, in_sec_cache);
+    if (is_in_sec_cache) {
+      *is_in_sec_cache = in_sec_cache;
+    }
+    return handle;
+  }
+
+  // Checks and deletes the value of a handle
+  static void CheckValue(SecondaryCacheResultHandle* handle,
+                         const std::string& expected) {
+    ASSERT_TRUE(handle->IsReady());
+    auto item = static_cast<TestItem*>(handle->Value());
+    ASSERT_NE(item, nullptr);
+    ASSERT_EQ(item->data(), expected);
+    ASSERT_EQ(handle->Size(), expected.size());
+    delete item;
+  }
+};
+
+constexpr Cache::CacheItemHelper TieredSecondaryCacheTest::kHelper;
+
+TEST_F(TieredSecondaryCacheTest, NvmAdmissionAndPromotion) {
+  auto persistent_cache = std::make_shared<TestPersistentCache>();
+  std::shared_ptr<Statistics> stats = CreateDBStatistics();
+  CompressedSecondaryCacheOptions comp_opts;
+  comp_opts.capacity = 1 << 20;
+  comp_opts.compression_type = kNoCompression;
+  TieredSecondaryCache cache(NewCompressedSecondaryCache(comp_opts),
+                             NewPersistentSecondaryCache(persistent_cache),
+                             /*nvm_admission_min_frequency=*/2,
+                             /*expected_entries=*/1024, stats);
+  Random rnd(301);
+  const std::string v1 = rnd.RandomString(1000);
+  const std::string v2 = rnd.RandomString(1000);
+
+  // Never looked up, so not admitted to the NVM tier
+  TestItem item1(v1);
+  ASSERT_OK(cache.Insert("k1", &item1, &kHelper));
+  ASSERT_EQ(persistent_cache->num_inserts(), 0U);
+  ASSERT_EQ(stats->getTickerCount(TIERED_CACHE_NVM_REJECTS), 1U);
+
+  // Looked up (missed) twice, as if read twice from the SST file
+  TestItem item2(v2);
+  ASSERT_EQ(Lookup(&cache, "k2", nullptr), nullptr);
+  ASSERT_EQ(Lookup(&cache, "k2", nullptr), nullptr);
+  ASSERT_OK(cache.Insert("k2", &item2, &kHelper));
+  ASSERT_EQ(persistent_cache->num_inserts(), 1U);
+  ASSERT_EQ(stats->getTickerCount(TIERED_CACHE_NVM_ADMITS), 1U);
+
+  // The compressed tier only keeps a dummy entry on the first insert, so k2
+  // is served by the NVM tier, which promotes it.
+  bool is_in_sec_cache = false;
+  auto handle = Lookup(&cache, "k2", &is_in_sec_cache);
+  ASSERT_NE(handle, nullptr);
+  ASSERT_TRUE(is_in_sec_cache);
+  CheckValue(handle.get(), v2);
+  ASSERT_EQ(stats->getTickerCount(TIERED_CACHE_NVM_HITS), 1U);
+  ASSERT_EQ(stats->getTickerCount(TIERED_CACHE_PROMOTIONS), 1U);
+  ASSERT_EQ(stats->getTickerCount(TIERED_CACHE_COMPRESSED_HITS), 0U);
+
+  // The promotion made k2 resident in the compressed tier
+  handle = Lookup(&cache, "k2", nullptr);
+  ASSERT_NE(handle, nullptr);
+  CheckValue(handle.get(), v2);
+  ASSERT_EQ(stats->getTickerCount(TIERED_CACHE_COMPRESSED_HITS), 1U);
+  ASSERT_EQ(stats->getTickerCount(TIERED_CACHE_NVM_HITS), 1U);
+
+  ASSERT_EQ(Lookup(&cache, "k3", nullptr), nullptr);
+}
+
+TEST_F(TieredSecondaryCacheTest, WaitAll) {
+  auto persistent_cache = std::make_shared<TestPersistentCache>();
+  CompressedSecondaryCacheOptions comp_opts;
+  comp_opts.capacity = 1 << 20;
+  comp_opts.compression_type = kNoCompression;
+  TieredSecondaryCache cache(NewCompressedSecondaryCache(comp_opts),
+                             NewPersistentSecondaryCache(persistent_cache),
+                             /*nvm_admission_min_frequency=*/0,
+                             /*expected_entries=*/1024, nullptr);
+  Random rnd(302);
+  const std::string v1 = rnd.RandomString(1000);
+  const std::string v2 = rnd.RandomString(1000);
+  TestItem item1(v1);
+  TestItem item2(v2);
+  // k1 in both tiers, k2 only in the NVM tier
+  ASSERT_OK(cache.Insert("k1", &item1, &kHelper));
+  ASSERT_OK(cache.Insert("k1", &item1, &kHelper));
+  ASSERT_OK(cache.Insert("k2", &item2, &kHelper));
+
+  bool in_sec_cache = false;
+  auto handle1 = cache.Lookup("k1", &kHelper, this, /*wait=*/false,
+                              /*advise_erase=*/false, in_sec_cache);
+  auto handle2 = cache.Lookup("k2", &kHelper, this, /*wait=*/false,
+                              /*advise_erase=*/false, in_sec_cache);
+  ASSERT_NE(handle1, nullptr);
+  ASSERT_NE(handle2, nullptr);
+  cache.WaitAll({handle1.get(), handle2.get()});
+  CheckValue(handle1.get(), v1);
+  CheckValue(handle2.get(), v2);
+}
+
+TEST_F(TieredSecondaryCacheTest, CapacityBudget) {
+  TieredCacheOptions opts;
+  opts.cache_opts.num_shard_bits = 0;
+  opts.total_capacity = 100 << 20;
+  opts.compressed_secondary_ratio = 0.25;
+  std::shared_ptr<Cache> cache = NewTieredCache(opts);
+  ASSERT_NE(cache, nullptr);
+  ASSERT_STREQ(cache->Name(), "TieredCache");
+
+  auto tiered = static_cast<TieredCache*>(cache.get());
+  ASSERT_EQ(tiered->GetCapacity(), size_t{100 << 20});
+  auto check_tiers = [&](size_t expected_primary, size_t expected_comp) {
+    ASSERT_EQ(tiered->GetPrimaryCapacity(), expected_primary);
+    size_t comp = 0;
+    ASSERT_OK(tiered->GetSecondaryCache()->GetCapacity(comp));
+    ASSERT_EQ(comp, expected_comp);
+  };
+  check_tiers(75 << 20, 25 << 20);
+
+  // Proportional rebalancing on a new budget
+  cache->SetCapacity(200 << 20);
+  ASSERT_EQ(cache->GetCapacity(), size_t{200 << 20});
+  check_tiers(150 << 20, 50 << 20);
+
+  // New ratio
+  ASSERT_OK(UpdateTieredCache(cache, -1, 0.5));
+  check_tiers(100 << 20, 100 << 20);
+  ASSERT_OK(UpdateTieredCache(cache, 40 << 20));
+  check_tiers(20 << 20, 20 << 20);
+
+  ASSERT_TRUE(UpdateTieredCache(cache, -1, 1.5).IsInvalidArgument());
+  ASSERT_TRUE(UpdateTieredCache(NewLRUCache(1 << 20)).IsInvalidArgument());
+
+  opts.compressed_secondary_ratio = 1.5;
+  ASSERT_EQ(NewTieredCache(opts), nullptr);
+}
+
+TEST_F(TieredSecondaryCacheTest, EndToEnd) {
+  auto persistent_cache = std::make_shared<TestPersistentCache>();
+  std::shared_ptr<Statistics> stats = CreateDBStatistics();
+  TieredCacheOptions opts;
+  opts.cache_opts.num_shard_bits = 0;
+  opts.cache_opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  opts.total_capacity = 8 << 10;
+  opts.compressed_secondary_ratio = 0.5;
+  opts.comp_cache_opts.compression_type = kNoCompression;
+  opts.nvm_sec_cache = NewPersistentSecondaryCache(persistent_cache);
+  opts.nvm_admission_min_frequency = 1;
+  opts.statistics = stats;
+  std::shared_ptr<Cache> cache = NewTieredCache(opts);
+  ASSERT_NE(cache, nullptr);
+
+  // The primary tier holds 4KB, so inserting 1KB entries evicts the oldest
+  // ones into the lower tiers.
+  Random rnd(303);
+  std::vector<std::string> values;
+  for (int i = 0; i < 8; ++i) {
+    const std::string key = "k" + std::to_string(i);
+    values.push_back(rnd.RandomString(1000));
+    // Simulates the lookup that misses before a block is read
+    ASSERT_EQ(cache->Lookup(key, &kHelper, this), nullptr);
+    ASSERT_OK(cache->Insert(key, new TestItem(values.back()), &kHelper,
+                            values.back().size()));
+  }
+  ASSERT_GT(persistent_cache->num_inserts(), 0U);
+
+  // k0 was evicted, and is found in the NVM tier
+  Cache::Handle* handle = cache->Lookup("k0", &kHelper, this);
+  ASSERT_NE(handle, nullptr);
+  ASSERT_EQ(static_cast<TestItem*>(cache->Value(handle))->data(), values[0]);
+  cache->Release(handle);
+  ASSERT_EQ(stats->getTickerCount(TIERED_CACHE_NVM_HITS), 1U);
+
+  // Asynchronous lookup
+  handle = cache->Lookup("k1", &kHelper, this, Cache::Priority::LOW,
+                         /*wait=*/false);
+  ASSERT_NE(handle, nullptr);
+  std::vector<Cache::Handle*> handles{handle};
+  cache->WaitAll(handles);
+  ASSERT_NE(cache->Value(handle), nullptr);
+  ASSERT_EQ(static_cast<TestItem*>(cache->Value(handle))->data(), values[1]);
+  cache->Release(handle);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,102 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/block_cache_warmup.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "util/coding.h"
+#include "util/crc32c.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// "BCWU" in little endian, followed by a format version
+constexpr uint32_t kBlockCacheWarmupMagic = 0x55574342;
+constexpr uint32_t kBlockCacheWarmupFormatVersion = 1;
+}  // namespace
+
+void EncodeBlockCacheWarmupList(const BlockCacheWarmupList& list,
+                                std::string* dst) {
+  const size_t start = dst->size();
+  PutFixed32(dst, kBlockCacheWarmupMagic);
+  PutVarint32(dst, kBlockCacheWarmupFormatVersion);
+  PutVarint64(dst, list.size());
+  for (const auto& [file_number, ids] : list) {
+    assert(std::is_sorted(ids.begin(), ids.end()));
+    PutVarint64(dst, file_number);
+    PutVarint64(dst, ids.size());
+    uint64_t prev = 0;
+    for (uint64_t id : ids) {
+      PutVarint64(dst, id - prev);
+      prev = id;
+    }
+  }
+  PutFixed32(dst, crc32c::Mask(crc32c::Value(dst->data() + start,
+                                             dst->size() - start)));
+}
+
+Status DecodeBlockCacheWarmupList(const Slice& src,
+                                  BlockCacheWarmupList* list) {
+  list->clear();
+  if (src.size() < 2 * sizeof(uint32_t)) {
+    return Status::Corruption("Block cache warmup file too short");
+  }
+  Slice input(src.data(), src.size() - sizeof(uint32_t));
+  const uint32_t expected_crc =
+      crc32c::Unmask(DecodeFixed32(src.data() + input.size()));
+  if (crc32c::Value(input.data(), input.size()) != expected_crc) {
+    return Status::Corruption("Block cache warmup file checksum mismatch");
+  }
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint64_t num_files = 0;
+  if (!GetFixed32(&input, &magic) || magic != kBlockCacheWarmupMagic ||
+      !GetVarint32(&input, &version) ||
+      version != kBlockCacheWarmupFormatVersion ||
+      !GetVarint64(&input, &num_files)) {
+    return Status::Corruption("Bad block cache warmup file header");
+  }
+  for (uint64_t i = 0; i < num_files; ++i) {
+    uint64_t file_number = 0;
+    uint64_t num_ids = 0;
+    if (!GetVarint64(&input, &file_number) || !GetVarint64(&input, &num_ids) ||
+        num_ids > input.size()) {
+      return Status::Corruption("Bad block cache warmup file entry");
+    }
+    std::vector<uint64_t>& ids = (*list)[file_number];
+    ids.reserve(static_cast<size_t>(num_ids));
+    uint64_t id = 0;
+    for (uint64_t j = 0; j < num_ids; ++j) {
+      uint64_t delta = 0;
+      if (!GetVarint64(&input, &delta)) {
+        return Status::Corruption("Bad block cache warmup file entry");
+      }
+      id += delta;
+      ids.push_back(id);
+    }
+  }
+  if (!input.empty()) {
+    return Status::Corruption("Trailing data in block cache warmup file");
+  }
+  return Status::OK();
+}
+
+std::string BlockCacheWarmupProgress::ToString() const {
+  char buf[200];
+  snprintf(buf, sizeof(buf),
+           "total_blocks: %" PRIu64 " processed_blocks: %" PRIu64
+           " loaded_blocks: %" PRIu64 " loaded_bytes: %" PRIu64 " done: %d",
+           total_blocks.load(std::memory_order_relaxed),
+           processed_blocks.load(std::memory_order_relaxed),
+           loaded_blocks.load(std::memory_order_relaxed),
+           loaded_bytes.load(std::memory_order_relaxed),
+           done.load(std::memory_order_acquire) ? 1 : 0);
+  return buf;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
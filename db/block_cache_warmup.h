@@ -0,0 +1,56 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Support for DBOptions::block_cache_warmup.
+//
+// The data blocks found in the block cache at a clean shutdown, as a map from
+// SST file number to the sorted ids of the file's cached blocks. A block id
+// is the offset passed to OffsetableCacheKey::WithOffset() for the block
+// (see BlockBasedTable::GetCacheKey()), so that it can be recovered from the
+// cache key alone.
+using BlockCacheWarmupList = std::map<uint64_t, std::vector<uint64_t>>;
+
+// Serializes `list` into a compact form appended to `*dst`: the ids of each
+// file are delta-encoded as varints and the whole is protected by a checksum.
+void EncodeBlockCacheWarmupList(const BlockCacheWarmupList& list,
+                                std::string* dst);
+
+// Parses the output of EncodeBlockCacheWarmupList() into `*list`. Returns
+// Corruption if `src` is malformed or fails the checksum.
+Status DecodeBlockCacheWarmupList(const Slice& src, BlockCacheWarmupList* list);
+
+// Progress of loading the blocks of a BlockCacheWarmupList back into the
+// block cache, reported by the "rocksdb.block-cache-warmup-progress" DB
+// property.
+struct BlockCacheWarmupProgress {
+  // Number of blocks to load, known once the list has been read at DB open.
+  std::atomic<uint64_t> total_blocks{0};
+  // Blocks whose files have been processed so far, including blocks that
+  // could not be loaded, e.g. because their file has gone.
+  std::atomic<uint64_t> processed_blocks{0};
+  // Blocks and bytes actually read into the block cache so far.
+  std::atomic<uint64_t> loaded_blocks{0};
+  std::atomic<uint64_t> loaded_bytes{0};
+  // Set once the warm-up has finished or has been abandoned.
+  std::atomic<bool> done{false};
+
+  std::string ToString() const;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -46,6 +46,7 @@
 #include "port/port.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/flush_block_policy.h"
 #include "rocksdb/options.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
@@ -284,6 +285,37 @@ void CompactionJob::Prepare() {
                                               /*sub_job_id*/ 0);
   }
 
+  // Collect the reads of the input files, both sampled while they were live
+  // and inherited from their own inputs, so that the output files can be laid
+  // out for how their data is read (see FlushBlockPolicyContext). This needs
+  // the table properties of the input files, so it is skipped unless the
+  // flush block policy uses the reads.
+  const auto* table_options =
+      cfd->ioptions()->table_factory->GetOptions<BlockBasedTableOptions>();
+  const bool collect_read_stats =
+      table_options != nullptr &&
+      table_options->flush_block_policy_factory != nullptr &&
+      table_options->flush_block_policy_factory->UsesReadStats();
+  if (collect_read_stats) {
+    for (const auto& each_level : *c->inputs()) {
+      for (const auto& fmd : each_level.files) {
+        const uint64_t num_reads =
+            fmd->stats.num_reads_sampled.load(std::memory_order_relaxed);
+        const uint64_t num_point_reads =
+            fmd->stats.num_point_reads_sampled.load(std::memory_order_relaxed);
+        input_num_point_reads_ += num_point_reads;
+        input_num_iterator_reads_ +=
+            num_reads - std::min(num_reads, num_point_reads);
+        std::shared_ptr<const TableProperties> tp;
+        Status s = c->input_version()->GetTableProperties(&tp, fmd, nullptr);
+        if (s.ok()) {
+          input_num_point_reads_ += tp->num_point_reads / 2;
+          input_num_iterator_reads_ += tp->num_iterator_reads / 2;
+        }
+      }
+    }
+  }
+
   // collect all seqno->time information from the input files which will be used
   // to encode seqno->time to the output files.
   uint64_t preserve_time_duration =
@@ -1877,6 +1909,8 @@ Status CompactionJob::OpenCompactionOutputFile(SubcompactionState* sub_compact,
       bottommost_level_, TableFileCreationReason::kCompaction,
       0 /* oldest_key_time */, current_time, db_id_, db_session_id_,
       sub_compact->compaction->max_output_file_size(), file_number);
+  tboptions.num_point_reads = input_num_point_reads_;
+  tboptions.num_iterator_reads = input_num_iterator_reads_;
 
   outputs.NewBuilder(tboptions);
 
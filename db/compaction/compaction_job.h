@@ -211,6 +211,11 @@ class CompactionJob {
   // Is this compaction creating a file in the bottom most level?
   bool bottommost_level_;
 
+  // Estimated reads of the input files, recorded in the output files'
+  // properties (see TableProperties::num_point_reads)
+  uint64_t input_num_point_reads_ = 0;
+  uint64_t input_num_iterator_reads_ = 0;
+
   Env::WriteLifeTimeHint write_hint_;
 
   IOStatus io_status_;
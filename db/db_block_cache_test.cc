@@ -391,6 +391,41 @@ TEST_F(DBBlockCacheTest, FillCacheAndIterateDB) {
   iter = nullptr;
 }
 
+TEST_F(DBBlockCacheTest, TenantProperties) {
+  auto table_options = GetTableOptions();
+  auto options = GetOptions(table_options);
+  std::shared_ptr<Cache> cache = NewLRUCache(1 << 20, 0);
+  table_options.block_cache = cache;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  // Only for a tenant of the block cache
+  uint64_t value = 0;
+  ASSERT_FALSE(
+      db_->GetIntProperty(DB::Properties::kBlockCacheTenantUsage, &value));
+
+  table_options.block_cache = NewCacheTenant(cache, "db", 1 << 10);
+  ASSERT_NE(table_options.block_cache, nullptr);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_OK(Put("key1", "val1"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("val1", Get("key1"));
+  ASSERT_EQ("val1", Get("key1"));
+
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kBlockCacheTenantUsage, &value));
+  ASSERT_GT(value, 0);
+  ASSERT_LE(value, cache->GetUsage());
+  uint64_t lookups = 0;
+  uint64_t hits = 0;
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kBlockCacheTenantLookups, &lookups));
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kBlockCacheTenantHits, &hits));
+  ASSERT_GT(hits, 0);
+  ASSERT_GT(lookups, hits);
+}
+
 TEST_F(DBBlockCacheTest, IndexAndFilterBlocksStats) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
@@ -610,6 +645,80 @@ TEST_F(DBBlockCacheTest, DynamicallyWarmCacheDuringFlush) {
 }
 #endif
 
+TEST_F(DBBlockCacheTest, WarmCacheAfterReopen) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.block_cache_warmup = true;
+  options.block_cache_warmup_threads = 2;
+
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(1 << 25, 0, false);
+  table_options.cache_index_and_filter_blocks = false;
+  // One block per key
+  table_options.block_size = 1;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  std::string value(kValueSize, 'a');
+  for (size_t i = 1; i <= kNumBlocks; i++) {
+    ASSERT_OK(Put(Key(static_cast<int>(i)), value));
+    if (i % 3 == 0) {
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_OK(Flush());
+  // Only the blocks of the even keys are cached
+  for (size_t i = 2; i <= kNumBlocks; i += 2) {
+    ASSERT_EQ(value, Get(Key(static_cast<int>(i))));
+  }
+  ASSERT_EQ(kNumBlocks / 2,
+            options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD));
+  Close();
+  ASSERT_OK(env_->FileExists(BlockCacheWarmupFileName(dbname_)));
+
+  // Start over with an empty cache
+  table_options.block_cache = NewLRUCache(1 << 25, 0, false);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  Reopen(options);
+  // The list is only good for one restart
+  ASSERT_TRUE(env_->FileExists(BlockCacheWarmupFileName(dbname_)).IsNotFound());
+
+  std::string progress;
+  for (;;) {
+    ASSERT_TRUE(
+        db_->GetProperty(DB::Properties::kBlockCacheWarmupProgress, &progress));
+    if (progress.find("done: 1") != std::string::npos) {
+      break;
+    }
+    env_->SleepForMicroseconds(1000);
+  }
+  ASSERT_TRUE(Slice(progress).starts_with(
+      "total_blocks: 5 processed_blocks: 5 loaded_blocks: 5 loaded_bytes: "));
+  ASSERT_EQ(progress.find("loaded_bytes: 0 "), std::string::npos);
+  ASSERT_EQ(kNumBlocks / 2,
+            options.statistics->getAndResetTickerCount(BLOCK_CACHE_DATA_ADD));
+  // Loading the blocks missed the cache
+  ASSERT_EQ(kNumBlocks / 2,
+            options.statistics->getAndResetTickerCount(BLOCK_CACHE_DATA_MISS));
+
+  for (size_t i = 2; i <= kNumBlocks; i += 2) {
+    ASSERT_EQ(value, Get(Key(static_cast<int>(i))));
+  }
+  ASSERT_EQ(0, options.statistics->getTickerCount(BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(kNumBlocks / 2,
+            options.statistics->getTickerCount(BLOCK_CACHE_DATA_HIT));
+  ASSERT_EQ(value, Get(Key(1)));
+  ASSERT_EQ(1, options.statistics->getTickerCount(BLOCK_CACHE_DATA_MISS));
+
+  // Not reported without the option
+  options.block_cache_warmup = false;
+  Reopen(options);
+  ASSERT_FALSE(
+      db_->GetProperty(DB::Properties::kBlockCacheWarmupProgress, &progress));
+}
+
 namespace {
 
 // A mock cache wraps LRUCache, and record how many entries have been
@@ -3463,6 +3463,131 @@ TEST_F(DBBloomFilterTest, WeirdPrefixExtractorWithFilter3) {
   }
 }
 
+TEST_F(DBBloomFilterTest, RangeFilter) {
+  BlockBasedTableOptions bbto;
+  bbto.range_filter_policy.reset(NewRosettaRangeFilterPolicy(10));
+  Options options = CurrentOptions();
+  options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  // Keys within the 8 bytes used by the filter
+  auto key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "k%06d", i);
+    return std::string(buf);
+  };
+  constexpr int kNumKeys = 1000;
+  constexpr int kGap = 10;
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(key(i * kGap), "val"));
+  }
+  // Deleted keys must not be skipped, as they hide older versions. The
+  // snapshot keeps them through compaction, so that the file bounds do not
+  // rule out the empty range past the last key before the range filter.
+  ASSERT_OK(Put(key(kNumKeys * kGap), "val"));
+  ASSERT_OK(Flush());
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Delete(key(kNumKeys * kGap)));
+  ASSERT_OK(Flush());
+
+  SetPerfLevel(kEnableCount);
+  for (bool compacted : {false, true}) {
+    SCOPED_TRACE("compacted=" + std::to_string(compacted));
+    if (compacted) {
+      ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    }
+    ReadOptions read_options;
+    int num_skipped = 0;
+    for (int i = 0; i < kNumKeys; ++i) {
+      // A range with a key
+      std::string lower = key(i * kGap);
+      std::string upper = key(i * kGap + kGap / 2);
+      Slice ub(upper);
+      read_options.iterate_upper_bound = &ub;
+      std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+      ASSERT_EQ(CountIter(iter, lower), 1);
+
+      // An empty range
+      lower = key(i * kGap + 1);
+      upper = key(i * kGap + kGap - 1);
+      ub = upper;
+      get_perf_context()->Reset();
+      iter.reset(db_->NewIterator(read_options));
+      ASSERT_EQ(CountIter(iter, lower), 0);
+      if (get_perf_context()->range_filter_sst_hit_count == 0) {
+        ASSERT_GT(get_perf_context()->range_filter_sst_miss_count, 0);
+        ASSERT_EQ(get_perf_context()->block_read_count, 0);
+        ASSERT_EQ(get_perf_context()->block_cache_hit_count, 0);
+        ++num_skipped;
+      }
+    }
+    ASSERT_GT(num_skipped, kNumKeys * 9 / 10);
+
+    std::string lower = key(kNumKeys * kGap);
+    std::string upper = key(kNumKeys * kGap + 1);
+    Slice ub(upper);
+    read_options.iterate_upper_bound = &ub;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    ASSERT_EQ(CountIter(iter, lower), 0);
+  }
+  SetPerfLevel(kDisable);
+  db_->ReleaseSnapshot(snapshot);
+}
+
+TEST_F(DBBloomFilterTest, FiltersWithParallelCompression) {
+  // With parallel compression, the keys are added to the full and range
+  // filters by a separate thread, and to partitioned filters by the write
+  // thread.
+  for (bool partition_filters : {false, true}) {
+    SCOPED_TRACE("partition_filters=" + std::to_string(partition_filters));
+    BlockBasedTableOptions bbto;
+    bbto.filter_policy.reset(NewBloomFilterPolicy(10));
+    bbto.range_filter_policy.reset(NewRosettaRangeFilterPolicy(10));
+    bbto.block_size = 256;
+    if (partition_filters) {
+      bbto.partition_filters = true;
+      bbto.index_type = BlockBasedTableOptions::kTwoLevelIndexSearch;
+      bbto.metadata_block_size = 256;
+    }
+    Options options = CurrentOptions();
+    options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+    options.compression_opts.parallel_threads = 4;
+    options.statistics = CreateDBStatistics();
+    DestroyAndReopen(options);
+
+    auto key = [](int i) {
+      char buf[16];
+      snprintf(buf, sizeof(buf), "k%06d", i);
+      return std::string(buf);
+    };
+    constexpr int kNumKeys = 5000;
+    for (int i = 0; i < kNumKeys; ++i) {
+      ASSERT_OK(Put(key(2 * i), "val" + std::to_string(i)));
+    }
+    ASSERT_OK(Flush());
+
+    for (int i = 0; i < kNumKeys; ++i) {
+      ASSERT_EQ(Get(key(2 * i)), "val" + std::to_string(i));
+    }
+    // No false negatives, so all the keys were added to the filter
+    ASSERT_EQ(TestGetTickerCount(options, BLOOM_FILTER_USEFUL), 0U);
+    for (int i = 0; i < kNumKeys; ++i) {
+      ASSERT_EQ(Get(key(2 * i + 1)), "NOT_FOUND");
+    }
+    ASSERT_GT(TestGetTickerCount(options, BLOOM_FILTER_USEFUL),
+              uint64_t{kNumKeys * 9 / 10});
+
+    ReadOptions read_options;
+    for (int i = 0; i < kNumKeys; i += 100) {
+      std::string upper = key(2 * i + 1);
+      Slice ub(upper);
+      read_options.iterate_upper_bound = &ub;
+      std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+      ASSERT_EQ(CountIter(iter, key(2 * i)), 1);
+    }
+  }
+}
 
 }  // namespace ROCKSDB_NAMESPACE
 
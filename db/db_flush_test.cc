@@ -23,6 +23,7 @@
 #include "util/mutexlock.h"
 #include "utilities/fault_injection_env.h"
 #include "utilities/fault_injection_fs.h"
+#include "utilities/merge_operators.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -1333,6 +1334,203 @@ TEST_F(DBFlushTest, MemPurgeDeleteAndDeleteRange) {
   Close();
 }
 
+TEST_F(DBFlushTest, MemPurgeFrozenOutput) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  options.write_buffer_size = 64 << 10;
+  options.experimental_mempurge_threshold = 15.0;
+  options.experimental_mempurge_frozen_output = true;
+  ASSERT_OK(TryReopen(options));
+
+  std::atomic<uint32_t> mempurge_count{0};
+  std::atomic<uint32_t> sst_count{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::FlushJob:MemPurgeSuccessful",
+      [&](void* /*arg*/) { mempurge_count++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::FlushJob:SSTFileCreated", [&](void* /*arg*/) { sst_count++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Keys written once, which stay in the frozen memtables output by mempurge
+  std::map<std::string, std::string> model;
+  Random rnd(301);
+  for (int i = 0; i < 100; i++) {
+    std::string key = "cold" + std::to_string(1000 + i);
+    model[key] = rnd.RandomString(20);
+    ASSERT_OK(Put(key, model[key]));
+  }
+  // Keys overwritten, deleted and merged into, so that the memtables are
+  // mostly garbage
+  for (int round = 0; round < 40; round++) {
+    for (int i = 0; i < 200; i++) {
+      std::string key = "hot" + std::to_string(1000 + i);
+      if (i % 7 == 0) {
+        if (round % 5 == 0) {
+          model[key] = "";
+          ASSERT_OK(Put(key, ""));
+        }
+        model[key] += "," + std::to_string(round);
+        ASSERT_OK(Merge(key, std::to_string(round)));
+      } else if (i % 11 == round % 11) {
+        model.erase(key);
+        ASSERT_OK(Delete(key));
+      } else {
+        model[key] = rnd.RandomString(100);
+        ASSERT_OK(Put(key, model[key]));
+      }
+    }
+  }
+  ASSERT_GE(mempurge_count.load(), 1);
+  ASSERT_EQ(sst_count.load(), 0);
+
+  auto verify = [&]() {
+    for (int i = 0; i < 200; i++) {
+      std::string key = "hot" + std::to_string(1000 + i);
+      auto it = model.find(key);
+      ASSERT_EQ(Get(key), it == model.end() ? "NOT_FOUND" : it->second);
+    }
+    for (int i = 0; i < 100; i++) {
+      std::string key = "cold" + std::to_string(1000 + i);
+      ASSERT_EQ(Get(key), model[key]);
+    }
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    auto expected = model.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected) {
+      ASSERT_TRUE(expected != model.end());
+      ASSERT_EQ(iter->key(), expected->first);
+      ASSERT_EQ(iter->value(), expected->second);
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(expected == model.end());
+    auto rexpected = model.rbegin();
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++rexpected) {
+      ASSERT_TRUE(rexpected != model.rend());
+      ASSERT_EQ(iter->key(), rexpected->first);
+      ASSERT_EQ(iter->value(), rexpected->second);
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(rexpected == model.rend());
+    for (int i = 0; i < 100; i++) {
+      std::string target = i % 2 ? "cold" : "hot";
+      target += std::to_string(1000 + rnd.Uniform(200)) + "a";
+      auto lower = model.lower_bound(target);
+      iter->Seek(target);
+      ASSERT_EQ(iter->Valid(), lower != model.end());
+      if (iter->Valid()) {
+        ASSERT_EQ(iter->key(), lower->first);
+      }
+      iter->SeekForPrev(target);
+      ASSERT_EQ(iter->Valid(), lower != model.begin());
+      if (iter->Valid()) {
+        ASSERT_EQ(iter->key(), std::prev(lower)->first);
+      }
+    }
+  };
+  verify();
+
+  // Keys read from a frozen memtable are not pinned
+  ReadOptions ropt;
+  ropt.pin_data = true;
+  std::string prop;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ropt));
+  iter->Seek("cold1050");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_OK(iter->GetProperty("rocksdb.iterator.is-key-pinned", &prop));
+  ASSERT_EQ(prop, "0");
+  iter.reset();
+
+  // Frozen memtables are flushed like the others. The mempurge output is
+  // counted as an immutable memtable, which stalls writes.
+  FlushOptions flush_opts;
+  flush_opts.allow_write_stall = true;
+  ASSERT_OK(db_->Flush(flush_opts));
+  ASSERT_GE(sst_count.load(), 1);
+  verify();
+  Reopen(options);
+  verify();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
+TEST_F(DBFlushTest, FrozenMemtableSpill) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.compression = kNoCompression;
+  // Memtables are only switched by the write buffer manager
+  options.write_buffer_size = 1 << 20;
+  options.arena_block_size = 4 << 10;
+  options.write_buffer_manager.reset(new WriteBufferManager(256 << 10));
+  options.experimental_frozen_memtable_spill = true;
+  ASSERT_OK(TryReopen(options));
+
+  std::atomic<uint32_t> spill_count{0};
+  std::atomic<uint32_t> sst_count{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::FlushJob:MemPurgeSuccessful",
+      [&](void* /*arg*/) { spill_count++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::FlushJob:SSTFileCreated", [&](void* /*arg*/) { sst_count++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::map<std::string, std::string> model;
+  Random rnd(301);
+  auto write = [&](int rounds) {
+    for (int round = 0; round < rounds; round++) {
+      for (int i = 0; i < 200; i++) {
+        std::string key = "key" + std::to_string(1000 + i);
+        if (i % 11 == round % 11) {
+          model.erase(key);
+          ASSERT_OK(Delete(key));
+        } else {
+          model[key] = rnd.RandomString(100);
+          ASSERT_OK(Put(key, model[key]));
+        }
+      }
+    }
+  };
+  auto verify = [&]() {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    auto expected = model.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected) {
+      ASSERT_TRUE(expected != model.end());
+      ASSERT_EQ(iter->key(), expected->first);
+      ASSERT_EQ(iter->value(), expected->second);
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(expected == model.end());
+    for (int i = 0; i < 200; i++) {
+      std::string key = "key" + std::to_string(1000 + i);
+      auto it = model.find(key);
+      ASSERT_EQ(Get(key), it == model.end() ? "NOT_FOUND" : it->second);
+    }
+  };
+
+  // The memtables are replaced with a frozen memtable instead of flushed
+  write(100);
+  ASSERT_OK(dbfull()->TEST_WaitForBackgroundWork());
+  ASSERT_GE(spill_count.load(), 1);
+  ASSERT_EQ(sst_count.load(), 0);
+  verify();
+
+  // Without the option, the memtables, including the frozen ones, are flushed
+  ASSERT_OK(dbfull()->SetOptions(
+      {{"experimental_frozen_memtable_spill", "false"}}));
+  write(100);
+  ASSERT_OK(dbfull()->TEST_WaitForBackgroundWork());
+  ASSERT_GE(sst_count.load(), 1);
+  verify();
+  Reopen(options);
+  verify();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
 // Create a Compaction Fitler that will be invoked
 // at flush time and will update the value of a KV pair
 // if the key string is "lower" than the filter_key_ string.
@@ -22,9 +22,11 @@
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "cache/cache_key.h"
 #include "db/arena_wrapped_db_iter.h"
 #include "db/builder.h"
 #include "db/compaction/compaction_job.h"
@@ -51,6 +53,7 @@
 #include "db/table_properties_collector.h"
 #include "db/transaction_log_impl.h"
 #include "db/version_set.h"
+#include "db/wide/wide_column_serialization.h"
 #include "db/write_batch_internal.h"
 #include "db/write_callback.h"
 #include "env/unique_id_gen.h"
@@ -86,6 +89,7 @@
 #include "rocksdb/write_buffer_manager.h"
 #include "table/block_based/block.h"
 #include "table/block_based/block_based_table_factory.h"
+#include "table/block_based/block_based_table_reader.h"
 #include "table/get_context.h"
 #include "table/merging_iterator.h"
 #include "table/multiget_context.h"
@@ -567,6 +571,9 @@ Status DBImpl::CloseHelper() {
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
   CancelAllBackgroundWork(false);
 
+  // The block cache warm-up stops early on shutting_down_
+  WaitForBlockCacheWarmup();
+
   // Cancel manual compaction if there's any
   if (HasPendingManualCompaction()) {
     DisableManualCompaction();
@@ -589,6 +596,10 @@ Status DBImpl::CloseHelper() {
     TEST_SYNC_POINT("DBImpl::~DBImpl:WaitJob");
     bg_cv_.Wait();
   }
+  if (block_cache_warmup_enabled_ && opened_successfully_ &&
+      error_handler_.GetBGError().ok()) {
+    SaveBlockCacheWarmupList();
+  }
   TEST_SYNC_POINT_CALLBACK("DBImpl::CloseHelper:PendingPurgeFinished",
                            &files_grabbed_for_purge_);
   EraseThreadStatusDbInfo();
@@ -1928,6 +1939,48 @@ Status DBImpl::Get(const ReadOptions& read_options,
   return s;
 }
 
+namespace {
+// Drops the columns of `*columns` that are not named in `projection` (see
+// ReadOptions::wide_column_projection). Table readers may have applied the
+// projection already, in which case this is a no-op.
+Status ApplyWideColumnProjection(const std::vector<Slice>& projection,
+                                 PinnableWideColumns* columns) {
+  auto is_projected = [&projection](const WideColumn& column) {
+    return std::find(projection.begin(), projection.end(), column.name()) !=
+           projection.end();
+  };
+  const WideColumns& all_columns = columns->columns();
+  if (std::all_of(all_columns.begin(), all_columns.end(), is_projected)) {
+    return Status::OK();
+  }
+  WideColumns projected;
+  std::copy_if(all_columns.begin(), all_columns.end(),
+               std::back_inserter(projected), is_projected);
+  std::string output;
+  Status s = WideColumnSerialization::Serialize(projected, output);
+  if (!s.ok()) {
+    return s;
+  }
+  // `projected` points into the old value, which is no longer needed
+  columns->Reset();
+  return columns->SetWideColumnValue(std::move(output));
+}
+
+void ApplyWideColumnProjection(const ReadOptions& read_options,
+                               size_t num_keys, PinnableWideColumns* results,
+                               Status* statuses) {
+  if (!read_options.wide_column_projection) {
+    return;
+  }
+  for (size_t i = 0; i < num_keys; ++i) {
+    if (statuses[i].ok()) {
+      statuses[i] = ApplyWideColumnProjection(
+          *read_options.wide_column_projection, &results[i]);
+    }
+  }
+}
+}  // namespace
+
 Status DBImpl::GetEntity(const ReadOptions& read_options,
                          ColumnFamilyHandle* column_family, const Slice& key,
                          PinnableWideColumns* columns) {
@@ -1947,7 +2000,12 @@ Status DBImpl::GetEntity(const ReadOptions& read_options,
   get_impl_options.column_family = column_family;
   get_impl_options.columns = columns;
 
-  return GetImpl(read_options, key, get_impl_options);
+  Status s = GetImpl(read_options, key, get_impl_options);
+  if (s.ok() && read_options.wide_column_projection) {
+    s = ApplyWideColumnProjection(*read_options.wide_column_projection,
+                                  columns);
+  }
+  return s;
 }
 
 bool DBImpl::ShouldReferenceSuperVersion(const MergeContext& merge_context) {
@@ -3053,6 +3111,7 @@ void DBImpl::MultiGetEntity(const ReadOptions& options, size_t num_keys,
                             Status* statuses, bool sorted_input) {
   MultiGetCommon(options, num_keys, column_families, keys, /* values */ nullptr,
                  results, /* timestamps */ nullptr, statuses, sorted_input);
+  ApplyWideColumnProjection(options, num_keys, results, statuses);
 }
 
 void DBImpl::MultiGetEntity(const ReadOptions& options,
@@ -3061,6 +3120,7 @@ void DBImpl::MultiGetEntity(const ReadOptions& options,
                             Status* statuses, bool sorted_input) {
   MultiGetCommon(options, column_family, num_keys, keys, /* values */ nullptr,
                  results, /* timestamps */ nullptr, statuses, sorted_input);
+  ApplyWideColumnProjection(options, num_keys, results, statuses);
 }
 
 Status DBImpl::CreateColumnFamily(const ColumnFamilyOptions& cf_options,
@@ -4004,6 +4064,238 @@ bool DBImpl::GetPropertyHandleOptionsStatistics(std::string* value) {
   return true;
 }
 
+bool DBImpl::GetPropertyHandleBlockCacheWarmupProgress(std::string* value) {
+  assert(value != nullptr);
+  if (!block_cache_warmup_enabled_) {
+    return false;
+  }
+  *value = block_cache_warmup_progress_.ToString();
+  return true;
+}
+
+void DBImpl::StartBlockCacheWarmup() {
+  assert(block_cache_warmup_enabled_);
+  assert(!block_cache_warmup_thread_);
+  const std::string fname = BlockCacheWarmupFileName(dbname_);
+  std::string data;
+  Status s = ReadFileToString(fs_.get(), fname, &data);
+  if (s.ok()) {
+    // Not to be used again after an unclean shutdown, when the cache
+    // contents it describes may be long gone
+    Status del = fs_->DeleteFile(fname, IOOptions(), nullptr);
+    if (!del.ok()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Failed to delete block cache warmup file %s: %s",
+                     fname.c_str(), del.ToString().c_str());
+    }
+  }
+  BlockCacheWarmupList list;
+  if (s.ok()) {
+    s = DecodeBlockCacheWarmupList(data, &list);
+  }
+  if (!s.ok()) {
+    if (!s.IsNotFound()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Skipping block cache warmup: %s", s.ToString().c_str());
+    }
+    block_cache_warmup_progress_.done.store(true, std::memory_order_release);
+    return;
+  }
+
+  struct WarmupFile {
+    ColumnFamilyData* cfd;
+    const FileMetaData* file;
+    std::vector<uint64_t> block_ids;
+  };
+  std::vector<WarmupFile> files;
+  // Keep the files alive while they are read
+  std::vector<SuperVersion*> super_versions;
+  uint64_t total_blocks = 0;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || !cfd->initialized()) {
+        continue;
+      }
+      SuperVersion* sv = cfd->GetSuperVersion();
+      bool sv_refed = false;
+      const VersionStorageInfo* vstorage = sv->current->storage_info();
+      for (int level = 0; level < vstorage->num_levels(); ++level) {
+        for (const FileMetaData* f : vstorage->LevelFiles(level)) {
+          auto it = list.find(f->fd.GetNumber());
+          if (it == list.end()) {
+            continue;
+          }
+          if (!sv_refed) {
+            super_versions.push_back(sv->Ref());
+            sv_refed = true;
+          }
+          total_blocks += it->second.size();
+          files.push_back({cfd, f, std::move(it->second)});
+        }
+      }
+    }
+  }
+  block_cache_warmup_progress_.total_blocks.store(total_blocks,
+                                                  std::memory_order_relaxed);
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "Starting block cache warmup of %" PRIu64
+                 " blocks in %" ROCKSDB_PRIszt " files",
+                 total_blocks, files.size());
+
+  block_cache_warmup_thread_.reset(new port::Thread(
+      [this, files = std::move(files),
+       super_versions = std::move(super_versions)]() {
+        std::atomic<size_t> next_file{0};
+        auto work = [&]() {
+          ReadOptions ro;
+          // Charged to the rate limiter, if any, at low priority
+          ro.rate_limiter_priority = Env::IO_LOW;
+          for (size_t i = next_file.fetch_add(1); i < files.size();
+               i = next_file.fetch_add(1)) {
+            if (shutting_down_.load(std::memory_order_acquire)) {
+              break;
+            }
+            const WarmupFile& wf = files[i];
+            uint64_t num_blocks = 0;
+            uint64_t num_bytes = 0;
+            Status ws = wf.cfd->table_cache()->WarmUpBlockCache(
+                ro, wf.cfd->internal_comparator(), *wf.file, wf.block_ids,
+                &num_blocks, &num_bytes);
+            if (!ws.ok() && !ws.IsNotSupported()) {
+              ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                             "Block cache warmup of file %" PRIu64
+                             " failed: %s",
+                             wf.file->fd.GetNumber(), ws.ToString().c_str());
+            }
+            auto& progress = block_cache_warmup_progress_;
+            progress.loaded_blocks.fetch_add(num_blocks,
+                                             std::memory_order_relaxed);
+            progress.loaded_bytes.fetch_add(num_bytes,
+                                            std::memory_order_relaxed);
+            progress.processed_blocks.fetch_add(wf.block_ids.size(),
+                                                std::memory_order_relaxed);
+          }
+        };
+        std::vector<port::Thread> workers;
+        for (int i = 1; i < immutable_db_options_.block_cache_warmup_threads;
+             ++i) {
+          workers.emplace_back(work);
+        }
+        work();
+        for (auto& t : workers) {
+          t.join();
+        }
+        for (SuperVersion* sv : super_versions) {
+          CleanupSuperVersion(sv);
+        }
+        ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                       "Block cache warmup finished: %s",
+                       block_cache_warmup_progress_.ToString().c_str());
+        block_cache_warmup_progress_.done.store(true,
+                                                std::memory_order_release);
+      }));
+}
+
+void DBImpl::WaitForBlockCacheWarmup() {
+  if (block_cache_warmup_thread_) {
+    block_cache_warmup_thread_->join();
+    block_cache_warmup_thread_.reset();
+  }
+}
+
+void DBImpl::SaveBlockCacheWarmupList() {
+  mutex_.AssertHeld();
+  struct FileCacheKey {
+    uint64_t file_number;
+    OffsetableCacheKey base_cache_key;
+  };
+  // Keyed by OffsetableCacheKey::CommonPrefixSlice()
+  std::unordered_map<std::string, FileCacheKey> files_by_prefix;
+  std::unordered_set<Cache*> caches;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped() || !cfd->initialized()) {
+      continue;
+    }
+    auto* table_factory = cfd->ioptions()->table_factory.get();
+    assert(table_factory != nullptr);
+    Cache* cache =
+        table_factory->GetOptions<Cache>(TableFactory::kBlockCacheOpts());
+    if (cache == nullptr) {
+      continue;
+    }
+    caches.insert(cache);
+    const VersionStorageInfo* vstorage = cfd->current()->storage_info();
+    for (int level = 0; level < vstorage->num_levels(); ++level) {
+      for (const FileMetaData* f : vstorage->LevelFiles(level)) {
+        // Only files with an open table reader can have blocks in the cache
+        std::shared_ptr<const TableProperties> props;
+        Status s = cfd->table_cache()->GetTableProperties(
+            file_options_, cfd->internal_comparator(), *f, &props,
+            /*prefix_extractor=*/nullptr, /*no_io=*/true);
+        if (!s.ok() || props == nullptr) {
+          continue;
+        }
+        const uint64_t file_number = f->fd.GetNumber();
+        OffsetableCacheKey base_cache_key;
+        BlockBasedTable::SetupBaseCacheKey(props.get(), db_session_id_,
+                                           file_number, &base_cache_key);
+        files_by_prefix.emplace(
+            base_cache_key.CommonPrefixSlice().ToString(),
+            FileCacheKey{file_number, base_cache_key});
+      }
+    }
+  }
+  if (files_by_prefix.empty()) {
+    return;
+  }
+
+  // Other threads can no longer change the live files at this point of the
+  // shutdown, but might still be using the mutex
+  InstrumentedMutexUnlock u(&mutex_);
+  BlockCacheWarmupList list;
+  uint64_t num_blocks = 0;
+  for (Cache* cache : caches) {
+    cache->ApplyToAllEntries(
+        [&](const Slice& key, Cache::ObjectPtr /*value*/, size_t /*charge*/,
+            const Cache::CacheItemHelper* helper) {
+          if (helper == nullptr || helper->role != CacheEntryRole::kDataBlock ||
+              key.size() != kCacheKeySize) {
+            return;
+          }
+          auto it = files_by_prefix.find(std::string(
+              key.data(), OffsetableCacheKey::kCommonPrefixSize));
+          if (it == files_by_prefix.end()) {
+            return;
+          }
+          list[it->second.file_number].push_back(
+              it->second.base_cache_key.GetOffset(key));
+          ++num_blocks;
+        },
+        {});
+  }
+  for (auto& [file_number, block_ids] : list) {
+    std::sort(block_ids.begin(), block_ids.end());
+    block_ids.erase(std::unique(block_ids.begin(), block_ids.end()),
+                    block_ids.end());
+  }
+
+  std::string data;
+  EncodeBlockCacheWarmupList(list, &data);
+  const std::string fname = BlockCacheWarmupFileName(dbname_);
+  Status s = WriteStringToFile(fs_.get(), data, fname, /*should_sync=*/true);
+  if (s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Saved %" PRIu64 " blocks of %" ROCKSDB_PRIszt
+                   " files for block cache warmup",
+                   num_blocks, list.size());
+  } else {
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Failed to save block cache warmup file %s: %s",
+                   fname.c_str(), s.ToString().c_str());
+  }
+}
+
 Status DBImpl::ResetStats() {
   InstrumentedMutexLock l(&mutex_);
   for (auto* cfd : *versions_->GetColumnFamilySet()) {
@@ -4715,6 +5007,11 @@ Status DestroyDB(const std::string& dbname, const Options& options,
         if (!del.ok() && result.ok()) {
           result = del;
         }
+      } else if (fname == kBlockCacheWarmupFileName) {
+        Status del = env->DeleteFile(BlockCacheWarmupFileName(dbname));
+        if (!del.ok() && result.ok()) {
+          result = del;
+        }
       }
     }
 
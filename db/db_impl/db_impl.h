@@ -20,6 +20,7 @@
 #include <utility>
 #include <vector>
 
+#include "db/block_cache_warmup.h"
 #include "db/column_family.h"
 #include "db/compaction/compaction_iterator.h"
 #include "db/compaction/compaction_job.h"
@@ -2000,6 +2001,13 @@ class DBImpl : public DB {
                       SequenceNumber sequence,
                       LogFileNumberSize& log_file_number_size);
 
+  // Used by PipelinedWriteImpl with enable_pipelined_wal_sync to sync the WAL
+  // records of sequence numbers up to seq, unless a sync started after they
+  // were appended has already succeeded. Once a sync failed, returns its
+  // error without syncing, as the records appended before it might have
+  // been lost even if a later sync succeeds.
+  Status SyncPipelinedWAL(SequenceNumber seq);
+
   IOStatus ConcurrentWriteToWAL(const WriteThread::WriteGroup& write_group,
                                 uint64_t* log_used,
                                 SequenceNumber* last_sequence, size_t seq_inc);
@@ -2155,6 +2163,22 @@ class DBImpl : public DB {
                               const DBPropertyInfo& property_info,
                               bool is_locked, uint64_t* value);
   bool GetPropertyHandleOptionsStatistics(std::string* value);
+  bool GetPropertyHandleBlockCacheWarmupProgress(std::string* value);
+
+  // For DBOptions::block_cache_warmup: reads (and deletes) the list saved by
+  // SaveBlockCacheWarmupList() at the last clean shutdown and starts loading
+  // its blocks into the block cache in the background.
+  void StartBlockCacheWarmup();
+
+  // Waits for the warm-up started by StartBlockCacheWarmup(), which stops
+  // early once shutting_down_ is set.
+  // REQUIRES: mutex_ not held
+  void WaitForBlockCacheWarmup();
+
+  // Records the data blocks of the live SST files found in the block cache,
+  // for StartBlockCacheWarmup() in the next DB::Open().
+  // REQUIRES: mutex_ held; releases it while scanning the block cache
+  void SaveBlockCacheWarmupList();
 
   bool HasPendingManualCompaction();
   bool HasExclusiveManualCompaction();
@@ -2578,6 +2602,15 @@ class DBImpl : public DB {
   // Number of threads intending to write to memtable
   std::atomic<size_t> pending_memtable_writes_ = {};
 
+  // With enable_pipelined_wal_sync, the last sequence number appended to the
+  // WAL by a WAL write group, and the last one known to be synced. The latter
+  // and the status of the first failed sync are guarded by
+  // pipelined_wal_sync_mutex_, which serializes the syncs.
+  std::atomic<SequenceNumber> pipelined_wal_appended_seq_ = {};
+  SequenceNumber pipelined_wal_synced_seq_ = 0;
+  Status pipelined_wal_sync_error_;
+  InstrumentedMutex pipelined_wal_sync_mutex_;
+
   // A flag indicating whether the current rocksdb database has any
   // data that is not yet persisted into either WAL or SST file.
   // Used when disableWAL is true.
@@ -2610,6 +2643,16 @@ class DBImpl : public DB {
   // Indicate DB was opened successfully
   bool opened_successfully_;
 
+  // Whether DBOptions::block_cache_warmup applies to this instance. Only set
+  // by DB::Open(), so read-only and secondary instances neither load nor save
+  // the block cache warm-up list.
+  bool block_cache_warmup_enabled_ = false;
+
+  // Runs the warm-up started by StartBlockCacheWarmup(), if any
+  std::unique_ptr<port::Thread> block_cache_warmup_thread_;
+
+  BlockCacheWarmupProgress block_cache_warmup_progress_;
+
   // The min threshold to triggere bottommost compaction for removing
   // garbages, among all column families.
   SequenceNumber bottommost_files_mark_threshold_ = kMaxSequenceNumber;
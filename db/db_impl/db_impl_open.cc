@@ -2081,6 +2081,10 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
   if (s.ok()) {
     s = impl->RegisterRecordSeqnoTimeWorker();
   }
+  if (s.ok() && impl->immutable_db_options_.block_cache_warmup) {
+    impl->block_cache_warmup_enabled_ = true;
+    impl->StartBlockCacheWarmup();
+  }
   if (!s.ok()) {
     for (auto* h : *handles) {
       delete h;
@@ -323,7 +323,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
           &trim_history_scheduler_,
           write_options.ignore_missing_column_families, 0 /*log_number*/, this,
           true /*concurrent_memtable_writes*/, seq_per_batch_, w.batch_cnt,
-          batch_per_txn_, write_options.memtable_insert_hint_per_batch);
+          batch_per_txn_, write_options.memtable_insert_hint_per_batch,
+          immutable_db_options_.sorted_memtable_insert);
 
       PERF_TIMER_START(write_pre_and_post_process_time);
     }
@@ -552,7 +553,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
             &flush_scheduler_, &trim_history_scheduler_,
             write_options.ignore_missing_column_families,
             0 /*recovery_log_number*/, this, parallel, seq_per_batch_,
-            batch_per_txn_);
+            batch_per_txn_, immutable_db_options_.sorted_memtable_insert);
       } else {
         write_group.last_sequence = last_sequence;
         write_thread_.LaunchParallelMemTableWriters(&write_group);
@@ -570,7 +571,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
               write_options.ignore_missing_column_families, 0 /*log_number*/,
               this, true /*concurrent_memtable_writes*/, seq_per_batch_,
               w.batch_cnt, batch_per_txn_,
-              write_options.memtable_insert_hint_per_batch);
+              write_options.memtable_insert_hint_per_batch,
+              immutable_db_options_.sorted_memtable_insert);
         }
       }
       if (seq_used != nullptr) {
@@ -664,6 +666,11 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
   WriteThread::Writer w(write_options, my_batch, callback, log_ref,
                         disable_memtable, /*_batch_cnt=*/0,
                         /*_pre_release_callback=*/nullptr);
+  // With enable_pipelined_wal_sync, the WAL of sync writes is synced by the
+  // memtable writers, so that the next WAL write group can append meanwhile.
+  const bool pipelined_wal_sync =
+      immutable_db_options_.enable_pipelined_wal_sync && !manual_wal_flush_ &&
+      !immutable_db_options_.allow_mmap_writes;
   write_thread_.JoinBatchGroup(&w);
   TEST_SYNC_POINT("DBImplWrite::PipelinedWriteImpl:AfterJoinBatchGroup");
   if (w.state == WriteThread::STATE_GROUP_LEADER) {
@@ -671,7 +678,8 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     if (w.callback && !w.callback->AllowWriteBatching()) {
       write_thread_.WaitForMemTableWriters();
     }
-    LogContext log_context(!write_options.disableWAL && write_options.sync);
+    LogContext log_context(!write_options.disableWAL && write_options.sync &&
+                           !pipelined_wal_sync);
     // PreprocessWrite does its own perf timing.
     PERF_TIMER_STOP(write_pre_and_post_process_time);
     w.status = PreprocessWrite(write_options, &log_context, &write_context);
@@ -746,6 +754,19 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
                      log_context.need_log_sync, log_context.need_log_dir_sync,
                      current_sequence, log_file_number_size);
       w.status = io_s;
+      if (io_s.ok() && pipelined_wal_sync) {
+        const SequenceNumber last_sequence = current_sequence + total_count - 1;
+        pipelined_wal_appended_seq_.store(last_sequence,
+                                          std::memory_order_release);
+        // Writers that skip the memtable complete on leaving the WAL stage
+        for (auto* writer : wal_write_group) {
+          if (writer->sync && writer->disable_memtable &&
+              !writer->CallbackFailed()) {
+            w.status = SyncPipelinedWAL(last_sequence);
+            break;
+          }
+        }
+      }
     }
 
     if (!io_s.ok()) {
@@ -782,15 +803,29 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     PERF_TIMER_GUARD(write_memtable_time);
     assert(w.ShouldWriteToMemtable());
     write_thread_.EnterAsMemTableWriter(&w, &memtable_write_group);
-    if (memtable_write_group.size > 1 &&
-        immutable_db_options_.allow_concurrent_memtable_write) {
+    if (pipelined_wal_sync) {
+      for (auto* writer : memtable_write_group) {
+        if (writer->sync) {
+          memtable_write_group.status =
+              SyncPipelinedWAL(memtable_write_group.last_sequence);
+          // Like a failed sync in the WAL stage, stops further writes
+          WriteStatusCheck(memtable_write_group.status);
+          break;
+        }
+      }
+    }
+    if (!memtable_write_group.status.ok()) {
+      write_thread_.ExitAsMemTableWriter(&w, memtable_write_group);
+    } else if (memtable_write_group.size > 1 &&
+               immutable_db_options_.allow_concurrent_memtable_write) {
       write_thread_.LaunchParallelMemTableWriters(&memtable_write_group);
     } else {
       memtable_write_group.status = WriteBatchInternal::InsertInto(
           memtable_write_group, w.sequence, column_family_memtables_.get(),
           &flush_scheduler_, &trim_history_scheduler_,
           write_options.ignore_missing_column_families, 0 /*log_number*/, this,
-          false /*concurrent_memtable_writes*/, seq_per_batch_, batch_per_txn_);
+          false /*concurrent_memtable_writes*/, seq_per_batch_, batch_per_txn_,
+          immutable_db_options_.sorted_memtable_insert);
       versions_->SetLastSequence(memtable_write_group.last_sequence);
       write_thread_.ExitAsMemTableWriter(&w, memtable_write_group);
     }
@@ -809,7 +844,8 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
         &trim_history_scheduler_, write_options.ignore_missing_column_families,
         0 /*log_number*/, this, true /*concurrent_memtable_writes*/,
         false /*seq_per_batch*/, 0 /*batch_cnt*/, true /*batch_per_txn*/,
-        write_options.memtable_insert_hint_per_batch);
+        write_options.memtable_insert_hint_per_batch,
+        immutable_db_options_.sorted_memtable_insert);
     if (write_thread_.CompleteParallelMemTableWriter(&w)) {
       MemTableInsertStatusCheck(w.status);
       versions_->SetLastSequence(w.write_group->last_sequence);
@@ -1431,6 +1467,29 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
   return io_s;
 }
 
+Status DBImpl::SyncPipelinedWAL(SequenceNumber seq) {
+  InstrumentedMutexLock l(&pipelined_wal_sync_mutex_);
+  if (!pipelined_wal_sync_error_.ok()) {
+    return pipelined_wal_sync_error_;
+  }
+  if (pipelined_wal_synced_seq_ >= seq) {
+    return Status::OK();
+  }
+  // Every record up to this one has been flushed to the WAL file
+  const SequenceNumber appended_seq =
+      pipelined_wal_appended_seq_.load(std::memory_order_acquire);
+  assert(appended_seq >= seq);
+  TEST_SYNC_POINT("DBImpl::SyncPipelinedWAL:BeforeSync");
+  Status s = SyncWAL();
+  if (s.ok()) {
+    pipelined_wal_synced_seq_ = appended_seq;
+  } else {
+    pipelined_wal_sync_error_ = s;
+    pipelined_wal_sync_error_.PermitUncheckedError();
+  }
+  return s;
+}
+
 IOStatus DBImpl::ConcurrentWriteToWAL(
     const WriteThread::WriteGroup& write_group, uint64_t* log_used,
     SequenceNumber* last_sequence, size_t seq_inc) {
@@ -1689,7 +1748,15 @@ Status DBImpl::HandleWriteBufferManagerFlush(WriteContext* write_context) {
       if (cfd->IsDropped()) {
         continue;
       }
-      if (!cfd->mem()->IsEmpty() && !cfd->imm()->IsFlushPendingOrRunning()) {
+      // The frozen memtables kept in memory by a spill (see
+      // experimental_frozen_memtable_spill) are pending flush, but no flush
+      // is scheduled for them: the next spill converts them again together
+      // with the mutable memtable.
+      const bool flush_pending_or_running =
+          cfd->GetLatestMutableCFOptions()->experimental_frozen_memtable_spill
+              ? cfd->queued_for_flush() || cfd->imm()->IsFlushRunning()
+              : cfd->imm()->IsFlushPendingOrRunning();
+      if (!cfd->mem()->IsEmpty() && !flush_pending_or_running) {
         // We only consider flush on CFs with bytes in the mutable memtable,
         // and no immutable memtables for which flush has yet to finish. If
         // we triggered flush on CFs already trying to flush, we would risk
@@ -9,6 +9,7 @@
 #include "db/db_test_util.h"
 #include "db/memtable.h"
 #include "db/range_del_aggregator.h"
+#include "memory/concurrent_arena.h"
 #include "port/stack_trace.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/slice_transform.h"
@@ -316,6 +317,215 @@ TEST_F(DBMemTableTest, InsertWithHint) {
   ASSERT_EQ("vvv", Get("NotInPrefixDomain"));
 }
 
+TEST_F(DBMemTableTest, BTreeRep) {
+  constexpr int kNumKeys = 20000;
+  constexpr int kNumThreads = 4;
+
+  InternalKeyComparator icmp(BytewiseComparator());
+  MemTable::KeyComparator key_cmp(icmp);
+  ConcurrentArena arena;
+  BTreeRepFactory factory;
+  std::unique_ptr<MemTableRep> rep(
+      factory.CreateMemTableRep(key_cmp, &arena, nullptr, nullptr));
+
+  // Entries of even keys only, so that seeks can target missing ones
+  auto user_key = [](int k) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%08d", k);
+    return std::string(buf);
+  };
+  auto new_entry = [&](int k) {
+    std::string ikey;
+    AppendInternalKey(&ikey, ParsedInternalKey(user_key(k), 1, kTypeValue));
+    char* buf;
+    KeyHandle handle = rep->Allocate(
+        VarintLength(ikey.size()) + ikey.size(), &buf);
+    char* p = EncodeVarint32(buf, static_cast<uint32_t>(ikey.size()));
+    memcpy(p, ikey.data(), ikey.size());
+    return handle;
+  };
+  auto entry_user_key = [](const char* entry) {
+    return ExtractUserKey(GetLengthPrefixedSlice(entry)).ToString();
+  };
+  std::string tmp;
+  // Sorts before (or with for_prev, after) the entries of the key
+  auto seek_key = [&](int k, bool for_prev = false) {
+    tmp.clear();
+    AppendInternalKey(&tmp, for_prev ? ParsedInternalKey(user_key(k), 0,
+                                                         kTypeDeletion)
+                                     : ParsedInternalKey(user_key(k),
+                                                         kMaxSequenceNumber,
+                                                         kValueTypeForSeek));
+    return Slice(tmp);
+  };
+
+  // Concurrent inserts in random order, with a concurrent reader checking
+  // that the entries are always sorted
+  std::atomic<bool> done{false};
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<int> keys;
+      for (int k = t; k < kNumKeys; k += kNumThreads) {
+        keys.push_back(2 * k);
+      }
+      RandomShuffle(keys.begin(), keys.end(), t);
+      for (int k : keys) {
+        ASSERT_TRUE(rep->InsertKeyConcurrently(new_entry(k)));
+      }
+    });
+  }
+  port::Thread reader([&]() {
+    std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+    while (!done.load()) {
+      std::string prev;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        std::string cur = entry_user_key(iter->key());
+        ASSERT_LT(prev, cur);
+        prev = cur;
+      }
+    }
+  });
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  done.store(true);
+  reader.join();
+
+  std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+  int k = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), k++) {
+    ASSERT_EQ(user_key(2 * k), entry_user_key(iter->key()));
+  }
+  ASSERT_EQ(kNumKeys, k);
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    k--;
+    ASSERT_EQ(user_key(2 * k), entry_user_key(iter->key()));
+  }
+  ASSERT_EQ(0, k);
+
+  for (int i = 0; i < 2 * kNumKeys; i += 7) {
+    iter->Seek(seek_key(i), nullptr);
+    if (i + 1 < 2 * kNumKeys) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(user_key(i + (i % 2)), entry_user_key(iter->key()));
+    } else {
+      ASSERT_FALSE(iter->Valid());
+    }
+    iter->SeekForPrev(seek_key(i, true /* for_prev */), nullptr);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(user_key(i - (i % 2)), entry_user_key(iter->key()));
+  }
+  std::string encoded;
+  iter->SeekForPrev(Slice(), EncodeKey(&encoded, seek_key(-1)));
+  ASSERT_FALSE(iter->Valid());
+
+  // Duplicates are detected
+  ASSERT_FALSE(rep->InsertKey(new_entry(42)));
+  ASSERT_TRUE(rep->InsertKey(new_entry(43)));
+  ASSERT_TRUE(rep->Contains(static_cast<const char*>(new_entry(43))));
+  ASSERT_FALSE(rep->Contains(static_cast<const char*>(new_entry(45))));
+}
+
+TEST_F(DBMemTableTest, BTreeRepConcurrentWrites) {
+  constexpr int kNumKeys = 2000;
+  constexpr int kNumThreads = 4;
+
+  Options options = CurrentOptions();
+  options.memtable_factory.reset(new BTreeRepFactory());
+  options.allow_concurrent_memtable_write = true;
+  DestroyAndReopen(options);
+
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int k = t; k < kNumKeys; k += kNumThreads) {
+        ASSERT_OK(Put(Key(k), "v" + std::to_string(k)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_OK(Put(Key(0), "v0.1"));
+
+  for (bool flushed : {false, true}) {
+    ASSERT_EQ("v0.1", Get(Key(0)));
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    int k = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), k++) {
+      ASSERT_EQ(Key(k), iter->key());
+      if (k > 0) {
+        ASSERT_EQ("v" + std::to_string(k), iter->value());
+      }
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumKeys, k);
+    if (!flushed) {
+      ASSERT_OK(Flush());
+    }
+  }
+}
+
+TEST_F(DBMemTableTest, PointLookupIndex) {
+  Options options = CurrentOptions();
+  options.memtable_point_lookup_index = true;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("a", "a1"));
+  ASSERT_OK(Put("b", "b1"));
+  ASSERT_OK(Merge("c", "c1"));
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Put("a", "a2"));
+  ASSERT_OK(Delete("b"));
+  ASSERT_OK(Merge("c", "c2"));
+  ASSERT_OK(Put("d", "d1"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "d",
+                             "e"));
+
+  SetPerfLevel(kEnableCount);
+  get_perf_context()->Reset();
+  ASSERT_EQ("a2", Get("a"));
+  ASSERT_EQ("NOT_FOUND", Get("b"));
+  ASSERT_EQ("NOT_FOUND", Get("d"));
+  ASSERT_EQ("NOT_FOUND", Get("x"));
+  // Answered by the index, including the key not in the memtable
+  ASSERT_EQ(4, get_perf_context()->memtable_point_lookup_index_count);
+
+  // Merge operands and older versions are read from the memtable
+  get_perf_context()->Reset();
+  ASSERT_EQ("c1,c2", Get("c"));
+  ASSERT_EQ("a1", Get("a", snapshot));
+  ASSERT_EQ("b1", Get("b", snapshot));
+  ASSERT_EQ(0, get_perf_context()->memtable_point_lookup_index_count);
+
+  std::vector<std::string> values =
+      MultiGet({"a", "b", "c", "d", "x"}, nullptr /* snapshot */);
+  ASSERT_EQ(values, std::vector<std::string>(
+                        {"a2", "NOT_FOUND", "c1,c2", "NOT_FOUND", "NOT_FOUND"}));
+  SetPerfLevel(kDisable);
+  db_->ReleaseSnapshot(snapshot);
+
+  // Not used with user-defined timestamps
+  options.comparator = test::BytewiseComparatorWithU64TsWrapper();
+  DestroyAndReopen(options);
+  std::string ts;
+  PutFixed64(&ts, 1);
+  ASSERT_OK(db_->Put(WriteOptions(), "a", ts, "a1"));
+  ts.clear();
+  PutFixed64(&ts, 2);
+  ASSERT_OK(db_->Put(WriteOptions(), "a", ts, "a2"));
+  std::string read_ts;
+  PutFixed64(&read_ts, 1);
+  Slice read_ts_slice = read_ts;
+  ReadOptions ropts;
+  ropts.timestamp = &read_ts_slice;
+  std::string value;
+  ASSERT_OK(db_->Get(ropts, "a", &value));
+  ASSERT_EQ("a1", value);
+}
+
 TEST_F(DBMemTableTest, ColumnFamilyId) {
   // Verifies MemTableRepFactory is told the right column family id.
   Options options;
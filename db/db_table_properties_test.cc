@@ -15,6 +15,7 @@
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/db.h"
+#include "rocksdb/flush_block_policy.h"
 #include "rocksdb/types.h"
 #include "rocksdb/utilities/table_properties_collectors.h"
 #include "table/format.h"
@@ -416,6 +417,103 @@ TEST_F(DBTablePropertiesTest, GetDbIdentifiersProperty) {
   }
 }
 
+TEST_F(DBTablePropertiesTest, AdaptiveFlushBlockPolicy) {
+  AdaptiveFlushBlockPolicyOptions policy_options;
+  policy_options.min_reads = 1;
+  auto factory =
+      std::make_shared<AdaptiveFlushBlockPolicyFactory>(policy_options);
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 16 * 1024;
+  table_options.flush_block_policy_factory = factory;
+
+  FlushBlockPolicyContext context;
+  auto choose = [&]() {
+    return factory->ChooseBlockSize(context, table_options);
+  };
+  ASSERT_EQ(uint64_t{16 * 1024}, choose());
+  context.num_point_reads = 1000;
+  ASSERT_EQ(uint64_t{4 * 1024}, choose());
+  context.num_iterator_reads = 1000;
+  ASSERT_EQ(uint64_t{16 * 1024}, choose());
+  context.num_point_reads = 0;
+  ASSERT_EQ(uint64_t{64 * 1024}, choose());
+
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  const int kNumKeys = 2000;
+  const int kNumReads = 20000;
+  // Compacts two L0 files read by `read` and returns the output's properties
+  auto compact_after_reads = [&](const std::function<void(int)>& read,
+                                 TableProperties* tp) {
+    DestroyAndReopen(options);
+    Random rnd(301);
+    for (int file = 0; file < 2; ++file) {
+      for (int i = 0; i < kNumKeys; ++i) {
+        ASSERT_OK(Put(Key(i), rnd.RandomString(100)));
+      }
+      ASSERT_OK(Flush());
+    }
+    for (int i = 0; i < kNumReads; ++i) {
+      read(i % kNumKeys);
+    }
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    TablePropertiesCollection fname_to_props;
+    ASSERT_OK(db_->GetPropertiesOfAllTables(&fname_to_props));
+    ASSERT_EQ(1U, fname_to_props.size());
+    *tp = *fname_to_props.begin()->second;
+  };
+
+  // The reads are sampled, but with one sample per 1024 reads on average,
+  // missing all of them is practically impossible.
+  TableProperties point_props;
+  compact_after_reads([&](int i) { ASSERT_NE("NOT_FOUND", Get(Key(i))); },
+                      &point_props);
+  ASSERT_GT(point_props.num_point_reads, 0U);
+  ASSERT_EQ(point_props.num_iterator_reads, 0U);
+
+  TableProperties scan_props;
+  compact_after_reads(
+      [&](int i) {
+        std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+        iter->Seek(Key(i));
+        for (int j = 0; j < 10 && iter->Valid(); ++j) {
+          iter->Next();
+        }
+        ASSERT_OK(iter->status());
+      },
+      &scan_props);
+  ASSERT_EQ(scan_props.num_point_reads, 0U);
+  ASSERT_GT(scan_props.num_iterator_reads, 0U);
+
+  // 4KB vs. 64KB blocks
+  ASSERT_GT(point_props.num_data_blocks, 8 * scan_props.num_data_blocks);
+
+  // Reads are not collected for flush block policies that do not use them
+  table_options.flush_block_policy_factory =
+      std::make_shared<FlushBlockBySizePolicyFactory>();
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  TableProperties by_size_props;
+  compact_after_reads([&](int i) { ASSERT_NE("NOT_FOUND", Get(Key(i))); },
+                      &by_size_props);
+  ASSERT_EQ(by_size_props.num_point_reads, 0U);
+  ASSERT_EQ(by_size_props.num_iterator_reads, 0U);
+
+  std::shared_ptr<FlushBlockPolicyFactory> from_string;
+  ASSERT_OK(FlushBlockPolicyFactory::CreateFromString(
+      ConfigOptions(),
+      "id=AdaptiveFlushBlockPolicyFactory;point_block_size=8192",
+      &from_string));
+  ASSERT_STREQ(from_string->Name(),
+               AdaptiveFlushBlockPolicyFactory::kClassName());
+  auto* from_string_options =
+      from_string->GetOptions<AdaptiveFlushBlockPolicyOptions>();
+  ASSERT_NE(from_string_options, nullptr);
+  ASSERT_EQ(from_string_options->point_block_size, 8192U);
+}
+
 class DBTableHostnamePropertyTest
     : public DBTestBase,
       public ::testing::WithParamInterface<std::tuple<int, std::string>> {
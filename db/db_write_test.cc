@@ -20,6 +20,7 @@
 #include "util/string_util.h"
 #include "utilities/fault_injection_env.h"
 #include "utilities/fault_injection_fs.h"
+#include "utilities/merge_operators.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -773,6 +774,209 @@ TEST_P(DBWriteTest, ConcurrentlyDisabledWAL) {
   ASSERT_LE(bytes_num, 1024 * 100);
 }
 
+TEST_P(DBWriteTest, SortedMemtableInsert) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumKeys = 50;
+  constexpr int kNumBatches = 200;
+  auto key = [](int t, int k) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "t%d_k%02d", t, k);
+    return std::string(buf);
+  };
+  for (bool allow_concurrent_memtable_write : {false, true}) {
+    Options options = GetOptions();
+    options.sorted_memtable_insert = true;
+    options.allow_concurrent_memtable_write = allow_concurrent_memtable_write;
+    options.merge_operator = MergeOperators::CreateStringAppendOperator();
+    DestroyAndReopen(options);
+
+    // Records of the same key in a batch are applied in order
+    WriteBatch batch;
+    ASSERT_OK(batch.Put("b", "b1"));
+    ASSERT_OK(batch.Put("a", "a1"));
+    ASSERT_OK(batch.Put("b", "b2"));
+    ASSERT_OK(batch.Delete("a"));
+    ASSERT_OK(batch.Merge("b", "b3"));
+    ASSERT_OK(batch.Put("c", "c1"));
+    const SequenceNumber seq = db_->GetLatestSequenceNumber();
+    ASSERT_OK(db_->Write(WriteOptions(), &batch));
+    ASSERT_EQ(seq + 6, db_->GetLatestSequenceNumber());
+    ASSERT_EQ("NOT_FOUND", Get("a"));
+    ASSERT_EQ("b2,b3", Get("b"));
+    ASSERT_EQ("c1", Get("c"));
+
+    // Concurrent writers of random keys, with range deletions now and then
+    std::vector<std::map<std::string, std::string>> expected(kNumThreads);
+    std::vector<port::Thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&, t]() {
+        Random rnd(301 + t);
+        auto& model = expected[t];
+        for (int i = 0; i < kNumBatches; i++) {
+          WriteBatch wb;
+          for (int j = 0; j < 5; j++) {
+            const std::string k = key(t, rnd.Uniform(kNumKeys));
+            const std::string v = std::to_string(i) + "_" + std::to_string(j);
+            switch (rnd.Uniform(3)) {
+              case 0:
+                ASSERT_OK(wb.Put(k, v));
+                model[k] = v;
+                break;
+              case 1:
+                ASSERT_OK(wb.Delete(k));
+                model.erase(k);
+                break;
+              default:
+                ASSERT_OK(wb.Merge(k, v));
+                model[k] = model.count(k) ? model[k] + "," + v : v;
+                break;
+            }
+          }
+          if (i % 50 == 49) {
+            ASSERT_OK(wb.DeleteRange(key(t, 10), key(t, 20)));
+            for (int k = 10; k < 20; k++) {
+              model.erase(key(t, k));
+            }
+          }
+          ASSERT_OK(db_->Write(WriteOptions(), &wb));
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    for (int reopen = 0; reopen < 2; reopen++) {
+      for (int t = 0; t < kNumThreads; t++) {
+        for (int k = 0; k < kNumKeys; k++) {
+          auto it = expected[t].find(key(t, k));
+          ASSERT_EQ(it == expected[t].end() ? "NOT_FOUND" : it->second,
+                    Get(key(t, k)));
+        }
+      }
+      // The WAL is replayed in order
+      Reopen(options);
+    }
+  }
+}
+
+TEST_F(DBWriteTestUnparameterized, PipelinedWALSync) {
+  std::unique_ptr<FaultInjectionTestEnv> fault_env(
+      new FaultInjectionTestEnv(env_));
+  Options options = CurrentOptions();
+  options.env = fault_env.get();
+  options.enable_pipelined_write = true;
+  options.enable_pipelined_wal_sync = true;
+  options.write_buffer_size = 64 << 10;
+  options.avoid_flush_during_shutdown = true;
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+
+  WriteOptions sync_options;
+  sync_options.sync = true;
+
+  // A WAL append is not held up by the sync of the previous write group
+  std::atomic<int> appends{0};
+  std::atomic<int> appends_before_sync{0};
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"DBWriteTest::PipelinedWALSync:SyncStarted",
+        "DBWriteTest::PipelinedWALSync:PutB"}});
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::WriteToWAL:log_entry", [&](void* /* arg */) { appends++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::SyncPipelinedWAL:BeforeSync", [&](void* /* arg */) {
+        TEST_SYNC_POINT("DBWriteTest::PipelinedWALSync:SyncStarted");
+        for (int i = 0; i < 1000 && appends < 2; i++) {
+          env_->SleepForMicroseconds(10000);
+        }
+        appends_before_sync = appends.load();
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  port::Thread writer_a([&]() { ASSERT_OK(Put("a", "va", sync_options)); });
+  TEST_SYNC_POINT("DBWriteTest::PipelinedWALSync:PutB");
+  ASSERT_OK(Put("b", "vb"));
+  writer_a.join();
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  SyncPoint::GetInstance()->ClearTrace();
+  ASSERT_EQ(2, appends_before_sync);
+
+  // Sync writes across memtable switches, with a sync per write at most
+  constexpr int kNumThreads = 4;
+  constexpr int kNumKeys = 200;
+  const uint64_t syncs_before =
+      options.statistics->getTickerCount(WAL_FILE_SYNCED);
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumKeys; i++) {
+        ASSERT_OK(Put("k" + std::to_string(t) + "_" + std::to_string(i),
+                      std::string(1000, 'v'), sync_options));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  const uint64_t syncs =
+      options.statistics->getTickerCount(WAL_FILE_SYNCED) - syncs_before;
+  ASSERT_GT(syncs, 0);
+  ASSERT_LE(syncs, kNumThreads * kNumKeys);
+
+  // Simulate full loss of unsynced data. Every sync write survives it.
+  Close();
+  ASSERT_OK(fault_env->DropUnsyncedFileData());
+  Reopen(options);
+  ASSERT_EQ("va", Get("a"));
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(std::string(1000, 'v'),
+                Get("k" + std::to_string(t) + "_" + std::to_string(i)));
+    }
+  }
+
+  // Need to close before `fault_env` goes out of scope.
+  Close();
+}
+
+TEST_F(DBWriteTestUnparameterized, PipelinedWALSyncError) {
+  std::shared_ptr<FaultInjectionTestFS> fault_fs(
+      new FaultInjectionTestFS(FileSystem::Default()));
+  std::unique_ptr<Env> fault_fs_env(NewCompositeEnv(fault_fs));
+  Options options = CurrentOptions();
+  options.env = fault_fs_env.get();
+  options.enable_pipelined_write = true;
+  options.enable_pipelined_wal_sync = true;
+  for (bool paranoid_checks : {true, false}) {
+    options.paranoid_checks = paranoid_checks;
+    DestroyAndReopen(options);
+    WriteOptions sync_options;
+    sync_options.sync = true;
+    ASSERT_OK(Put("a", "va", sync_options));
+
+    // Only the sync of the memtable stage fails, after the append
+    SyncPoint::GetInstance()->SetCallBack(
+        "DBImpl::SyncPipelinedWAL:BeforeSync", [&](void* /* arg */) {
+          fault_fs->SetFilesystemActive(false,
+                                        IOStatus::IOError("Injected sync"));
+        });
+    SyncPoint::GetInstance()->EnableProcessing();
+    ASSERT_NOK(Put("b", "vb", sync_options));
+    SyncPoint::GetInstance()->DisableProcessing();
+    SyncPoint::GetInstance()->ClearAllCallBacks();
+    fault_fs->SetFilesystemActive(true);
+    if (paranoid_checks) {
+      ASSERT_NOK(dbfull()->TEST_GetBGError());
+    }
+
+    // A later sync must not report "b" as synced, even if the file system
+    // works again
+    ASSERT_NOK(Put("c", "vc", sync_options));
+    ASSERT_EQ("va", Get("a"));
+    Close();
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
@@ -218,6 +218,11 @@ Status FlushJob::Run(LogsWithPrepTracker* prep_tracker, FileMetaData* file_meta,
   // FlushJob::Run call.
   double mempurge_threshold =
       mutable_cf_options_.experimental_mempurge_threshold;
+  // Under write buffer manager pressure, the memtables can be spilled into a
+  // frozen memtable, which reuses the MemPurge process, instead of flushed.
+  const bool frozen_spill =
+      mutable_cf_options_.experimental_frozen_memtable_spill &&
+      flush_reason_ == FlushReason::kWriteBufferManager;
 
   AutoThreadOperationStageUpdater stage_run(ThreadStatus::STAGE_FLUSH_RUN);
   if (mems_.empty()) {
@@ -245,11 +250,13 @@ Status FlushJob::Run(LogsWithPrepTracker* prep_tracker, FileMetaData* file_meta,
     prev_cpu_read_nanos = IOSTATS(cpu_read_nanos);
   }
   Status mempurge_s = Status::NotFound("No MemPurge.");
-  if ((mempurge_threshold > 0.0) &&
-      (flush_reason_ == FlushReason::kWriteBufferFull) && (!mems_.empty()) &&
-      MemPurgeDecider(mempurge_threshold) && !(db_options_.atomic_flush)) {
+  if ((frozen_spill ||
+       ((mempurge_threshold > 0.0) &&
+        (flush_reason_ == FlushReason::kWriteBufferFull) &&
+        MemPurgeDecider(mempurge_threshold))) &&
+      (!mems_.empty()) && !(db_options_.atomic_flush)) {
     cfd_->SetMempurgeUsed();
-    mempurge_s = MemPurge();
+    mempurge_s = MemPurge(frozen_spill);
     if (!mempurge_s.ok()) {
       // Mempurge is typically aborted when the output
       // bytes cannot be contained onto a single output memtable.
@@ -360,7 +367,7 @@ void FlushJob::Cancel() {
   base_->Unref();
 }
 
-Status FlushJob::MemPurge() {
+Status FlushJob::MemPurge(bool frozen_output) {
   Status s;
   db_mutex_->AssertHeld();
   db_mutex_->Unlock();
@@ -417,7 +424,8 @@ Status FlushJob::MemPurge() {
   // Place iterator at the First (meaning most recent) key node.
   iter->SeekToFirst();
 
-  const std::string* const full_history_ts_low = &(cfd_->GetFullHistoryTsLow());
+  const std::string* const full_history_ts_low =
+      full_history_ts_low_.empty() ? nullptr : &full_history_ts_low_;
   std::unique_ptr<CompactionRangeDelAggregator> range_del_agg(
       new CompactionRangeDelAggregator(&(cfd_->internal_comparator()),
                                        existing_snapshots_,
@@ -452,9 +460,11 @@ Status FlushJob::MemPurge() {
       }
     }
 
-    new_mem = new MemTable((cfd_->internal_comparator()), *(cfd_->ioptions()),
-                           mutable_cf_options_, cfd_->write_buffer_mgr(),
-                           earliest_seqno, cfd_->GetID());
+    new_mem = new MemTable(
+        (cfd_->internal_comparator()), *(cfd_->ioptions()), mutable_cf_options_,
+        cfd_->write_buffer_mgr(), earliest_seqno, cfd_->GetID(),
+        frozen_output ||
+            mutable_cf_options_.experimental_mempurge_frozen_output);
     assert(new_mem != nullptr);
 
     Env* env = db_options_.env;
@@ -1014,12 +1024,6 @@ Status FlushJob::WriteLevel0Table() {
   stats.micros = micros;
   stats.cpu_micros = cpu_micros;
 
-  ROCKS_LOG_INFO(db_options_.info_log,
-                 "[%s] [JOB %d] Flush lasted %" PRIu64
-                 " microseconds, and %" PRIu64 " cpu microseconds.\n",
-                 cfd_->GetName().c_str(), job_context_->job_id, micros,
-                 cpu_micros);
-
   if (has_output) {
     stats.bytes_written = meta_.fd.GetFileSize();
     stats.num_output_files = 1;
@@ -1030,6 +1034,19 @@ Status FlushJob::WriteLevel0Table() {
     stats.bytes_written_blob += blob.GetTotalBlobBytes();
   }
 
+  // Write throughput of the flush, to tell whether building the table (e.g.
+  // compression, see CompressionOptions::parallel_threads) is a bottleneck
+  const uint64_t bytes_written = stats.bytes_written + stats.bytes_written_blob;
+  ROCKS_LOG_INFO(db_options_.info_log,
+                 "[%s] [JOB %d] Flush lasted %" PRIu64
+                 " microseconds, and %" PRIu64
+                 " cpu microseconds, writing %" PRIu64
+                 " bytes (%.1f MB/sec).\n",
+                 cfd_->GetName().c_str(), job_context_->job_id, micros,
+                 cpu_micros, bytes_written,
+                 static_cast<double>(bytes_written) /
+                     static_cast<double>(std::max(micros, uint64_t{1})));
+
   stats.num_output_files_blob = static_cast<int>(blobs.size());
 
   RecordTimeToHistogram(stats_, FLUSH_TIME, stats.micros);
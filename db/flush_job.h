@@ -121,7 +121,10 @@ class FlushJob {
   // first go through the MemPurge process. Therefore, we strongly
   // recommend all users not to set this flag as true given that the MemPurge
   // process has not matured yet.
-  Status MemPurge();
+  // With frozen_output, the output is a frozen memtable whatever
+  // experimental_mempurge_frozen_output is, as when spilling memtables under
+  // write buffer manager pressure (experimental_frozen_memtable_spill).
+  Status MemPurge(bool frozen_output);
   bool MemPurgeDecider(double threshold);
   // The rate limiter priority (io_priority) is determined dynamically here.
   Env::IOPriority GetRateLimiterPriorityForWrite();
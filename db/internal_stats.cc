@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstddef>
+#include <cstring>
 #include <limits>
 #include <sstream>
 #include <string>
@@ -21,6 +22,8 @@
 
 #include "cache/cache_entry_roles.h"
 #include "cache/cache_entry_stats.h"
+#include "cache/ghost_cache.h"
+#include "cache/lru_cache.h"
 #include "db/column_family.h"
 #include "db/db_impl/db_impl.h"
 #include "port/port.h"
@@ -246,6 +249,8 @@ static const std::string cf_file_histogram = "cf-file-histogram";
 static const std::string dbstats = "dbstats";
 static const std::string levelstats = "levelstats";
 static const std::string block_cache_entry_stats = "block-cache-entry-stats";
+static const std::string block_cache_miss_ratio_curve =
+    "block-cache-miss-ratio-curve";
 static const std::string fast_block_cache_entry_stats =
     "fast-block-cache-entry-stats";
 static const std::string num_immutable_mem_table = "num-immutable-mem-table";
@@ -300,7 +305,13 @@ static const std::string is_write_stopped = "is-write-stopped";
 static const std::string estimate_oldest_key_time = "estimate-oldest-key-time";
 static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
+static const std::string block_cache_tenant_usage = "block-cache-tenant-usage";
+static const std::string block_cache_tenant_lookups =
+    "block-cache-tenant-lookups";
+static const std::string block_cache_tenant_hits = "block-cache-tenant-hits";
 static const std::string block_cache_pinned_usage = "block-cache-pinned-usage";
+static const std::string block_cache_warmup_progress =
+    "block-cache-warmup-progress";
 static const std::string options_statistics = "options-statistics";
 static const std::string num_blob_files = "num-blob-files";
 static const std::string blob_stats = "blob-stats";
@@ -329,6 +340,8 @@ const std::string DB::Properties::kBlockCacheEntryStats =
     rocksdb_prefix + block_cache_entry_stats;
 const std::string DB::Properties::kFastBlockCacheEntryStats =
     rocksdb_prefix + fast_block_cache_entry_stats;
+const std::string DB::Properties::kBlockCacheMissRatioCurve =
+    rocksdb_prefix + block_cache_miss_ratio_curve;
 const std::string DB::Properties::kNumImmutableMemTable =
     rocksdb_prefix + num_immutable_mem_table;
 const std::string DB::Properties::kNumImmutableMemTableFlushed =
@@ -402,6 +415,14 @@ const std::string DB::Properties::kBlockCacheUsage =
     rocksdb_prefix + block_cache_usage;
 const std::string DB::Properties::kBlockCachePinnedUsage =
     rocksdb_prefix + block_cache_pinned_usage;
+const std::string DB::Properties::kBlockCacheTenantUsage =
+    rocksdb_prefix + block_cache_tenant_usage;
+const std::string DB::Properties::kBlockCacheTenantLookups =
+    rocksdb_prefix + block_cache_tenant_lookups;
+const std::string DB::Properties::kBlockCacheTenantHits =
+    rocksdb_prefix + block_cache_tenant_hits;
+const std::string DB::Properties::kBlockCacheWarmupProgress =
+    rocksdb_prefix + block_cache_warmup_progress;
 const std::string DB::Properties::kOptionsStatistics =
     rocksdb_prefix + options_statistics;
 const std::string DB::Properties::kLiveSstFilesSizeAtTemperature =
@@ -459,6 +480,9 @@ const UnorderedMap<std::string, DBPropertyInfo>
         {DB::Properties::kFastBlockCacheEntryStats,
          {true, &InternalStats::HandleFastBlockCacheEntryStats, nullptr,
           &InternalStats::HandleFastBlockCacheEntryStatsMap, nullptr}},
+        {DB::Properties::kBlockCacheMissRatioCurve,
+         {false, &InternalStats::HandleBlockCacheMissRatioCurve, nullptr,
+          &InternalStats::HandleBlockCacheMissRatioCurveMap, nullptr}},
         {DB::Properties::kSSTables,
          {false, &InternalStats::HandleSsTables, nullptr, nullptr, nullptr}},
         {DB::Properties::kAggregatedTableProperties,
@@ -575,6 +599,18 @@ const UnorderedMap<std::string, DBPropertyInfo>
         {DB::Properties::kBlockCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlockCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kBlockCacheTenantUsage,
+         {false, nullptr, &InternalStats::HandleBlockCacheTenantUsage, nullptr,
+          nullptr}},
+        {DB::Properties::kBlockCacheTenantLookups,
+         {false, nullptr, &InternalStats::HandleBlockCacheTenantLookups,
+          nullptr, nullptr}},
+        {DB::Properties::kBlockCacheTenantHits,
+         {false, nullptr, &InternalStats::HandleBlockCacheTenantHits, nullptr,
+          nullptr}},
+        {DB::Properties::kBlockCacheWarmupProgress,
+         {true, nullptr, nullptr, nullptr,
+          &DBImpl::GetPropertyHandleBlockCacheWarmupProgress}},
         {DB::Properties::kOptionsStatistics,
          {true, nullptr, nullptr, nullptr,
           &DBImpl::GetPropertyHandleOptionsStatistics}},
@@ -792,6 +828,38 @@ bool InternalStats::HandleFastBlockCacheEntryStatsMap(
   return HandleBlockCacheEntryStatsMapInternal(values, true /* fast */);
 }
 
+bool InternalStats::HandleBlockCacheMissRatioCurve(std::string* value,
+                                                   Slice /*suffix*/) {
+  Cache* block_cache = GetBlockCacheForStats();
+  if (block_cache == nullptr ||
+      strcmp(block_cache->Name(), GhostCache::kClassName()) != 0) {
+    return false;
+  }
+  *value = static_cast<GhostCache*>(block_cache)->ToString();
+  return true;
+}
+
+bool InternalStats::HandleBlockCacheMissRatioCurveMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  Cache* block_cache = GetBlockCacheForStats();
+  if (block_cache == nullptr ||
+      strcmp(block_cache->Name(), GhostCache::kClassName()) != 0) {
+    return false;
+  }
+  std::vector<GhostCacheStats> stats;
+  static_cast<GhostCache*>(block_cache)->GetStats(&stats);
+  values->clear();
+  for (const GhostCacheStats& ghost_stats : stats) {
+    const std::string prefix =
+        GhostCache::GetPolicyName(ghost_stats.config.policy) +
+        std::string(".") + std::to_string(ghost_stats.config.capacity) + ".";
+    (*values)[prefix + "lookups"] = std::to_string(ghost_stats.lookups);
+    (*values)[prefix + "hits"] = std::to_string(ghost_stats.hits);
+    (*values)[prefix + "miss_ratio"] = std::to_string(ghost_stats.MissRatio());
+  }
+  return true;
+}
+
 bool InternalStats::HandleLiveSstFilesSizeAtTemperature(std::string* value,
                                                         Slice suffix) {
   uint64_t temperature;
@@ -1463,6 +1531,38 @@ bool InternalStats::HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* /*db*/,
   return false;
 }
 
+bool InternalStats::HandleBlockCacheTenantUsage(uint64_t* value,
+                                                DBImpl* /*db*/,
+                                                Version* /*version*/) {
+  CacheTenantStats stats;
+  if (GetCacheTenantViewStats(GetBlockCacheForStats(), &stats)) {
+    *value = static_cast<uint64_t>(stats.usage);
+    return true;
+  }
+  return false;
+}
+
+bool InternalStats::HandleBlockCacheTenantLookups(uint64_t* value,
+                                                  DBImpl* /*db*/,
+                                                  Version* /*version*/) {
+  CacheTenantStats stats;
+  if (GetCacheTenantViewStats(GetBlockCacheForStats(), &stats)) {
+    *value = stats.lookups;
+    return true;
+  }
+  return false;
+}
+
+bool InternalStats::HandleBlockCacheTenantHits(uint64_t* value, DBImpl* /*db*/,
+                                               Version* /*version*/) {
+  CacheTenantStats stats;
+  if (GetCacheTenantViewStats(GetBlockCacheForStats(), &stats)) {
+    *value = stats.hits;
+    return true;
+  }
+  return false;
+}
+
 void InternalStats::DumpDBMapStats(
     std::map<std::string, std::string>* db_stats) {
   for (int i = 0; i < static_cast<int>(kIntStatsNumMax); ++i) {
@@ -805,12 +805,21 @@ class InternalStats {
                                    Version* version);
   bool HandleBlockCacheCapacity(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlockCacheUsage(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleBlockCacheTenantUsage(uint64_t* value, DBImpl* db,
+                                   Version* version);
+  bool HandleBlockCacheTenantLookups(uint64_t* value, DBImpl* db,
+                                     Version* version);
+  bool HandleBlockCacheTenantHits(uint64_t* value, DBImpl* db,
+                                  Version* version);
   bool HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* db,
                                    Version* version);
   bool HandleBlockCacheEntryStatsInternal(std::string* value, bool fast);
   bool HandleBlockCacheEntryStatsMapInternal(
       std::map<std::string, std::string>* values, bool fast);
   bool HandleBlockCacheEntryStats(std::string* value, Slice suffix);
+  bool HandleBlockCacheMissRatioCurve(std::string* value, Slice suffix);
+  bool HandleBlockCacheMissRatioCurveMap(
+      std::map<std::string, std::string>* values, Slice suffix);
   bool HandleBlockCacheEntryStatsMap(std::map<std::string, std::string>* values,
                                      Slice suffix);
   bool HandleFastBlockCacheEntryStats(std::string* value, Slice suffix);
@@ -25,6 +25,7 @@
 #include "logging/logging.h"
 #include "memory/arena.h"
 #include "memory/memory_usage.h"
+#include "memtable/frozen_rep.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics.h"
 #include "port/lang.h"
@@ -57,6 +58,8 @@ ImmutableMemTableOptions::ImmutableMemTableOptions(
       memtable_huge_page_size(mutable_cf_options.memtable_huge_page_size),
       memtable_whole_key_filtering(
           mutable_cf_options.memtable_whole_key_filtering),
+      memtable_point_lookup_index(
+          mutable_cf_options.memtable_point_lookup_index),
       inplace_update_support(ioptions.inplace_update_support),
       inplace_update_num_locks(mutable_cf_options.inplace_update_num_locks),
       inplace_callback(ioptions.inplace_callback),
@@ -72,7 +75,8 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                    const ImmutableOptions& ioptions,
                    const MutableCFOptions& mutable_cf_options,
                    WriteBufferManager* write_buffer_manager,
-                   SequenceNumber latest_seq, uint32_t column_family_id)
+                   SequenceNumber latest_seq, uint32_t column_family_id,
+                   bool frozen)
     : comparator_(cmp),
       moptions_(ioptions, mutable_cf_options),
       refs_(0),
@@ -85,9 +89,11 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                  ? &mem_tracker_
                  : nullptr,
              mutable_cf_options.memtable_huge_page_size),
-      table_(ioptions.memtable_factory->CreateMemTableRep(
-          comparator_, &arena_, mutable_cf_options.prefix_extractor.get(),
-          ioptions.logger, column_family_id)),
+      table_(frozen ? NewFrozenRep(comparator_, &arena_)
+                    : ioptions.memtable_factory->CreateMemTableRep(
+                          comparator_, &arena_,
+                          mutable_cf_options.prefix_extractor.get(),
+                          ioptions.logger, column_family_id)),
       range_del_table_(SkipListFactory().CreateMemTableRep(
           comparator_, &arena_, nullptr /* transform */, ioptions.logger,
           column_family_id)),
@@ -108,6 +114,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                  ? moptions_.inplace_update_num_locks
                  : 0),
       prefix_extractor_(mutable_cf_options.prefix_extractor.get()),
+      frozen_(frozen),
       flush_state_(FLUSH_NOT_REQUESTED),
       clock_(ioptions.clock),
       insert_with_hint_prefix_extractor_(
@@ -127,6 +134,15 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                          6 /* hard coded 6 probes */,
                          moptions_.memtable_huge_page_size, ioptions.logger));
   }
+  // Not with user-defined timestamps, where the newest entry of a user key
+  // may be newer than the read timestamp. Nor in a frozen memtable, where
+  // entries are not pinned.
+  if (moptions_.memtable_point_lookup_index && !frozen &&
+      comparator_.comparator.user_comparator()->timestamp_size() == 0) {
+    point_lookup_index_.reset(new PointLookupIndex(
+        &arena_, mutable_cf_options.write_buffer_size / 256 + 1,
+        moptions_.memtable_huge_page_size, ioptions.logger));
+  }
   // Initialize cached_range_tombstone_ here since it could
   // be read before it is constructed in MemTable::Add(), which could also lead
   // to a data race on the global mutex table backing atomic shared_ptr.
@@ -370,8 +386,11 @@ class MemTableIterator : public InternalIterator {
         comparator_(mem.comparator_),
         valid_(false),
         arena_mode_(arena != nullptr),
+        key_pinned_(use_range_del_table || !mem.frozen_),
         value_pinned_(
-            !mem.GetImmutableMemTableOptions()->inplace_update_support),
+            !mem.GetImmutableMemTableOptions()->inplace_update_support &&
+            key_pinned_),
+        pin_value_copies_(!key_pinned_),
         protection_bytes_per_key_(mem.moptions_.protection_bytes_per_key),
         status_(Status::OK()),
         logger_(mem.moptions_.info_log) {
@@ -404,12 +423,10 @@ class MemTableIterator : public InternalIterator {
     }
   }
 
-#ifndef NDEBUG
   void SetPinnedItersMgr(PinnedIteratorsManager* pinned_iters_mgr) override {
     pinned_iters_mgr_ = pinned_iters_mgr;
   }
   PinnedIteratorsManager* pinned_iters_mgr_ = nullptr;
-#endif
 
   bool Valid() const override { return valid_ && status_.ok(); }
   void Seek(const Slice& k) override {
@@ -432,6 +449,7 @@ class MemTableIterator : public InternalIterator {
     }
     iter_->Seek(k, nullptr);
     valid_ = iter_->Valid();
+    value_copy_ = nullptr;
     VerifyEntryChecksum();
   }
   void SeekForPrev(const Slice& k) override {
@@ -453,6 +471,7 @@ class MemTableIterator : public InternalIterator {
     }
     iter_->Seek(k, nullptr);
     valid_ = iter_->Valid();
+    value_copy_ = nullptr;
     VerifyEntryChecksum();
     if (!Valid() && status().ok()) {
       SeekToLast();
@@ -464,11 +483,13 @@ class MemTableIterator : public InternalIterator {
   void SeekToFirst() override {
     iter_->SeekToFirst();
     valid_ = iter_->Valid();
+    value_copy_ = nullptr;
     VerifyEntryChecksum();
   }
   void SeekToLast() override {
     iter_->SeekToLast();
     valid_ = iter_->Valid();
+    value_copy_ = nullptr;
     VerifyEntryChecksum();
   }
   void Next() override {
@@ -477,6 +498,7 @@ class MemTableIterator : public InternalIterator {
     iter_->Next();
     TEST_SYNC_POINT_CALLBACK("MemTableIterator::Next:0", iter_);
     valid_ = iter_->Valid();
+    value_copy_ = nullptr;
     VerifyEntryChecksum();
   }
   bool NextAndGetResult(IterateResult* result) override {
@@ -494,6 +516,7 @@ class MemTableIterator : public InternalIterator {
     assert(Valid());
     iter_->Prev();
     valid_ = iter_->Valid();
+    value_copy_ = nullptr;
     VerifyEntryChecksum();
   }
   Slice key() const override {
@@ -503,19 +526,34 @@ class MemTableIterator : public InternalIterator {
   Slice value() const override {
     assert(Valid());
     Slice key_slice = GetLengthPrefixedSlice(iter_->key());
-    return GetLengthPrefixedSlice(key_slice.data() + key_slice.size());
+    Slice value = GetLengthPrefixedSlice(key_slice.data() + key_slice.size());
+    if (PinningValueCopies()) {
+      // The entry is only valid until iter_ moves, so it is copied once per
+      // entry, until the pinned data is released
+      if (value_copy_ == nullptr) {
+        char* copy = new char[value.size()];
+        memcpy(copy, value.data(), value.size());
+        pinned_iters_mgr_->RegisterCleanup(&ReleaseValueCopy,
+                                           const_cast<MemTableIterator*>(this),
+                                           copy);
+        value_copy_ = copy;
+      }
+      value = Slice(value_copy_, value.size());
+    }
+    return value;
   }
 
   Status status() const override { return status_; }
 
   bool IsKeyPinned() const override {
-    // memtable data is always pinned
-    return true;
+    // memtable data is always pinned, except in a frozen memtable
+    return key_pinned_;
   }
 
   bool IsValuePinned() const override {
     // memtable value is always pinned, except if we allow inplace update.
-    return value_pinned_;
+    // In a frozen memtable, values are copied while pinning is enabled.
+    return value_pinned_ || PinningValueCopies();
   }
 
  private:
@@ -525,11 +563,31 @@ class MemTableIterator : public InternalIterator {
   MemTableRep::Iterator* iter_;
   bool valid_;
   bool arena_mode_;
+  bool key_pinned_;
   bool value_pinned_;
+  bool pin_value_copies_;
+  // The pinned copy of the current entry's value, if any
+  mutable const char* value_copy_ = nullptr;
   size_t protection_bytes_per_key_;
   Status status_;
   Logger* logger_;
 
+  bool PinningValueCopies() const {
+    return pin_value_copies_ && pinned_iters_mgr_ != nullptr &&
+           pinned_iters_mgr_->PinningEnabled();
+  }
+
+  // A cleanup of the PinnedIteratorsManager, which is released before the
+  // iterator is destroyed
+  static void ReleaseValueCopy(void* arg1, void* arg2) {
+    MemTableIterator* iter = static_cast<MemTableIterator*>(arg1);
+    char* copy = static_cast<char*>(arg2);
+    if (iter->value_copy_ == copy) {
+      iter->value_copy_ = nullptr;
+    }
+    delete[] copy;
+  }
+
   void VerifyEntryChecksum() {
     if (protection_bytes_per_key_ > 0 && Valid()) {
       status_ = MemTable::VerifyEntryChecksum(iter_->key(),
@@ -767,7 +825,8 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
         return Status::TryAgain("key+seq exists");
       }
     } else {
-      bool res = table->InsertKey(handle);
+      bool res = (hint == nullptr) ? table->InsertKey(handle)
+                                   : table->InsertKeyWithHint(handle, hint);
       if (UNLIKELY(!res)) {
         return Status::TryAgain("key+seq exists");
       }
@@ -792,13 +851,17 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
     if (bloom_filter_ && moptions_.memtable_whole_key_filtering) {
       bloom_filter_->Add(key_without_ts);
     }
+    if (point_lookup_index_ && type != kTypeRangeDeletion) {
+      point_lookup_index_->Add(buf);
+    }
 
-    // The first sequence number inserted into the memtable
-    assert(first_seqno_ == 0 || s >= first_seqno_);
-    if (first_seqno_ == 0) {
+    // The first sequence number inserted into the memtable. With
+    // sorted_memtable_insert, the records of a write group are not inserted
+    // in sequence order.
+    if (first_seqno_ == 0 || s < first_seqno_) {
       first_seqno_.store(s, std::memory_order_relaxed);
 
-      if (earliest_seqno_ == kMaxSequenceNumber) {
+      if (s < earliest_seqno_) {
         earliest_seqno_.store(GetFirstSequenceNumber(),
                               std::memory_order_relaxed);
       }
@@ -829,6 +892,9 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
     if (bloom_filter_ && moptions_.memtable_whole_key_filtering) {
       bloom_filter_->AddConcurrently(key_without_ts);
     }
+    if (point_lookup_index_ && type != kTypeRangeDeletion) {
+      point_lookup_index_->Add(buf);
+    }
 
     // atomically update first_seqno_ and earliest_seqno_.
     uint64_t cur_seq_num = first_seqno_.load(std::memory_order_relaxed);
@@ -895,6 +961,8 @@ struct Saver {
   Logger* logger;
   Statistics* statistics;
   bool inplace_update_support;
+  // Whether the entries outlive the lookup
+  bool operand_pinned;
   bool do_merge;
   SystemClock* clock;
 
@@ -1056,8 +1124,7 @@ static bool SaveValue(void* arg, const char* entry) {
           // TODO(yanqin) update MergeContext so that timestamps information
           // can also be retained.
 
-          merge_context->PushOperand(
-              v, s->inplace_update_support == false /* operand_pinned */);
+          merge_context->PushOperand(v, s->operand_pinned);
         } else if (*(s->merge_in_progress)) {
           assert(s->do_merge);
 
@@ -1118,9 +1185,7 @@ static bool SaveValue(void* arg, const char* entry) {
               v, value_of_default);
 
           if (s->status->ok()) {
-            merge_context->PushOperand(
-                value_of_default,
-                s->inplace_update_support == false /* operand_pinned */);
+            merge_context->PushOperand(value_of_default, s->operand_pinned);
           }
         } else if (*(s->merge_in_progress)) {
           assert(s->do_merge);
@@ -1228,8 +1293,7 @@ static bool SaveValue(void* arg, const char* entry) {
         }
         Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
         *(s->merge_in_progress) = true;
-        merge_context->PushOperand(
-            v, s->inplace_update_support == false /* operand_pinned */);
+        merge_context->PushOperand(v, s->operand_pinned);
         PERF_COUNTER_ADD(internal_merge_count_point_lookups, 1);
 
         if (s->do_merge && merge_operator->ShouldMerge(
@@ -1379,6 +1443,7 @@ void MemTable::GetFromTable(const LookupKey& key,
   saver.merge_operator = moptions_.merge_operator;
   saver.logger = moptions_.info_log;
   saver.inplace_update_support = moptions_.inplace_update_support;
+  saver.operand_pinned = !moptions_.inplace_update_support && !frozen_;
   saver.statistics = moptions_.statistics;
   saver.clock = clock_;
   saver.callback_ = callback;
@@ -1386,6 +1451,29 @@ void MemTable::GetFromTable(const LookupKey& key,
   saver.do_merge = do_merge;
   saver.allow_data_in_errors = moptions_.allow_data_in_errors;
   saver.protection_bytes_per_key = moptions_.protection_bytes_per_key;
+  if (point_lookup_index_ != nullptr && callback == nullptr) {
+    const char* entry = point_lookup_index_->Find(key.user_key());
+    if (entry == nullptr) {
+      // Not in the memtable
+      PERF_COUNTER_ADD(memtable_point_lookup_index_count, 1);
+      *seq = saver.seq;
+      return;
+    }
+    // The newest entry of the key is the result, unless it is a merge operand
+    // or newer than the read
+    Slice internal_key = GetLengthPrefixedSlice(entry);
+    SequenceNumber entry_seq;
+    ValueType entry_type;
+    UnPackSequenceAndType(ExtractInternalKeyFooter(internal_key), &entry_seq,
+                          &entry_type);
+    if (entry_type != kTypeMerge &&
+        entry_seq <= GetInternalKeySeqno(key.internal_key())) {
+      PERF_COUNTER_ADD(memtable_point_lookup_index_count, 1);
+      SaveValue(&saver, entry);
+      *seq = saver.seq;
+      return;
+    }
+  }
   table_->Get(key, &saver, SaveValue);
   *seq = saver.seq;
 }
@@ -23,6 +23,7 @@
 #include "db/version_edit.h"
 #include "memory/allocator.h"
 #include "memory/concurrent_arena.h"
+#include "memtable/point_lookup_index.h"
 #include "monitoring/instrumented_mutex.h"
 #include "options/cf_options.h"
 #include "rocksdb/db.h"
@@ -47,6 +48,7 @@ struct ImmutableMemTableOptions {
   uint32_t memtable_prefix_bloom_bits;
   size_t memtable_huge_page_size;
   bool memtable_whole_key_filtering;
+  bool memtable_point_lookup_index;
   bool inplace_update_support;
   size_t inplace_update_num_locks;
   UpdateStatus (*inplace_callback)(char* existing_value,
@@ -104,11 +106,17 @@ class MemTable {
   // If the earliest sequence number is not known, kMaxSequenceNumber may be
   // used, but this may prevent some transactions from succeeding until the
   // first key is inserted into the memtable.
+  //
+  // A frozen memtable stores its entries in a compact read-only array (see
+  // memtable/frozen_rep.h) instead of the memtable_factory representation.
+  // Its entries must be added in increasing order of internal key, and are
+  // not pinned by its iterators.
   explicit MemTable(const InternalKeyComparator& comparator,
                     const ImmutableOptions& ioptions,
                     const MutableCFOptions& mutable_cf_options,
                     WriteBufferManager* write_buffer_manager,
-                    SequenceNumber earliest_seq, uint32_t column_family_id);
+                    SequenceNumber earliest_seq, uint32_t column_family_id,
+                    bool frozen = false);
   // No copying allowed
   MemTable(const MemTable&) = delete;
   MemTable& operator=(const MemTable&) = delete;
@@ -236,6 +244,14 @@ class MemTable {
              MemTablePostProcessInfo* post_process_info = nullptr,
              void** hint = nullptr);
 
+  // Returns the insert hint for Add() without allow_concurrent, for writers
+  // inserting in key order (see WriteBatchInternal::InsertInto()). It lives
+  // as long as the memtable.
+  //
+  // REQUIRES: external synchronization to prevent simultaneous
+  // operations on the same MemTable.
+  void** GetSequentialInsertHint() { return &sequential_insert_hint_; }
+
   // Used to Get value associated with key or Get Merge Operands associated
   // with key.
   // If do_merge = true the default behavior which is Get value for key is
@@ -587,6 +603,10 @@ class MemTable {
 
   const SliceTransform* const prefix_extractor_;
   std::unique_ptr<DynamicBloom> bloom_filter_;
+  // The newest entry of each user key, if memtable_point_lookup_index
+  std::unique_ptr<PointLookupIndex> point_lookup_index_;
+
+  const bool frozen_;
 
   std::atomic<FlushStateEnum> flush_state_;
 
@@ -598,6 +618,9 @@ class MemTable {
   // Insert hints for each prefix.
   UnorderedMapH<Slice, void*, SliceHasher> insert_hints_;
 
+  // Insert hint of non-concurrent writers inserting in key order
+  void* sequential_insert_hint_ = nullptr;
+
   // Timestamp of oldest key
   std::atomic<uint64_t> oldest_key_time_;
 
@@ -377,11 +377,11 @@ bool MemTableList::IsFlushPending() const {
 }
 
 bool MemTableList::IsFlushPendingOrRunning() const {
-  if (current_->memlist_.size() - num_flush_not_started_ > 0) {
-    // Flush is already running on at least one memtable
-    return true;
-  }
-  return IsFlushPending();
+  return IsFlushRunning() || IsFlushPending();
+}
+
+bool MemTableList::IsFlushRunning() const {
+  return current_->memlist_.size() - num_flush_not_started_ > 0;
 }
 
 // Returns the memtables that need to be flushed.
@@ -263,6 +263,9 @@ class MemTableList {
   // flushing.
   bool IsFlushPendingOrRunning() const;
 
+  // Returns true if there is at least one memtable on which flush has started.
+  bool IsFlushRunning() const;
+
   // Returns the earliest memtables that needs to be flushed. The returned
   // memtables are guaranteed to be in the ascending order of created time.
   void PickMemtablesToFlush(uint64_t max_memtable_id,
@@ -607,6 +607,28 @@ Status TableCache::ApproximateKeyAnchors(
   return s;
 }
 
+Status TableCache::WarmUpBlockCache(
+    const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+    const FileMetaData& file_meta, const std::vector<uint64_t>& block_ids,
+    uint64_t* num_blocks, uint64_t* num_bytes) {
+  Status s;
+  TableReader* t = file_meta.fd.table_reader;
+  TypedHandle* handle = nullptr;
+  if (t == nullptr) {
+    s = FindTable(ro, file_options_, internal_comparator, file_meta, &handle);
+    if (s.ok()) {
+      t = cache_.Value(handle);
+    }
+  }
+  if (s.ok() && t != nullptr) {
+    s = t->WarmUpBlockCache(ro, block_ids, num_blocks, num_bytes);
+  }
+  if (handle != nullptr) {
+    cache_.Release(handle);
+  }
+  return s;
+}
+
 size_t TableCache::GetMemoryUsageByTableReader(
     const FileOptions& file_options,
     const InternalKeyComparator& internal_comparator,
@@ -191,6 +191,14 @@ class TableCache {
                                const FileMetaData& file_meta,
                                std::vector<TableReader::Anchor>& anchors);
 
+  // Loads the blocks of the file identified by `block_ids` (see
+  // TableReader::WarmUpBlockCache) into the block cache.
+  Status WarmUpBlockCache(const ReadOptions& ro,
+                          const InternalKeyComparator& internal_comparator,
+                          const FileMetaData& file_meta,
+                          const std::vector<uint64_t>& block_ids,
+                          uint64_t* num_blocks, uint64_t* num_bytes);
+
   // Return total memory usage of the table reader of the file.
   // 0 if table reader of the file is not loaded.
   size_t GetMemoryUsageByTableReader(
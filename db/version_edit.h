@@ -159,15 +159,19 @@ struct FileDescriptor {
 };
 
 struct FileSampledStats {
-  FileSampledStats() : num_reads_sampled(0) {}
+  FileSampledStats() : num_reads_sampled(0), num_point_reads_sampled(0) {}
   FileSampledStats(const FileSampledStats& other) { *this = other; }
   FileSampledStats& operator=(const FileSampledStats& other) {
     num_reads_sampled = other.num_reads_sampled.load();
+    num_point_reads_sampled = other.num_point_reads_sampled.load();
     return *this;
   }
 
   // number of user reads to this file.
   mutable std::atomic<uint64_t> num_reads_sampled;
+  // number of user reads to this file by Get() and MultiGet(), included in
+  // num_reads_sampled. The other reads are by iterators.
+  mutable std::atomic<uint64_t> num_point_reads_sampled;
 };
 
 struct FileMetaData {
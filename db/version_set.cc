@@ -2309,7 +2309,7 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
       break;
     }
     if (get_context.sample()) {
-      sample_file_read_inc(f->file_metadata);
+      sample_file_point_read_inc(f->file_metadata);
     }
 
     bool timer_enabled =
@@ -57,7 +57,7 @@ DEFINE_SYNC_AND_ASYNC(Status, Version::MultiGetFromSST)
     }
 
     if (get_context.sample()) {
-      sample_file_read_inc(f->file_metadata);
+      sample_file_point_read_inc(f->file_metadata);
     }
     batch_size++;
     num_index_read += get_context.get_context_stats_.num_index_read;
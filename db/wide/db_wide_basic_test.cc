@@ -210,6 +210,165 @@ TEST_F(DBWideBasicTest, PutEntity) {
   verify();
 }
 
+TEST_F(DBWideBasicTest, ColumnarEntitiesAndProjection) {
+  constexpr char first_key[] = "first";
+  WideColumns first_columns{{kDefaultWideColumnName, "hello"},
+                            {"attr_name1", "foo"},
+                            {"attr_name2", "bar"}};
+
+  constexpr char second_key[] = "second";
+  WideColumns second_columns{{"attr_name2", "two"}, {"attr_three", "four"}};
+
+  constexpr char third_key[] = "third";
+  constexpr char third_value[] = "baz";
+
+  const std::vector<Slice> projection{"attr_name2", kDefaultWideColumnName};
+  const WideColumns first_projected{{kDefaultWideColumnName, "hello"},
+                                    {"attr_name2", "bar"}};
+  const WideColumns second_projected{{"attr_name2", "two"}};
+  const WideColumns third_projected{{kDefaultWideColumnName, third_value}};
+
+  auto verify = [&]() {
+    PinnableSlice value;
+    ASSERT_OK(db_->Get(ReadOptions(), db_->DefaultColumnFamily(), first_key,
+                       &value));
+    ASSERT_EQ(value, "hello");
+    value.Reset();
+    ASSERT_OK(db_->Get(ReadOptions(), db_->DefaultColumnFamily(), second_key,
+                       &value));
+    ASSERT_TRUE(value.empty());
+
+    PinnableWideColumns result;
+    ASSERT_OK(db_->GetEntity(ReadOptions(), db_->DefaultColumnFamily(),
+                             first_key, &result));
+    ASSERT_EQ(result.columns(), first_columns);
+
+    ReadOptions read_options;
+    read_options.wide_column_projection = &projection;
+    ASSERT_OK(db_->GetEntity(read_options, db_->DefaultColumnFamily(),
+                             first_key, &result));
+    ASSERT_EQ(result.columns(), first_projected);
+    ASSERT_OK(db_->GetEntity(read_options, db_->DefaultColumnFamily(),
+                             second_key, &result));
+    ASSERT_EQ(result.columns(), second_projected);
+    ASSERT_OK(db_->GetEntity(read_options, db_->DefaultColumnFamily(),
+                             third_key, &result));
+    ASSERT_EQ(result.columns(), third_projected);
+
+    constexpr size_t num_keys = 3;
+    std::array<Slice, num_keys> keys{{first_key, second_key, third_key}};
+    std::array<PinnableWideColumns, num_keys> results;
+    std::array<Status, num_keys> statuses;
+    db_->MultiGetEntity(read_options, db_->DefaultColumnFamily(), num_keys,
+                        &keys[0], &results[0], &statuses[0]);
+    ASSERT_OK(statuses[0]);
+    ASSERT_EQ(results[0].columns(), first_projected);
+    ASSERT_OK(statuses[1]);
+    ASSERT_EQ(results[1].columns(), second_projected);
+    ASSERT_OK(statuses[2]);
+    ASSERT_EQ(results[2].columns(), third_projected);
+
+    // Iterators ignore the projection.
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    iter->SeekToFirst();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(iter->columns(), first_columns);
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(iter->columns(), second_columns);
+    ASSERT_OK(iter->status());
+  };
+
+  for (bool columnar : {false, true}) {
+    Options options = GetDefaultOptions();
+    options.create_if_missing = true;
+    BlockBasedTableOptions table_options;
+    table_options.data_block_columnar_entities = columnar;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    ASSERT_OK(db_->PutEntity(WriteOptions(), db_->DefaultColumnFamily(),
+                             first_key, first_columns));
+    ASSERT_OK(db_->PutEntity(WriteOptions(), db_->DefaultColumnFamily(),
+                             second_key, second_columns));
+    ASSERT_OK(db_->Put(WriteOptions(), db_->DefaultColumnFamily(), third_key,
+                       third_value));
+
+    // Memtable
+    verify();
+
+    // Table file written by flush
+    ASSERT_OK(Flush());
+    verify();
+
+    // Table file written by compaction, which reads entities back from the
+    // column sections of the flushed file
+    CompactRangeOptions cro;
+    cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+    ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+    verify();
+  }
+}
+
+TEST_F(DBWideBasicTest, ColumnarEntitiesPinnedReverseIteration) {
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator("|");
+  BlockBasedTableOptions table_options;
+  table_options.data_block_columnar_entities = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Entities in one block of one file, and merge operands for some of them in
+  // another file
+  constexpr int kNumKeys = 20;
+  auto key = [](int i) { return "key" + std::to_string(100 + i); };
+  auto default_value = [](int i) { return "value" + std::to_string(100 + i); };
+  auto is_merged = [](int i) { return i % 3 == 0; };
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(db_->PutEntity(WriteOptions(), db_->DefaultColumnFamily(),
+                             key(i),
+                             WideColumns{{kDefaultWideColumnName,
+                                          default_value(i)},
+                                         {"attr", "attr" + key(i)}}));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < kNumKeys; ++i) {
+    if (is_merged(i)) {
+      ASSERT_OK(db_->Merge(WriteOptions(), db_->DefaultColumnFamily(), key(i),
+                           "op"));
+    }
+  }
+  ASSERT_OK(Flush());
+
+  // With pin_data, the values of unmerged entities must stay valid after the
+  // iterator moves on, even though they are re-serialized from the column
+  // section of the block.
+  ReadOptions read_options;
+  read_options.pin_data = true;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  std::vector<std::pair<int, Slice>> pinned_values;
+  int i = kNumKeys - 1;
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev(), --i) {
+    ASSERT_GE(i, 0);
+    ASSERT_EQ(iter->key(), key(i));
+    if (is_merged(i)) {
+      ASSERT_EQ(iter->value(), default_value(i) + "|op");
+      ASSERT_EQ(iter->columns(),
+                (WideColumns{{kDefaultWideColumnName, default_value(i) + "|op"},
+                             {"attr", "attr" + key(i)}}));
+    } else {
+      ASSERT_EQ(iter->value(), default_value(i));
+      pinned_values.emplace_back(i, iter->value());
+    }
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(i, -1);
+  for (const auto& pinned : pinned_values) {
+    ASSERT_EQ(pinned.second, default_value(pinned.first));
+  }
+}
+
 TEST_F(DBWideBasicTest, PutEntityColumnFamily) {
   Options options = GetDefaultOptions();
   CreateAndReopenWithCF({"corinthian"}, options);
@@ -1799,6 +1799,16 @@ class MemTableInserter : public WriteBatch::Handler {
     return *reinterpret_cast<HintMap*>(&hint_);
   }
 
+  void** GetHint(MemTable* mem) {
+    if (!hint_per_batch_) {
+      return nullptr;
+    }
+    // Non-concurrent writers share the memtable's hint, allocated from its
+    // arena, instead of allocating one per batch
+    return concurrent_memtable_writes_ ? &GetHintMap()[mem]
+                                       : mem->GetSequentialInsertHint();
+  }
+
   MemPostInfoMap& GetPostMap() {
     assert(concurrent_memtable_writes_);
     if (!post_info_created_) {
@@ -1932,6 +1942,15 @@ class MemTableInserter : public WriteBatch::Handler {
     prot_info_idx_ = 0;
   }
 
+  // Sets the sequence number and protection info of the next record, which is
+  // the prot_info_idx-th of its batch, to insert records out of batch order
+  void set_next_record(const WriteBatch::ProtectionInfo* prot_info,
+                       size_t prot_info_idx, SequenceNumber sequence) {
+    prot_info_ = prot_info;
+    prot_info_idx_ = prot_info_idx;
+    sequence_ = sequence;
+  }
+
   SequenceNumber sequence() const { return sequence_; }
 
   void PostProcess() {
@@ -2023,7 +2042,7 @@ class MemTableInserter : public WriteBatch::Handler {
       ret_status =
           mem->Add(sequence_, value_type, key, value, kv_prot_info,
                    concurrent_memtable_writes_, get_post_process_info(mem),
-                   hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+                   GetHint(mem));
     } else if (moptions->inplace_callback == nullptr ||
                value_type != kTypeValue) {
       assert(!concurrent_memtable_writes_);
@@ -2187,7 +2206,7 @@ class MemTableInserter : public WriteBatch::Handler {
     ret_status =
         mem->Add(sequence_, delete_type, key, value, kv_prot_info,
                  concurrent_memtable_writes_, get_post_process_info(mem),
-                 hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+                 GetHint(mem));
     if (UNLIKELY(ret_status.IsTryAgain())) {
       assert(seq_per_batch_);
       const bool kBatchBoundary = true;
@@ -2864,6 +2883,90 @@ class MemTableInserter : public WriteBatch::Handler {
   }
 };
 
+// Whether the records of batch can be inserted out of order by
+// InsertSortedByKey()
+bool CanInsertSortedByKey(const WriteBatch* batch, bool seq_per_batch) {
+  return !seq_per_batch && !batch->HasDeleteRange() &&
+         !batch->HasBeginPrepare() && !batch->HasEndPrepare() &&
+         !batch->HasCommit() && !batch->HasRollback();
+}
+
+// Inserts the records of the batches of writers ordered by column family and
+// key, so that consecutive memtable insertions are close to each other and
+// can reuse the insert hint of the memtable. Sorting is stable, so records of
+// the same key are inserted in the order of their sequence numbers. Each
+// writer's batch must have its sequence number set.
+Status InsertSortedByKey(const autovector<WriteThread::Writer*>& writers,
+                         ColumnFamilyMemTables* memtables,
+                         MemTableInserter* inserter) {
+  struct Record {
+    WriteThread::Writer* writer;
+    const Comparator* ucmp;
+    uint32_t column_family;
+    Slice key;
+    // Offsets of the record in the batch
+    size_t begin;
+    size_t end;
+    // Index of the record among those of the batch taking a sequence number
+    size_t index;
+  };
+  std::vector<Record> records;
+  uint32_t last_column_family = 0;
+  const Comparator* last_ucmp = nullptr;
+  for (auto* w : writers) {
+    const std::string& rep = w->batch->Data();
+    Slice input(rep);
+    input.remove_prefix(WriteBatchInternal::kHeader);
+    size_t index = 0;
+    while (!input.empty()) {
+      const size_t begin = rep.size() - input.size();
+      char tag = 0;
+      uint32_t column_family = 0;
+      Slice key, value, blob, xid;
+      Status s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key,
+                                          &value, &blob, &xid);
+      if (!s.ok()) {
+        w->status = s;
+        return s;
+      }
+      if (tag == kTypeLogData || tag == kTypeNoop) {
+        continue;
+      }
+      if (last_ucmp == nullptr || column_family != last_column_family) {
+        // Records of missing column families are left to the inserter
+        last_ucmp = memtables->Seek(column_family)
+                        ? memtables->GetMemTable()
+                              ->GetInternalKeyComparator()
+                              .user_comparator()
+                        : BytewiseComparator();
+        last_column_family = column_family;
+      }
+      records.push_back({w, last_ucmp, column_family, key, begin,
+                         rep.size() - input.size(), index++});
+    }
+  }
+  std::stable_sort(records.begin(), records.end(),
+                   [](const Record& a, const Record& b) {
+                     if (a.column_family != b.column_family) {
+                       return a.column_family < b.column_family;
+                     }
+                     return a.ucmp->Compare(a.key, b.key) < 0;
+                   });
+  for (const Record& r : records) {
+    WriteThread::Writer* w = r.writer;
+    inserter->set_log_number_ref(w->log_ref);
+    inserter->set_next_record(WriteBatchInternal::GetProtectionInfo(w->batch),
+                              r.index,
+                              WriteBatchInternal::Sequence(w->batch) + r.index);
+    Status s = WriteBatchInternal::Iterate(w->batch, inserter, r.begin, r.end);
+    if (!s.ok()) {
+      w->status = s;
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
 }  // anonymous namespace
 
 // This function can only be called in these conditions:
@@ -2876,12 +2979,38 @@ Status WriteBatchInternal::InsertInto(
     ColumnFamilyMemTables* memtables, FlushScheduler* flush_scheduler,
     TrimHistoryScheduler* trim_history_scheduler,
     bool ignore_missing_column_families, uint64_t recovery_log_number, DB* db,
-    bool concurrent_memtable_writes, bool seq_per_batch, bool batch_per_txn) {
+    bool concurrent_memtable_writes, bool seq_per_batch, bool batch_per_txn,
+    bool sort_by_key) {
+  if (sort_by_key) {
+    for (auto w : write_group) {
+      if (w->ShouldWriteToMemtable() &&
+          !CanInsertSortedByKey(w->batch, seq_per_batch)) {
+        sort_by_key = false;
+        break;
+      }
+    }
+  }
   MemTableInserter inserter(
       sequence, memtables, flush_scheduler, trim_history_scheduler,
       ignore_missing_column_families, recovery_log_number, db,
       concurrent_memtable_writes, nullptr /* prot_info */,
-      nullptr /*has_valid_writes*/, seq_per_batch, batch_per_txn);
+      nullptr /*has_valid_writes*/, seq_per_batch, batch_per_txn,
+      sort_by_key /* hint_per_batch */);
+  if (sort_by_key) {
+    autovector<WriteThread::Writer*> writers;
+    for (auto w : write_group) {
+      if (w->CallbackFailed()) {
+        continue;
+      }
+      w->sequence = sequence;
+      if (w->ShouldWriteToMemtable()) {
+        SetSequence(w->batch, sequence);
+        sequence += Count(w->batch);
+        writers.push_back(w);
+      }
+    }
+    return InsertSortedByKey(writers, memtables, &inserter);
+  }
   for (auto w : write_group) {
     if (w->CallbackFailed()) {
       continue;
@@ -2911,23 +3040,32 @@ Status WriteBatchInternal::InsertInto(
     TrimHistoryScheduler* trim_history_scheduler,
     bool ignore_missing_column_families, uint64_t log_number, DB* db,
     bool concurrent_memtable_writes, bool seq_per_batch, size_t batch_cnt,
-    bool batch_per_txn, bool hint_per_batch) {
+    bool batch_per_txn, bool hint_per_batch, bool sort_by_key) {
 #ifdef NDEBUG
   (void)batch_cnt;
 #endif
   assert(writer->ShouldWriteToMemtable());
+  sort_by_key = sort_by_key && Count(writer->batch) > 1 &&
+                CanInsertSortedByKey(writer->batch, seq_per_batch);
   MemTableInserter inserter(sequence, memtables, flush_scheduler,
                             trim_history_scheduler,
                             ignore_missing_column_families, log_number, db,
                             concurrent_memtable_writes, nullptr /* prot_info */,
                             nullptr /*has_valid_writes*/, seq_per_batch,
-                            batch_per_txn, hint_per_batch);
+                            batch_per_txn, hint_per_batch || sort_by_key);
   SetSequence(writer->batch, sequence);
-  inserter.set_log_number_ref(writer->log_ref);
-  inserter.set_prot_info(writer->batch->prot_info_.get());
-  Status s = writer->batch->Iterate(&inserter);
-  assert(!seq_per_batch || batch_cnt != 0);
-  assert(!seq_per_batch || inserter.sequence() - sequence == batch_cnt);
+  Status s;
+  if (sort_by_key) {
+    autovector<WriteThread::Writer*> writers;
+    writers.push_back(writer);
+    s = InsertSortedByKey(writers, memtables, &inserter);
+  } else {
+    inserter.set_log_number_ref(writer->log_ref);
+    inserter.set_prot_info(writer->batch->prot_info_.get());
+    s = writer->batch->Iterate(&inserter);
+    assert(!seq_per_batch || batch_cnt != 0);
+    assert(!seq_per_batch || inserter.sequence() - sequence == batch_cnt);
+  }
   if (concurrent_memtable_writes) {
     inserter.PostProcess();
   }
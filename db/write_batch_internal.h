@@ -150,6 +150,11 @@ class WriteBatchInternal {
 
   static Slice Contents(const WriteBatch* batch) { return Slice(batch->rep_); }
 
+  static const WriteBatch::ProtectionInfo* GetProtectionInfo(
+      const WriteBatch* batch) {
+    return batch->prot_info_.get();
+  }
+
   static size_t ByteSize(const WriteBatch* batch) { return batch->rep_.size(); }
 
   static Status SetContents(WriteBatch* batch, const Slice& contents);
@@ -174,13 +179,19 @@ class WriteBatchInternal {
   //
   // Under concurrent use, the caller is responsible for making sure that
   // the memtables object itself is thread-local.
+  //
+  // If sort_by_key is true, the records of the group are inserted in the
+  // order of their column families and keys rather than of the group, unless
+  // a batch has range deletions or transaction markers, or seq_per_batch is
+  // true. Records of the same key keep their order.
   static Status InsertInto(
       WriteThread::WriteGroup& write_group, SequenceNumber sequence,
       ColumnFamilyMemTables* memtables, FlushScheduler* flush_scheduler,
       TrimHistoryScheduler* trim_history_scheduler,
       bool ignore_missing_column_families = false, uint64_t log_number = 0,
       DB* db = nullptr, bool concurrent_memtable_writes = false,
-      bool seq_per_batch = false, bool batch_per_txn = true);
+      bool seq_per_batch = false, bool batch_per_txn = true,
+      bool sort_by_key = false);
 
   // Convenience form of InsertInto when you have only one batch
   // next_seq returns the seq after last sequence number used in MemTable insert
@@ -202,7 +213,8 @@ class WriteBatchInternal {
                            bool concurrent_memtable_writes = false,
                            bool seq_per_batch = false, size_t batch_cnt = 0,
                            bool batch_per_txn = true,
-                           bool hint_per_batch = false);
+                           bool hint_per_batch = false,
+                           bool sort_by_key = false);
 
   // Appends src write batch to dst write batch and updates count in dst
   // write batch. Returns OK if the append is successful. Checks number of
@@ -25,6 +25,7 @@ namespace ROCKSDB_NAMESPACE {
 const std::string kCurrentFileName = "CURRENT";
 const std::string kOptionsFileNamePrefix = "OPTIONS-";
 const std::string kTempFileNameSuffix = "dbtmp";
+const std::string kBlockCacheWarmupFileName = "BLOCK_CACHE_WARMUP";
 
 static const std::string kRocksDbTFileExt = "sst";
 static const std::string kLevelDbTFileExt = "ldb";
@@ -252,6 +253,10 @@ std::string IdentityFileName(const std::string& dbname) {
   return dbname + "/IDENTITY";
 }
 
+std::string BlockCacheWarmupFileName(const std::string& dbname) {
+  return dbname + "/" + kBlockCacheWarmupFileName;
+}
+
 // Owned filenames have the form:
 //    dbname/IDENTITY
 //    dbname/CURRENT
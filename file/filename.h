@@ -147,6 +147,12 @@ extern std::string MetaDatabaseName(const std::string& dbname, uint64_t number);
 // either from a backup-image or empty
 extern std::string IdentityFileName(const std::string& dbname);
 
+extern const std::string kBlockCacheWarmupFileName;  // = "BLOCK_CACHE_WARMUP"
+
+// Return the name of the file recording the block cache contents at the last
+// clean shutdown, for DBOptions::block_cache_warmup.
+extern std::string BlockCacheWarmupFileName(const std::string& dbname);
+
 // If filename is a rocksdb file, store the type of the file in *type.
 // The number encoded in the filename is stored in *number.  If the
 // filename was successfully parsed, returns true.  Else return false.
@@ -439,6 +439,23 @@ class Cache {
   // thread-safe on pending handles.
   virtual void WaitAll(std::vector<Handle*>& /*handles*/) {}
 
+  // Records the expected latency, in microseconds, of loading entries whose
+  // keys start with `key_prefix` again after a miss, e.g. of reading the
+  // blocks of one table file (see FSRandomAccessFile::GetReadLatencyHint()).
+  // Caches with a CacheEvictionCostPolicy (see
+  // ShardedCacheOptions::eviction_cost_policy) pass it to the policy; others
+  // ignore it.
+  virtual void SetReadLatencyHint(const Slice& /*key_prefix*/,
+                                  uint64_t /*latency_us*/) {}
+
+  // Records the compression dictionary `dict` of entries whose keys start
+  // with `key_prefix`, e.g. of the blocks of one table file compressed with
+  // a dictionary. Caches pass it to their secondary cache, which may compress
+  // these entries with it (see
+  // CompressedSecondaryCacheOptions::use_compression_dict); others ignore it.
+  virtual void SetCompressionDict(const Slice& /*key_prefix*/,
+                                  const Slice& /*dict*/) {}
+
  private:
   std::shared_ptr<MemoryAllocator> memory_allocator_;
 };
@@ -516,6 +533,23 @@ class CacheWrapper : public Cache {
 
   void EraseUnRefEntries() override { target_->EraseUnRefEntries(); }
 
+  bool IsReady(Handle* handle) override { return target_->IsReady(handle); }
+
+  void Wait(Handle* handle) override { target_->Wait(handle); }
+
+  void WaitAll(std::vector<Handle*>& handles) override {
+    target_->WaitAll(handles);
+  }
+
+  void SetReadLatencyHint(const Slice& key_prefix,
+                          uint64_t latency_us) override {
+    target_->SetReadLatencyHint(key_prefix, latency_us);
+  }
+
+  void SetCompressionDict(const Slice& key_prefix, const Slice& dict) override {
+    target_->SetCompressionDict(key_prefix, dict);
+  }
+
  protected:
   std::shared_ptr<Cache> target_;
 };
@@ -367,6 +367,41 @@ struct AdvancedColumnFamilyOptions {
   // [experimental]
   double experimental_mempurge_threshold = 0.0;
 
+  // EXPERIMENTAL
+  // Store the output of mempurge in a frozen memtable: a read-only array of
+  // entries sorted by key, with keys prefix compressed like in data blocks,
+  // instead of a memtable of memtable_factory. The output then takes less
+  // memory, and so is less likely to exceed a memtable and fall back to a
+  // flush, at the cost of slower reads: point lookups and seeks binary search
+  // the array then decode entries one by one, and iterators over it copy
+  // keys and values.
+  //
+  // Only used when experimental_mempurge_threshold > 0.0.
+  //
+  // Default: false (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  bool experimental_mempurge_frozen_output = false;
+
+  // EXPERIMENTAL
+  // When a WriteBufferManager asks for a flush (see
+  // WriteBufferManager::ShouldFlush()), convert the immutable memtables of
+  // this column family into a frozen memtable (see
+  // experimental_mempurge_frozen_output), kept in memory in their place,
+  // instead of flushing them. As with mempurge, entries hidden by newer ones
+  // and not needed by a snapshot are dropped. The frozen memtable takes much
+  // less memory than the memtables it replaces, which relieves the
+  // WriteBufferManager without writing a small L0 file. When the output,
+  // which includes the frozen memtables of earlier conversions, does not fit
+  // in write_buffer_size, the memtables are flushed as usual, together.
+  //
+  // Not supported with atomic_flush.
+  //
+  // Default: false (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  bool experimental_frozen_memtable_spill = false;
+
   // existing_value - pointer to previous value (from both memtable and sst).
   //                  nullptr if key doesn't exist
   // existing_value_size - pointer to size of existing_value).
@@ -438,6 +473,20 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   bool memtable_whole_key_filtering = false;
 
+  // EXPERIMENTAL
+  // Maintain a hash index in each memtable, from user key to its newest entry,
+  // updated on every insert. A point lookup then reads the newest entry from
+  // the index rather than searching the memtable, unless that entry is a
+  // merge operand, is not visible to the read, or the column family uses
+  // user-defined timestamps. The index takes about one pointer per 256 bytes
+  // of write_buffer_size, plus two pointers per distinct key, charged to the
+  // memtable.
+  //
+  // Default: false (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  bool memtable_point_lookup_index = false;
+
   // Page size for huge page for the arena used by the memtable. If <=0, it
   // won't allocate from huge page but from malloc.
   // Users are responsible to reserve huge pages for it to be allocated. For
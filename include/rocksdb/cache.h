@@ -14,16 +14,20 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rocksdb/compression_type.h"
 #include "rocksdb/data_structure.h"
 #include "rocksdb/memory_allocator.h"
+#include "rocksdb/status.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 class Cache;  // defined in advanced_cache.h
 struct ConfigOptions;
 class SecondaryCache;
+class Slice;
+class Statistics;
 
 // Classifications of block cache entries.
 //
@@ -102,6 +106,58 @@ enum CacheMetadataChargePolicy {
 const CacheMetadataChargePolicy kDefaultCacheMetadataChargePolicy =
     kFullChargeCacheMetadata;
 
+// EXPERIMENTAL
+// Estimates the cost of a cache miss on each entry, for caches to prefer
+// evicting entries that are cheap to load again (see
+// ShardedCacheOptions::eviction_cost_policy). For example, a miss on an index
+// or filter partition, or on a block of a table file on slow (e.g. remote or
+// cold tier) storage, usually costs more than a miss on a data block of a
+// file on local flash.
+class CacheEvictionCostPolicy {
+ public:
+  // The cost of a miss on a typical entry, such as a data block of a table
+  // file on local storage. Costs are relative to this.
+  static constexpr uint32_t kTypicalMissCost = 100;
+
+  virtual ~CacheEvictionCostPolicy() {}
+
+  virtual const char* Name() const = 0;
+
+  // Returns the estimated cost of a miss on the entry with key `key` and role
+  // `role`, relative to kTypicalMissCost. Called for each insertion into the
+  // cache, possibly concurrently, so it must be thread-safe and fast.
+  virtual uint32_t GetMissCost(const Slice& key, CacheEntryRole role) = 0;
+
+  // Records the expected latency of loading entries whose keys start with
+  // `key_prefix` again, as passed to Cache::SetReadLatencyHint(). Ignored by
+  // default.
+  virtual void SetReadLatencyHint(const Slice& /*key_prefix*/,
+                                  uint64_t /*latency_us*/) {}
+};
+
+struct CacheEvictionCostPolicyOptions {
+  // Ratio of the miss cost of index, filter and other meta blocks of
+  // block-based tables to that of data blocks, which are read back with a
+  // single I/O while a miss on a meta block typically also stalls many
+  // subsequent reads (or, for partitions, reads of many data blocks).
+  double meta_block_cost_ratio = 4.0;
+
+  // The read latency, in microseconds, of entries without a read latency
+  // hint, whose miss cost is that of their role. Entries with a hint have
+  // their miss cost scaled by the ratio of the hint to this latency.
+  uint64_t default_read_latency_us = 100;
+};
+
+// Returns a CacheEvictionCostPolicy estimating the miss cost of entries from
+// their CacheEntryRole and, for block cache entries of table files whose
+// FileSystem provides FSRandomAccessFile::GetReadLatencyHint(), the read
+// latency of their file. Read latency hints are tracked by the 8-byte prefix
+// common to the block cache keys of a file, in a fixed-size table, so files
+// sharing a slot share a hint.
+extern std::shared_ptr<CacheEvictionCostPolicy> NewCacheEvictionCostPolicy(
+    const CacheEvictionCostPolicyOptions& options =
+        CacheEvictionCostPolicyOptions());
+
 // Options shared betweeen various cache implementations that
 // divide the key space into shards using hashing.
 struct ShardedCacheOptions {
@@ -135,6 +191,33 @@ struct ShardedCacheOptions {
   CacheMetadataChargePolicy metadata_charge_policy =
       kDefaultCacheMetadataChargePolicy;
 
+  // EXPERIMENTAL If true, the cache keeps a small sketch of how often keys
+  // were recently looked up (TinyLFU) and uses it as an admission filter:
+  // when inserting an entry requires evicting another, the new entry is
+  // admitted only if its estimated recent lookup frequency is higher than
+  // that of the entry that would be evicted. (So a new key typically needs a
+  // couple of lookups before it can displace an entry that was looked up
+  // once, while the aging of frequencies lets the cache adapt to a changing
+  // working set.) Otherwise the new entry is not cached; if a handle was
+  // requested it is returned as a standalone handle (charged to usage until
+  // released, as with a failed insert under strict_capacity_limit=false), and
+  // the insert fails with Status::MemoryLimit() if strict_capacity_limit is
+  // set. This protects a working set from being flushed by scans or other
+  // one-time reads, at the cost of a few bytes per entry and a little work
+  // per Lookup().
+  // Supported by LRUCache and HyperClockCache.
+  bool tiny_lfu_admission = false;
+
+  // EXPERIMENTAL If non-nullptr, the cache weighs the cost of a miss on each
+  // entry, as estimated by this policy (see NewCacheEvictionCostPolicy()),
+  // when evicting entries, rather than going by recency (and priority)
+  // alone. LRUCache evicts, among the few least recently used unreferenced
+  // entries, the one with the lowest miss cost per unit of charge; entries
+  // passed over have their miss cost halved, so that costly entries are kept
+  // longer but not indefinitely. HyperClockCache sets the initial clock
+  // countdown of entries from their miss cost rather than their priority.
+  std::shared_ptr<CacheEvictionCostPolicy> eviction_cost_policy;
+
   ShardedCacheOptions() {}
   ShardedCacheOptions(
       size_t _capacity, int _num_shard_bits, bool _strict_capacity_limit,
@@ -185,6 +268,19 @@ struct LRUCacheOptions : public ShardedCacheOptions {
   // A SecondaryCache instance to use a the non-volatile tier.
   std::shared_ptr<SecondaryCache> secondary_cache;
 
+  // EXPERIMENTAL If true, Lookup() and most Release() calls do not take the
+  // mutex of the cache shard, and only write to a per-core stripe of the
+  // shard, unless an insert, erase or eviction is in progress. Instead of
+  // moving an entry in the LRU list on each hit, Lookup() records the hit in
+  // a small lock-free buffer of that stripe, and the buffered hits are
+  // applied to the LRU list in a batch when a stripe fills up or before the
+  // next insert, erase or eviction (similar to the read buffer of Caffeine).
+  // Referenced entries stay in the LRU list until eviction reaches them.
+  // This reduces contention on the shard for lookups from many threads, at
+  // the cost of less precise recency (hits are dropped while a stripe is
+  // full) and of inserts also waiting for the lookups in progress.
+  bool use_read_buffer = false;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio,
@@ -220,6 +316,17 @@ extern std::shared_ptr<Cache> NewLRUCache(
 
 extern std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts);
 
+// EXPERIMENTAL
+// How a CompressedSecondaryCache compresses the entries of one role.
+struct CacheEntryRoleCompression {
+  CacheEntryRole role = CacheEntryRole::kMisc;
+  CompressionType type = CompressionType::kLZ4Compression;
+  // As CompressionOptions::level, where 32767
+  // (CompressionOptions::kDefaultCompressionLevel) is the default level of
+  // the compression type.
+  int level = 32767;
+};
+
 // EXPERIMENTAL
 // Options structure for configuring a SecondaryCache instance based on
 // LRUCache. The LRUCacheOptions.secondary_cache is not used and
@@ -243,6 +350,23 @@ struct CompressedSecondaryCacheOptions : LRUCacheOptions {
   // (Filter blocks are essentially non-compressible but others usually are.)
   CacheEntryRoleSet do_not_compress_roles = {CacheEntryRole::kFilterBlock};
 
+  // Compression type and level of the entries of some roles, overriding
+  // compression_type. do_not_compress_roles still applies.
+  std::vector<CacheEntryRoleCompression> role_compression;
+
+  // If true, the blocks of a table file compressed with a dictionary are
+  // also compressed with that dictionary in this cache, which compresses
+  // small blocks much better. The dictionary is passed by the table reader
+  // through Cache::SetCompressionDict() of the primary cache, once per table
+  // reader, and is pinned in this cache, charged to its capacity.
+  bool use_compression_dict = false;
+
+  // If greater than 0, entries are compressed by a pool of this many
+  // background threads, rather than by the thread inserting them, which is
+  // typically a foreground thread evicting from the primary cache. Entries
+  // are kept uncompressed, and charged as such, until they are compressed.
+  int compression_threads = 0;
+
   CompressedSecondaryCacheOptions() {}
   CompressedSecondaryCacheOptions(
       size_t _capacity, int _num_shard_bits, bool _strict_capacity_limit,
@@ -285,15 +409,251 @@ extern std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
 extern std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
     const CompressedSecondaryCacheOptions& opts);
 
+// EXPERIMENTAL
+// Counters of a CompressedSecondaryCache for the entries of one role, from
+// which its compression ratio (uncompressed_bytes / compressed_bytes) and
+// throughput (uncompressed_bytes / compress_nanos) can be derived.
+struct CompressedSecondaryCacheRoleStats {
+  // Entries compressed, and those of them compressed with a dictionary
+  uint64_t compressed_count = 0;
+  uint64_t dict_compressed_count = 0;
+  // Sizes of the compressed entries before and after compression
+  uint64_t uncompressed_bytes = 0;
+  uint64_t compressed_bytes = 0;
+  uint64_t compress_nanos = 0;
+  // Entries decompressed on lookup
+  uint64_t decompressed_count = 0;
+  uint64_t decompress_nanos = 0;
+};
+
+// Gets the counters of `sec_cache`, a cache created by
+// NewCompressedSecondaryCache(), indexed by CacheEntryRole. Returns
+// InvalidArgument for other caches.
+extern Status GetCompressedSecondaryCacheStats(
+    const std::shared_ptr<SecondaryCache>& sec_cache,
+    std::vector<CompressedSecondaryCacheRoleStats>* stats);
+
+// EXPERIMENTAL
+// Options for a tiered block cache, which stacks an LRUCache of uncompressed
+// entries, a CompressedSecondaryCache and optionally a local flash (NVM) tier.
+// The two in-memory tiers share a single capacity budget.
+struct TieredCacheOptions {
+  // Options of the primary (uncompressed) cache. The capacity and
+  // secondary_cache fields are ignored.
+  LRUCacheOptions cache_opts;
+
+  // Memory budget shared by the primary and compressed tiers.
+  size_t total_capacity = 0;
+
+  // Fraction of total_capacity given to the compressed tier, between 0 and 1.
+  // When total_capacity is changed (with Cache::SetCapacity() or
+  // UpdateTieredCache()), both tiers are resized proportionally.
+  double compressed_secondary_ratio = 0.0;
+
+  // Options of the compressed tier. The capacity field is ignored.
+  CompressedSecondaryCacheOptions comp_cache_opts;
+
+  // Optional tier below the compressed tier, typically backed by local flash
+  // (see NewPersistentSecondaryCache()). Its capacity is not part of
+  // total_capacity.
+  std::shared_ptr<SecondaryCache> nvm_sec_cache;
+
+  // Entries evicted from the primary cache are admitted to nvm_sec_cache only
+  // if they were looked up at least this many times recently, as estimated
+  // by a frequency sketch, so that the flash tier is not written with entries
+  // that were read only once. (The compressed tier has its own admission
+  // policy: an entry is only stored on its second eviction.) 0 or 1 admits
+  // all entries.
+  uint32_t nvm_admission_min_frequency = 2;
+
+  // If set, per-tier statistics are recorded here (TIERED_CACHE_* tickers).
+  std::shared_ptr<Statistics> statistics;
+};
+
+// EXPERIMENTAL
+// Creates a tiered cache. The result can be used as
+// BlockBasedTableOptions::block_cache.
+extern std::shared_ptr<Cache> NewTieredCache(const TieredCacheOptions& opts);
+
+// EXPERIMENTAL
+// Changes the memory budget and/or the compressed tier ratio of a cache
+// created by NewTieredCache(). Negative values leave a setting unchanged.
+extern Status UpdateTieredCache(const std::shared_ptr<Cache>& cache,
+                                int64_t total_capacity = -1,
+                                double compressed_secondary_ratio = -1.0);
+
+// EXPERIMENTAL
+// Options for a NUMA-aware block cache, made of one LRUCache per NUMA node.
+// Entries inserted by a thread are cached by the cache of the node that the
+// thread runs on, and lookups probe the cache of the local node before those
+// of the other nodes, so that most cache memory accesses stay on the local
+// node. The same key may be cached by more than one node.
+struct NumaAwareCacheOptions {
+  // Options of the cache of each node. The capacity is split evenly between
+  // the nodes, and num_shard_bits (or its automatic value) applies to each
+  // node's cache.
+  LRUCacheOptions cache_opts;
+
+  // Number of NUMA nodes (at most 64), or 0 for the number of nodes of the
+  // host. Without NUMA support (WITH_NUMA), the host is considered to have a
+  // single node, and if num_nodes is set the CPUs are assigned to nodes in
+  // contiguous ranges.
+  int num_nodes = 0;
+
+  // If set, one memory allocator per node, used for the values of the
+  // entries inserted on that node (through Cache::memory_allocator(), see
+  // BlockBasedTableOptions::block_cache), typically allocating from memory
+  // of that node. Otherwise cache_opts.memory_allocator is used for all
+  // nodes, and the allocations rely on the operating system placing memory
+  // on the node of the thread that first writes it.
+  std::vector<std::shared_ptr<MemoryAllocator>> node_memory_allocators;
+
+  // If true, an entry found in the cache of another node is copied into the
+  // cache of the local node, for entries supporting it (with secondary cache
+  // callbacks, like block cache entries), so that further lookups from the
+  // local node do not access remote memory.
+  bool promote_remote_hits = false;
+};
+
+// EXPERIMENTAL
+// Creates a NUMA-aware cache, or returns nullptr if the options are invalid.
+// The result can be used as BlockBasedTableOptions::block_cache.
+extern std::shared_ptr<Cache> NewNumaAwareCache(
+    const NumaAwareCacheOptions& opts);
+
+// EXPERIMENTAL
+// Lookup counters of a node of a cache created by NewNumaAwareCache(), for
+// the lookups made by threads running on that node.
+struct NumaCacheNodeStats {
+  // Lookups that found the entry in the cache of the node
+  uint64_t local_hits = 0;
+  // Lookups that found the entry in the cache of another node
+  uint64_t remote_hits = 0;
+  // Lookups that found the entry in no cache
+  uint64_t misses = 0;
+  // Remote hits copied into the cache of the node
+  uint64_t promotions = 0;
+  // Total time spent probing the caches of other nodes
+  uint64_t remote_lookup_nanos = 0;
+  // Usage of the cache of the node
+  size_t usage = 0;
+};
+
+// EXPERIMENTAL
+// Gets the counters of each node of a cache created by NewNumaAwareCache().
+extern Status GetNumaAwareCacheStats(const std::shared_ptr<Cache>& cache,
+                                     std::vector<NumaCacheNodeStats>* stats);
+
+// EXPERIMENTAL
+// Returns a view of `cache`, an LRUCache shared by several DB instances or
+// column families, for one of them (the tenant), to be used as its
+// BlockBasedTableOptions::block_cache. The entries inserted through the view
+// are charged to the tenant, and when the cache is full, eviction prefers
+// the entries of tenants using more than their soft quota of the cache
+// among the least recently used entries, so that a tenant reading a lot
+// evicts its own entries rather than those of the others. soft_quota = 0
+// means no quota.
+//
+// A tenant is identified by its name: the views of the same name (e.g. of a
+// DB instance reopened) share the usage and stats of the tenant, and the
+// soft quota of the last one created. Returns nullptr if `cache` is not an
+// LRUCache, or if it already has 255 tenants.
+extern std::shared_ptr<Cache> NewCacheTenant(
+    const std::shared_ptr<Cache>& cache, const std::string& name,
+    size_t soft_quota);
+
+// EXPERIMENTAL
+struct CacheTenantStats {
+  std::string name;
+  size_t soft_quota = 0;
+  // Total charge of the tenant's entries in the cache
+  size_t usage = 0;
+  // Lookups through the tenant's views, and the hits among them
+  uint64_t lookups = 0;
+  uint64_t hits = 0;
+};
+
+// EXPERIMENTAL
+// Gets the stats of all the tenants of a cache shared with NewCacheTenant(),
+// given the shared cache, or of one tenant given one of its views. (The
+// current tenant of a DB or column family is also available through the
+// "rocksdb.block-cache-tenant-*" DB properties.)
+extern Status GetCacheTenantStats(const std::shared_ptr<Cache>& cache,
+                                  std::vector<CacheTenantStats>* stats);
+
+// EXPERIMENTAL
+// Replacement policies of the caches simulated by NewGhostCache()
+enum class GhostCachePolicy : uint8_t {
+  kLRU,
+  // As HyperClockCache
+  kClock,
+  // LRU with TinyLFU admission, see LRUCacheOptions::tiny_lfu_admission
+  kTinyLFU,
+};
+
+// EXPERIMENTAL
+struct GhostCacheConfig {
+  size_t capacity = 0;
+  GhostCachePolicy policy = GhostCachePolicy::kLRU;
+};
+
+// EXPERIMENTAL
+struct GhostCacheOptions {
+  // The caches to simulate, typically of a range of capacities for a miss
+  // ratio curve.
+  std::vector<GhostCacheConfig> configs;
+
+  // Fraction of the keys, chosen by hash, whose lookups are simulated, each
+  // simulated cache being scaled down by the same ratio. Bounds the CPU and
+  // memory overhead of the simulation; with block cache keys, the miss
+  // ratios of small samples are typically within a few percent of the real
+  // ones.
+  double sample_ratio = 0.01;
+};
+
+// EXPERIMENTAL
+// Returns a wrapper of `cache` that also simulates the caches of `opts`,
+// live, on a sample of its lookups, to estimate the miss ratio the cache
+// would have with other capacities or replacement policies (for capacity
+// planning, without offline tracing as with the block cache simulator).
+// The simulated caches only keep the keys and charges of the sampled
+// entries. To be used as BlockBasedTableOptions::block_cache, whose
+// simulated miss ratios are then also available through the
+// "rocksdb.block-cache-miss-ratio-curve" DB property. Returns nullptr if
+// sample_ratio is not in (0, 1].
+extern std::shared_ptr<Cache> NewGhostCache(std::shared_ptr<Cache> cache,
+                                            const GhostCacheOptions& opts);
+
+// EXPERIMENTAL
+struct GhostCacheStats {
+  GhostCacheConfig config;
+  // Sampled lookups, and the hits among them
+  uint64_t lookups = 0;
+  uint64_t hits = 0;
+
+  double MissRatio() const {
+    return lookups == 0 ? 0.0
+                        : 1.0 - static_cast<double>(hits) /
+                                    static_cast<double>(lookups);
+  }
+};
+
+// EXPERIMENTAL
+// Gets the stats of each simulated cache of a cache created by
+// NewGhostCache(), in the order of GhostCacheOptions::configs. Returns
+// InvalidArgument for other caches.
+extern Status GetGhostCacheStats(const std::shared_ptr<Cache>& cache,
+                                 std::vector<GhostCacheStats>* stats);
+
 // HyperClockCache - A lock-free Cache alternative for RocksDB block cache
 // that offers much improved CPU efficiency vs. LRUCache under high parallel
 // load or high contention, with some caveats:
 // * Not a general Cache implementation: can only be used for
 // BlockBasedTableOptions::block_cache, which RocksDB uses in a way that is
 // compatible with HyperClockCache.
-// * Requires an extra tuning parameter: see estimated_entry_charge below.
-// Similarly, substantially changing the capacity with SetCapacity could
-// harm efficiency.
+// * Requires an extra tuning parameter: see estimated_entry_charge below
+// (or 0 for automatic sizing). Similarly, substantially changing the capacity
+// with SetCapacity could harm efficiency.
 // * SecondaryCache is not yet supported.
 // * Cache priorities are less aggressively enforced, which could cause
 // cache dilution from long range scans (unless they use fill_cache=false).
@@ -333,6 +693,13 @@ struct HyperClockCacheOptions : public ShardedCacheOptions {
   // GetOccupancyCount(). However, when the average value size might vary
   // (e.g. balance between metadata and data blocks in cache), it is better
   // to estimate toward the lower side than the higher side.
+  //
+  // 0 means automatic sizing (EXPERIMENTAL): the hash table of each cache
+  // shard starts small and grows, without blocking reads, as the observed
+  // average charge of the entries calls for more slots. This avoids picking
+  // a value when entry sizes are unknown or vary (e.g. different block
+  // sizes across column families), at some cost in lookup time, especially
+  // for misses.
   size_t estimated_entry_charge;
 
   HyperClockCacheOptions(
@@ -962,6 +962,12 @@ class DB {
     //      stale values more frequently to reduce overhead and latency.
     static const std::string kFastBlockCacheEntryStats;
 
+    //  "rocksdb.block-cache-miss-ratio-curve" - returns a multi-line string
+    //      or map with the estimated miss ratio of each cache simulated by
+    //      the block cache, if it was created by NewGhostCache(). The map
+    //      has keys "<policy>.<capacity>.{lookups,hits,miss_ratio}".
+    static const std::string kBlockCacheMissRatioCurve;
+
     //  "rocksdb.num-immutable-mem-table" - returns number of immutable
     //      memtables that have not yet been flushed.
     static const std::string kNumImmutableMemTable;
@@ -1129,6 +1135,21 @@ class DB {
     //      entries being pinned.
     static const std::string kBlockCachePinnedUsage;
 
+    //  "rocksdb.block-cache-tenant-usage",
+    //  "rocksdb.block-cache-tenant-lookups" and
+    //  "rocksdb.block-cache-tenant-hits" - return the usage, lookups and
+    //      lookup hits of the tenant of a block cache shared between
+    //      tenants, if the block cache is a view created by
+    //      NewCacheTenant().
+    static const std::string kBlockCacheTenantUsage;
+    static const std::string kBlockCacheTenantLookups;
+    static const std::string kBlockCacheTenantHits;
+
+    // "rocksdb.block-cache-warmup-progress" - returns the progress of
+    //      loading blocks into the block cache at DB open, with
+    //      DBOptions::block_cache_warmup.
+    static const std::string kBlockCacheWarmupProgress;
+
     // "rocksdb.options-statistics" - returns multi-line string
     //      of options.statistics
     static const std::string kOptionsStatistics;
@@ -1223,6 +1244,9 @@ class DB {
   //  "rocksdb.block-cache-capacity"
   //  "rocksdb.block-cache-usage"
   //  "rocksdb.block-cache-pinned-usage"
+  //  "rocksdb.block-cache-tenant-usage"
+  //  "rocksdb.block-cache-tenant-lookups"
+  //  "rocksdb.block-cache-tenant-hits"
   //
   //  Properties dedicated for BlobDB:
   //  "rocksdb.num-blob-files"
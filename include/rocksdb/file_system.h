@@ -919,6 +919,13 @@ class FSRandomAccessFile {
   // open.
   virtual Temperature GetTemperature() const { return Temperature::kUnknown; }
 
+  // EXPERIMENTAL
+  // When available, returns the expected latency, in microseconds, of a small
+  // random read from this file, e.g. as measured by the FileSystem for the
+  // storage tier holding it, or 0 if unknown. Used to estimate the cost of
+  // block cache misses on blocks of the file (see CacheEvictionCostPolicy).
+  virtual uint64_t GetReadLatencyHint() const { return 0; }
+
   // If you're adding methods here, remember to add them to
   // RandomAccessFileWrapper too.
 };
@@ -1611,6 +1618,9 @@ class FSRandomAccessFileWrapper : public FSRandomAccessFile {
   Temperature GetTemperature() const override {
     return target_->GetTemperature();
   }
+  uint64_t GetReadLatencyHint() const override {
+    return target_->GetReadLatencyHint();
+  }
 
  private:
   std::unique_ptr<FSRandomAccessFile> guard_;
@@ -203,4 +203,78 @@ extern const FilterPolicy* NewBloomFilterPolicy(
 extern const FilterPolicy* NewRibbonFilterPolicy(
     double bloom_equivalent_bits_per_key, int bloom_before_level = 0);
 
+// EXPERIMENTAL
+// Builds a range filter over the user keys of one SST file. Keys are added in
+// the order of the table, possibly with duplicates.
+class RangeFilterBitsBuilder {
+ public:
+  virtual ~RangeFilterBitsBuilder() {}
+
+  virtual void AddKey(const Slice& user_key) = 0;
+
+  // Generate the filter using the keys that are added, and return the
+  // contents, whose storage is transferred to `*buf`. An empty result means
+  // that no filter is stored.
+  virtual Slice Finish(std::unique_ptr<const char[]>* buf) = 0;
+};
+
+// EXPERIMENTAL
+// Answers range emptiness queries against a range filter.
+class RangeFilterBitsReader {
+ public:
+  virtual ~RangeFilterBitsReader() {}
+
+  // Returns false only if no key added to the filter is in the range
+  // [lower, upper) of user keys.
+  virtual bool MayMatchRange(const Slice& lower, const Slice& upper) const = 0;
+
+  virtual size_t ApproximateMemoryUsage() const = 0;
+};
+
+// EXPERIMENTAL
+// Determines what kind of range filter (if any) to generate in SST files.
+// Unlike FilterPolicy, which answers point or prefix membership queries, a
+// range filter can tell that an SST file has no key at all in a range of user
+// keys, independently of any prefix extractor. Block-based tables consult it
+// on Seek() when ReadOptions::iterate_upper_bound is set, so that scans of
+// empty ranges skip the file without reading any data block.
+//
+// Range filters are only built and used for column families ordered by
+// BytewiseComparator() without user-defined timestamps.
+class RangeFilterPolicy : public Customizable {
+ public:
+  virtual ~RangeFilterPolicy() {}
+  static const char* Type() { return "RangeFilterPolicy"; }
+
+  // Creates a new RangeFilterPolicy based on the input value string and
+  // returns the result. The value might be an ID and/or options, such as
+  // "rocksdb.RosettaRangeFilter:16".
+  static Status CreateFromString(
+      const ConfigOptions& config_options, const std::string& value,
+      std::shared_ptr<const RangeFilterPolicy>* result);
+
+  // Return a new RangeFilterBitsBuilder for the table file being built, or
+  // nullptr to build no range filter. The table builder owns the result.
+  virtual RangeFilterBitsBuilder* GetBuilderWithContext(
+      const FilterBuildingContext&) const = 0;
+
+  // Return a new RangeFilterBitsReader for a range filter built by a policy
+  // with the same Name(). The table reader owns the result.
+  virtual RangeFilterBitsReader* GetRangeFilterBitsReader(
+      const Slice& contents) const = 0;
+};
+
+// EXPERIMENTAL
+// Return a new range filter policy in the style of Rosetta: the prefixes of
+// the keys at a number of granularities are stored in a Bloom filter, and a
+// range is checked by probing its covering prefixes from the coarsest to the
+// finest granularity. Only the first 8 bytes of the keys are used, so the
+// filter cannot tell apart ranges within keys sharing their first 8 bytes.
+//
+// bits_per_key: average bits allocated per stored prefix. Up to 16 prefixes
+// are stored per key, fewer when keys share leading bytes, so the filter is
+// usually several times as large as a Bloom filter with the same setting.
+extern const RangeFilterPolicy* NewRosettaRangeFilterPolicy(
+    double bits_per_key);
+
 }  // namespace ROCKSDB_NAMESPACE
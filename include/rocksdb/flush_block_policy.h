@@ -9,6 +9,7 @@
 
 #include "rocksdb/customizable.h"
 #include "rocksdb/table.h"
+#include "rocksdb/types.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -32,6 +33,19 @@ class FlushBlockPolicy {
   virtual ~FlushBlockPolicy() {}
 };
 
+// Information about the table file being built, for
+// FlushBlockPolicyFactory::NewFlushBlockPolicyWithContext()
+struct FlushBlockPolicyContext {
+  TableFileCreationReason reason = TableFileCreationReason::kMisc;
+  // The level of the table file, or -1 if unknown
+  int level_at_creation = -1;
+  // Estimated reads of the files the table file is compacted from, see
+  // TableProperties::num_point_reads and num_iterator_reads. Both are 0 for
+  // table files not built by compaction.
+  uint64_t num_point_reads = 0;
+  uint64_t num_iterator_reads = 0;
+};
+
 class FlushBlockPolicyFactory : public Customizable {
  public:
   static const char* Type() { return "FlushBlockPolicyFactory"; }
@@ -53,6 +67,21 @@ class FlushBlockPolicyFactory : public Customizable {
       const BlockBasedTableOptions& table_options,
       const BlockBuilder& data_block_builder) const = 0;
 
+  // Same as NewFlushBlockPolicy(), with information about the table file
+  // being built. This is what block-based tables call, and by default it
+  // ignores `context`.
+  virtual FlushBlockPolicy* NewFlushBlockPolicyWithContext(
+      const FlushBlockPolicyContext& /*context*/,
+      const BlockBasedTableOptions& table_options,
+      const BlockBuilder& data_block_builder) const {
+    return NewFlushBlockPolicy(table_options, data_block_builder);
+  }
+
+  // Whether NewFlushBlockPolicyWithContext() uses the read counts of its
+  // context. Compactions only collect the reads of their input files, which
+  // needs their table properties, for factories that use them.
+  virtual bool UsesReadStats() const { return false; }
+
   virtual ~FlushBlockPolicyFactory() {}
 };
 
@@ -72,4 +101,59 @@ class FlushBlockBySizePolicyFactory : public FlushBlockPolicyFactory {
       const BlockBuilder& data_block_builder);
 };
 
+struct AdaptiveFlushBlockPolicyOptions {
+  static const char* kName() { return "AdaptiveFlushBlockPolicyOptions"; }
+
+  // Block size for table files whose inputs were only read by Get() and
+  // MultiGet()
+  uint64_t point_block_size = 4 * 1024;
+  // Block size for table files whose inputs were only read by iterators
+  uint64_t scan_block_size = 64 * 1024;
+  // Table files whose inputs had fewer estimated reads than this use
+  // BlockBasedTableOptions::block_size
+  uint64_t min_reads = 16 * 1024;
+};
+
+// EXPERIMENTAL
+//
+// Flushes data blocks by size like FlushBlockBySizePolicyFactory, with a
+// block size chosen per table file from how the files it is compacted from
+// were read (see TableProperties::num_point_reads and num_iterator_reads).
+// Files read by point lookups get small blocks, which read less data per
+// lookup, and files read by scans get large blocks, which need fewer reads
+// and index entries per scanned byte. In between, the block size is
+// interpolated geometrically by the share of point reads and rounded to a
+// power of two. Flushed files and files with too few reads use
+// BlockBasedTableOptions::block_size.
+//
+// It can be created from a string such as
+// "id=AdaptiveFlushBlockPolicyFactory;point_block_size=8192".
+class AdaptiveFlushBlockPolicyFactory : public FlushBlockPolicyFactory {
+ public:
+  explicit AdaptiveFlushBlockPolicyFactory(
+      const AdaptiveFlushBlockPolicyOptions& options =
+          AdaptiveFlushBlockPolicyOptions());
+
+  static const char* kClassName() { return "AdaptiveFlushBlockPolicyFactory"; }
+  const char* Name() const override { return kClassName(); }
+
+  FlushBlockPolicy* NewFlushBlockPolicy(
+      const BlockBasedTableOptions& table_options,
+      const BlockBuilder& data_block_builder) const override;
+
+  FlushBlockPolicy* NewFlushBlockPolicyWithContext(
+      const FlushBlockPolicyContext& context,
+      const BlockBasedTableOptions& table_options,
+      const BlockBuilder& data_block_builder) const override;
+
+  bool UsesReadStats() const override { return true; }
+
+  // Returns the block size for a table file built with `context`
+  uint64_t ChooseBlockSize(const FlushBlockPolicyContext& context,
+                           const BlockBasedTableOptions& table_options) const;
+
+ private:
+  AdaptiveFlushBlockPolicyOptions options_;
+};
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -386,6 +386,35 @@ class VectorRepFactory : public MemTableRepFactory {
                                          Logger* logger) override;
 };
 
+// EXPERIMENTAL
+// This creates MemTableReps that are backed by a B+-tree supporting
+// concurrent inserts and lock-free reads (optimistic lock coupling). Compared
+// to the skip list, a lookup or insert visits a few wide nodes rather than
+// chasing a pointer per level, and a scan reads entries stored next to each
+// other, which makes inserts, lookups and scans cheaper in large memtables.
+// Iterators copy the leaf they are positioned in, and do not see the entries
+// inserted into it afterwards.
+class BTreeRepFactory : public MemTableRepFactory {
+ public:
+  BTreeRepFactory() {}
+
+  // Methods for Configurable/Customizable class overrides
+  static const char* kClassName() { return "BTreeRepFactory"; }
+  static const char* kNickName() { return "btree"; }
+  const char* Name() const override { return kClassName(); }
+  const char* NickName() const override { return kNickName(); }
+
+  // Methods for MemTableRepFactory class overrides
+  using MemTableRepFactory::CreateMemTableRep;
+  MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
+                                 Allocator*, const SliceTransform*,
+                                 Logger* logger) override;
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+};
+
 // This class contains a fixed array of buckets, each
 // pointing to a skiplist (null if the bucket is empty).
 // bucket_count: number of fixed array buckets
@@ -1059,6 +1059,19 @@ struct DBOptions {
   // Default: false
   bool enable_pipelined_write = false;
 
+  // EXPERIMENTAL: If true and enable_pipelined_write is true, writes with
+  // WriteOptions::sync sync the WAL in the memtable writer queue instead of
+  // the WAL writer queue. The next write group appends to the WAL while the
+  // previous one waits for its sync, and a single sync serves all the groups
+  // appended before it started. Writes still become visible and return only
+  // once their WAL records are synced. As in the WAL writer queue, a failed
+  // sync sets a background error with paranoid_checks. Either way, it fails
+  // every later sync write until the DB is reopened. Ignored if
+  // manual_wal_flush or allow_mmap_writes is true.
+  //
+  // Default: false
+  bool enable_pipelined_wal_sync = false;
+
   // Setting unordered_write to true trades higher write throughput with
   // relaxing the immutability guarantee of snapshots. This violates the
   // repeatability one expects from ::Get from a snapshot, as well as
@@ -1095,6 +1108,19 @@ struct DBOptions {
   // Default: true
   bool allow_concurrent_memtable_write = true;
 
+  // EXPERIMENTAL: If true, the records of a write group are inserted into the
+  // memtables in key order instead of in the order of the writes, reusing
+  // the position of the previous insertion as a hint. With
+  // allow_concurrent_memtable_write, each writer of a group inserting in
+  // parallel sorts the records of its own batch. Records of the same key keep
+  // the order of their sequence numbers, and write groups with range
+  // deletions or transaction markers are inserted in order. This mainly helps
+  // workloads of random keys with many small writes, with memtables that
+  // support insert hints (SkipListFactory).
+  //
+  // Default: false
+  bool sorted_memtable_insert = false;
+
   // If true, threads synchronizing with the write batch group leader will
   // wait for up to write_thread_max_yield_usec before blocking on a mutex.
   // This can substantially improve throughput for concurrent workloads,
@@ -1393,6 +1419,27 @@ struct DBOptions {
   // of the contract leads to undefined behaviors with high possibility of data
   // inconsistency, e.g. deleted old data become visible again, etc.
   bool enforce_single_del_contracts = true;
+
+  // EXPERIMENTAL
+  // If true, the keys of data blocks held in the block cache at a clean
+  // shutdown (DB::Close() or destruction of the DB object) are recorded, as
+  // SST file number and block offset, in a compact file in the DB directory.
+  // On the next DB::Open() those blocks are read back into the block cache in
+  // the background, so that a restarted instance does not start with a cold
+  // cache. The reads are issued at Env::IO_LOW priority, so they are charged
+  // to `rate_limiter` if it is configured, and the file is deleted as soon as
+  // it has been read. Progress is reported by the DB property
+  // "rocksdb.block-cache-warmup-progress". Only column families using
+  // BlockBasedTable with a block cache are recorded.
+  //
+  // Default: false
+  bool block_cache_warmup = false;
+
+  // The number of threads reading blocks back into the block cache for
+  // `block_cache_warmup`. Values below 1 are treated as 1.
+  //
+  // Default: 4
+  int block_cache_warmup_threads = 4;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1696,6 +1743,23 @@ struct ReadOptions {
   // Default: true
   bool optimize_multiget_for_io;
 
+  // EXPERIMENTAL
+  //
+  // If not nullptr, GetEntity() and MultiGetEntity() only return the
+  // wide columns whose names are in the pointed-to vector (which must outlive
+  // the call); the other columns are dropped from the results. Use
+  // kDefaultWideColumnName for the anonymous default column. Plain key-values
+  // are returned as an entity with just the default column, so they come out
+  // empty unless it is projected. Data blocks with
+  // BlockBasedTableOptions::data_block_columnar_entities do not even decode
+  // the other columns.
+  //
+  // Merges are applied before the projection, so the result is the same as
+  // projecting the full result. Other read APIs ignore this option.
+  //
+  // Default: nullptr
+  const std::vector<Slice>* wide_column_projection = nullptr;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
@@ -261,6 +261,21 @@ struct PerfContext {
 
   uint64_t number_async_seek;
 
+  // total number of buffers for blocks not inserted into block cache that were
+  // reused from, or newly allocated by, the pool enabled by
+  // BlockBasedTableOptions::pool_uncached_block_buffers
+  uint64_t block_buffer_pool_hit_count;
+  uint64_t block_buffer_pool_miss_count;
+
+  // total number of Seek()s on SST tables whose range filter may (hit) or
+  // may not (miss) have keys before ReadOptions::iterate_upper_bound
+  uint64_t range_filter_sst_hit_count;
+  uint64_t range_filter_sst_miss_count;
+
+  // total number of mem table point lookups answered by
+  // memtable_point_lookup_index
+  uint64_t memtable_point_lookup_index_count;
+
   std::map<uint32_t, PerfContextByLevel>* level_to_perf_context = nullptr;
   bool per_level_perf_context_enabled = false;
 };
@@ -19,6 +19,8 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class SecondaryCache;
+
 // PersistentCache
 //
 // Persistent cache interface for caching IO pages on a persistent medium. The
@@ -71,4 +73,11 @@ Status NewPersistentCache(Env* const env, const std::string& path,
                           const std::shared_ptr<Logger>& log,
                           const bool optimized_for_nvm,
                           std::shared_ptr<PersistentCache>* cache);
+
+// EXPERIMENTAL
+// Returns a SecondaryCache that stores the persistable data of block cache
+// entries in `cache`, e.g. a flash tier created by NewPersistentCache(), for
+// use as TieredCacheOptions::nvm_sec_cache.
+std::shared_ptr<SecondaryCache> NewPersistentSecondaryCache(
+    const std::shared_ptr<PersistentCache>& cache);
 }  // namespace ROCKSDB_NAMESPACE
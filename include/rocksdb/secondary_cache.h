@@ -130,6 +130,12 @@ class SecondaryCache : public Customizable {
   virtual Status GetCapacity(size_t& /* capacity */) {
     return Status::NotSupported();
   }
+
+  // Records the compression dictionary of entries whose keys start with
+  // `key_prefix`, as passed to Cache::SetCompressionDict(). Ignored by
+  // default.
+  virtual void SetCompressionDict(const Slice& /*key_prefix*/,
+                                  const Slice& /*dict*/) {}
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -420,6 +420,19 @@ enum Tickers : uint32_t {
   SECONDARY_CACHE_INDEX_HITS,
   SECONDARY_CACHE_DATA_HITS,
 
+  // Tiered cache (see NewTieredCache()) stats
+  // # of lookups served by the compressed tier
+  TIERED_CACHE_COMPRESSED_HITS,
+  // # of lookups served by the NVM tier
+  TIERED_CACHE_NVM_HITS,
+  // # of entries evicted from the primary cache admitted to the NVM tier
+  TIERED_CACHE_NVM_ADMITS,
+  // # of entries evicted from the primary cache rejected by the NVM tier's
+  // admission policy
+  TIERED_CACHE_NVM_REJECTS,
+  // # of NVM tier hits offered to the compressed tier
+  TIERED_CACHE_PROMOTIONS,
+
   TICKER_ENUM_MAX
 };
 
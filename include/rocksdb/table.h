@@ -36,6 +36,7 @@ class FilterPolicy;
 class FlushBlockPolicyFactory;
 class PersistentCache;
 class RandomAccessFile;
+class RangeFilterPolicy;
 struct TableReaderOptions;
 struct TableBuilderOptions;
 class TableBuilder;
@@ -229,6 +230,17 @@ struct BlockBasedTableOptions {
     // Makes the index significantly bigger (2x or more), especially when keys
     // are long.
     kBinarySearchWithFirstKey = 0x03,
+
+    // Like kBinarySearch, but a piecewise-linear model of the index block is
+    // also built and stored in the table. Seeks in the index block use the
+    // model to predict the position of the target and only binary search a
+    // small window around the prediction, falling back to a full binary search
+    // when the prediction turns out to be wrong. The model is fitted to the
+    // first 8 bytes of the keys, so this works best for keys that grow
+    // steadily within those bytes, e.g. big-endian timestamps or sequential
+    // IDs. Only supported with BytewiseComparator; with other comparators the
+    // index behaves like kBinarySearch. Not readable by older versions.
+    kLearnedIndexSearch = 0x04,
   };
 
   IndexType index_type = kBinarySearch;
@@ -245,6 +257,62 @@ struct BlockBasedTableOptions {
   // kDataBlockBinaryAndHash.
   double data_block_hash_table_util_ratio = 0.75;
 
+  // EXPERIMENTAL
+  //
+  // By default, data blocks with more than 253 restart intervals get no hash
+  // index, even with kDataBlockBinaryAndHash. If true, such blocks get a hash
+  // index with 16-bit buckets instead, so that large blocks or small
+  // block_restart_interval values keep the benefit of the hash index. Blocks
+  // with fewer restart intervals are written as before.
+  //
+  // Blocks with 16-bit buckets cannot be read by RocksDB versions that do not
+  // support them.
+  bool data_block_hash_index_wide_buckets = false;
+
+  // EXPERIMENTAL
+  //
+  // If true, and the table's comparator is BytewiseComparator(), each data
+  // block read into memory gets a small in-memory array of fixed-width (8
+  // byte) prefixes of its restart keys. Seeks within the block then narrow
+  // the restart-point binary search with vectorized integer comparisons
+  // (AVX2 or SSE4.2 when RocksDB is built for them) before falling back to
+  // key comparisons, which reduces CPU for point lookups and seeks when keys
+  // are well distinguished by their first 8 bytes. This costs 8 bytes of
+  // memory per restart point per cached data block, charged to the block
+  // cache, and some CPU when a block is loaded. It does not change the file
+  // format and can be toggled freely.
+  bool restart_key_prefix_seek = false;
+
+  // EXPERIMENTAL
+  //
+  // If true, and the table's comparator is BytewiseComparator(), new data
+  // blocks persist the 8-byte restart key prefixes described above in a
+  // dense array after the restart array. Readers then search that array
+  // instead of the interleaved restart entries, so a seek touches far fewer
+  // cache lines, and get the benefit of `restart_key_prefix_seek` without
+  // building anything when a block is loaded. Costs 8 bytes per restart
+  // point in each data block on disk.
+  //
+  // Requires format_version >= 6, and is ignored otherwise.
+  bool data_block_restart_key_prefixes = false;
+
+  // EXPERIMENTAL
+  //
+  // If true, data blocks store the wide-column entities (see
+  // DB::PutEntity()) in a columnar (PAX) layout: each block keeps a
+  // dictionary of the column names of its entities and stores the values of
+  // each column together, and entity entries only hold small row
+  // descriptors. Point lookups that ask for a subset of the columns (see
+  // ReadOptions::wide_column_projection) and Get() (which only needs the
+  // default column) then skip decoding the other columns, and scanning a
+  // column touches fewer cache lines. Returning a whole entity requires
+  // re-serializing it, so values of such blocks are copied rather than
+  // pinned. Blocks without entities are not affected.
+  //
+  // Blocks written with this option cannot be read by RocksDB versions that
+  // do not support it.
+  bool data_block_columnar_entities = false;
+
   // Option hash_index_allow_collision is now deleted.
   // It will behave as if hash_index_allow_collision=true.
 
@@ -258,6 +326,15 @@ struct BlockBasedTableOptions {
   // point to a nullptr object.
   bool no_block_cache = false;
 
+  // If true, blocks that are read from a file but not inserted into the block
+  // cache (e.g. reads with ReadOptions::fill_cache=false, such as compaction
+  // inputs, or any read with no_block_cache) are decompressed into buffers
+  // recycled through a process-wide pool rather than newly allocated ones.
+  // This reduces allocator churn for scans at the cost of retaining up to
+  // 1MB of free buffers per CPU core. Ignored if the block cache has a
+  // MemoryAllocator. Hits and misses of the pool are reported in PerfContext.
+  bool pool_uncached_block_buffers = false;
+
   // If non-NULL use the specified cache for blocks.
   // If NULL, rocksdb will automatically create and use an 8MB internal cache.
   std::shared_ptr<Cache> block_cache = nullptr;
@@ -441,6 +518,17 @@ struct BlockBasedTableOptions {
   // NewBloomFilterPolicy() here.
   std::shared_ptr<const FilterPolicy> filter_policy = nullptr;
 
+  // EXPERIMENTAL
+  // If non-nullptr, use the specified range filter policy to build a range
+  // filter for each table file. Iterators with
+  // ReadOptions::iterate_upper_bound set consult it on Seek() to skip files
+  // that have no key in [seek key, upper bound) without reading any data
+  // block, independently of the prefix extractor. Range filters are held in
+  // table reader memory rather than in the block cache, and are only built for
+  // BytewiseComparator() without user-defined timestamps. See
+  // NewRosettaRangeFilterPolicy().
+  std::shared_ptr<const RangeFilterPolicy> range_filter_policy = nullptr;
+
   // If true, place whole keys in the filter (not just prefixes).
   // This must generally be true for gets to be efficient.
   bool whole_key_filtering = true;
@@ -512,6 +600,9 @@ struct BlockBasedTableOptions {
   // 5 -- Can be read by RocksDB's versions since 6.6.0. Full and partitioned
   // filters use a generally faster and more accurate Bloom filter
   // implementation, with a different schema.
+  // 6 -- Can be read by RocksDB's versions since 8.1.0. Data blocks can
+  // persist the prefixes of their restart keys, see
+  // `data_block_restart_key_prefixes`.
   uint32_t format_version = 5;
 
   // Store index blocks on disk in compressed format. Changing this option to
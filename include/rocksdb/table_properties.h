@@ -69,6 +69,8 @@ struct TablePropertiesNames {
   static const std::string kFileCreationTime;
   static const std::string kSlowCompressionEstimatedDataSize;
   static const std::string kFastCompressionEstimatedDataSize;
+  static const std::string kNumPointReads;
+  static const std::string kNumIteratorReads;
   static const std::string kSequenceNumberTimeMapping;
 };
 
@@ -234,6 +236,15 @@ struct TableProperties {
   // compression algorithm (see `ColumnFamilyOptions::sample_for_compression`).
   // 0 means unknown.
   uint64_t fast_compression_estimated_data_size = 0;
+  // Estimated number of user reads by Get()/MultiGet() of the files this file
+  // was compacted from, as sampled while they were live plus half of their
+  // own num_point_reads, so that older reads fade over compactions. 0 for
+  // files not created by compaction, whose inputs were not read, or whose
+  // flush block policy does not use them (see
+  // FlushBlockPolicyFactory::UsesReadStats()).
+  uint64_t num_point_reads = 0;
+  // Same as num_point_reads, for reads by iterators
+  uint64_t num_iterator_reads = 0;
   // Offset of the value of the property "external sst file global seqno" in the
   // file if the property exists.
   // 0 means not exists.
@@ -5125,6 +5125,16 @@ class TickerTypeJni {
         return -0x38;
       case ROCKSDB_NAMESPACE::Tickers::SECONDARY_CACHE_DATA_HITS:
         return -0x39;
+      case ROCKSDB_NAMESPACE::Tickers::TIERED_CACHE_COMPRESSED_HITS:
+        return -0x3A;
+      case ROCKSDB_NAMESPACE::Tickers::TIERED_CACHE_NVM_HITS:
+        return -0x3B;
+      case ROCKSDB_NAMESPACE::Tickers::TIERED_CACHE_NVM_ADMITS:
+        return -0x3C;
+      case ROCKSDB_NAMESPACE::Tickers::TIERED_CACHE_NVM_REJECTS:
+        return -0x3D;
+      case ROCKSDB_NAMESPACE::Tickers::TIERED_CACHE_PROMOTIONS:
+        return -0x3E;
       case ROCKSDB_NAMESPACE::Tickers::TICKER_ENUM_MAX:
         // 0x5F was the max value in the initial copy of tickers to Java.
         // Since these values are exposed directly to Java clients, we keep
@@ -5482,6 +5492,16 @@ class TickerTypeJni {
         return ROCKSDB_NAMESPACE::Tickers::SECONDARY_CACHE_INDEX_HITS;
       case -0x39:
         return ROCKSDB_NAMESPACE::Tickers::SECONDARY_CACHE_DATA_HITS;
+      case -0x3A:
+        return ROCKSDB_NAMESPACE::Tickers::TIERED_CACHE_COMPRESSED_HITS;
+      case -0x3B:
+        return ROCKSDB_NAMESPACE::Tickers::TIERED_CACHE_NVM_HITS;
+      case -0x3C:
+        return ROCKSDB_NAMESPACE::Tickers::TIERED_CACHE_NVM_ADMITS;
+      case -0x3D:
+        return ROCKSDB_NAMESPACE::Tickers::TIERED_CACHE_NVM_REJECTS;
+      case -0x3E:
+        return ROCKSDB_NAMESPACE::Tickers::TIERED_CACHE_PROMOTIONS;
       case 0x5F:
         // 0x5F was the max value in the initial copy of tickers to Java.
         // Since these values are exposed directly to Java clients, we keep
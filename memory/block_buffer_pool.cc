@@ -0,0 +1,134 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memory/block_buffer_pool.h"
+
+#include <cassert>
+
+#include "monitoring/perf_context_imp.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+// Every buffer is preceded by a header recording its size class, so that
+// Deallocate() can find its free list. The header size keeps the returned
+// pointer aligned like the ones returned by operator new.
+struct BufferHeader {
+  uint32_t size_class;
+};
+constexpr size_t kHeaderSize = alignof(std::max_align_t);
+static_assert(sizeof(BufferHeader) <= kHeaderSize, "header too large");
+
+// Size class of buffers that are too large to be pooled.
+constexpr uint32_t kUnpooled = UINT32_MAX;
+
+inline uint32_t SizeClassFor(size_t size) {
+  uint32_t size_class = 0;
+  while ((size_t{1} << (BlockBufferPool::kMinClassShift + size_class)) <
+         size) {
+    if (++size_class == BlockBufferPool::kNumClasses) {
+      return kUnpooled;
+    }
+  }
+  return size_class;
+}
+
+inline size_t ClassCapacity(uint32_t size_class) {
+  return size_t{1} << (BlockBufferPool::kMinClassShift + size_class);
+}
+
+inline BufferHeader* HeaderOf(void* p) {
+  return reinterpret_cast<BufferHeader*>(static_cast<char*>(p) - kHeaderSize);
+}
+
+char* NewBuffer(uint32_t size_class, size_t capacity) {
+  char* raw = new char[kHeaderSize + capacity];
+  reinterpret_cast<BufferHeader*>(raw)->size_class = size_class;
+  return raw + kHeaderSize;
+}
+
+}  // namespace
+
+BlockBufferPool* BlockBufferPool::Default() {
+  // Intentionally leaked, since buffers may be released during static
+  // destruction.
+  static BlockBufferPool* const pool = new BlockBufferPool();
+  return pool;
+}
+
+BlockBufferPool::BlockBufferPool() {}
+
+BlockBufferPool::~BlockBufferPool() {
+  for (size_t i = 0; i < shards_.Size(); ++i) {
+    for (auto& free_list : shards_.AccessAtCore(i)->free_lists) {
+      for (char* buf : free_list) {
+        delete[] reinterpret_cast<char*>(HeaderOf(buf));
+      }
+    }
+  }
+}
+
+void* BlockBufferPool::Allocate(size_t size) {
+  const uint32_t size_class = SizeClassFor(size);
+  if (size_class == kUnpooled) {
+    PERF_COUNTER_ADD(block_buffer_pool_miss_count, 1);
+    return NewBuffer(kUnpooled, size);
+  }
+  Shard* shard = shards_.Access();
+  {
+    MutexLock lock(&shard->mutex);
+    auto& free_list = shard->free_lists[size_class];
+    if (!free_list.empty()) {
+      char* buf = free_list.back();
+      free_list.pop_back();
+      shard->retained_bytes -= ClassCapacity(size_class);
+      PERF_COUNTER_ADD(block_buffer_pool_hit_count, 1);
+      return buf;
+    }
+  }
+  PERF_COUNTER_ADD(block_buffer_pool_miss_count, 1);
+  return NewBuffer(size_class, ClassCapacity(size_class));
+}
+
+void BlockBufferPool::Deallocate(void* p) {
+  if (p == nullptr) {
+    return;
+  }
+  BufferHeader* header = HeaderOf(p);
+  const uint32_t size_class = header->size_class;
+  if (size_class != kUnpooled) {
+    assert(size_class < kNumClasses);
+    const size_t capacity = ClassCapacity(size_class);
+    Shard* shard = shards_.Access();
+    MutexLock lock(&shard->mutex);
+    if (shard->retained_bytes + capacity <= kMaxRetainedBytesPerCore) {
+      shard->free_lists[size_class].push_back(static_cast<char*>(p));
+      shard->retained_bytes += capacity;
+      return;
+    }
+  }
+  delete[] reinterpret_cast<char*>(header);
+}
+
+size_t BlockBufferPool::UsableSize(void* p, size_t allocation_size) const {
+  const uint32_t size_class = HeaderOf(p)->size_class;
+  if (size_class == kUnpooled) {
+    return allocation_size;
+  }
+  return ClassCapacity(size_class);
+}
+
+size_t BlockBufferPool::TEST_RetainedBytes() const {
+  size_t total = 0;
+  for (size_t i = 0; i < shards_.Size(); ++i) {
+    Shard* shard = shards_.AccessAtCore(i);
+    MutexLock lock(&shard->mutex);
+    total += shard->retained_bytes;
+  }
+  return total;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
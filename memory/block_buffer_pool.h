@@ -0,0 +1,71 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/memory_allocator.h"
+#include "util/core_local.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// BlockBufferPool is a MemoryAllocator that recycles the buffers of blocks
+// that are read from files but not inserted into the block cache (see
+// BlockBasedTableOptions::pool_uncached_block_buffers). Such blocks live only
+// as long as the iterator or PinnableSlice using them, so without pooling,
+// scans with ReadOptions::fill_cache=false and compactions allocate and free
+// one buffer per block.
+//
+// Allocations are rounded up to power-of-two size classes and freed buffers
+// are kept in per-core free lists, up to a bounded number of bytes per core.
+// A buffer may be freed by a different thread than the one that allocated it,
+// e.g. when a pinned value is released. Since block buffers carry their
+// allocator, a buffer goes back to the pool exactly when the last reference
+// to its block is released, so pinning needs no special handling; the pool is
+// never destroyed so that it outlives every buffer.
+//
+// Allocate() records block_buffer_pool_hit_count or
+// block_buffer_pool_miss_count in the thread's PerfContext.
+class BlockBufferPool : public MemoryAllocator {
+ public:
+  static const char* kClassName() { return "BlockBufferPool"; }
+  const char* Name() const override { return kClassName(); }
+
+  // The process-wide pool.
+  static BlockBufferPool* Default();
+
+  BlockBufferPool();
+  // REQUIRES: all buffers allocated from the pool have been deallocated.
+  ~BlockBufferPool() override;
+
+  void* Allocate(size_t size) override;
+  void Deallocate(void* p) override;
+  size_t UsableSize(void* p, size_t allocation_size) const override;
+
+  // Bytes of free buffers currently retained by the pool.
+  size_t TEST_RetainedBytes() const;
+
+  static constexpr size_t kMinClassShift = 10;  // 1KB
+  static constexpr size_t kMaxClassShift = 18;  // 256KB
+  static constexpr size_t kNumClasses = kMaxClassShift - kMinClassShift + 1;
+  // Upper bound on free buffer bytes kept for each core.
+  static constexpr size_t kMaxRetainedBytesPerCore = size_t{1} << 20;
+
+ private:
+  struct alignas(CACHE_LINE_SIZE) Shard {
+    port::Mutex mutex;
+    std::array<std::vector<char*>, kNumClasses> free_lists;
+    size_t retained_bytes = 0;
+  };
+
+  CoreLocalArray<Shard> shards_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -6,12 +6,14 @@
 
 #include <cstdio>
 
+#include "memory/block_buffer_pool.h"
 #include "memory/jemalloc_nodump_allocator.h"
 #include "memory/memkind_kmem_allocator.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
+#include "rocksdb/perf_context.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "test_util/testharness.h"
 #include "utilities/memory_allocators.h"
@@ -209,6 +211,55 @@ TEST_F(CreateMemoryAllocatorTest, NewJemallocNodumpAllocator) {
   ASSERT_EQ(opts->limit_tcache_size, jopts.limit_tcache_size);
 }
 
+TEST(BlockBufferPoolTest, Recycle) {
+  BlockBufferPool pool;
+  SetPerfLevel(PerfLevel::kEnableCount);
+  get_perf_context()->Reset();
+
+  // Sizes are rounded up to a size class.
+  void* p = pool.Allocate(3000);
+  ASSERT_NE(p, nullptr);
+  ASSERT_EQ(4096u, pool.UsableSize(p, 3000));
+  memset(p, 'x', 4096);
+  pool.Deallocate(p);
+  ASSERT_EQ(4096u, pool.TEST_RetainedBytes());
+
+  // Freed buffers are reused. The thread may migrate between cores, so only
+  // check that most allocations are served from the pool.
+  const int kIterations = 100;
+  for (int i = 0; i < kIterations; ++i) {
+    p = pool.Allocate(4000);
+    pool.Deallocate(p);
+  }
+  ASSERT_EQ(kIterations + 1, get_perf_context()->block_buffer_pool_hit_count +
+                                 get_perf_context()->block_buffer_pool_miss_count);
+  ASSERT_GT(get_perf_context()->block_buffer_pool_hit_count,
+            static_cast<uint64_t>(kIterations / 2));
+
+  // Large buffers are not pooled.
+  const size_t kLarge = (size_t{1} << BlockBufferPool::kMaxClassShift) + 1;
+  const size_t retained = pool.TEST_RetainedBytes();
+  p = pool.Allocate(kLarge);
+  ASSERT_EQ(kLarge, pool.UsableSize(p, kLarge));
+  memset(p, 'x', kLarge);
+  pool.Deallocate(p);
+  ASSERT_EQ(retained, pool.TEST_RetainedBytes());
+
+  // Retention is bounded.
+  std::vector<void*> buffers;
+  for (int i = 0; i < 64; ++i) {
+    buffers.push_back(pool.Allocate(128 << 10));
+  }
+  for (void* buf : buffers) {
+    pool.Deallocate(buf);
+  }
+  // There are fewer than 2 * num_cpus + 8 per-core free lists.
+  ASSERT_LT(pool.TEST_RetainedBytes(),
+            BlockBufferPool::kMaxRetainedBytesPerCore *
+                (2 * std::thread::hardware_concurrency() + 8));
+  SetPerfLevel(PerfLevel::kDisable);
+}
+
 INSTANTIATE_TEST_CASE_P(DefaultMemoryAllocator, MemoryAllocatorTest,
                         ::testing::Values(std::make_tuple(
                             DefaultMemoryAllocator::kClassName(), true)));
@@ -0,0 +1,602 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <unordered_set>
+
+#include "db/memtable.h"
+#include "memory/allocator.h"
+#include "memory/arena.h"
+#include "port/port.h"
+#include "rocksdb/memtablerep.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+// A B+-tree of memtable entries, synchronized with optimistic lock coupling
+// ("The ART of Practical Synchronization", Leis et al.): every node has a
+// version, odd while a writer holds the node locked. Readers take no locks;
+// they read a node, then check that its version did not change, restarting
+// from the root otherwise. Writers descend the same way and only lock the
+// leaf they insert into, or the node they split and its parent.
+//
+// Entries are never removed, so nodes are never merged nor freed: a split
+// moves the upper half of a node into a new right sibling, and inserts the
+// first key of the sibling into the parent. Nodes are allocated from the
+// memtable's allocator. Inner nodes are split on the way down when full, so
+// that a parent always has room for a new child.
+//
+// There are no sibling links. Iterators copy the leaf they are positioned in,
+// and move to the next (previous) leaf by searching from the root for the
+// entries following (preceding) the copy, so they do not see the entries
+// concurrently inserted into the copied leaf.
+class BTreeRep : public MemTableRep {
+ public:
+  BTreeRep(const KeyComparator& compare, Allocator* allocator)
+      : MemTableRep(allocator), compare_(compare) {
+    root_.store(NewLeaf(), std::memory_order_release);
+  }
+
+  void Insert(KeyHandle handle) override {
+    InsertImpl(static_cast<const char*>(handle));
+  }
+
+  bool InsertKey(KeyHandle handle) override {
+    return InsertImpl(static_cast<const char*>(handle));
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** /*hint*/) override {
+    return InsertImpl(static_cast<const char*>(handle));
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    InsertImpl(static_cast<const char*>(handle));
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    return InsertImpl(static_cast<const char*>(handle));
+  }
+
+  bool InsertKeyWithHintConcurrently(KeyHandle handle,
+                                     void** /*hint*/) override {
+    return InsertImpl(static_cast<const char*>(handle));
+  }
+
+  bool Contains(const char* key) const override {
+    Iterator iter(this);
+    iter.Seek(Slice(), key);
+    return iter.Valid() && compare_(iter.key(), key) == 0;
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    Iterator iter(this);
+    for (iter.Seek(Slice(), k.memtable_key().data());
+         iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+  }
+
+  void UniqueRandomSample(const uint64_t num_entries,
+                          const uint64_t target_sample_size,
+                          std::unordered_set<const char*>* entries) override {
+    entries->clear();
+    assert(target_sample_size > 0);
+    assert(num_entries > 0);
+    // Add each entry to the sample with probability
+    // num_samples_left / (num_entries - counter)
+    Random* rnd = Random::GetTLSInstance();
+    Iterator iter(this);
+    iter.SeekToFirst();
+    uint64_t counter = 0, num_samples_left = target_sample_size;
+    for (; iter.Valid() && num_samples_left > 0 && counter < num_entries;
+         iter.Next(), counter++) {
+      if (rnd->Next() % (num_entries - counter) < num_samples_left) {
+        entries->insert(iter.key());
+        num_samples_left--;
+      }
+    }
+  }
+
+  ~BTreeRep() override {}
+
+ private:
+  static constexpr uint32_t kNodeSlots = 32;
+
+  struct Node {
+    explicit Node(bool is_leaf) : leaf(is_leaf) {}
+
+    // Odd while locked, incremented when locked and when unlocked after a
+    // change
+    std::atomic<uint64_t> version{0};
+    std::atomic<uint32_t> count{0};
+    const bool leaf;
+    // Sorted. Entries in a leaf; in an inner node, keys[i] is the first
+    // entry of the subtree children[i + 1].
+    std::atomic<const char*> keys[kNodeSlots];
+  };
+
+  struct Leaf : public Node {
+    Leaf() : Node(true) {
+      for (auto& key : keys) {
+        key.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  struct Inner : public Node {
+    Inner() : Node(false) {
+      for (auto& key : keys) {
+        key.store(nullptr, std::memory_order_relaxed);
+      }
+      for (auto& child : children) {
+        child.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    std::atomic<Node*> children[kNodeSlots + 1];
+  };
+
+  // The contents of a leaf, and the bounds of its entries when copied: all
+  // entries >= lower and < upper (nullptr if unbounded).
+  struct LeafCopy {
+    const char* keys[kNodeSlots];
+    uint32_t count = 0;
+    const char* lower = nullptr;
+    const char* upper = nullptr;
+  };
+
+  // How a search descends the tree
+  enum class Route {
+    kFirst,
+    kLast,
+    // To the subtree holding the key
+    kAtKey,
+    // To the subtree holding the entries just less than the key
+    kBeforeKey,
+  };
+
+  Leaf* NewLeaf() {
+    return new (allocator_->AllocateAligned(sizeof(Leaf))) Leaf();
+  }
+
+  Inner* NewInner() {
+    return new (allocator_->AllocateAligned(sizeof(Inner))) Inner();
+  }
+
+  // Returns the version of the node once unlocked
+  static uint64_t ReadLock(const Node* node) {
+    uint64_t version = node->version.load(std::memory_order_acquire);
+    while (version & 1) {
+      port::AsmVolatilePause();
+      version = node->version.load(std::memory_order_acquire);
+    }
+    return version;
+  }
+
+  // Whether the node did not change since ReadLock() returned version
+  static bool Validate(const Node* node, uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return node->version.load(std::memory_order_relaxed) == version;
+  }
+
+  static bool UpgradeLock(Node* node, uint64_t version) {
+    return node->version.compare_exchange_strong(version, version + 1,
+                                                 std::memory_order_acquire);
+  }
+
+  static void WriteUnlock(Node* node) {
+    node->version.fetch_add(1, std::memory_order_release);
+  }
+
+  // Unlocks a node locked by UpgradeLock(version) without changing it
+  static void Unlock(Node* node, uint64_t version) {
+    node->version.store(version, std::memory_order_release);
+  }
+
+  static uint32_t Count(const Node* node) {
+    return std::min(node->count.load(std::memory_order_acquire), kNodeSlots);
+  }
+
+  // Number of the first n keys of node less than key, or less than or equal
+  // to key with or_equal. Sets *torn if it read a slot being written.
+  uint32_t Rank(const Node* node, uint32_t n, const char* key, bool or_equal,
+                bool* torn) const {
+    uint32_t lo = 0, hi = n;
+    while (lo < hi) {
+      const uint32_t mid = (lo + hi) / 2;
+      const char* mid_key = node->keys[mid].load(std::memory_order_acquire);
+      if (mid_key == nullptr) {
+        *torn = true;
+        return 0;
+      }
+      const int cmp = compare_(mid_key, key);
+      if (cmp < 0 || (or_equal && cmp == 0)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  uint32_t ChildIndex(const Node* node, uint32_t n, const char* key,
+                      Route route, bool* torn) const {
+    switch (route) {
+      case Route::kFirst:
+        return 0;
+      case Route::kLast:
+        return n;
+      case Route::kAtKey:
+        return Rank(node, n, key, true /* or_equal */, torn);
+      case Route::kBeforeKey:
+        return Rank(node, n, key, false /* or_equal */, torn);
+    }
+    return 0;
+  }
+
+  // Copies the leaf the route leads to. Never fails, but restarts from the
+  // root while racing with writers.
+  void CopyLeaf(const char* key, Route route, LeafCopy* copy) const {
+    while (!TryCopyLeaf(key, route, copy)) {
+    }
+  }
+
+  bool TryCopyLeaf(const char* key, Route route, LeafCopy* copy) const {
+    Node* node = root_.load(std::memory_order_acquire);
+    uint64_t version = ReadLock(node);
+    if (node != root_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    const Node* parent = nullptr;
+    uint64_t parent_version = 0;
+    bool torn = false;
+    copy->lower = nullptr;
+    copy->upper = nullptr;
+    while (!node->leaf) {
+      if (parent != nullptr && !Validate(parent, parent_version)) {
+        return false;
+      }
+      const Inner* inner = static_cast<const Inner*>(node);
+      const uint32_t n = Count(inner);
+      const uint32_t pos = ChildIndex(inner, n, key, route, &torn);
+      Node* child = inner->children[pos].load(std::memory_order_acquire);
+      const char* lower =
+          pos > 0 ? inner->keys[pos - 1].load(std::memory_order_acquire)
+                  : nullptr;
+      const char* upper =
+          pos < n ? inner->keys[pos].load(std::memory_order_acquire) : nullptr;
+      if (torn || child == nullptr || (pos > 0 && lower == nullptr) ||
+          (pos < n && upper == nullptr) || !Validate(inner, version)) {
+        return false;
+      }
+      // Bounds get tighter going down
+      if (lower != nullptr) {
+        copy->lower = lower;
+      }
+      if (upper != nullptr) {
+        copy->upper = upper;
+      }
+      parent = inner;
+      parent_version = version;
+      node = child;
+      version = ReadLock(node);
+    }
+    copy->count = Count(node);
+    for (uint32_t i = 0; i < copy->count; i++) {
+      copy->keys[i] = node->keys[i].load(std::memory_order_acquire);
+      if (copy->keys[i] == nullptr) {
+        return false;
+      }
+    }
+    return Validate(node, version) &&
+           (parent == nullptr || Validate(parent, parent_version));
+  }
+
+  enum class InsertResult { kInserted, kDuplicate, kRestart };
+
+  bool InsertImpl(const char* key) {
+    InsertResult result;
+    while ((result = TryInsert(key)) == InsertResult::kRestart) {
+    }
+    return result == InsertResult::kInserted;
+  }
+
+  InsertResult TryInsert(const char* key) {
+    Node* node = root_.load(std::memory_order_acquire);
+    uint64_t version = ReadLock(node);
+    if (node != root_.load(std::memory_order_acquire)) {
+      return InsertResult::kRestart;
+    }
+    Inner* parent = nullptr;
+    uint64_t parent_version = 0;
+    bool torn = false;
+    while (!node->leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      if (inner->count.load(std::memory_order_acquire) >= kNodeSlots) {
+        Split(parent, parent_version, inner, version, key);
+        return InsertResult::kRestart;
+      }
+      if (parent != nullptr && !Validate(parent, parent_version)) {
+        return InsertResult::kRestart;
+      }
+      const uint32_t pos =
+          Rank(inner, Count(inner), key, true /* or_equal */, &torn);
+      Node* child = inner->children[pos].load(std::memory_order_acquire);
+      if (torn || child == nullptr || !Validate(inner, version)) {
+        return InsertResult::kRestart;
+      }
+      parent = inner;
+      parent_version = version;
+      node = child;
+      version = ReadLock(node);
+    }
+
+    if (node->count.load(std::memory_order_acquire) >= kNodeSlots) {
+      Split(parent, parent_version, node, version, key);
+      return InsertResult::kRestart;
+    }
+    if (!UpgradeLock(node, version)) {
+      return InsertResult::kRestart;
+    }
+    if (parent != nullptr && !Validate(parent, parent_version)) {
+      Unlock(node, version);
+      return InsertResult::kRestart;
+    }
+    // Locked and routed to the right leaf, which has room
+    const uint32_t n = node->count.load(std::memory_order_relaxed);
+    const uint32_t pos = Rank(node, n, key, false /* or_equal */, &torn);
+    assert(!torn);
+    if (pos < n &&
+        compare_(node->keys[pos].load(std::memory_order_relaxed), key) == 0) {
+      Unlock(node, version);
+      return InsertResult::kDuplicate;
+    }
+    for (uint32_t i = n; i > pos; i--) {
+      node->keys[i].store(node->keys[i - 1].load(std::memory_order_relaxed),
+                          std::memory_order_release);
+    }
+    node->keys[pos].store(key, std::memory_order_release);
+    node->count.store(n + 1, std::memory_order_release);
+    WriteUnlock(node);
+    return InsertResult::kInserted;
+  }
+
+  // Splits a full node, read at version, under parent, read at
+  // parent_version, if neither changed since. key is the entry being
+  // inserted.
+  void Split(Inner* parent, uint64_t parent_version, Node* node,
+             uint64_t version, const char* key) {
+    if (parent != nullptr && !UpgradeLock(parent, parent_version)) {
+      return;
+    }
+    if (!UpgradeLock(node, version)) {
+      if (parent != nullptr) {
+        Unlock(parent, parent_version);
+      }
+      return;
+    }
+    if (parent == nullptr && node != root_.load(std::memory_order_relaxed)) {
+      Unlock(node, version);
+      return;
+    }
+    // Parents were split on the way down if full
+    assert(parent == nullptr ||
+           parent->count.load(std::memory_order_relaxed) < kNodeSlots);
+
+    const uint32_t n = node->count.load(std::memory_order_relaxed);
+    const char* separator;
+    Node* sibling;
+    if (node->leaf) {
+      // Keep leaves full when appending in order
+      const uint32_t left =
+          compare_(node->keys[n - 1].load(std::memory_order_relaxed), key) < 0
+              ? n - 1
+              : n / 2;
+      Leaf* right = NewLeaf();
+      for (uint32_t i = left; i < n; i++) {
+        right->keys[i - left].store(
+            node->keys[i].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+      }
+      right->count.store(n - left, std::memory_order_relaxed);
+      separator = node->keys[left].load(std::memory_order_relaxed);
+      node->count.store(left, std::memory_order_release);
+      sibling = right;
+    } else {
+      // The middle key moves up
+      const uint32_t left = n / 2;
+      Inner* inner = static_cast<Inner*>(node);
+      Inner* right = NewInner();
+      for (uint32_t i = left + 1; i < n; i++) {
+        right->keys[i - left - 1].store(
+            inner->keys[i].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+      }
+      for (uint32_t i = left + 1; i <= n; i++) {
+        right->children[i - left - 1].store(
+            inner->children[i].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+      }
+      right->count.store(n - left - 1, std::memory_order_relaxed);
+      separator = inner->keys[left].load(std::memory_order_relaxed);
+      inner->count.store(left, std::memory_order_release);
+      sibling = right;
+    }
+
+    if (parent != nullptr) {
+      const uint32_t parent_n = parent->count.load(std::memory_order_relaxed);
+      bool torn = false;
+      const uint32_t pos =
+          Rank(parent, parent_n, separator, false /* or_equal */, &torn);
+      assert(!torn);
+      for (uint32_t i = parent_n; i > pos; i--) {
+        parent->keys[i].store(
+            parent->keys[i - 1].load(std::memory_order_relaxed),
+            std::memory_order_release);
+        parent->children[i + 1].store(
+            parent->children[i].load(std::memory_order_relaxed),
+            std::memory_order_release);
+      }
+      parent->keys[pos].store(separator, std::memory_order_release);
+      parent->children[pos + 1].store(sibling, std::memory_order_release);
+      parent->count.store(parent_n + 1, std::memory_order_release);
+      WriteUnlock(node);
+      WriteUnlock(parent);
+    } else {
+      Inner* root = NewInner();
+      root->keys[0].store(separator, std::memory_order_relaxed);
+      root->children[0].store(node, std::memory_order_relaxed);
+      root->children[1].store(sibling, std::memory_order_relaxed);
+      root->count.store(1, std::memory_order_relaxed);
+      root_.store(root, std::memory_order_release);
+      WriteUnlock(node);
+    }
+  }
+
+ public:
+  // Iteration over the contents of the tree
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const BTreeRep* rep) : rep_(rep) {}
+
+    ~Iterator() override {}
+
+    bool Valid() const override { return pos_ < copy_.count; }
+
+    const char* key() const override {
+      assert(Valid());
+      return copy_.keys[pos_];
+    }
+
+    void Next() override {
+      assert(Valid());
+      if (pos_ + 1 < copy_.count) {
+        pos_++;
+      } else {
+        SeekForward(copy_.keys[pos_], true /* exclusive */);
+      }
+    }
+
+    void Prev() override {
+      assert(Valid());
+      if (pos_ > 0) {
+        pos_--;
+      } else {
+        SeekBackward(copy_.keys[0], true /* exclusive */);
+      }
+    }
+
+    // Advance to the first entry with a key >= target
+    void Seek(const Slice& internal_key, const char* memtable_key) override {
+      SeekForward(memtable_key != nullptr ? memtable_key
+                                          : EncodeKey(&tmp_, internal_key),
+                  false /* exclusive */);
+    }
+
+    // Retreat to the last entry with a key <= target
+    void SeekForPrev(const Slice& internal_key,
+                     const char* memtable_key) override {
+      SeekBackward(memtable_key != nullptr ? memtable_key
+                                           : EncodeKey(&tmp_, internal_key),
+                   false /* exclusive */);
+    }
+
+    void SeekToFirst() override { SeekForward(nullptr, false); }
+
+    void SeekToLast() override { SeekBackward(nullptr, false); }
+
+   private:
+    // Number of copied entries less than key, or less than or equal to key
+    // with or_equal
+    uint32_t Rank(const char* key, bool or_equal) const {
+      uint32_t lo = 0, hi = copy_.count;
+      while (lo < hi) {
+        const uint32_t mid = (lo + hi) / 2;
+        const int cmp = rep_->compare_(copy_.keys[mid], key);
+        if (cmp < 0 || (or_equal && cmp == 0)) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      return lo;
+    }
+
+    // Positions at the first entry > key (>= key if not exclusive), or the
+    // first entry if key is nullptr
+    void SeekForward(const char* key, bool exclusive) {
+      Route route = key == nullptr ? Route::kFirst : Route::kAtKey;
+      while (true) {
+        rep_->CopyLeaf(key, route, &copy_);
+        pos_ = key == nullptr ? 0 : Rank(key, exclusive);
+        if (pos_ < copy_.count || copy_.upper == nullptr) {
+          return;
+        }
+        // Continue with the next leaf
+        key = copy_.upper;
+        route = Route::kAtKey;
+        exclusive = false;
+      }
+    }
+
+    // Positions at the last entry < key (<= key if not exclusive), or the
+    // last entry if key is nullptr
+    void SeekBackward(const char* key, bool exclusive) {
+      Route route = key == nullptr
+                        ? Route::kLast
+                        : (exclusive ? Route::kBeforeKey : Route::kAtKey);
+      while (true) {
+        rep_->CopyLeaf(key, route, &copy_);
+        const uint32_t end = key == nullptr ? copy_.count : Rank(key, !exclusive);
+        if (end > 0) {
+          pos_ = end - 1;
+          return;
+        }
+        if (copy_.lower == nullptr) {
+          pos_ = copy_.count;
+          return;
+        }
+        // Continue with the previous leaf
+        key = copy_.lower;
+        route = Route::kBeforeKey;
+        exclusive = true;
+      }
+    }
+
+    const BTreeRep* rep_;
+    LeafCopy copy_;
+    uint32_t pos_ = 0;
+    std::string tmp_;  // For passing to EncodeKey
+  };
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    void* mem = arena ? arena->AllocateAligned(sizeof(BTreeRep::Iterator))
+                      : operator new(sizeof(BTreeRep::Iterator));
+    return new (mem) BTreeRep::Iterator(this);
+  }
+
+ private:
+  const KeyComparator& compare_;
+  std::atomic<Node*> root_;
+};
+}  // namespace
+
+MemTableRep* BTreeRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* /*transform*/, Logger* /*logger*/) {
+  return new BTreeRep(compare, allocator);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
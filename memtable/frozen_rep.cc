@@ -0,0 +1,331 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+#include "memtable/frozen_rep.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "db/memtable.h"
+#include "memory/allocator.h"
+#include "memory/arena.h"
+#include "rocksdb/memtablerep.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+// Entries are appended to chunks of the allocator as records, in groups of
+// up to kRestartInterval records. The first record of a group (a restart) is
+// the length of the entry followed by the entry itself, so that restarts can
+// be binary searched and returned without copying. The other records only
+// store the internal key suffix not shared with the previous record:
+//
+//   shared     : varint32 of the length of the prefix shared with the
+//                previous internal key
+//   non_shared : varint32 of the length of the rest of the internal key
+//   rest_size  : varint32 of the length of the entry after the internal key
+//   key delta  : char[non_shared]
+//   rest       : char[rest_size] (value size, value and checksum)
+//
+// A group never spans two chunks.
+class FrozenRep : public MemTableRep {
+ public:
+  FrozenRep(const KeyComparator& compare, Allocator* allocator)
+      : MemTableRep(allocator), compare_(compare) {}
+
+  KeyHandle Allocate(const size_t len, char** buf) override {
+    scratch_.resize(len);
+    *buf = &scratch_[0];
+    return static_cast<KeyHandle>(*buf);
+  }
+
+  void Insert(KeyHandle handle) override {
+    bool res = InsertKey(handle);
+    assert(res);
+    (void)res;
+  }
+
+  bool InsertKey(KeyHandle handle) override {
+    const char* entry = static_cast<const char*>(handle);
+    assert(entry == scratch_.data());
+    const Slice internal_key = GetLengthPrefixedSlice(entry);
+    if (!groups_.empty() && compare_(entry, Slice(last_key_)) <= 0) {
+      return false;
+    }
+    const char* rest = internal_key.data() + internal_key.size();
+    const size_t rest_size = scratch_.size() - (rest - entry);
+
+    bool restart = groups_.empty() || group_size_ == kRestartInterval;
+    size_t shared = 0;
+    if (!restart) {
+      const size_t limit = std::min(last_key_.size(), internal_key.size());
+      while (shared < limit && last_key_[shared] == internal_key[shared]) {
+        shared++;
+      }
+    }
+    const size_t non_shared = internal_key.size() - shared;
+    size_t record_size =
+        VarintLength(shared) + VarintLength(non_shared) +
+        VarintLength(rest_size) + non_shared + rest_size;
+    if (restart || record_size > static_cast<size_t>(limit_ - cur_)) {
+      record_size = VarintLength(scratch_.size()) + scratch_.size();
+      if (record_size > static_cast<size_t>(limit_ - cur_)) {
+        const size_t chunk_size = std::max(kChunkSize, record_size);
+        cur_ = allocator_->Allocate(chunk_size);
+        limit_ = cur_ + chunk_size;
+      }
+      restart = true;
+    }
+
+    char* p = cur_;
+    if (restart) {
+      p = EncodeVarint32(p, static_cast<uint32_t>(scratch_.size()));
+      memcpy(p, entry, scratch_.size());
+      p += scratch_.size();
+      groups_.push_back({cur_, p});
+      group_size_ = 1;
+    } else {
+      p = EncodeVarint32(p, static_cast<uint32_t>(shared));
+      p = EncodeVarint32(p, static_cast<uint32_t>(non_shared));
+      p = EncodeVarint32(p, static_cast<uint32_t>(rest_size));
+      memcpy(p, internal_key.data() + shared, non_shared);
+      p += non_shared;
+      memcpy(p, rest, rest_size);
+      p += rest_size;
+      groups_.back().end = p;
+      group_size_++;
+    }
+    assert(static_cast<size_t>(p - cur_) == record_size);
+    cur_ = p;
+    last_key_.assign(internal_key.data(), internal_key.size());
+    return true;
+  }
+
+  bool InsertKeyWithHint(KeyHandle handle, void** /*hint*/) override {
+    return InsertKey(handle);
+  }
+
+  bool Contains(const char* key) const override {
+    const Slice internal_key = GetLengthPrefixedSlice(key);
+    Iterator iter(this);
+    iter.Seek(internal_key, nullptr);
+    return iter.Valid() && compare_(iter.key(), internal_key) == 0;
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    // Records are in the allocator
+    return groups_.capacity() * sizeof(Group) + scratch_.capacity() +
+           last_key_.capacity();
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    Iterator iter(this);
+    for (iter.Seek(k.internal_key(), nullptr);
+         iter.Valid() && callback_func(callback_args, iter.key());
+         iter.Next()) {
+    }
+  }
+
+  // Samples the first entry of restart intervals, the only entries which
+  // are stored as is
+  void UniqueRandomSample(const uint64_t num_entries,
+                          const uint64_t target_sample_size,
+                          std::unordered_set<const char*>* entries) override {
+    (void)num_entries;
+    const uint64_t num_groups = groups_.size();
+    uint64_t needed = std::min(target_sample_size, num_groups);
+    Random64 rnd(301);
+    for (uint64_t i = 0; i < num_groups && needed > 0; i++) {
+      if (rnd.Uniform(num_groups - i) < needed) {
+        entries->insert(RestartEntry(i));
+        needed--;
+      }
+    }
+  }
+
+  ~FrozenRep() override {}
+
+ private:
+  static constexpr size_t kRestartInterval = 16;
+  static constexpr size_t kChunkSize = 4096;
+
+  struct Group {
+    const char* begin;
+    const char* end;
+  };
+
+  const char* RestartEntry(size_t group) const {
+    const char* p = groups_[group].begin;
+    uint32_t entry_size = 0;
+    return GetVarint32Ptr(p, p + 5, &entry_size);
+  }
+
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const FrozenRep* rep)
+        : rep_(rep), group_(rep->groups_.size()) {}
+    ~Iterator() override {}
+
+    bool Valid() const override { return group_ < rep_->groups_.size(); }
+
+    const char* key() const override {
+      assert(Valid());
+      return entry_;
+    }
+
+    void Next() override {
+      assert(Valid());
+      if (next_ < rep_->groups_[group_].end) {
+        ParseRecord(next_);
+      } else if (++group_ < rep_->groups_.size()) {
+        ParseRecord(rep_->groups_[group_].begin);
+      }
+    }
+
+    void Prev() override {
+      assert(Valid());
+      const char* target = record_;
+      if (target == rep_->groups_[group_].begin) {
+        if (group_ == 0) {
+          group_ = rep_->groups_.size();
+          return;
+        }
+        group_--;
+        target = rep_->groups_[group_].end;
+      }
+      // Records can only be decoded forward from the restart
+      ParseRecord(rep_->groups_[group_].begin);
+      while (next_ != target) {
+        ParseRecord(next_);
+      }
+    }
+
+    void Seek(const Slice& internal_key,
+              const char* /*memtable_key*/) override {
+      const auto& groups = rep_->groups_;
+      // Find the last group starting before the target
+      size_t left = 0;
+      size_t right = groups.size();
+      while (left < right) {
+        const size_t mid = left + (right - left) / 2;
+        if (rep_->compare_(rep_->RestartEntry(mid), internal_key) < 0) {
+          left = mid + 1;
+        } else {
+          right = mid;
+        }
+      }
+      group_ = left > 0 ? left - 1 : 0;
+      if (group_ >= groups.size()) {
+        return;
+      }
+      ParseRecord(groups[group_].begin);
+      while (Valid() && rep_->compare_(entry_, internal_key) < 0) {
+        Next();
+      }
+    }
+
+    void SeekForPrev(const Slice& internal_key,
+                     const char* /*memtable_key*/) override {
+      Seek(internal_key, nullptr);
+      if (!Valid()) {
+        SeekToLast();
+      }
+      while (Valid() && rep_->compare_(entry_, internal_key) > 0) {
+        Prev();
+      }
+    }
+
+    void SeekToFirst() override {
+      group_ = 0;
+      if (Valid()) {
+        ParseRecord(rep_->groups_[group_].begin);
+      }
+    }
+
+    void SeekToLast() override {
+      group_ = rep_->groups_.size();
+      if (group_ == 0) {
+        return;
+      }
+      group_--;
+      const char* end = rep_->groups_[group_].end;
+      ParseRecord(rep_->groups_[group_].begin);
+      while (next_ != end) {
+        ParseRecord(next_);
+      }
+    }
+
+   private:
+    // Positions the iterator at the record starting at p, which must be the
+    // restart of the current group or follow the current record
+    void ParseRecord(const char* p) {
+      record_ = p;
+      if (p == rep_->groups_[group_].begin) {
+        uint32_t entry_size = 0;
+        entry_ = GetVarint32Ptr(p, p + 5, &entry_size);
+        next_ = entry_ + entry_size;
+        const Slice internal_key = GetLengthPrefixedSlice(entry_);
+        key_.assign(internal_key.data(), internal_key.size());
+        return;
+      }
+      uint32_t shared = 0;
+      uint32_t non_shared = 0;
+      uint32_t rest_size = 0;
+      p = GetVarint32Ptr(p, p + 5, &shared);
+      p = GetVarint32Ptr(p, p + 5, &non_shared);
+      p = GetVarint32Ptr(p, p + 5, &rest_size);
+      assert(shared <= key_.size());
+      key_.resize(shared);
+      key_.append(p, non_shared);
+      p += non_shared;
+      buf_.clear();
+      PutVarint32(&buf_, static_cast<uint32_t>(key_.size()));
+      buf_.append(key_);
+      buf_.append(p, rest_size);
+      entry_ = buf_.data();
+      next_ = p + rest_size;
+    }
+
+    const FrozenRep* const rep_;
+    size_t group_;
+    const char* record_ = nullptr;
+    const char* next_ = nullptr;
+    // The current entry, either in the allocator or in buf_
+    const char* entry_ = nullptr;
+    std::string key_;
+    std::string buf_;
+  };
+
+ public:
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    void* mem = arena ? arena->AllocateAligned(sizeof(FrozenRep::Iterator))
+                      : operator new(sizeof(FrozenRep::Iterator));
+    return new (mem) FrozenRep::Iterator(this);
+  }
+
+ private:
+  const KeyComparator& compare_;
+  std::vector<Group> groups_;
+  size_t group_size_ = 0;
+  char* cur_ = nullptr;
+  char* limit_ = nullptr;
+  // The entry being added, between Allocate() and InsertKey()
+  std::string scratch_;
+  std::string last_key_;
+};
+
+}  // anonymous namespace
+
+MemTableRep* NewFrozenRep(const MemTableRep::KeyComparator& compare,
+                          Allocator* allocator) {
+  return new FrozenRep(compare, allocator);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,27 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include "rocksdb/memtablerep.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Allocator;
+
+// Returns the representation of a frozen memtable: a read-only array of
+// entries sorted by key, stored in the allocator with the keys prefix
+// compressed, like the entries of a data block.
+//
+// Entries must be inserted in increasing key order by a single writer before
+// the memtable is read, which is how MemPurge builds its output memtable.
+// InsertKey() returns false for an entry out of order. Since entries other
+// than the first of each restart interval are decoded into the iterator, the
+// entries passed to callers are only valid until the iterator moves, or the
+// Get() callback returns.
+MemTableRep* NewFrozenRep(const MemTableRep::KeyComparator& compare,
+                          Allocator* allocator);
+
+}  // namespace ROCKSDB_NAMESPACE
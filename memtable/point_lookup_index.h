@@ -0,0 +1,116 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "db/dbformat.h"
+#include "memory/allocator.h"
+#include "rocksdb/slice.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Logger;
+
+// A hash index of memtable entries by user key, holding the entry with the
+// highest sequence number of each key. Add() is lock-free and may be called
+// concurrently with Add() and Find(). Entries are never removed, and nodes
+// are allocated from the memtable's allocator.
+//
+// Entries are in the memtable format (see MemTable::Add()). User keys are
+// compared as bytes, like those added to the memtable Bloom filter.
+class PointLookupIndex {
+ public:
+  PointLookupIndex(Allocator* allocator, size_t num_buckets,
+                   size_t huge_page_tlb_size = 0, Logger* logger = nullptr)
+      : allocator_(allocator), num_buckets_(num_buckets > 0 ? num_buckets : 1) {
+    char* raw = allocator_->AllocateAligned(
+        num_buckets_ * sizeof(std::atomic<Node*>), huge_page_tlb_size, logger);
+    buckets_ = reinterpret_cast<std::atomic<Node*>*>(raw);
+    for (size_t i = 0; i < num_buckets_; i++) {
+      new (&buckets_[i]) std::atomic<Node*>(nullptr);
+    }
+  }
+
+  // Records entry as the newest of its user key, unless the index holds a
+  // newer one
+  void Add(const char* entry) {
+    const Slice user_key = UserKeyOf(entry);
+    const SequenceNumber seq = SeqOf(entry);
+    std::atomic<Node*>& bucket = GetBucket(user_key);
+    Node* head = bucket.load(std::memory_order_acquire);
+    Node* node = nullptr;
+    while (true) {
+      for (Node* n = head; n != nullptr; n = n->next) {
+        const char* cur = n->entry.load(std::memory_order_acquire);
+        if (UserKeyOf(cur) == user_key) {
+          while (SeqOf(cur) < seq && !n->entry.compare_exchange_weak(
+                                         cur, entry, std::memory_order_release,
+                                         std::memory_order_acquire)) {
+          }
+          // A node allocated for a previous attempt is left unused
+          return;
+        }
+      }
+      if (node == nullptr) {
+        node = new (allocator_->AllocateAligned(sizeof(Node))) Node();
+        node->entry.store(entry, std::memory_order_relaxed);
+      }
+      node->next = head;
+      if (bucket.compare_exchange_weak(head, node, std::memory_order_release,
+                                       std::memory_order_acquire)) {
+        return;
+      }
+      // Another key was added to the bucket, maybe this one
+    }
+  }
+
+  // Returns the newest entry of user_key, or nullptr if there is none
+  const char* Find(const Slice& user_key) const {
+    for (Node* n = GetBucket(user_key).load(std::memory_order_acquire);
+         n != nullptr; n = n->next) {
+      const char* entry = n->entry.load(std::memory_order_acquire);
+      if (UserKeyOf(entry) == user_key) {
+        return entry;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  struct Node {
+    std::atomic<const char*> entry;
+    // Immutable once the node is in a bucket
+    Node* next = nullptr;
+  };
+
+  static Slice UserKeyOf(const char* entry) {
+    uint32_t key_length = 0;
+    const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+    assert(key_length >= 8);
+    return Slice(key_ptr, key_length - 8);
+  }
+
+  static SequenceNumber SeqOf(const char* entry) {
+    const Slice user_key = UserKeyOf(entry);
+    return DecodeFixed64(user_key.data() + user_key.size()) >> 8;
+  }
+
+  std::atomic<Node*>& GetBucket(const Slice& user_key) const {
+    return buckets_[GetSliceRangedNPHash(user_key, num_buckets_)];
+  }
+
+  Allocator* const allocator_;
+  const size_t num_buckets_;
+  std::atomic<Node*>* buckets_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,86 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// A micro-benchmark for seeking within a single in-memory data block, with
+// and without BlockBasedTableOptions::restart_key_prefix_seek.
+#include "benchmark/benchmark.h"
+#include "db/dbformat.h"
+#include "rocksdb/comparator.h"
+#include "table/block_based/block.h"
+#include "table/block_based/block_builder.h"
+#include "util/coding.h"
+#include "util/math.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// benchmark arguments:
+// 0. data block size in bytes
+// 1. restart_key_prefix_seek (0 or 1)
+// 2. user key length
+// 3. block_restart_interval
+static void CustomArguments(benchmark::internal::Benchmark *b) {
+  for (int64_t block_size : {4 << 10, 16 << 10, 64 << 10}) {
+    for (int64_t prefix_seek : {0, 1}) {
+      for (int64_t key_len : {16, 48}) {
+        for (int64_t restart_interval : {4, 16}) {
+          b->Args({block_size, prefix_seek, key_len, restart_interval});
+        }
+      }
+    }
+  }
+  b->ArgNames(
+      {"block_size", "prefix_seek", "key_len", "restart_interval"});
+}
+
+static void DataBlockSeek(benchmark::State &state) {
+  const size_t kBlockSize = static_cast<size_t>(state.range(0));
+  const bool kPrefixSeek = state.range(1) != 0;
+  const size_t kKeyLen = static_cast<size_t>(state.range(2));
+  const int kRestartInterval = static_cast<int>(state.range(3));
+  const size_t kValueLen = 32;
+
+  // Build a block of sorted keys filled up to the target size. Keys begin
+  // with a big-endian counter so that restart keys are ordered and mostly
+  // distinguished within the first 8 bytes, as for timestamp or ID keys.
+  Random rnd(301);
+  std::vector<std::string> keys;
+  BlockBuilder builder(kRestartInterval);
+  std::string value = rnd.RandomString(static_cast<int>(kValueLen));
+  for (uint64_t i = 0; builder.CurrentSizeEstimate() < kBlockSize; ++i) {
+    std::string key;
+    PutFixed64(&key, 0);
+    EncodeFixed64(&key[0], EndianSwapValue(i * 16));
+    key += rnd.RandomString(static_cast<int>(kKeyLen - 8));
+    AppendInternalKeyFooter(&key, 0 /* seqno */, kTypeValue);
+    builder.Add(key, value);
+    keys.push_back(std::move(key));
+  }
+  Slice raw = builder.Finish();
+  BlockContents contents;
+  contents.data = raw;
+  Block block(std::move(contents), 0 /* read_amp_bytes_per_bit */,
+              nullptr /* statistics */, kPrefixSeek);
+  std::unique_ptr<DataBlockIter> iter(block.NewDataIterator(
+      BytewiseComparator(), kDisableGlobalSequenceNumber));
+
+  size_t found = 0;
+  size_t i = 0;
+  for (auto _ : state) {
+    iter->Seek(keys[i]);
+    found += iter->Valid() ? 1 : 0;
+    i = (i + 7919) % keys.size();
+  }
+  if (found == 0) {
+    state.SkipWithError("no key found");
+  }
+  state.counters["num_restarts"] = static_cast<double>(block.NumRestarts());
+  state.counters["num_keys"] = static_cast<double>(keys.size());
+}
+BENCHMARK(DataBlockSeek)->Apply(CustomArguments);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
@@ -11,6 +11,7 @@ namespace ROCKSDB_NAMESPACE {
 static const uint32_t kFileReadSampleRate = 1024;
 extern bool should_sample_file_read();
 extern void sample_file_read_inc(FileMetaData*);
+extern void sample_file_point_read_inc(FileMetaData*);
 
 inline bool should_sample_file_read() {
   return (Random::GetTLSInstance()->Next() % kFileReadSampleRate == 307);
@@ -20,4 +21,10 @@ inline void sample_file_read_inc(FileMetaData* meta) {
   meta->stats.num_reads_sampled.fetch_add(kFileReadSampleRate,
                                           std::memory_order_relaxed);
 }
+
+inline void sample_file_point_read_inc(FileMetaData* meta) {
+  sample_file_read_inc(meta);
+  meta->stats.num_point_reads_sampled.fetch_add(kFileReadSampleRate,
+                                                std::memory_order_relaxed);
+}
 }  // namespace ROCKSDB_NAMESPACE
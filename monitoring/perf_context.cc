@@ -135,6 +135,11 @@ PerfContext::PerfContext(const PerfContext& other) {
   iter_prev_cpu_nanos = other.iter_prev_cpu_nanos;
   iter_seek_cpu_nanos = other.iter_seek_cpu_nanos;
   number_async_seek = other.number_async_seek;
+  block_buffer_pool_hit_count = other.block_buffer_pool_hit_count;
+  block_buffer_pool_miss_count = other.block_buffer_pool_miss_count;
+  range_filter_sst_hit_count = other.range_filter_sst_hit_count;
+  range_filter_sst_miss_count = other.range_filter_sst_miss_count;
+  memtable_point_lookup_index_count = other.memtable_point_lookup_index_count;
   if (per_level_perf_context_enabled && level_to_perf_context != nullptr) {
     ClearPerLevelPerfContext();
   }
@@ -255,6 +260,11 @@ PerfContext::PerfContext(PerfContext&& other) noexcept {
   iter_prev_cpu_nanos = other.iter_prev_cpu_nanos;
   iter_seek_cpu_nanos = other.iter_seek_cpu_nanos;
   number_async_seek = other.number_async_seek;
+  block_buffer_pool_hit_count = other.block_buffer_pool_hit_count;
+  block_buffer_pool_miss_count = other.block_buffer_pool_miss_count;
+  range_filter_sst_hit_count = other.range_filter_sst_hit_count;
+  range_filter_sst_miss_count = other.range_filter_sst_miss_count;
+  memtable_point_lookup_index_count = other.memtable_point_lookup_index_count;
   if (per_level_perf_context_enabled && level_to_perf_context != nullptr) {
     ClearPerLevelPerfContext();
   }
@@ -377,6 +387,11 @@ PerfContext& PerfContext::operator=(const PerfContext& other) {
   iter_prev_cpu_nanos = other.iter_prev_cpu_nanos;
   iter_seek_cpu_nanos = other.iter_seek_cpu_nanos;
   number_async_seek = other.number_async_seek;
+  block_buffer_pool_hit_count = other.block_buffer_pool_hit_count;
+  block_buffer_pool_miss_count = other.block_buffer_pool_miss_count;
+  range_filter_sst_hit_count = other.range_filter_sst_hit_count;
+  range_filter_sst_miss_count = other.range_filter_sst_miss_count;
+  memtable_point_lookup_index_count = other.memtable_point_lookup_index_count;
   if (per_level_perf_context_enabled && level_to_perf_context != nullptr) {
     ClearPerLevelPerfContext();
   }
@@ -489,6 +504,11 @@ void PerfContext::Reset() {
   iter_prev_cpu_nanos = 0;
   iter_seek_cpu_nanos = 0;
   number_async_seek = 0;
+  block_buffer_pool_hit_count = 0;
+  block_buffer_pool_miss_count = 0;
+  range_filter_sst_hit_count = 0;
+  range_filter_sst_miss_count = 0;
+  memtable_point_lookup_index_count = 0;
   if (per_level_perf_context_enabled && level_to_perf_context) {
     for (auto& kv : *level_to_perf_context) {
       kv.second.Reset();
@@ -622,6 +642,11 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(iter_prev_cpu_nanos);
   PERF_CONTEXT_OUTPUT(iter_seek_cpu_nanos);
   PERF_CONTEXT_OUTPUT(number_async_seek);
+  PERF_CONTEXT_OUTPUT(block_buffer_pool_hit_count);
+  PERF_CONTEXT_OUTPUT(block_buffer_pool_miss_count);
+  PERF_CONTEXT_OUTPUT(range_filter_sst_hit_count);
+  PERF_CONTEXT_OUTPUT(range_filter_sst_miss_count);
+  PERF_CONTEXT_OUTPUT(memtable_point_lookup_index_count);
   PERF_CONTEXT_BY_LEVEL_OUTPUT_ONE_COUNTER(bloom_filter_useful);
   PERF_CONTEXT_BY_LEVEL_OUTPUT_ONE_COUNTER(bloom_filter_full_positive);
   PERF_CONTEXT_BY_LEVEL_OUTPUT_ONE_COUNTER(bloom_filter_full_true_positive);
@@ -216,7 +216,12 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {ASYNC_READ_ERROR_COUNT, "rocksdb.async.read.error.count"},
     {SECONDARY_CACHE_FILTER_HITS, "rocksdb.secondary.cache.filter.hits"},
     {SECONDARY_CACHE_INDEX_HITS, "rocksdb.secondary.cache.index.hits"},
-    {SECONDARY_CACHE_DATA_HITS, "rocksdb.secondary.cache.data.hits"}};
+    {SECONDARY_CACHE_DATA_HITS, "rocksdb.secondary.cache.data.hits"},
+    {TIERED_CACHE_COMPRESSED_HITS, "rocksdb.tiered.cache.compressed.hits"},
+    {TIERED_CACHE_NVM_HITS, "rocksdb.tiered.cache.nvm.hits"},
+    {TIERED_CACHE_NVM_ADMITS, "rocksdb.tiered.cache.nvm.admits"},
+    {TIERED_CACHE_NVM_REJECTS, "rocksdb.tiered.cache.nvm.rejects"},
+    {TIERED_CACHE_PROMOTIONS, "rocksdb.tiered.cache.promotions"}};
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {DB_GET, "rocksdb.db.get.micros"},
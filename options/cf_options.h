@@ -114,12 +114,17 @@ struct MutableCFOptions {
         memtable_prefix_bloom_size_ratio(
             options.memtable_prefix_bloom_size_ratio),
         memtable_whole_key_filtering(options.memtable_whole_key_filtering),
+        memtable_point_lookup_index(options.memtable_point_lookup_index),
         memtable_huge_page_size(options.memtable_huge_page_size),
         max_successive_merges(options.max_successive_merges),
         inplace_update_num_locks(options.inplace_update_num_locks),
         prefix_extractor(options.prefix_extractor),
         experimental_mempurge_threshold(
             options.experimental_mempurge_threshold),
+        experimental_mempurge_frozen_output(
+            options.experimental_mempurge_frozen_output),
+        experimental_frozen_memtable_spill(
+            options.experimental_frozen_memtable_spill),
         disable_auto_compactions(options.disable_auto_compactions),
         soft_pending_compaction_bytes_limit(
             options.soft_pending_compaction_bytes_limit),
@@ -182,11 +187,14 @@ struct MutableCFOptions {
         arena_block_size(0),
         memtable_prefix_bloom_size_ratio(0),
         memtable_whole_key_filtering(false),
+        memtable_point_lookup_index(false),
         memtable_huge_page_size(0),
         max_successive_merges(0),
         inplace_update_num_locks(0),
         prefix_extractor(nullptr),
         experimental_mempurge_threshold(0.0),
+        experimental_mempurge_frozen_output(false),
+        experimental_frozen_memtable_spill(false),
         disable_auto_compactions(false),
         soft_pending_compaction_bytes_limit(0),
         hard_pending_compaction_bytes_limit(0),
@@ -247,6 +255,7 @@ struct MutableCFOptions {
   size_t arena_block_size;
   double memtable_prefix_bloom_size_ratio;
   bool memtable_whole_key_filtering;
+  bool memtable_point_lookup_index;
   size_t memtable_huge_page_size;
   size_t max_successive_merges;
   size_t inplace_update_num_locks;
@@ -267,6 +276,8 @@ struct MutableCFOptions {
   //   ratios.
   // [experimental]
   double experimental_mempurge_threshold;
+  bool experimental_mempurge_frozen_output;
+  bool experimental_frozen_memtable_spill;
 
   // Compaction related options
   bool disable_auto_compactions;
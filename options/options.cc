@@ -50,10 +50,15 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       inplace_update_support(options.inplace_update_support),
       inplace_update_num_locks(options.inplace_update_num_locks),
       experimental_mempurge_threshold(options.experimental_mempurge_threshold),
+      experimental_mempurge_frozen_output(
+          options.experimental_mempurge_frozen_output),
+      experimental_frozen_memtable_spill(
+          options.experimental_frozen_memtable_spill),
       inplace_callback(options.inplace_callback),
       memtable_prefix_bloom_size_ratio(
           options.memtable_prefix_bloom_size_ratio),
       memtable_whole_key_filtering(options.memtable_whole_key_filtering),
+      memtable_point_lookup_index(options.memtable_point_lookup_index),
       memtable_huge_page_size(options.memtable_huge_page_size),
       memtable_insert_with_hint_prefix_extractor(
           options.memtable_insert_with_hint_prefix_extractor),
@@ -381,6 +386,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "              Options.memtable_whole_key_filtering: %d",
                      memtable_whole_key_filtering);
+    ROCKS_LOG_HEADER(log,
+                     "               Options.memtable_point_lookup_index: %d",
+                     memtable_point_lookup_index);
 
     ROCKS_LOG_HEADER(log, "  Options.memtable_huge_page_size: %" ROCKSDB_PRIszt,
                      memtable_huge_page_size);
@@ -444,6 +452,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     }
     ROCKS_LOG_HEADER(log, "Options.experimental_mempurge_threshold: %f",
                      experimental_mempurge_threshold);
+    ROCKS_LOG_HEADER(log, "Options.experimental_mempurge_frozen_output: %d",
+                     experimental_mempurge_frozen_output);
+    ROCKS_LOG_HEADER(log, "Options.experimental_frozen_memtable_spill: %d",
+                     experimental_frozen_memtable_spill);
 }  // ColumnFamilyOptions::Dump
 
 void Options::Dump(Logger* log) const {
@@ -16,12 +16,14 @@
 #include <unordered_map>
 #include <vector>
 
+#include "db/wide/wide_column_serialization.h"
 #include "monitoring/perf_context_imp.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_footer.h"
+#include "table/block_based/learned_index.h"
 #include "table/format.h"
 #include "util/coding.h"
 
@@ -142,6 +144,43 @@ void DataBlockIter::NextImpl() {
   ParseNextDataKey(&is_shared);
 }
 
+bool DataBlockIter::AppendEntity(const Slice& row, std::string* output) const {
+  assert(wide_columns_ != nullptr);
+  if (!wide_columns_->DecodeRow(
+          row, has_wide_column_projection_ ? &wide_column_projection_ : nullptr,
+          &entity_columns_)) {
+    return false;
+  }
+  return WideColumnSerialization::Serialize(entity_columns_, *output).ok();
+}
+
+namespace {
+void DeletePinnedEntity(void* arg1, void* /* arg2 */) {
+  delete static_cast<std::string*>(arg1);
+}
+}  // namespace
+
+Slice DataBlockIter::EntityValue(bool pin) const {
+  // Serialize each entry at most once, and once more if it is pinned later
+  if (entity_offset_ != current_ || (pin && !entity_pinned_)) {
+    std::string* buf = &entity_buf_;
+    if (pin) {
+      buf = new std::string;
+      const_cast<DataBlockIter*>(this)->RegisterCleanup(&DeletePinnedEntity,
+                                                        buf, nullptr);
+    } else {
+      entity_buf_.clear();
+    }
+    if (!AppendEntity(value_, buf)) {
+      buf->clear();
+    }
+    entity_offset_ = current_;
+    entity_value_ = *buf;
+    entity_pinned_ = pin;
+  }
+  return entity_value_;
+}
+
 void MetaBlockIter::NextImpl() {
   bool is_shared = false;
   ParseNextKey<CheckAndDecodeEntry>(&is_shared);
@@ -271,15 +310,29 @@ void DataBlockIter::PrevImpl() {
   prev_entries_idx_ = static_cast<int32_t>(prev_entries_.size()) - 1;
 }
 
+bool DataBlockIter::RestartSeek(const Slice& target, uint32_t* index,
+                                bool* skip_linear_scan) {
+  if (restart_key_prefix_index_ == nullptr || restarts_ == 0) {
+    return BinarySeek<DecodeKey>(target, index, skip_linear_scan);
+  }
+  int64_t left, right;
+  restart_key_prefix_index_->Narrow(ExtractUserKey(target), &left, &right);
+  return BinarySeekInRange<DecodeKey>(target, left, right, index,
+                                      skip_linear_scan);
+}
+
 void DataBlockIter::SeekImpl(const Slice& target) {
   Slice seek_key = target;
   PERF_TIMER_GUARD(block_seek_nanos);
   if (data_ == nullptr) {  // Not init yet
     return;
   }
+  if (data_block_hash_index_ && HashSeekImpl(seek_key)) {
+    return;
+  }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  bool ok = RestartSeek(seek_key, &index, &skip_linear_scan);
 
   if (!ok) {
     return;
@@ -287,6 +340,43 @@ void DataBlockIter::SeekImpl(const Slice& target) {
   FindKeyAfterBinarySeek(seek_key, index, skip_linear_scan);
 }
 
+bool DataBlockIter::HashSeekImpl(const Slice& target) {
+  Slice target_user_key = ExtractUserKey(target);
+  uint16_t entry = data_block_hash_index_->Lookup(
+      data_, data_block_hash_index_->map_offset(), target_user_key);
+  if (entry == kHashIndexNoEntry || entry == kHashIndexCollision ||
+      entry >= num_restarts_) {
+    return false;
+  }
+
+  uint32_t restart_index = entry;
+  SeekToRestartPoint(restart_index);
+  current_ = GetRestartPoint(restart_index);
+
+  uint32_t limit = restarts_;
+  if (restart_index + 1 < num_restarts_) {
+    limit = GetRestartPoint(restart_index + 1);
+  }
+  while (current_ < limit) {
+    bool shared;
+    if (!ParseNextDataKey(&shared)) {
+      // Corruption was reported by ParseNextDataKey()
+      return true;
+    }
+    if (CompareCurrentKey(target) >= 0) {
+      // All keys before the restart interval are smaller than the ones in it,
+      // so if this is an entry of the seek key's user key, it is the first
+      // entry of the block at or after the seek key. Otherwise the hash
+      // index may have pointed to another user key's interval, and the
+      // result is unknown.
+      return icmp_->user_comparator()->Compare(raw_key_.GetUserKey(),
+                                               target_user_key) == 0;
+    }
+  }
+  // All the entries of the interval are before the seek key
+  return false;
+}
+
 void MetaBlockIter::SeekImpl(const Slice& target) {
   Slice seek_key = target;
   PERF_TIMER_GUARD(block_seek_nanos);
@@ -329,17 +419,16 @@ void MetaBlockIter::SeekImpl(const Slice& target) {
 //    but larger type).
 bool DataBlockIter::SeekForGetImpl(const Slice& target) {
   Slice target_user_key = ExtractUserKey(target);
-  uint32_t map_offset = restarts_ + num_restarts_ * sizeof(uint32_t);
-  uint8_t entry =
-      data_block_hash_index_->Lookup(data_, map_offset, target_user_key);
+  uint16_t entry = data_block_hash_index_->Lookup(
+      data_, data_block_hash_index_->map_offset(), target_user_key);
 
-  if (entry == kCollision) {
+  if (entry == kHashIndexCollision) {
     // HashSeek not effective, falling back
     SeekImpl(target);
     return true;
   }
 
-  if (entry == kNoEntry) {
+  if (entry == kHashIndexNoEntry) {
     // Even if we cannot find the user_key in this block, the result may
     // exist in the next block. Consider this example:
     //
@@ -355,7 +444,7 @@ bool DataBlockIter::SeekForGetImpl(const Slice& target) {
     // The while-loop below will search the last restart interval for the
     // key. It will stop at the first key that is larger than the seek_key,
     // or to the end of the block if no one is larger.
-    entry = static_cast<uint8_t>(num_restarts_ - 1);
+    entry = static_cast<uint16_t>(num_restarts_ - 1);
   }
 
   uint32_t restart_index = entry;
@@ -450,6 +539,12 @@ void IndexBlockIter::SeekImpl(const Slice& target) {
     // restart interval must be one when hash search is enabled so the binary
     // search simply lands at the right place.
     skip_linear_scan = true;
+  } else if (learned_index_) {
+    ok = value_delta_encoded_
+             ? LearnedSeek<DecodeKeyV4>(target, seek_key, &index,
+                                        &skip_linear_scan)
+             : LearnedSeek<DecodeKey>(target, seek_key, &index,
+                                      &skip_linear_scan);
   } else if (value_delta_encoded_) {
     ok = BinarySeek<DecodeKeyV4>(seek_key, &index, &skip_linear_scan);
   } else {
@@ -470,7 +565,7 @@ void DataBlockIter::SeekForPrevImpl(const Slice& target) {
   }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  bool ok = RestartSeek(seek_key, &index, &skip_linear_scan);
 
   if (!ok) {
     return;
@@ -761,7 +856,17 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
     // key accesses.
     return false;
   }
+  return BinarySeekInRange<DecodeKeyFunc>(target, -1, num_restarts_ - 1, index,
+                                          skip_linear_scan);
+}
 
+template <class TValue>
+template <typename DecodeKeyFunc>
+bool BlockIter<TValue>::BinarySeekInRange(const Slice& target, int64_t left,
+                                          int64_t right, uint32_t* index,
+                                          bool* skip_linear_scan) {
+  assert(restarts_ != 0);
+  assert(-1 <= left && left <= right && right < num_restarts_);
   *skip_linear_scan = false;
   // Loop invariants:
   // - Restart key at index `left` is less than or equal to the target key. The
@@ -769,7 +874,6 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   //   keys.
   // - Any restart keys after index `right` are strictly greater than the target
   //   key.
-  int64_t left = -1, right = num_restarts_ - 1;
   while (left != right) {
     // The `mid` is computed by rounding up so it lands in (`left`, `right`].
     int64_t mid = left + (right - left + 1) / 2;
@@ -809,6 +913,48 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   return true;
 }
 
+template <typename DecodeKeyFunc>
+bool IndexBlockIter::LearnedSeek(const Slice& target, const Slice& seek_key,
+                                 uint32_t* index, bool* skip_linear_scan) {
+  if (restarts_ == 0) {
+    // See BinarySeek()
+    return false;
+  }
+  int64_t left, right;
+  learned_index_->Predict(ExtractUserKey(target), num_restarts_, &left,
+                          &right);
+  // The model only sees key prefixes, so check that the window satisfies the
+  // invariants of BinarySeekInRange() before trusting it: the restart key at
+  // `left` must not be greater than the target and the one after `right` must
+  // be greater.
+  bool in_window = true;
+  if (left >= 0) {
+    int cmp = CompareBlockKey(static_cast<uint32_t>(left), seek_key);
+    if (!status_.ok()) {
+      return false;
+    }
+    if (cmp == 0) {
+      *index = static_cast<uint32_t>(left);
+      *skip_linear_scan = true;
+      return true;
+    }
+    in_window = cmp < 0;
+  }
+  if (in_window && right + 1 < static_cast<int64_t>(num_restarts_)) {
+    int cmp = CompareBlockKey(static_cast<uint32_t>(right + 1), seek_key);
+    if (!status_.ok()) {
+      return false;
+    }
+    in_window = cmp > 0;
+  }
+  if (!in_window) {
+    TEST_SYNC_POINT("IndexBlockIter::LearnedSeek:Fallback");
+    return BinarySeek<DecodeKeyFunc>(seek_key, index, skip_linear_scan);
+  }
+  return BinarySeekInRange<DecodeKeyFunc>(seek_key, left, right, index,
+                                          skip_linear_scan);
+}
+
 // Compare target key and the block key of the block of `block_index`.
 // Return -1 if error.
 int IndexBlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
@@ -952,13 +1098,44 @@ uint32_t Block::NumRestarts() const {
     // Such check is for backward compatibility. We can ensure legacy block
     // with a vary large num_restarts i.e. >= 0x80000000 can be interpreted
     // correctly as no HashIndex even if the MSB of num_restarts is set.
-    return num_restarts;
+    //
+    // Restart key prefixes and wide-column sections are not limited by block
+    // size, and their flags are never set in a legacy footer (it would
+    // require a block > 2GiB). The former are also only recognized for
+    // format_version >= 6.
+    if (!HasRestartKeyPrefixes() && !HasWideColumns()) {
+      return num_restarts;
+    }
   }
   BlockBasedTableOptions::DataBlockIndexType index_type;
   UnPackIndexTypeAndNumRestarts(block_footer, &index_type, &num_restarts);
   return num_restarts;
 }
 
+bool Block::HasRestartKeyPrefixes() const {
+  assert(size_ >= 2 * sizeof(uint32_t));
+  if (!allow_restart_key_prefixes_) {
+    return false;
+  }
+  uint32_t block_footer = DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  bool has_restart_key_prefixes = false;
+  UnPackIndexTypeAndNumRestarts(block_footer, nullptr /* index_type */,
+                                nullptr /* num_restarts */,
+                                &has_restart_key_prefixes);
+  return has_restart_key_prefixes;
+}
+
+bool Block::HasWideColumns() const {
+  assert(size_ >= 2 * sizeof(uint32_t));
+  uint32_t block_footer = DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  bool has_wide_columns = false;
+  UnPackIndexTypeAndNumRestarts(block_footer, nullptr /* index_type */,
+                                nullptr /* num_restarts */,
+                                nullptr /* has_restart_key_prefixes */,
+                                &has_wide_columns);
+  return has_wide_columns;
+}
+
 BlockBasedTableOptions::DataBlockIndexType Block::IndexType() const {
   assert(size_ >= 2 * sizeof(uint32_t));
   if (size_ > kMaxBlockSizeSupportedByHashIndex) {
@@ -979,27 +1156,35 @@ Block::~Block() {
 }
 
 Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
-             Statistics* statistics)
+             Statistics* statistics, bool restart_key_prefix_seek,
+             bool allow_restart_key_prefixes)
     : contents_(std::move(contents)),
       data_(contents_.data.data()),
       size_(contents_.data.size()),
       restart_offset_(0),
-      num_restarts_(0) {
+      num_restarts_(0),
+      allow_restart_key_prefixes_(allow_restart_key_prefixes) {
   TEST_SYNC_POINT("Block::Block:0");
+  bool has_restart_key_prefixes = false;
+  bool has_wide_columns = false;
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
   } else {
     // Should only decode restart points for uncompressed blocks
     num_restarts_ = NumRestarts();
+    has_restart_key_prefixes = HasRestartKeyPrefixes();
+    has_wide_columns = HasWideColumns();
+    // Persisted restart key prefixes and the wide-column section sit, in
+    // this order, between the restart array and the (optional) hash index.
+    const uint64_t prefixes_size =
+        has_restart_key_prefixes
+            ? uint64_t{num_restarts_} * RestartKeyPrefixIndex::kPrefixSize
+            : 0;
+    // Offset in data_ of the end of the restart array and what follows it
+    uint64_t end = 0;
     switch (IndexType()) {
       case BlockBasedTableOptions::kDataBlockBinarySearch:
-        restart_offset_ = static_cast<uint32_t>(size_) -
-                          (1 + num_restarts_) * sizeof(uint32_t);
-        if (restart_offset_ > size_ - sizeof(uint32_t)) {
-          // The size is too small for NumRestarts() and therefore
-          // restart_offset_ wrapped around.
-          size_ = 0;
-        }
+        end = size_ - sizeof(uint32_t);
         break;
       case BlockBasedTableOptions::kDataBlockBinaryAndHash:
         if (size_ < sizeof(uint32_t) /* block footer */ +
@@ -1015,24 +1200,43 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
                                   sizeof(uint32_t)), /*chop off
                                                  NUM_RESTARTS*/
             &map_offset);
-
-        restart_offset_ = map_offset - num_restarts_ * sizeof(uint32_t);
-
-        if (restart_offset_ > map_offset) {
-          // map_offset is too small for NumRestarts() and
-          // therefore restart_offset_ wrapped around.
-          size_ = 0;
-          break;
-        }
+        end = map_offset;
         break;
       default:
         size_ = 0;  // Error marker
     }
+    if (size_ != 0 && has_wide_columns) {
+      uint32_t section_size = 0;
+      if (wide_columns_.Initialize(data_ + end, end, &section_size)) {
+        end -= section_size;
+      } else {
+        size_ = 0;
+      }
+    }
+    if (size_ != 0) {
+      if (uint64_t{num_restarts_} * sizeof(uint32_t) + prefixes_size > end) {
+        // The size is too small for NumRestarts().
+        size_ = 0;
+      } else {
+        restart_offset_ = static_cast<uint32_t>(
+            end - uint64_t{num_restarts_} * sizeof(uint32_t) - prefixes_size);
+      }
+    }
   }
   if (read_amp_bytes_per_bit != 0 && statistics && size_ != 0) {
     read_amp_bitmap_.reset(new BlockReadAmpBitmap(
         restart_offset_, read_amp_bytes_per_bit, statistics));
   }
+  if (has_restart_key_prefixes && size_ != 0 && num_restarts_ > 0) {
+    restart_key_prefix_index_.InitializeFromBlock(
+        data_ + restart_offset_ + num_restarts_ * sizeof(uint32_t),
+        num_restarts_);
+  } else if (restart_key_prefix_seek && size_ != 0 && num_restarts_ > 0) {
+    // Failure to build simply leaves the index invalid; the regular binary
+    // search (and its corruption reporting) is used instead.
+    restart_key_prefix_index_.Initialize(data_, restart_offset_,
+                                         num_restarts_);
+  }
 }
 
 MetaBlockIter* Block::NewMetaIterator(bool block_contents_pinned) {
@@ -1072,7 +1276,10 @@ DataBlockIter* Block::NewDataIterator(const Comparator* raw_ucmp,
     ret_iter->Initialize(
         raw_ucmp, data_, restart_offset_, num_restarts_, global_seqno,
         read_amp_bitmap_.get(), block_contents_pinned,
-        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr);
+        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr,
+        restart_key_prefix_index_.Valid() ? &restart_key_prefix_index_
+                                          : nullptr,
+        wide_columns_.Valid() ? &wide_columns_ : nullptr);
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
         // DB changed the Statistics pointer, we need to notify read_amp_bitmap_
@@ -1088,7 +1295,8 @@ IndexBlockIter* Block::NewIndexIterator(
     const Comparator* raw_ucmp, SequenceNumber global_seqno,
     IndexBlockIter* iter, Statistics* /*stats*/, bool total_order_seek,
     bool have_first_key, bool key_includes_seq, bool value_is_full,
-    bool block_contents_pinned, BlockPrefixIndex* prefix_index) {
+    bool block_contents_pinned, BlockPrefixIndex* prefix_index,
+    const LearnedIndexModel* learned_index) {
   IndexBlockIter* ret_iter;
   if (iter != nullptr) {
     ret_iter = iter;
@@ -1109,7 +1317,7 @@ IndexBlockIter* Block::NewIndexIterator(
     ret_iter->Initialize(raw_ucmp, data_, restart_offset_, num_restarts_,
                          global_seqno, prefix_index_ptr, have_first_key,
                          key_includes_seq, value_is_full,
-                         block_contents_pinned);
+                         block_contents_pinned, learned_index);
   }
 
   return ret_iter;
@@ -1125,6 +1333,7 @@ size_t Block::ApproximateMemoryUsage() const {
   if (read_amp_bitmap_) {
     usage += read_amp_bitmap_->ApproximateMemoryUsage();
   }
+  usage += restart_key_prefix_index_.ApproximateMemoryUsage();
   return usage;
 }
 
@@ -11,6 +11,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -23,6 +24,8 @@
 #include "rocksdb/table.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_hash_index.h"
+#include "table/block_based/data_block_wide_columns.h"
+#include "table/block_based/restart_key_prefix_index.h"
 #include "table/format.h"
 #include "table/internal_iterator.h"
 #include "test_util/sync_point.h"
@@ -38,6 +41,7 @@ class DataBlockIter;
 class IndexBlockIter;
 class MetaBlockIter;
 class BlockPrefixIndex;
+class LearnedIndexModel;
 
 // BlockReadAmpBitmap is a bitmap that map the ROCKSDB_NAMESPACE::Block data
 // bytes to a bitmap with ratio bytes_per_bit. Whenever we access a range of
@@ -154,8 +158,20 @@ class BlockReadAmpBitmap {
 class Block {
  public:
   // Initialize the block with the specified contents.
+  //
+  // If `restart_key_prefix_seek` is true, a RestartKeyPrefixIndex is built
+  // over the restart keys so that data block seeks can narrow the binary
+  // search without comparator calls. The caller must only set it for data
+  // blocks ordered by BytewiseComparator.
+  //
+  // If `allow_restart_key_prefixes` is true, i.e. the block comes from a
+  // table whose format_version allows it (see
+  // FormatVersionAllowsRestartKeyPrefixes()), restart key prefixes persisted
+  // in the block are used regardless of `restart_key_prefix_seek`.
   explicit Block(BlockContents&& contents, size_t read_amp_bytes_per_bit = 0,
-                 Statistics* statistics = nullptr);
+                 Statistics* statistics = nullptr,
+                 bool restart_key_prefix_seek = false,
+                 bool allow_restart_key_prefixes = false);
   // No copying allowed
   Block(const Block&) = delete;
   void operator=(const Block&) = delete;
@@ -170,6 +186,12 @@ class Block {
   bool own_bytes() const { return contents_.own_bytes(); }
 
   BlockBasedTableOptions::DataBlockIndexType IndexType() const;
+  // Whether the block persists a restart key prefix array (see
+  // RestartKeyPrefixIndex).
+  bool HasRestartKeyPrefixes() const;
+  // Whether the block stores its wide-column entities in a column section
+  // (see DataBlockWideColumns).
+  bool HasWideColumns() const;
 
   // raw_ucmp is a raw (i.e., not wrapped by `UserComparatorWrapper`) user key
   // comparator.
@@ -222,6 +244,9 @@ class Block {
   // If `prefix_index` is not nullptr this block will do hash lookup for the key
   // prefix. If total_order_seek is true, prefix_index_ is ignored.
   //
+  // If `learned_index` is not nullptr, seeks start with a binary search in the
+  // window of restart points predicted by the model.
+  //
   // `have_first_key` controls whether IndexValue will contain
   // first_internal_key. It affects data serialization format, so the same value
   // have_first_key must be used when writing and reading index.
@@ -232,7 +257,9 @@ class Block {
                                    bool total_order_seek, bool have_first_key,
                                    bool key_includes_seq, bool value_is_full,
                                    bool block_contents_pinned = false,
-                                   BlockPrefixIndex* prefix_index = nullptr);
+                                   BlockPrefixIndex* prefix_index = nullptr,
+                                   const LearnedIndexModel* learned_index =
+                                       nullptr);
 
   // Report an approximation of how much memory has been used.
   size_t ApproximateMemoryUsage() const;
@@ -246,8 +273,12 @@ class Block {
   size_t size_;              // contents_.data.size()
   uint32_t restart_offset_;  // Offset in data_ of restart array
   uint32_t num_restarts_;
+  // Whether the footer may flag persisted restart key prefixes
+  const bool allow_restart_key_prefixes_;
   std::unique_ptr<BlockReadAmpBitmap> read_amp_bitmap_;
   DataBlockHashIndex data_block_hash_index_;
+  RestartKeyPrefixIndex restart_key_prefix_index_;
+  DataBlockWideColumns wide_columns_;
 };
 
 // A `BlockIter` iterates over the entries in a `Block`'s data buffer. The
@@ -486,6 +517,13 @@ class BlockIter : public InternalIteratorBase<TValue> {
   inline bool BinarySeek(const Slice& target, uint32_t* index,
                          bool* is_index_key_result);
 
+  // Same as `BinarySeek()`, but the caller already knows that the result lies
+  // within restart indexes [`left`, `right`], where `left` may be -1.
+  template <typename DecodeKeyFunc>
+  inline bool BinarySeekInRange(const Slice& target, int64_t left,
+                                int64_t right, uint32_t* index,
+                                bool* is_index_key_result);
+
   void FindKeyAfterBinarySeek(const Slice& target, uint32_t index,
                               bool is_index_key_result);
 };
@@ -497,34 +535,60 @@ class DataBlockIter final : public BlockIter<Slice> {
   DataBlockIter(const Comparator* raw_ucmp, const char* data, uint32_t restarts,
                 uint32_t num_restarts, SequenceNumber global_seqno,
                 BlockReadAmpBitmap* read_amp_bitmap, bool block_contents_pinned,
-                DataBlockHashIndex* data_block_hash_index)
+                DataBlockHashIndex* data_block_hash_index,
+                const RestartKeyPrefixIndex* restart_key_prefix_index = nullptr,
+                const DataBlockWideColumns* wide_columns = nullptr)
       : DataBlockIter() {
     Initialize(raw_ucmp, data, restarts, num_restarts, global_seqno,
-               read_amp_bitmap, block_contents_pinned, data_block_hash_index);
-  }
-  void Initialize(const Comparator* raw_ucmp, const char* data,
-                  uint32_t restarts, uint32_t num_restarts,
-                  SequenceNumber global_seqno,
-                  BlockReadAmpBitmap* read_amp_bitmap,
-                  bool block_contents_pinned,
-                  DataBlockHashIndex* data_block_hash_index) {
+               read_amp_bitmap, block_contents_pinned, data_block_hash_index,
+               restart_key_prefix_index, wide_columns);
+  }
+  void Initialize(
+      const Comparator* raw_ucmp, const char* data, uint32_t restarts,
+      uint32_t num_restarts, SequenceNumber global_seqno,
+      BlockReadAmpBitmap* read_amp_bitmap, bool block_contents_pinned,
+      DataBlockHashIndex* data_block_hash_index,
+      const RestartKeyPrefixIndex* restart_key_prefix_index = nullptr,
+      const DataBlockWideColumns* wide_columns = nullptr) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts, global_seqno,
                    block_contents_pinned);
     raw_key_.SetIsUserKey(false);
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
     data_block_hash_index_ = data_block_hash_index;
+    restart_key_prefix_index_ = restart_key_prefix_index;
+    wide_columns_ = wide_columns;
+    has_wide_column_projection_ = false;
+    entity_offset_ = kNoEntity;
   }
 
-  Slice value() const override {
-    assert(Valid());
-    if (read_amp_bitmap_ && current_ < restarts_ &&
-        current_ != last_bitmap_offset_) {
-      read_amp_bitmap_->Mark(current_ /* current entry offset */,
-                             NextEntryOffset() - 1);
-      last_bitmap_offset_ = current_;
+  Slice value() const override { return ValueImpl(false /* pin_entity */); }
+
+  // Wide-column entities of blocks with a column section are re-serialized
+  // into memory owned by the iterator, so values of such blocks are never
+  // reported as pinned.
+  bool IsValuePinned() const override {
+    return wide_columns_ == nullptr && BlockIter::IsValuePinned();
+  }
+
+  // Like value(), except that a re-serialized wide-column entity stays valid
+  // until the cleanup functions of the iterator run, rather than until the
+  // iterator is repositioned. So the value lives as long as the block does
+  // when the cleanup functions are delegated to a PinnedIteratorsManager.
+  Slice PinnedValue() const { return ValueImpl(true /* pin_entity */); }
+
+  // Restricts the wide-column entities returned by value() to the columns
+  // named in `*column_names`, or returns all columns if it is nullptr. Only
+  // blocks with a column section (see DataBlockWideColumns) apply the
+  // projection, in which case the other columns are not decoded at all;
+  // entities of other blocks are returned in full.
+  void SetWideColumnProjection(const std::vector<Slice>* column_names) {
+    entity_offset_ = kNoEntity;
+    has_wide_column_projection_ =
+        wide_columns_ != nullptr && column_names != nullptr;
+    if (has_wide_column_projection_) {
+      wide_columns_->Project(*column_names, &wide_column_projection_);
     }
-    return value_;
   }
 
   inline bool SeekForGet(const Slice& target) {
@@ -586,8 +650,56 @@ class DataBlockIter final : public BlockIter<Slice> {
   int32_t prev_entries_idx_ = -1;
 
   DataBlockHashIndex* data_block_hash_index_;
+  const RestartKeyPrefixIndex* restart_key_prefix_index_ = nullptr;
+
+  // Column section of the block, if any
+  const DataBlockWideColumns* wide_columns_ = nullptr;
+  bool has_wide_column_projection_ = false;
+  // Column ids of wide_columns_ to return, if has_wide_column_projection_
+  std::vector<bool> wide_column_projection_;
+  static constexpr uint32_t kNoEntity = std::numeric_limits<uint32_t>::max();
+  // Offset of the entry whose entity is serialized in entity_value_, which
+  // points to entity_buf_, or to a copy released by the cleanup functions of
+  // the iterator if entity_pinned_
+  mutable uint32_t entity_offset_ = kNoEntity;
+  mutable Slice entity_value_;
+  mutable bool entity_pinned_ = false;
+  mutable std::string entity_buf_;
+  mutable WideColumns entity_columns_;
+
+  static bool IsEntity(const Slice& internal_key) {
+    return ExtractValueType(internal_key) == kTypeWideColumnEntity;
+  }
+  Slice ValueImpl(bool pin_entity) const {
+    assert(Valid());
+    if (read_amp_bitmap_ && current_ < restarts_ &&
+        current_ != last_bitmap_offset_) {
+      read_amp_bitmap_->Mark(current_ /* current entry offset */,
+                             NextEntryOffset() - 1);
+      last_bitmap_offset_ = current_;
+    }
+    if (wide_columns_ != nullptr && IsEntity(raw_key_.GetInternalKey())) {
+      return EntityValue(pin_entity);
+    }
+    return value_;
+  }
+  // Returns the current entry's entity, re-serialized from its row
+  // descriptor (see PinnedValue() for `pin`). An empty result, which is not
+  // a valid serialized entity, signals a corrupted row to the consumer.
+  Slice EntityValue(bool pin) const;
+  // Appends the entity with row descriptor `row` to `*output`.
+  bool AppendEntity(const Slice& row, std::string* output) const;
 
   bool SeekForGetImpl(const Slice& target);
+  // Tries to position the iterator at the first entry at or after `target`
+  // using the hash index, which only works if the block has entries of the
+  // target's user key. Returns false, leaving the position undefined, if the
+  // hash index could not find the entry.
+  bool HashSeekImpl(const Slice& target);
+  // Finds the restart interval to start the linear scan from, using
+  // `restart_key_prefix_index_` to narrow the binary search when available.
+  inline bool RestartSeek(const Slice& target, uint32_t* index,
+                          bool* skip_linear_scan);
 };
 
 // Iterator over MetaBlocks.  MetaBlocks are similar to Data Blocks and
@@ -623,7 +735,8 @@ class MetaBlockIter final : public BlockIter<Slice> {
 
 class IndexBlockIter final : public BlockIter<IndexValue> {
  public:
-  IndexBlockIter() : BlockIter(), prefix_index_(nullptr) {}
+  IndexBlockIter()
+      : BlockIter(), prefix_index_(nullptr), learned_index_(nullptr) {}
 
   // key_includes_seq, default true, means that the keys are in internal key
   // format.
@@ -633,11 +746,13 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
                   uint32_t restarts, uint32_t num_restarts,
                   SequenceNumber global_seqno, BlockPrefixIndex* prefix_index,
                   bool have_first_key, bool key_includes_seq,
-                  bool value_is_full, bool block_contents_pinned) {
+                  bool value_is_full, bool block_contents_pinned,
+                  const LearnedIndexModel* learned_index = nullptr) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts,
                    kDisableGlobalSequenceNumber, block_contents_pinned);
     raw_key_.SetIsUserKey(!key_includes_seq);
     prefix_index_ = prefix_index;
+    learned_index_ = learned_index;
     value_delta_encoded_ = !value_is_full;
     have_first_key_ = have_first_key;
     if (have_first_key_ && global_seqno != kDisableGlobalSequenceNumber) {
@@ -703,6 +818,7 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   bool value_delta_encoded_;
   bool have_first_key_;  // value includes first_internal_key
   BlockPrefixIndex* prefix_index_;
+  const LearnedIndexModel* learned_index_;
   // Whether the value is delta encoded. In that case the value is assumed to be
   // BlockHandle. The first value in each restart interval is the full encoded
   // BlockHandle; the restart of encoded size part of the BlockHandle. The
@@ -730,6 +846,11 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   // as `target`. If not set, the result position should be the same as total
   // order Seek.
   bool PrefixSeek(const Slice& target, uint32_t* index, bool* prefix_may_exist);
+  // Like `BinarySeek()`, but first tries to binary search only the window of
+  // restart points predicted by `learned_index_`.
+  template <typename DecodeKeyFunc>
+  bool LearnedSeek(const Slice& target, const Slice& seek_key, uint32_t* index,
+                   bool* skip_linear_scan);
   // Set *prefix_may_exist to false if no key can possibly share the same
   // prefix as `target`. If not set, the result position should be the same
   // as total order seek.
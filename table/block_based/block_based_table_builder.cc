@@ -12,6 +12,8 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <list>
 #include <map>
@@ -104,6 +106,18 @@ FilterBlockBuilder* CreateFilterBlockBuilder(
   }
 }
 
+// Fills the trailer of a block with contents `block_contents` compressed
+// with `type`: the compression type and the checksum.
+void ComputeBlockTrailer(ChecksumType checksum_type,
+                         const Slice& block_contents, CompressionType type,
+                         std::array<char, kBlockTrailerSize>* trailer) {
+  (*trailer)[0] = type;
+  uint32_t checksum = ComputeBuiltinChecksumWithLastByte(
+      checksum_type, block_contents.data(), block_contents.size(),
+      /*last_byte*/ type);
+  EncodeFixed32(trailer->data() + 1, checksum);
+}
+
 bool GoodCompressionRatio(size_t compressed_size, size_t uncomp_size) {
   // Check to see if compressed less than 12.5%
   return compressed_size < uncomp_size - (uncomp_size / 8u);
@@ -324,6 +338,7 @@ struct BlockBasedTableBuilder::Rep {
       compression_dict_buffer_cache_res_mgr;
   const bool use_delta_encoding_for_index_values;
   std::unique_ptr<FilterBlockBuilder> filter_builder;
+  std::unique_ptr<RangeFilterBitsBuilder> range_filter_builder;
   OffsetableCacheKey base_cache_key;
   const TableFileCreationReason reason;
 
@@ -421,7 +436,14 @@ struct BlockBasedTableBuilder::Rep {
                            ->CanKeysWithDifferentByteContentsBeEqual()
                        ? BlockBasedTableOptions::kDataBlockBinarySearch
                        : table_options.data_block_index_type,
-                   table_options.data_block_hash_table_util_ratio),
+                   table_options.data_block_hash_table_util_ratio,
+                   table_options.data_block_restart_key_prefixes &&
+                       FormatVersionAllowsRestartKeyPrefixes(
+                           table_options.format_version) &&
+                       tbo.internal_comparator.user_comparator() ==
+                           BytewiseComparator(),
+                   table_options.data_block_columnar_entities,
+                   table_options.data_block_hash_index_wide_buckets),
         range_del_block(1 /* block_restart_interval */),
         internal_prefix_transform(tbo.moptions.prefix_extractor.get()),
         compression_type(tbo.compression_type),
@@ -441,9 +463,13 @@ struct BlockBasedTableBuilder::Rep {
         use_delta_encoding_for_index_values(table_opt.format_version >= 4 &&
                                             !table_opt.block_align),
         reason(tbo.reason),
-        flush_block_policy(
-            table_options.flush_block_policy_factory->NewFlushBlockPolicy(
-                table_options, data_block)),
+        flush_block_policy(table_options.flush_block_policy_factory
+                               ->NewFlushBlockPolicyWithContext(
+                                   FlushBlockPolicyContext{
+                                       tbo.reason, tbo.level_at_creation,
+                                       tbo.num_point_reads,
+                                       tbo.num_iterator_reads},
+                                   table_options, data_block)),
         create_context(&table_options, ioptions.stats,
                        compression_type == kZSTD ||
                            compression_type == kZSTDNotFinalCompression),
@@ -521,6 +547,23 @@ struct BlockBasedTableBuilder::Rep {
           ioptions, moptions, filter_context,
           use_delta_encoding_for_index_values, p_index_builder_));
     }
+    // Range filters map keys to values in bytewise order
+    if (table_options.range_filter_policy && !tbo.skip_filters &&
+        internal_comparator.user_comparator() == BytewiseComparator()) {
+      FilterBuildingContext range_filter_context(table_options);
+      range_filter_context.info_log = ioptions.logger;
+      range_filter_context.column_family_name = tbo.column_family_name;
+      range_filter_context.reason = reason;
+      if (reason != TableFileCreationReason::kMisc) {
+        range_filter_context.compaction_style = ioptions.compaction_style;
+        range_filter_context.num_levels = ioptions.num_levels;
+        range_filter_context.level_at_creation = tbo.level_at_creation;
+        range_filter_context.is_bottommost = tbo.is_bottommost;
+      }
+      range_filter_builder.reset(
+          table_options.range_filter_policy->GetBuilderWithContext(
+              range_filter_context));
+    }
 
     assert(tbo.int_tbl_prop_collector_factories);
     for (auto& factory : *tbo.int_tbl_prop_collector_factories) {
@@ -552,6 +595,8 @@ struct BlockBasedTableBuilder::Rep {
     props.oldest_key_time = tbo.oldest_key_time;
     props.file_creation_time = tbo.file_creation_time;
     props.orig_file_number = tbo.cur_file_num;
+    props.num_point_reads = tbo.num_point_reads;
+    props.num_iterator_reads = tbo.num_iterator_reads;
     props.db_id = tbo.db_id;
     props.db_session_id = tbo.db_session_id;
     props.db_host_id = ioptions.db_host_id;
@@ -618,10 +663,15 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
     std::unique_ptr<std::string> data;
     std::unique_ptr<std::string> compressed_data;
     CompressionType compression_type;
+    // Trailer of compressed_contents, computed by the compression thread
+    std::array<char, kBlockTrailerSize> trailer;
     std::unique_ptr<std::string> first_key_in_next_block;
     std::unique_ptr<Keys> keys;
     std::unique_ptr<BlockRepSlot> slot;
     Status status;
+    // Number of the ordered stages (write thread and filter thread) that
+    // have yet to process the block before it can be recycled
+    std::atomic<int> pending_stages{0};
   };
   // Use a vector of BlockRep as a buffer for a determined number
   // of BlockRep structures. All data referenced by pointers in
@@ -666,6 +716,19 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
   WriteQueue write_queue;
   std::unique_ptr<port::Thread> write_thread;
 
+  // Filter queue will pass references to BlockRep in block_rep_buf, in block
+  // order, to the filter thread. The filter thread adds the keys to the
+  // filters that do not depend on the index (full and range filters) while
+  // the blocks are compressed and written. Partitioned filters are cut along
+  // with the index, so their keys are added by the write thread.
+  using FilterQueue = WorkQueue<BlockRep*>;
+  FilterQueue filter_queue;
+  std::unique_ptr<port::Thread> filter_thread;
+  // Whether the filter thread adds the keys to the (full) filter
+  bool filter_thread_adds_to_filter = false;
+  // Whether the filter thread adds the keys to the range filter
+  bool filter_thread_adds_to_range_filter = false;
+
   // Estimate output file size when parallel compression is enabled. This is
   // necessary because compression & flush are no longer synchronized,
   // and BlockBasedTableBuilder::FileSize() is no longer accurate.
@@ -776,14 +839,19 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
   std::condition_variable first_block_cond;
   std::mutex first_block_mutex;
 
+  // One block for each compression thread, plus one for each ordered stage
+  // so that writing and filter building overlap with compression.
+  static constexpr uint32_t kNumOrderedStages = 2;
+
   explicit ParallelCompressionRep(uint32_t parallel_threads)
       : curr_block_keys(new Keys()),
-        block_rep_buf(parallel_threads),
-        block_rep_pool(parallel_threads),
-        compress_queue(parallel_threads),
-        write_queue(parallel_threads),
+        block_rep_buf(parallel_threads + kNumOrderedStages),
+        block_rep_pool(parallel_threads + kNumOrderedStages),
+        compress_queue(parallel_threads + kNumOrderedStages),
+        write_queue(parallel_threads + kNumOrderedStages),
+        filter_queue(parallel_threads + kNumOrderedStages),
         first_block_processed(false) {
-    for (uint32_t i = 0; i < parallel_threads; i++) {
+    for (uint32_t i = 0; i < block_rep_buf.size(); i++) {
       block_rep_buf[i].contents = Slice();
       block_rep_buf[i].compressed_contents = Slice();
       block_rep_buf[i].data.reset(new std::string());
@@ -832,9 +900,14 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
   void EmitBlock(BlockRep* block_rep) {
     assert(block_rep != nullptr);
     assert(block_rep->status.ok());
+    block_rep->pending_stages.store(filter_thread ? 2 : 1,
+                                    std::memory_order_relaxed);
     if (!write_queue.push(block_rep->slot.get())) {
       return;
     }
+    if (filter_thread && !filter_queue.push(block_rep)) {
+      return;
+    }
     if (!compress_queue.push(block_rep)) {
       return;
     }
@@ -847,6 +920,15 @@ struct BlockBasedTableBuilder::ParallelCompressionRep {
     }
   }
 
+  // Called by each ordered stage when done with a block, the last of which
+  // reaps the block
+  void FinishStage(BlockRep* block_rep) {
+    if (block_rep->pending_stages.fetch_sub(1, std::memory_order_acq_rel) ==
+        1) {
+      ReapBlock(block_rep);
+    }
+  }
+
   // Reap a block from compression thread
   void ReapBlock(BlockRep* block_rep) {
     assert(block_rep != nullptr);
@@ -984,6 +1066,9 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
               r->internal_comparator.user_comparator()->timestamp_size();
           r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
         }
+        if (r->range_filter_builder != nullptr) {
+          r->range_filter_builder->AddKey(ExtractUserKey(key));
+        }
       }
     }
 
@@ -1099,6 +1184,10 @@ void BlockBasedTableBuilder::BGWorkCompression(
                            block_rep->compressed_data.get(),
                            &block_rep->compressed_contents,
                            &(block_rep->compression_type), &block_rep->status);
+    // Checksum here rather than in the write thread, which is serial
+    ComputeBlockTrailer(rep_->table_options.checksum,
+                        block_rep->compressed_contents,
+                        block_rep->compression_type, &block_rep->trailer);
     block_rep->slot->Fill(block_rep);
   }
 }
@@ -1235,7 +1324,8 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
 
 void BlockBasedTableBuilder::WriteMaybeCompressedBlock(
     const Slice& block_contents, CompressionType type, BlockHandle* handle,
-    BlockType block_type, const Slice* uncompressed_block_data) {
+    BlockType block_type, const Slice* uncompressed_block_data,
+    const char* precomputed_trailer) {
   Rep* r = rep_;
   bool is_data_block = block_type == BlockType::kData;
   // Old, misleading name of this function: WriteRawBlock
@@ -1258,10 +1348,12 @@ void BlockBasedTableBuilder::WriteMaybeCompressedBlock(
   }
 
   std::array<char, kBlockTrailerSize> trailer;
-  trailer[0] = type;
-  uint32_t checksum = ComputeBuiltinChecksumWithLastByte(
-      r->table_options.checksum, block_contents.data(), block_contents.size(),
-      /*last_byte*/ type);
+  if (precomputed_trailer != nullptr) {
+    std::copy_n(precomputed_trailer, kBlockTrailerSize, trailer.begin());
+  } else {
+    ComputeBlockTrailer(r->table_options.checksum, block_contents, type,
+                        &trailer);
+  }
 
   if (block_type == BlockType::kFilter) {
     Status s = r->filter_builder->MaybePostVerifyFilter(block_contents);
@@ -1271,7 +1363,6 @@ void BlockBasedTableBuilder::WriteMaybeCompressedBlock(
     }
   }
 
-  EncodeFixed32(trailer.data() + 1, checksum);
   TEST_SYNC_POINT_CALLBACK(
       "BlockBasedTableBuilder::WriteMaybeCompressedBlock:TamperWithChecksum",
       trailer.data());
@@ -1345,17 +1436,22 @@ void BlockBasedTableBuilder::BGWorkWriteMaybeCompressedBlock() {
       // Reap block so that blocked Flush() can finish
       // if there is one, and Flush() will notice !ok() next time.
       block_rep->status = Status::OK();
-      r->pc_rep->ReapBlock(block_rep);
+      r->pc_rep->FinishStage(block_rep);
       continue;
     }
 
     for (size_t i = 0; i < block_rep->keys->Size(); i++) {
       auto& key = (*block_rep->keys)[i];
-      if (r->filter_builder != nullptr) {
+      if (r->filter_builder != nullptr &&
+          !r->pc_rep->filter_thread_adds_to_filter) {
         size_t ts_sz =
             r->internal_comparator.user_comparator()->timestamp_size();
         r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
       }
+      if (r->range_filter_builder != nullptr &&
+          !r->pc_rep->filter_thread_adds_to_range_filter) {
+        r->range_filter_builder->AddKey(ExtractUserKey(key));
+      }
       r->index_builder->OnKeyAdded(key);
     }
 
@@ -1363,7 +1459,8 @@ void BlockBasedTableBuilder::BGWorkWriteMaybeCompressedBlock() {
         block_rep->data->size());
     WriteMaybeCompressedBlock(block_rep->compressed_contents,
                               block_rep->compression_type, &r->pending_handle,
-                              BlockType::kData, &block_rep->contents);
+                              BlockType::kData, &block_rep->contents,
+                              block_rep->trailer.data());
     if (!ok()) {
       break;
     }
@@ -1371,18 +1468,44 @@ void BlockBasedTableBuilder::BGWorkWriteMaybeCompressedBlock() {
     r->props.data_size = r->get_offset();
     ++r->props.num_data_blocks;
 
+    // AddIndexEntry() shortens the last key in place, so give it a copy if
+    // the filter thread might still be reading the keys of the block
+    std::string last_key_copy;
+    std::string* last_key = &(block_rep->keys->Back());
+    if (r->pc_rep->filter_thread) {
+      last_key_copy = *last_key;
+      last_key = &last_key_copy;
+    }
     if (block_rep->first_key_in_next_block == nullptr) {
-      r->index_builder->AddIndexEntry(&(block_rep->keys->Back()), nullptr,
-                                      r->pending_handle);
+      r->index_builder->AddIndexEntry(last_key, nullptr, r->pending_handle);
     } else {
       Slice first_key_in_next_block =
           Slice(*block_rep->first_key_in_next_block);
-      r->index_builder->AddIndexEntry(&(block_rep->keys->Back()),
-                                      &first_key_in_next_block,
+      r->index_builder->AddIndexEntry(last_key, &first_key_in_next_block,
                                       r->pending_handle);
     }
 
-    r->pc_rep->ReapBlock(block_rep);
+    r->pc_rep->FinishStage(block_rep);
+  }
+}
+
+void BlockBasedTableBuilder::BGWorkFilter() {
+  Rep* r = rep_;
+  ParallelCompressionRep::BlockRep* block_rep = nullptr;
+  const size_t ts_sz =
+      r->internal_comparator.user_comparator()->timestamp_size();
+  while (r->pc_rep->filter_queue.pop(block_rep)) {
+    assert(block_rep != nullptr);
+    for (size_t i = 0; i < block_rep->keys->Size(); i++) {
+      const Slice key = (*block_rep->keys)[i];
+      if (r->pc_rep->filter_thread_adds_to_filter) {
+        r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
+      }
+      if (r->pc_rep->filter_thread_adds_to_range_filter) {
+        r->range_filter_builder->AddKey(ExtractUserKey(key));
+      }
+    }
+    r->pc_rep->FinishStage(block_rep);
   }
 }
 
@@ -1399,6 +1522,16 @@ void BlockBasedTableBuilder::StartParallelCompression() {
   }
   rep_->pc_rep->write_thread.reset(
       new port::Thread([this] { BGWorkWriteMaybeCompressedBlock(); }));
+  rep_->pc_rep->filter_thread_adds_to_filter =
+      rep_->filter_builder != nullptr &&
+      !rep_->table_options.partition_filters;
+  rep_->pc_rep->filter_thread_adds_to_range_filter =
+      rep_->range_filter_builder != nullptr;
+  if (rep_->pc_rep->filter_thread_adds_to_filter ||
+      rep_->pc_rep->filter_thread_adds_to_range_filter) {
+    rep_->pc_rep->filter_thread.reset(
+        new port::Thread([this] { BGWorkFilter(); }));
+  }
 }
 
 void BlockBasedTableBuilder::StopParallelCompression() {
@@ -1408,6 +1541,10 @@ void BlockBasedTableBuilder::StopParallelCompression() {
   }
   rep_->pc_rep->write_queue.finish();
   rep_->pc_rep->write_thread->join();
+  if (rep_->pc_rep->filter_thread) {
+    rep_->pc_rep->filter_queue.finish();
+    rep_->pc_rep->filter_thread->join();
+  }
 }
 
 Status BlockBasedTableBuilder::status() const { return rep_->GetStatus(); }
@@ -1494,6 +1631,28 @@ void BlockBasedTableBuilder::WriteFilterBlock(
   }
 }
 
+void BlockBasedTableBuilder::WriteRangeFilterBlock(
+    MetaIndexBuilder* meta_index_builder) {
+  if (rep_->range_filter_builder == nullptr || !ok()) {
+    return;
+  }
+  std::unique_ptr<const char[]> range_filter_data;
+  Slice range_filter_content =
+      rep_->range_filter_builder->Finish(&range_filter_data);
+  if (range_filter_content.empty()) {
+    return;
+  }
+  BlockHandle range_filter_block_handle;
+  WriteMaybeCompressedBlock(range_filter_content, kNoCompression,
+                            &range_filter_block_handle,
+                            BlockType::kRangeFilter);
+  if (ok()) {
+    std::string key = BlockBasedTable::kRangeFilterBlockPrefix;
+    key.append(rep_->table_options.range_filter_policy->Name());
+    meta_index_builder->Add(key, range_filter_block_handle);
+  }
+}
+
 void BlockBasedTableBuilder::WriteIndexBlock(
     MetaIndexBuilder* meta_index_builder, BlockHandle* index_block_handle) {
   if (!ok()) {
@@ -1846,6 +2005,9 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
               r->internal_comparator.user_comparator()->timestamp_size();
           r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
         }
+        if (r->range_filter_builder != nullptr) {
+          r->range_filter_builder->AddKey(ExtractUserKey(key));
+        }
         r->index_builder->OnKeyAdded(key);
       }
       WriteBlock(Slice(data_block), &r->pending_handle, BlockType::kData);
@@ -1909,6 +2071,7 @@ Status BlockBasedTableBuilder::Finish() {
   BlockHandle metaindex_block_handle, index_block_handle;
   MetaIndexBuilder meta_index_builder;
   WriteFilterBlock(&meta_index_builder);
+  WriteRangeFilterBlock(&meta_index_builder);
   WriteIndexBlock(&meta_index_builder, &index_block_handle);
   WriteCompressionDictBlock(&meta_index_builder);
   WriteRangeDelBlock(&meta_index_builder);
@@ -2004,4 +2167,5 @@ const std::string BlockBasedTable::kObsoleteFilterBlockPrefix = "filter.";
 const std::string BlockBasedTable::kFullFilterBlockPrefix = "fullfilter.";
 const std::string BlockBasedTable::kPartitionedFilterBlockPrefix =
     "partitionedfilter.";
+const std::string BlockBasedTable::kRangeFilterBlockPrefix = "rangefilter.";
 }  // namespace ROCKSDB_NAMESPACE
@@ -121,10 +121,13 @@ class BlockBasedTableBuilder : public TableBuilder {
   // Compress and write block content to the file.
   void WriteBlock(const Slice& block_contents, BlockHandle* handle,
                   BlockType block_type);
-  // Directly write data to the file.
+  // Directly write data to the file. `precomputed_trailer`, if not null,
+  // points to the block trailer (compression type and checksum) of
+  // `block_contents`.
   void WriteMaybeCompressedBlock(
       const Slice& block_contents, CompressionType, BlockHandle* handle,
-      BlockType block_type, const Slice* uncompressed_block_data = nullptr);
+      BlockType block_type, const Slice* uncompressed_block_data = nullptr,
+      const char* precomputed_trailer = nullptr);
 
   void SetupCacheKeyPrefix(const TableBuilderOptions& tbo);
 
@@ -141,6 +144,7 @@ class BlockBasedTableBuilder : public TableBuilder {
                                       const BlockHandle* handle);
 
   void WriteFilterBlock(MetaIndexBuilder* meta_index_builder);
+  void WriteRangeFilterBlock(MetaIndexBuilder* meta_index_builder);
   void WriteIndexBlock(MetaIndexBuilder* meta_index_builder,
                        BlockHandle* index_block_handle);
   void WritePropertiesBlock(MetaIndexBuilder* meta_index_builder);
@@ -186,11 +190,16 @@ class BlockBasedTableBuilder : public TableBuilder {
   // Get compressed blocks from BGWorkCompression and write them into SST
   void BGWorkWriteMaybeCompressedBlock();
 
-  // Initialize parallel compression context and
-  // start BGWorkCompression and BGWorkWriteMaybeCompressedBlock threads
+  // Add the keys of the emitted blocks to the filters that do not depend on
+  // the index, concurrently with BGWorkWriteMaybeCompressedBlock
+  void BGWorkFilter();
+
+  // Initialize parallel compression context and start BGWorkCompression,
+  // BGWorkWriteMaybeCompressedBlock and (if needed) BGWorkFilter threads
   void StartParallelCompression();
 
-  // Stop BGWorkCompression and BGWorkWriteMaybeCompressedBlock threads
+  // Stop BGWorkCompression, BGWorkWriteMaybeCompressedBlock and BGWorkFilter
+  // threads
   void StopParallelCompression();
 };
 
@@ -30,6 +30,13 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target,
     ResetDataIter();
     return;
   }
+  if (target && check_range_filter_ &&
+      !table_->RangeMayMatch(*target, read_options_)) {
+    // No key in [target, iterate_upper_bound). The level iterator moves on
+    // to the next file only if it starts before the upper bound.
+    ResetDataIter();
+    return;
+  }
 
   bool need_seek_index = true;
   if (block_iter_points_to_real_block_ && block_iter_.Valid()) {
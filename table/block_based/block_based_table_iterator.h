@@ -23,7 +23,7 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
       const BlockBasedTable* table, const ReadOptions& read_options,
       const InternalKeyComparator& icomp,
       std::unique_ptr<InternalIteratorBase<IndexValue>>&& index_iter,
-      bool check_filter, bool need_upper_bound_check,
+      bool check_filter, bool check_range_filter, bool need_upper_bound_check,
       const SliceTransform* prefix_extractor, TableReaderCaller caller,
       size_t compaction_readahead_size = 0, bool allow_unprepared_value = false)
       : index_iter_(std::move(index_iter)),
@@ -40,6 +40,7 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
         allow_unprepared_value_(allow_unprepared_value),
         block_iter_points_to_real_block_(false),
         check_filter_(check_filter),
+        check_range_filter_(check_range_filter),
         need_upper_bound_check_(need_upper_bound_check),
         async_read_in_progress_(false) {}
 
@@ -88,6 +89,10 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
     assert(!is_at_first_key_from_index_);
     assert(Valid());
 
+    if (pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled()) {
+      // See IsValuePinned()
+      return block_iter_.PinnedValue();
+    }
     return block_iter_.value();
   }
   Status status() const override {
@@ -129,7 +134,11 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
     assert(!is_at_first_key_from_index_);
     assert(Valid());
 
-    // BlockIter::IsValuePinned() is always true. No need to check
+    // The cleanup functions of block_iter_, which keep the block alive, are
+    // delegated to pinned_iters_mgr_ when moving to another block. value()
+    // then returns values that live as long as the block, including
+    // wide-column entities re-serialized from a column section. No need to
+    // check BlockIter::IsValuePinned()
     return pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled() &&
            block_iter_points_to_real_block_;
   }
@@ -235,6 +244,9 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
   // that block yet. A call to PrepareValue() will trigger loading the block.
   bool is_at_first_key_from_index_ = false;
   bool check_filter_;
+  // Whether to check the range filter of the table, which unlike the prefix
+  // filter does not depend on a prefix extractor
+  bool check_range_filter_;
   // TODO(Zhongyi): pick a better name
   bool need_upper_bound_check_;
 
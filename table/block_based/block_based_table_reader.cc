@@ -29,6 +29,7 @@
 #include "file/file_util.h"
 #include "file/random_access_file_reader.h"
 #include "logging/logging.h"
+#include "memory/block_buffer_pool.h"
 #include "monitoring/perf_context_imp.h"
 #include "parsed_full_filter_block.h"
 #include "port/lang.h"
@@ -56,6 +57,7 @@
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/hash_index_reader.h"
+#include "table/block_based/learned_index_reader.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/block_based/partitioned_index_reader.h"
 #include "table/block_fetcher.h"
@@ -124,6 +126,7 @@ namespace ROCKSDB_NAMESPACE {
 extern const uint64_t kBlockBasedTableMagicNumber;
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
+extern const std::string kLearnedIndexModelBlock;
 
 BlockBasedTable::~BlockBasedTable() { delete rep_; }
 
@@ -142,7 +145,8 @@ Status ReadAndParseBlockFromFile(
     BlockCreateContext& create_context, bool maybe_compressed,
     const UncompressionDict& uncompression_dict,
     const PersistentCacheOptions& cache_options,
-    MemoryAllocator* memory_allocator, bool for_compaction, bool async_read) {
+    MemoryAllocator* memory_allocator, bool for_compaction, bool async_read,
+    MemoryAllocator* memory_allocator_compressed = nullptr) {
   assert(result);
 
   BlockContents contents;
@@ -150,7 +154,7 @@ Status ReadAndParseBlockFromFile(
       file, prefetch_buffer, footer, options, handle, &contents, ioptions,
       /*do_uncompress*/ maybe_compressed, maybe_compressed,
       TBlocklike::kBlockType, uncompression_dict, cache_options,
-      memory_allocator, nullptr, for_compaction);
+      memory_allocator, memory_allocator_compressed, for_compaction);
   Status s;
   // If prefetch_buffer is not allocated, it will fallback to synchronous
   // reading of block contents.
@@ -670,9 +674,16 @@ Status BlockBasedTable::Open(
            CompressionTypeToString(kZSTD) ||
        rep->table_properties->compression_name ==
            CompressionTypeToString(kZSTDNotFinalCompression));
-  rep->create_context =
-      BlockCreateContext(&rep->table_options, rep->ioptions.stats,
-                         blocks_definitely_zstd_compressed);
+  // The restart key prefix index relies on plain bytewise ordering of user
+  // keys, so it is only enabled for BytewiseComparator (and not, e.g., for
+  // comparators with user-defined timestamps).
+  bool restart_key_prefix_seek =
+      rep->table_options.restart_key_prefix_seek &&
+      rep->internal_comparator.user_comparator() == BytewiseComparator();
+  rep->create_context = BlockCreateContext(
+      &rep->table_options, rep->ioptions.stats,
+      blocks_definitely_zstd_compressed, restart_key_prefix_seek,
+      footer.format_version());
 
   // Check expected unique id if provided
   if (expected_unique_id != kNullUniqueId64x2) {
@@ -753,6 +764,16 @@ Status BlockBasedTable::Open(
   SetupBaseCacheKey(rep->table_properties.get(), cur_db_session_id,
                     cur_file_num, &rep->base_cache_key);
 
+  // Lets a cost-aware block cache know how costly misses on blocks of this
+  // file are
+  if (rep->table_options.block_cache) {
+    const uint64_t read_latency_us = rep->file->file()->GetReadLatencyHint();
+    if (read_latency_us > 0) {
+      rep->table_options.block_cache->SetReadLatencyHint(
+          rep->base_cache_key.CommonPrefixSlice(), read_latency_us);
+    }
+  }
+
   rep->persistent_cache_options =
       PersistentCacheOptions(rep->table_options.persistent_cache,
                              rep->base_cache_key, rep->ioptions.stats);
@@ -1169,6 +1190,36 @@ Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
     rep_->uncompression_dict_reader = std::move(uncompression_dict_reader);
   }
 
+  if (rep_->range_filter_policy &&
+      rep_->internal_comparator.user_comparator() == BytewiseComparator()) {
+    // Like for the other filters, failing to load the range filter is not a
+    // hard error.
+    std::string range_filter_block_key = kRangeFilterBlockPrefix;
+    range_filter_block_key.append(rep_->range_filter_policy->Name());
+    BlockHandle range_filter_handle;
+    if (FindMetaBlock(meta_iter, range_filter_block_key, &range_filter_handle)
+            .ok()) {
+      BlockFetcher range_filter_block_fetcher(
+          rep_->file.get(), prefetch_buffer, rep_->footer, ro,
+          range_filter_handle, &rep_->range_filter_contents, rep_->ioptions,
+          false /*decompress*/, false /*maybe_compressed*/,
+          BlockType::kRangeFilter, UncompressionDict::GetEmptyDict(),
+          rep_->persistent_cache_options,
+          GetMemoryAllocator(rep_->table_options));
+      Status range_filter_s = range_filter_block_fetcher.ReadBlockContents();
+      if (range_filter_s.ok()) {
+        rep_->range_filter.reset(
+            rep_->range_filter_policy->GetRangeFilterBitsReader(
+                rep_->range_filter_contents.data));
+      } else {
+        ROCKS_LOG_WARN(rep_->ioptions.logger,
+                       "Failed to load range filter of %s: %s",
+                       rep_->file->file_name().c_str(),
+                       range_filter_s.ToString().c_str());
+      }
+    }
+  }
+
   assert(s.ok());
   return s;
 }
@@ -1212,6 +1263,10 @@ size_t BlockBasedTable::ApproximateMemoryUsage() const {
   if (rep_->uncompression_dict_reader) {
     usage += rep_->uncompression_dict_reader->ApproximateMemoryUsage();
   }
+  if (rep_->range_filter) {
+    usage += rep_->range_filter->ApproximateMemoryUsage() +
+             rep_->range_filter_contents.ApproximateMemoryUsage();
+  }
   if (rep_->table_properties) {
     usage += rep_->table_properties->ApproximateMemoryUsage();
   }
@@ -1661,6 +1716,16 @@ WithBlocklikeCheck<Status, TBlocklike> BlockBasedTable::RetrieveBlock(
       rep_->blocks_maybe_compressed;
   std::unique_ptr<TBlocklike> block;
 
+  // The block is not going to the block cache, so its buffers can come from
+  // the pool, which gets them back when the block is released.
+  MemoryAllocator* memory_allocator = GetMemoryAllocator(rep_->table_options);
+  MemoryAllocator* memory_allocator_compressed = nullptr;
+  if (memory_allocator == nullptr &&
+      rep_->table_options.pool_uncached_block_buffers) {
+    memory_allocator = BlockBufferPool::Default();
+    memory_allocator_compressed = memory_allocator;
+  }
+
   {
     Histograms histogram =
         for_compaction ? READ_BLOCK_COMPACTION_MICROS : READ_BLOCK_GET_MICROS;
@@ -1668,8 +1733,8 @@ WithBlocklikeCheck<Status, TBlocklike> BlockBasedTable::RetrieveBlock(
     s = ReadAndParseBlockFromFile(
         rep_->file.get(), prefetch_buffer, rep_->footer, ro, handle, &block,
         rep_->ioptions, rep_->create_context, maybe_compressed,
-        uncompression_dict, rep_->persistent_cache_options,
-        GetMemoryAllocator(rep_->table_options), for_compaction, async_read);
+        uncompression_dict, rep_->persistent_cache_options, memory_allocator,
+        for_compaction, async_read, memory_allocator_compressed);
 
     if (get_context) {
       switch (TBlocklike::kBlockType) {
@@ -1791,6 +1856,26 @@ bool BlockBasedTable::PrefixRangeMayMatch(
   return may_match;
 }
 
+bool BlockBasedTable::RangeMayMatch(const Slice& internal_key,
+                                    const ReadOptions& read_options) const {
+  const Slice* const upper_bound = read_options.iterate_upper_bound;
+  if (rep_->range_filter == nullptr || upper_bound == nullptr) {
+    return true;
+  }
+  // Range filters are only loaded for BytewiseComparator()
+  const Slice user_key = ExtractUserKey(internal_key);
+  if (user_key.compare(*upper_bound) >= 0) {
+    // Out of bound anyway
+    return true;
+  }
+  if (rep_->range_filter->MayMatchRange(user_key, *upper_bound)) {
+    PERF_COUNTER_ADD(range_filter_sst_hit_count, 1);
+    return true;
+  }
+  PERF_COUNTER_ADD(range_filter_sst_miss_count, 1);
+  return false;
+}
+
 bool BlockBasedTable::PrefixExtractorChanged(
     const SliceTransform* prefix_extractor) const {
   if (prefix_extractor == nullptr) {
@@ -1820,7 +1905,7 @@ InternalIterator* BlockBasedTable::NewIterator(
         this, read_options, rep_->internal_comparator, std::move(index_iter),
         !skip_filters && !read_options.total_order_seek &&
             prefix_extractor != nullptr,
-        need_upper_bound_check, prefix_extractor, caller,
+        !skip_filters, need_upper_bound_check, prefix_extractor, caller,
         compaction_readahead_size, allow_unprepared_value);
   } else {
     auto* mem = arena->AllocateAligned(sizeof(BlockBasedTableIterator));
@@ -1828,7 +1913,7 @@ InternalIterator* BlockBasedTable::NewIterator(
         this, read_options, rep_->internal_comparator, std::move(index_iter),
         !skip_filters && !read_options.total_order_seek &&
             prefix_extractor != nullptr,
-        need_upper_bound_check, prefix_extractor, caller,
+        !skip_filters, need_upper_bound_check, prefix_extractor, caller,
         compaction_readahead_size, allow_unprepared_value);
   }
 }
@@ -2072,6 +2157,8 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
         break;
       }
 
+      biter.SetWideColumnProjection(get_context->NeededWideColumns(
+          read_options.wide_column_projection));
       bool may_exist = biter.SeekForGet(key);
       // If user-specified timestamp is supported, we cannot end the search
       // just because hash index lookup indicates the key+ts does not exist.
@@ -2244,6 +2331,59 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
   return Status::OK();
 }
 
+Status BlockBasedTable::WarmUpBlockCache(const ReadOptions& read_options,
+                                         const std::vector<uint64_t>& block_ids,
+                                         uint64_t* num_blocks,
+                                         uint64_t* num_bytes) {
+  assert(std::is_sorted(block_ids.begin(), block_ids.end()));
+  if (rep_->table_options.block_cache == nullptr || block_ids.empty()) {
+    return Status::OK();
+  }
+  BlockCacheLookupContext lookup_context{TableReaderCaller::kPrefetch};
+  IndexBlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(read_options, /*need_upper_bound_check=*/false,
+                                &iiter_on_stack, /*get_context=*/nullptr,
+                                &lookup_context);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr = std::unique_ptr<InternalIteratorBase<IndexValue>>(iiter);
+  }
+
+  if (!iiter->status().ok()) {
+    // error opening index iterator
+    return iiter->status();
+  }
+
+  // Both the index and `block_ids` are in file order, so merge them.
+  auto id_it = block_ids.begin();
+  for (iiter->SeekToFirst(); iiter->Valid() && id_it != block_ids.end();
+       iiter->Next()) {
+    BlockHandle block_handle = iiter->value().handle;
+    // See GetCacheKey()
+    const uint64_t id = block_handle.offset() >> 2;
+    id_it = std::lower_bound(id_it, block_ids.end(), id);
+    if (id_it == block_ids.end() || *id_it != id) {
+      continue;
+    }
+
+    DataBlockIter biter;
+    Status tmp_status;
+    NewDataBlockIterator<DataBlockIter>(
+        read_options, block_handle, &biter, /*type=*/BlockType::kData,
+        /*get_context=*/nullptr, &lookup_context,
+        /*prefetch_buffer=*/nullptr, /*for_compaction=*/false,
+        /*async_read=*/false, tmp_status);
+
+    if (!biter.status().ok()) {
+      return biter.status();
+    }
+    ++*num_blocks;
+    *num_bytes += block_handle.size();
+  }
+
+  return iiter->status();
+}
+
 Status BlockBasedTable::VerifyChecksum(const ReadOptions& read_options,
                                        TableReaderCaller caller) {
   Status s;
@@ -2351,6 +2491,14 @@ BlockType BlockBasedTable::GetBlockTypeForMetaBlockByName(
     return BlockType::kHashIndexMetadata;
   }
 
+  if (meta_block_name == kLearnedIndexModelBlock) {
+    return BlockType::kLearnedIndexModel;
+  }
+
+  if (meta_block_name.starts_with(kRangeFilterBlockPrefix)) {
+    return BlockType::kRangeFilter;
+  }
+
   if (meta_block_name.starts_with(kObsoleteFilterBlockPrefix)) {
     // Obsolete but possible in old files
     return BlockType::kInvalid;
@@ -2466,6 +2614,11 @@ Status BlockBasedTable::CreateIndexReader(
                                        index_reader);
       }
     }
+    case BlockBasedTableOptions::kLearnedIndexSearch: {
+      return LearnedIndexReader::Create(this, ro, prefetch_buffer, meta_iter,
+                                        use_cache, prefetch, pin,
+                                        lookup_context, index_reader);
+    }
     default: {
       std::string error_message =
           "Unrecognized index type: " + std::to_string(rep_->index_type);
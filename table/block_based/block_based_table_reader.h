@@ -17,6 +17,7 @@
 #include "cache/cache_reservation_manager.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "file/filename.h"
+#include "rocksdb/filter_policy.h"
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/table_properties.h"
 #include "table/block_based/block.h"
@@ -70,6 +71,7 @@ class BlockBasedTable : public TableReader {
   static const std::string kObsoleteFilterBlockPrefix;
   static const std::string kFullFilterBlockPrefix;
   static const std::string kPartitionedFilterBlockPrefix;
+  static const std::string kRangeFilterBlockPrefix;
 
   // 1-byte compression type + 32-bit checksum
   static constexpr size_t kBlockTrailerSize = 5;
@@ -118,6 +120,12 @@ class BlockBasedTable : public TableReader {
                            const bool need_upper_bound_check,
                            BlockCacheLookupContext* lookup_context) const;
 
+  // Returns false if the range filter of the table (if any) shows that the
+  // table has no key in [user key of `internal_key`,
+  // read_options.iterate_upper_bound).
+  bool RangeMayMatch(const Slice& internal_key,
+                     const ReadOptions& read_options) const;
+
   // Returns a new iterator over the table contents.
   // The result of NewIterator() is initially invalid (caller must
   // call one of the Seek methods on the iterator before using it).
@@ -174,6 +182,12 @@ class BlockBasedTable : public TableReader {
   Status ApproximateKeyAnchors(const ReadOptions& read_options,
                                std::vector<Anchor>& anchors) override;
 
+  // The ids are the offsets passed to OffsetableCacheKey::WithOffset() by
+  // GetCacheKey().
+  Status WarmUpBlockCache(const ReadOptions& read_options,
+                          const std::vector<uint64_t>& block_ids,
+                          uint64_t* num_blocks, uint64_t* num_bytes) override;
+
   bool TEST_BlockInCache(const BlockHandle& handle) const;
 
   // Returns true if the block for the specified key is in cache.
@@ -531,6 +545,9 @@ struct BlockBasedTable::Rep {
         env_options(_env_options),
         table_options(_table_opt),
         filter_policy(skip_filters ? nullptr : _table_opt.filter_policy.get()),
+        range_filter_policy(skip_filters
+                                ? nullptr
+                                : _table_opt.range_filter_policy.get()),
         internal_comparator(_internal_comparator),
         filter_type(FilterType::kNoFilter),
         index_type(BlockBasedTableOptions::IndexType::kBinarySearch),
@@ -545,6 +562,7 @@ struct BlockBasedTable::Rep {
   const EnvOptions& env_options;
   const BlockBasedTableOptions table_options;
   const FilterPolicy* const filter_policy;
+  const RangeFilterPolicy* const range_filter_policy;
   const InternalKeyComparator& internal_comparator;
   Status status;
   std::unique_ptr<RandomAccessFileReader> file;
@@ -557,6 +575,10 @@ struct BlockBasedTable::Rep {
   std::unique_ptr<IndexReader> index_reader;
   std::unique_ptr<FilterBlockReader> filter;
   std::unique_ptr<UncompressionDictReader> uncompression_dict_reader;
+  // The range filter is small enough to be kept with the table reader.
+  // range_filter refers to range_filter_contents.
+  BlockContents range_filter_contents;
+  std::unique_ptr<RangeFilterBitsReader> range_filter;
 
   enum class FilterType {
     kNoFilter,
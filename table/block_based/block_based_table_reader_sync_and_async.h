@@ -658,6 +658,8 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::MultiGet)
           value_pinner = nullptr;
         }
 
+        biter->SetWideColumnProjection(get_context->NeededWideColumns(
+            read_options.wide_column_projection));
         bool may_exist = biter->SeekForGet(key);
         if (!may_exist) {
           // HashSeek cannot find the key this block and the the iter is not
@@ -28,8 +28,15 @@
 //
 // The trailer of the block has the form:
 //     restarts: uint32[num_restarts]
+//     restart_key_prefixes: fixed64[num_restarts] (optional)
+//     wide_columns: char[] (optional)
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+// restart_key_prefixes[i] contains the first 8 bytes of the ith restart key
+// (see RestartKeyPrefixIndex), and its presence is flagged in num_restarts.
+// wide_columns holds the column values of the wide-column entities of the
+// block, whose values are then row descriptors (see DataBlockWideColumns);
+// its presence is also flagged in num_restarts.
 
 #include "table/block_based/block_builder.h"
 
@@ -40,6 +47,7 @@
 #include "db/dbformat.h"
 #include "rocksdb/comparator.h"
 #include "table/block_based/data_block_footer.h"
+#include "table/block_based/restart_key_prefix_index.h"
 #include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -48,19 +56,22 @@ BlockBuilder::BlockBuilder(
     int block_restart_interval, bool use_delta_encoding,
     bool use_value_delta_encoding,
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    double data_block_hash_table_util_ratio)
+    double data_block_hash_table_util_ratio, bool use_restart_key_prefixes,
+    bool use_wide_column_section, bool use_wide_hash_buckets)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
       use_value_delta_encoding_(use_value_delta_encoding),
       restarts_(1, 0),  // First restart point is at offset 0
       counter_(0),
-      finished_(false) {
+      finished_(false),
+      use_restart_key_prefixes_(use_restart_key_prefixes),
+      use_wide_column_section_(use_wide_column_section) {
   switch (index_type) {
     case BlockBasedTableOptions::kDataBlockBinarySearch:
       break;
     case BlockBasedTableOptions::kDataBlockBinaryAndHash:
       data_block_hash_index_builder_.Initialize(
-          data_block_hash_table_util_ratio);
+          data_block_hash_table_util_ratio, use_wide_hash_buckets);
       break;
     default:
       assert(0);
@@ -80,6 +91,8 @@ void BlockBuilder::Reset() {
   if (data_block_hash_index_builder_.Valid()) {
     data_block_hash_index_builder_.Reset();
   }
+  restart_key_prefixes_.clear();
+  wide_columns_builder_.Reset();
 #ifndef NDEBUG
   add_with_last_key_called_ = false;
 #endif
@@ -105,6 +118,9 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key,
 
   if (counter_ >= block_restart_interval_) {
     estimate += sizeof(uint32_t);  // a new restart entry.
+    if (use_restart_key_prefixes_) {
+      estimate += RestartKeyPrefixIndex::kPrefixSize;
+    }
   }
 
   estimate += sizeof(int32_t);  // varint for shared prefix length.
@@ -125,6 +141,22 @@ Slice BlockBuilder::Finish() {
   }
 
   uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
+
+  // Append restart key prefixes, unless the block is empty (and thus the
+  // sole restart point has no key).
+  bool has_restart_key_prefixes =
+      use_restart_key_prefixes_ &&
+      restart_key_prefixes_.size() ==
+          num_restarts * RestartKeyPrefixIndex::kPrefixSize;
+  if (has_restart_key_prefixes) {
+    buffer_.append(restart_key_prefixes_);
+  }
+
+  const bool has_wide_columns = !wide_columns_builder_.empty();
+  if (has_wide_columns) {
+    wide_columns_builder_.Finish(buffer_);
+  }
+
   BlockBasedTableOptions::DataBlockIndexType index_type =
       BlockBasedTableOptions::kDataBlockBinarySearch;
   if (data_block_hash_index_builder_.Valid() &&
@@ -134,7 +166,8 @@ Slice BlockBuilder::Finish() {
   }
 
   // footer is a packed format of data_block_index_type and num_restarts
-  uint32_t block_footer = PackIndexTypeAndNumRestarts(index_type, num_restarts);
+  uint32_t block_footer = PackIndexTypeAndNumRestarts(
+      index_type, num_restarts, has_restart_key_prefixes, has_wide_columns);
 
   PutFixed32(&buffer_, block_footer);
   finished_ = true;
@@ -180,13 +213,23 @@ void BlockBuilder::AddWithLastKey(const Slice& key, const Slice& value,
 }
 
 inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
-                                             const Slice& value,
+                                             const Slice& value_param,
                                              const Slice& last_key,
                                              const Slice* const delta_value,
                                              size_t buffer_size) {
   assert(!finished_);
   assert(counter_ <= block_restart_interval_);
   assert(!use_value_delta_encoding_ || delta_value);
+  Slice value = value_param;
+  if (use_wide_column_section_ &&
+      ExtractValueType(key) == kTypeWideColumnEntity) {
+    // Only the row descriptor is stored inline; the column values go to the
+    // wide-column section.
+    assert(!use_value_delta_encoding_);
+    wide_column_row_.clear();
+    wide_columns_builder_.AddEntity(value, &wide_column_row_);
+    value = wide_column_row_;
+  }
   size_t shared = 0;  // number of bytes shared with prev key
   if (counter_ >= block_restart_interval_) {
     // Restart compression
@@ -198,6 +241,13 @@ inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
     shared = key.difference_offset(last_key);
   }
 
+  if (use_restart_key_prefixes_ && counter_ == 0) {
+    // First key of a restart interval
+    RestartKeyPrefixIndex::AppendPrefix(&restart_key_prefixes_,
+                                        ExtractUserKey(key));
+    estimate_ += RestartKeyPrefixIndex::kPrefixSize;
+  }
+
   const size_t non_shared = key.size() - shared;
 
   if (use_value_delta_encoding_) {
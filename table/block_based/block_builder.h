@@ -15,6 +15,7 @@
 #include "rocksdb/slice.h"
 #include "rocksdb/table.h"
 #include "table/block_based/data_block_hash_index.h"
+#include "table/block_based/data_block_wide_columns.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -28,7 +29,10 @@ class BlockBuilder {
                         bool use_value_delta_encoding = false,
                         BlockBasedTableOptions::DataBlockIndexType index_type =
                             BlockBasedTableOptions::kDataBlockBinarySearch,
-                        double data_block_hash_table_util_ratio = 0.75);
+                        double data_block_hash_table_util_ratio = 0.75,
+                        bool use_restart_key_prefixes = false,
+                        bool use_wide_column_section = false,
+                        bool use_wide_hash_buckets = false);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
@@ -64,9 +68,11 @@ class BlockBuilder {
   // Returns an estimate of the current (uncompressed) size of the block
   // we are building.
   inline size_t CurrentSizeEstimate() const {
-    return estimate_ + (data_block_hash_index_builder_.Valid()
-                            ? data_block_hash_index_builder_.EstimateSize()
-                            : 0);
+    return estimate_ +
+           (data_block_hash_index_builder_.Valid()
+                ? data_block_hash_index_builder_.EstimateSize()
+                : 0) +
+           wide_columns_builder_.EstimateSize();
   }
 
   // Returns an estimated block size after appending key and value.
@@ -94,6 +100,17 @@ class BlockBuilder {
   bool finished_;  // Has Finish() been called?
   std::string last_key_;
   DataBlockHashIndexBuilder data_block_hash_index_builder_;
+  // Whether to persist a RestartKeyPrefixIndex array. Requires internal keys
+  // ordered by BytewiseComparator.
+  const bool use_restart_key_prefixes_;
+  // Encoded prefixes of the restart keys, one per entry in restarts_.
+  std::string restart_key_prefixes_;
+  // Whether to store wide-column entities in a DataBlockWideColumns section.
+  // Requires internal keys.
+  const bool use_wide_column_section_;
+  DataBlockWideColumnsBuilder wide_columns_builder_;
+  // Row descriptor of the entity being added
+  std::string wide_column_row_;
 #ifndef NDEBUG
   bool add_with_last_key_called_ = false;
 #endif
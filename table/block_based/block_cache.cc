@@ -10,7 +10,9 @@ namespace ROCKSDB_NAMESPACE {
 void BlockCreateContext::Create(std::unique_ptr<Block_kData>* parsed_out,
                                 BlockContents&& block) {
   parsed_out->reset(new Block_kData(
-      std::move(block), table_options->read_amp_bytes_per_bit, statistics));
+      std::move(block), table_options->read_amp_bytes_per_bit, statistics,
+      restart_key_prefix_seek,
+      FormatVersionAllowsRestartKeyPrefixes(format_version)));
 }
 void BlockCreateContext::Create(std::unique_ptr<Block_kIndex>* parsed_out,
                                 BlockContents&& block) {
@@ -63,6 +65,8 @@ constexpr std::array<const Cache::CacheItemHelper*,
         nullptr,  // kHashIndexMetadata
         nullptr,  // kMetaIndex (not yet stored in block cache)
         &BlockCacheInterface<Block_kIndex>::kFullHelper,
+        nullptr,  // kLearnedIndexModel
+        nullptr,  // kRangeFilter
         nullptr,  // kInvalid
     }};
 
@@ -80,6 +84,8 @@ constexpr std::array<const Cache::CacheItemHelper*,
         nullptr,  // kHashIndexMetadata
         nullptr,  // kMetaIndex (not yet stored in block cache)
         &BlockCacheInterface<Block_kIndex>::kBasicHelper,
+        nullptr,  // kLearnedIndexModel
+        nullptr,  // kRangeFilter
         nullptr,  // kInvalid
     }};
 }  // namespace
@@ -70,14 +70,23 @@ class Block_kMetaIndex : public Block {
 struct BlockCreateContext : public Cache::CreateContext {
   BlockCreateContext() {}
   BlockCreateContext(const BlockBasedTableOptions* _table_options,
-                     Statistics* _statistics, bool _using_zstd)
+                     Statistics* _statistics, bool _using_zstd,
+                     bool _restart_key_prefix_seek = false,
+                     uint32_t _format_version = 0)
       : table_options(_table_options),
         statistics(_statistics),
-        using_zstd(_using_zstd) {}
+        using_zstd(_using_zstd),
+        restart_key_prefix_seek(_restart_key_prefix_seek),
+        format_version(_format_version) {}
 
   const BlockBasedTableOptions* table_options = nullptr;
   Statistics* statistics = nullptr;
   bool using_zstd = false;
+  // Whether data blocks should be parsed with a RestartKeyPrefixIndex. Only
+  // set when the table's keys are ordered by BytewiseComparator.
+  bool restart_key_prefix_seek = false;
+  // format_version of the table, from its footer
+  uint32_t format_version = 0;
 
   // For TypedCacheInterface
   template <typename TBlocklike>
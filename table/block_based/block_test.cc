@@ -17,6 +17,7 @@
 
 #include "db/dbformat.h"
 #include "db/memtable.h"
+#include "db/wide/wide_column_serialization.h"
 #include "db/write_batch_internal.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
@@ -127,6 +128,283 @@ TEST_F(BlockTest, SimpleTest) {
   delete iter;
 }
 
+// Blocks that store wide-column entities in a column section must return
+// the same entities (and plain values) as row-wise blocks, and only the
+// projected columns when a projection is set.
+TEST_F(BlockTest, ColumnarEntities) {
+  Random rnd(301);
+  const std::vector<std::string> kColumnNames = {"", "a", "bb", "c", "dd"};
+  const std::vector<Slice> projection = {Slice("bb"), kDefaultWideColumnName,
+                                         Slice("missing")};
+  // Small enough for the hash index
+  const int kNumRecords = 400;
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  std::vector<std::string> projected_values;
+  for (int i = 0; i < kNumRecords; i++) {
+    std::string key = GenerateInternalKey(i, 0, 0, &rnd);
+    if (i % 3 == 0) {
+      keys.push_back(key);
+      values.push_back(rnd.RandomString(20));
+      projected_values.push_back(values.back());
+      continue;
+    }
+    key.resize(key.size() - 8);
+    AppendInternalKeyFooter(&key, 0 /* seqno */, kTypeWideColumnEntity);
+    keys.push_back(key);
+    std::vector<std::string> column_values;
+    WideColumns columns;
+    WideColumns projected;
+    for (size_t c = 0; c < kColumnNames.size(); c++) {
+      column_values.push_back(rnd.RandomString(rnd.Uniform(30)));
+    }
+    for (size_t c = 0; c < kColumnNames.size(); c++) {
+      if (rnd.OneIn(3)) {
+        continue;
+      }
+      columns.emplace_back(kColumnNames[c], column_values[c]);
+      if (std::find(projection.begin(), projection.end(),
+                    columns.back().name()) != projection.end()) {
+        projected.push_back(columns.back());
+      }
+    }
+    std::string entity;
+    ASSERT_OK(WideColumnSerialization::Serialize(columns, entity));
+    values.push_back(entity);
+    std::string projected_entity;
+    ASSERT_OK(WideColumnSerialization::Serialize(projected, projected_entity));
+    projected_values.push_back(projected_entity);
+  }
+
+  for (auto index_type : {BlockBasedTableOptions::kDataBlockBinarySearch,
+                          BlockBasedTableOptions::kDataBlockBinaryAndHash}) {
+    BlockBuilder builder(16, true /* use_delta_encoding */,
+                         false /* use_value_delta_encoding */, index_type,
+                         0.75 /* data_block_hash_table_util_ratio */,
+                         false /* use_restart_key_prefixes */,
+                         true /* use_wide_column_section */);
+    for (int i = 0; i < kNumRecords; i++) {
+      builder.Add(keys[i], values[i]);
+    }
+    BlockContents contents;
+    contents.data = builder.Finish();
+    Block reader(std::move(contents));
+    ASSERT_TRUE(reader.HasWideColumns());
+    ASSERT_EQ(index_type, reader.IndexType());
+
+    for (bool project : {false, true}) {
+      const std::vector<std::string> &expected =
+          project ? projected_values : values;
+      std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+          BytewiseComparator(), kDisableGlobalSequenceNumber, nullptr,
+          nullptr, true /* block_contents_pinned */));
+      iter->SetWideColumnProjection(project ? &projection : nullptr);
+      int count = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next(), count++) {
+        ASSERT_EQ(keys[count], iter->key().ToString());
+        ASSERT_EQ(expected[count], iter->value().ToString());
+        ASSERT_FALSE(iter->IsValuePinned());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(kNumRecords, count);
+
+      for (int i = 0; i < 100; i++) {
+        const int index = static_cast<int>(rnd.Uniform(kNumRecords));
+        ASSERT_TRUE(iter->SeekForGet(keys[index]));
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(expected[index], iter->value().ToString());
+        if (index > 0) {
+          iter->Prev();
+          ASSERT_EQ(expected[index - 1], iter->value().ToString());
+        }
+      }
+    }
+  }
+
+  // Blocks without entities do not get a column section.
+  BlockBuilder builder(16, true /* use_delta_encoding */,
+                       false /* use_value_delta_encoding */,
+                       BlockBasedTableOptions::kDataBlockBinarySearch,
+                       0.75 /* data_block_hash_table_util_ratio */,
+                       false /* use_restart_key_prefixes */,
+                       true /* use_wide_column_section */);
+  builder.Add(keys[0], values[0]);
+  BlockContents contents;
+  contents.data = builder.Finish();
+  Block reader(std::move(contents));
+  ASSERT_FALSE(reader.HasWideColumns());
+}
+
+// Seeks in a block with a RestartKeyPrefixIndex, whether built in memory or
+// persisted in the block (with or without a hash index), must land on the
+// same entries as plain binary search, including for targets that are absent,
+// share long prefixes with their neighbors, or differ only in sequence
+// number.
+TEST_F(BlockTest, RestartKeyPrefixSeek) {
+  Random rnd(301);
+  Options options = Options();
+
+  for (int restart_interval : {1, 4, 16}) {
+    std::vector<std::string> keys;
+    BlockBuilder builder(restart_interval);
+    for (int i = 0; i < 2000; ++i) {
+      // Short keys, keys longer than the 8 byte prefix that tie on it, and
+      // multiple versions of one user key.
+      std::string user_key =
+          (i % 3 == 0) ? std::to_string(100000 + i)
+                       : "key" + std::to_string(10000 + i / 7) +
+                             std::string(i % 7, 'x');
+      for (SequenceNumber seq : {SequenceNumber{9}, SequenceNumber{3}}) {
+        std::string ikey = user_key;
+        AppendInternalKeyFooter(&ikey, seq, kTypeValue);
+        keys.push_back(ikey);
+      }
+    }
+    // Prefixes at the top of the range must not overflow.
+    for (size_t len : {7, 8, 9}) {
+      std::string ikey(len, '\xff');
+      AppendInternalKeyFooter(&ikey, 1, kTypeValue);
+      keys.push_back(ikey);
+    }
+    InternalKeyComparator icmp(options.comparator);
+    std::sort(keys.begin(), keys.end(),
+              [&](const std::string &a, const std::string &b) {
+                return icmp.Compare(a, b) < 0;
+              });
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    BlockBuilder persisted_builder(
+        restart_interval, true /* use_delta_encoding */,
+        false /* use_value_delta_encoding */,
+        BlockBasedTableOptions::kDataBlockBinarySearch,
+        0.75 /* data_block_hash_table_util_ratio */,
+        true /* use_restart_key_prefixes */);
+    BlockBuilder persisted_hash_builder(
+        restart_interval, true /* use_delta_encoding */,
+        false /* use_value_delta_encoding */,
+        BlockBasedTableOptions::kDataBlockBinaryAndHash,
+        0.75 /* data_block_hash_table_util_ratio */,
+        true /* use_restart_key_prefixes */);
+    // Keep the hash index variant under its 64KiB and 253 restart interval
+    // limits.
+    const size_t kHashKeys = std::min<size_t>(
+        {keys.size(), size_t{1000},
+         size_t{kMaxRestartSupportedByHashIndex} *
+             static_cast<size_t>(restart_interval)});
+    for (size_t i = 0; i < keys.size(); ++i) {
+      builder.Add(keys[i], "v");
+      persisted_builder.Add(keys[i], "v");
+      if (i < kHashKeys) {
+        persisted_hash_builder.Add(keys[i], "v");
+      }
+    }
+    Slice rawblock = builder.Finish();
+
+    // On the heap, as ApproximateMemoryUsage() might measure the Block itself
+    // with malloc_usable_size()
+    BlockContents plain_contents;
+    plain_contents.data = rawblock;
+    std::unique_ptr<Block> plain(new Block(std::move(plain_contents)));
+    BlockContents prefix_contents;
+    prefix_contents.data = rawblock;
+    std::unique_ptr<Block> prefixed(new Block(
+        std::move(prefix_contents), 0 /* read_amp_bytes_per_bit */,
+        nullptr /* statistics */, true /* restart_key_prefix_seek */));
+    ASSERT_GT(prefixed->ApproximateMemoryUsage(),
+              plain->ApproximateMemoryUsage());
+    ASSERT_FALSE(plain->HasRestartKeyPrefixes());
+
+    BlockContents persisted_contents;
+    persisted_contents.data = persisted_builder.Finish();
+    // Only recognized for format_version >= 6
+    BlockContents unrecognized_contents;
+    unrecognized_contents.data = persisted_contents.data;
+    Block unrecognized(std::move(unrecognized_contents));
+    ASSERT_FALSE(unrecognized.HasRestartKeyPrefixes());
+    Block persisted(std::move(persisted_contents),
+                    0 /* read_amp_bytes_per_bit */, nullptr /* statistics */,
+                    false /* restart_key_prefix_seek */,
+                    true /* allow_restart_key_prefixes */);
+    ASSERT_TRUE(persisted.HasRestartKeyPrefixes());
+    ASSERT_EQ(persisted.NumRestarts(), plain->NumRestarts());
+    ASSERT_EQ(persisted.size(),
+              plain->size() +
+                  plain->NumRestarts() * RestartKeyPrefixIndex::kPrefixSize);
+
+    BlockContents persisted_hash_contents;
+    persisted_hash_contents.data = persisted_hash_builder.Finish();
+    Block persisted_hash(std::move(persisted_hash_contents),
+                         0 /* read_amp_bytes_per_bit */,
+                         nullptr /* statistics */,
+                         false /* restart_key_prefix_seek */,
+                         true /* allow_restart_key_prefixes */);
+    ASSERT_TRUE(persisted_hash.HasRestartKeyPrefixes());
+    ASSERT_EQ(persisted_hash.IndexType(),
+              BlockBasedTableOptions::kDataBlockBinaryAndHash);
+
+    std::unique_ptr<DataBlockIter> plain_iter(plain->NewDataIterator(
+        options.comparator, kDisableGlobalSequenceNumber));
+    std::vector<std::unique_ptr<DataBlockIter>> prefixed_iters;
+    prefixed_iters.emplace_back(prefixed->NewDataIterator(
+        options.comparator, kDisableGlobalSequenceNumber));
+    prefixed_iters.emplace_back(persisted.NewDataIterator(
+        options.comparator, kDisableGlobalSequenceNumber));
+
+    // Entries past the end of the hash index variant are checked only
+    // against the other iterators.
+    std::unique_ptr<DataBlockIter> persisted_hash_iter(
+        persisted_hash.NewDataIterator(options.comparator,
+                                       kDisableGlobalSequenceNumber));
+    std::string hash_limit = keys[kHashKeys - 1];
+
+    auto check = [&](const Slice &target) {
+      plain_iter->Seek(target);
+      for (auto &prefixed_iter : prefixed_iters) {
+        prefixed_iter->Seek(target);
+        ASSERT_EQ(plain_iter->Valid(), prefixed_iter->Valid());
+        if (plain_iter->Valid()) {
+          ASSERT_EQ(plain_iter->key(), prefixed_iter->key());
+        }
+      }
+      if (icmp.Compare(target, hash_limit) <= 0) {
+        persisted_hash_iter->Seek(target);
+        ASSERT_TRUE(persisted_hash_iter->Valid());
+        ASSERT_EQ(plain_iter->key(), persisted_hash_iter->key());
+      }
+      plain_iter->SeekForPrev(target);
+      for (auto &prefixed_iter : prefixed_iters) {
+        prefixed_iter->SeekForPrev(target);
+        ASSERT_EQ(plain_iter->Valid(), prefixed_iter->Valid());
+        if (plain_iter->Valid()) {
+          ASSERT_EQ(plain_iter->key(), prefixed_iter->key());
+        }
+      }
+    };
+
+    for (const auto &key : keys) {
+      check(key);
+      // Same user key, newer and older than every version.
+      std::string user_key = ExtractUserKey(key).ToString();
+      std::string newest = user_key;
+      AppendInternalKeyFooter(&newest, kMaxSequenceNumber, kValueTypeForSeek);
+      check(newest);
+      std::string oldest = user_key;
+      AppendInternalKeyFooter(&oldest, 0, kTypeDeletion);
+      check(oldest);
+    }
+    for (int i = 0; i < 2000; ++i) {
+      std::string target = rnd.RandomString(rnd.Uniform(12));
+      AppendInternalKeyFooter(&target, rnd.Uniform(12), kTypeValue);
+      check(target);
+    }
+    std::string empty_target;
+    AppendInternalKeyFooter(&empty_target, kMaxSequenceNumber, kTypeValue);
+    check(empty_target);
+    std::string max_target(12, '\xff');
+    AppendInternalKeyFooter(&max_target, 0, kTypeValue);
+    check(max_target);
+  }
+}
+
 // return the block contents
 BlockContents GetBlockContents(std::unique_ptr<BlockBuilder> *builder,
                                const std::vector<std::string> &keys,
@@ -13,13 +13,19 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+// The data block footer packs num_restarts with the data block index type
+// in the MSB. The next bit flags a persisted restart key prefix array (see
+// RestartKeyPrefixIndex), and the one after it a wide-column section (see
+// DataBlockWideColumns).
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts);
+    uint32_t num_restarts, bool has_restart_key_prefixes = false,
+    bool has_wide_columns = false);
 
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
-    uint32_t* num_restarts);
+    uint32_t* num_restarts, bool* has_restart_key_prefixes = nullptr,
+    bool* has_wide_columns = nullptr);
 
 }  // namespace ROCKSDB_NAMESPACE
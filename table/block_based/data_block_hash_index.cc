@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 #include "table/block_based/data_block_hash_index.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -16,20 +17,23 @@ namespace ROCKSDB_NAMESPACE {
 void DataBlockHashIndexBuilder::Add(const Slice& key,
                                     const size_t restart_index) {
   assert(Valid());
-  if (restart_index > kMaxRestartSupportedByHashIndex) {
+  if (restart_index > (allow_wide_buckets_
+                           ? size_t{kMaxRestartSupportedByWideHashIndex}
+                           : size_t{kMaxRestartSupportedByHashIndex})) {
     valid_ = false;
     return;
   }
 
   uint32_t hash_value = GetSliceHash(key);
   hash_and_restart_pairs_.emplace_back(hash_value,
-                                       static_cast<uint8_t>(restart_index));
+                                       static_cast<uint16_t>(restart_index));
   estimated_num_buckets_ += bucket_per_key_;
+  max_restart_index_ = std::max(max_restart_index_, restart_index);
 }
 
-void DataBlockHashIndexBuilder::Finish(std::string& buffer) {
-  assert(Valid());
-  uint16_t num_buckets = static_cast<uint16_t>(estimated_num_buckets_);
+uint16_t DataBlockHashIndexBuilder::NumBuckets() const {
+  uint16_t num_buckets = static_cast<uint16_t>(
+      std::min(estimated_num_buckets_, double{kMaxHashIndexBuckets}));
 
   if (num_buckets == 0) {
     num_buckets = 1;  // sanity check
@@ -39,30 +43,41 @@ void DataBlockHashIndexBuilder::Finish(std::string& buffer) {
   // buckets when num_buckets is power of two, resulting in high hash
   // collision.
   // We made the num_buckets to be odd to avoid this issue.
-  num_buckets |= 1;
+  return num_buckets | 1;
+}
 
-  std::vector<uint8_t> buckets(num_buckets, kNoEntry);
+void DataBlockHashIndexBuilder::Finish(std::string& buffer) {
+  assert(Valid());
+  const uint16_t num_buckets = NumBuckets();
+  const bool wide = BucketSize() == sizeof(uint16_t);
+  const uint16_t no_entry = wide ? kHashIndexNoEntry : kNoEntry;
+  const uint16_t collision = wide ? kHashIndexCollision : kCollision;
+
+  std::vector<uint16_t> buckets(num_buckets, no_entry);
   // write the restart_index array
   for (auto& entry : hash_and_restart_pairs_) {
     uint32_t hash_value = entry.first;
-    uint8_t restart_index = entry.second;
+    uint16_t restart_index = entry.second;
     uint16_t buck_idx = static_cast<uint16_t>(hash_value % num_buckets);
-    if (buckets[buck_idx] == kNoEntry) {
+    if (buckets[buck_idx] == no_entry) {
       buckets[buck_idx] = restart_index;
     } else if (buckets[buck_idx] != restart_index) {
       // same bucket cannot store two different restart_index, mark collision
-      buckets[buck_idx] = kCollision;
+      buckets[buck_idx] = collision;
     }
   }
 
-  for (uint8_t restart_index : buckets) {
-    buffer.append(
-        const_cast<const char*>(reinterpret_cast<char*>(&restart_index)),
-        sizeof(restart_index));
+  for (uint16_t restart_index : buckets) {
+    if (wide) {
+      PutFixed16(&buffer, restart_index);
+    } else {
+      buffer.push_back(static_cast<char>(restart_index));
+    }
   }
 
   // write NUM_BUCK
-  PutFixed16(&buffer, num_buckets);
+  PutFixed16(&buffer, wide ? (num_buckets | kHashIndexWideBucketsFlag)
+                           : num_buckets);
 
   assert(buffer.size() <= kMaxBlockSizeSupportedByHashIndex);
 }
@@ -70,25 +85,40 @@ void DataBlockHashIndexBuilder::Finish(std::string& buffer) {
 void DataBlockHashIndexBuilder::Reset() {
   estimated_num_buckets_ = 0;
   valid_ = true;
+  max_restart_index_ = 0;
   hash_and_restart_pairs_.clear();
 }
 
 void DataBlockHashIndex::Initialize(const char* data, uint16_t size,
                                     uint16_t* map_offset) {
   assert(size >= sizeof(uint16_t));  // NUM_BUCKETS
-  num_buckets_ = DecodeFixed16(data + size - sizeof(uint16_t));
+  const uint16_t num_buck = DecodeFixed16(data + size - sizeof(uint16_t));
+  wide_ = (num_buck & kHashIndexWideBucketsFlag) != 0;
+  num_buckets_ = num_buck & kMaxHashIndexBuckets;
+  const size_t bucket_size = wide_ ? sizeof(uint16_t) : sizeof(uint8_t);
   assert(num_buckets_ > 0);
-  assert(size > num_buckets_ * sizeof(uint8_t));
+  assert(size > num_buckets_ * bucket_size);
   *map_offset = static_cast<uint16_t>(size - sizeof(uint16_t) -
-                                      num_buckets_ * sizeof(uint8_t));
+                                      num_buckets_ * bucket_size);
+  map_offset_ = *map_offset;
 }
 
-uint8_t DataBlockHashIndex::Lookup(const char* data, uint32_t map_offset,
-                                   const Slice& key) const {
+uint16_t DataBlockHashIndex::Lookup(const char* data, uint32_t map_offset,
+                                    const Slice& key) const {
   uint32_t hash_value = GetSliceHash(key);
   uint16_t idx = static_cast<uint16_t>(hash_value % num_buckets_);
   const char* bucket_table = data + map_offset;
-  return static_cast<uint8_t>(*(bucket_table + idx * sizeof(uint8_t)));
+  if (wide_) {
+    return DecodeFixed16(bucket_table + idx * sizeof(uint16_t));
+  }
+  const uint8_t entry =
+      static_cast<uint8_t>(*(bucket_table + idx * sizeof(uint8_t)));
+  if (entry == kNoEntry) {
+    return kHashIndexNoEntry;
+  } else if (entry == kCollision) {
+    return kHashIndexCollision;
+  }
+  return entry;
 }
 
 }  // namespace ROCKSDB_NAMESPACE
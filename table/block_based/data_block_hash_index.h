@@ -16,7 +16,8 @@ namespace ROCKSDB_NAMESPACE {
 // point-lookup within a data-block. It is only used in data blocks, and not
 // in meta-data blocks or per-table index blocks.
 //
-// It only used to support BlockBasedTable::Get().
+// It is used by BlockBasedTable::Get() and, for seek keys whose user key is
+// in the block, by Seek() on data block iterators.
 //
 // A serialized hash index is appended to the data-block. The new block data
 // format is as follows:
@@ -60,13 +61,33 @@ namespace ROCKSDB_NAMESPACE {
 // (kCollision). If either of those happens, we get the restart index of
 // the key and will directly go to the restart interval to search the key.
 //
-// Note that we only support blocks with #restart_interval < 254. If a block
-// has more restart interval than that, hash index will not be create for it.
+// Note that these buckets only support blocks with #restart_interval < 254.
+// A block with more restart intervals gets a hash index with 16-bit buckets
+// if BlockBasedTableOptions::data_block_hash_index_wide_buckets is set, and
+// none otherwise. Wide buckets are flagged by the MSB of NUM_BUCK, which is
+// otherwise never set since the number of buckets is capped at 32767:
+//
+// HASH_IDX: [WB WB WB ... WB NUM_BUCK]
+//
+// WB:        uint16_t bucket, with the special values kHashIndexNoEntry and
+//            kHashIndexCollision.
+// NUM_BUCK:  Number of buckets, with the MSB set.
+//
+// Blocks with wide buckets cannot be read by older versions, which is why
+// they are only written when needed.
 
 const uint8_t kNoEntry = 255;
 const uint8_t kCollision = 254;
 const uint8_t kMaxRestartSupportedByHashIndex = 253;
 
+// Results of DataBlockHashIndex::Lookup() other than a restart index, and
+// special values of wide buckets
+const uint16_t kHashIndexNoEntry = 0xFFFF;
+const uint16_t kHashIndexCollision = 0xFFFE;
+const uint16_t kMaxRestartSupportedByWideHashIndex = 0xFFFD;
+const uint16_t kHashIndexWideBucketsFlag = 0x8000;
+const uint16_t kMaxHashIndexBuckets = 0x7FFF;
+
 // Because we use uint16_t address, we only support block no more than 64KB
 const size_t kMaxBlockSizeSupportedByHashIndex = 1u << 16;
 const double kDefaultUtilRatio = 0.75;
@@ -76,14 +97,17 @@ class DataBlockHashIndexBuilder {
   DataBlockHashIndexBuilder()
       : bucket_per_key_(-1 /*uninitialized marker*/),
         estimated_num_buckets_(0),
-        valid_(false) {}
+        valid_(false),
+        allow_wide_buckets_(false),
+        max_restart_index_(0) {}
 
-  void Initialize(double util_ratio) {
+  void Initialize(double util_ratio, bool allow_wide_buckets = false) {
     if (util_ratio <= 0) {
       util_ratio = kDefaultUtilRatio;  // sanity check
     }
     bucket_per_key_ = 1 / util_ratio;
     valid_ = true;
+    allow_wide_buckets_ = allow_wide_buckets;
   }
 
   inline bool Valid() const { return valid_ && bucket_per_key_ > 0; }
@@ -91,39 +115,53 @@ class DataBlockHashIndexBuilder {
   void Finish(std::string& buffer);
   void Reset();
   inline size_t EstimateSize() const {
-    uint16_t estimated_num_buckets =
-        static_cast<uint16_t>(estimated_num_buckets_);
-
     // Maching the num_buckets number in DataBlockHashIndexBuilder::Finish.
-    estimated_num_buckets |= 1;
-
     return sizeof(uint16_t) +
-           static_cast<size_t>(estimated_num_buckets * sizeof(uint8_t));
+           static_cast<size_t>(NumBuckets()) * BucketSize();
   }
 
  private:
   double bucket_per_key_;  // is the multiplicative inverse of util_ratio_
   double estimated_num_buckets_;
 
+  uint16_t NumBuckets() const;
+  size_t BucketSize() const {
+    return max_restart_index_ > kMaxRestartSupportedByHashIndex
+               ? sizeof(uint16_t)
+               : sizeof(uint8_t);
+  }
+
   // Now the only usage for `valid_` is to mark false when the inserted
   // restart_index is larger than supported. In this case HashIndex is not
   // appended to the block content.
   bool valid_;
+  bool allow_wide_buckets_;
+  size_t max_restart_index_;
 
-  std::vector<std::pair<uint32_t, uint8_t>> hash_and_restart_pairs_;
+  std::vector<std::pair<uint32_t, uint16_t>> hash_and_restart_pairs_;
   friend class DataBlockHashIndex_DataBlockHashTestSmall_Test;
 };
 
 class DataBlockHashIndex {
  public:
-  DataBlockHashIndex() : num_buckets_(0) {}
+  DataBlockHashIndex() : num_buckets_(0), map_offset_(0), wide_(false) {}
 
   void Initialize(const char* data, uint16_t size, uint16_t* map_offset);
 
-  uint8_t Lookup(const char* data, uint32_t map_offset, const Slice& key) const;
+  // Returns the index of the restart interval holding the entries of user key
+  // `key` if it is in the block (though it may also be that of another user
+  // key), kHashIndexNoEntry if `key` is not in the block, or
+  // kHashIndexCollision if the index cannot tell.
+  uint16_t Lookup(const char* data, uint32_t map_offset,
+                  const Slice& key) const;
 
   inline bool Valid() { return num_buckets_ != 0; }
 
+  // Offset of the bucket array in the block, as set by Initialize(). Other
+  // sections (e.g. restart key prefixes) may sit between the restart array
+  // and the hash index, so this cannot be derived from the restart array.
+  uint16_t map_offset() const { return map_offset_; }
+
  private:
   // To make the serialized hash index compact and to save the space overhead,
   // here all the data fields persisted in the block are in uint16 format.
@@ -132,6 +170,9 @@ class DataBlockHashIndex {
   // So in other words, DataBlockHashIndex does not support block size equal
   // or greater then 64KiB.
   uint16_t num_buckets_;
+  uint16_t map_offset_;
+  // Whether the buckets are uint16_t
+  bool wide_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
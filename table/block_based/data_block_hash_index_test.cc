@@ -24,13 +24,13 @@ namespace ROCKSDB_NAMESPACE {
 
 bool SearchForOffset(DataBlockHashIndex& index, const char* data,
                      uint16_t map_offset, const Slice& key,
-                     uint8_t& restart_point) {
-  uint8_t entry = index.Lookup(data, map_offset, key);
-  if (entry == kCollision) {
+                     uint16_t restart_point) {
+  uint16_t entry = index.Lookup(data, map_offset, key);
+  if (entry == kHashIndexCollision) {
     return true;
   }
 
-  if (entry == kNoEntry) {
+  if (entry == kHashIndexNoEntry) {
     return false;
   }
 
@@ -258,6 +258,107 @@ TEST(DataBlockHashIndex, RestartIndexExceedMax) {
   ASSERT_TRUE(builder.Valid());
 }
 
+TEST(DataBlockHashIndex, WideBuckets) {
+  DataBlockHashIndexBuilder builder;
+  builder.Initialize(0.75 /*util_ratio*/, true /* allow_wide_buckets */);
+
+  const uint16_t kNumRestarts = 1000;
+  for (uint16_t i = 0; i < kNumRestarts; i++) {
+    builder.Add("key" + std::to_string(i), i);
+  }
+  ASSERT_TRUE(builder.Valid());
+
+  std::string buffer("fake content");
+  size_t original_size = buffer.size();
+  size_t estimated_size = builder.EstimateSize();
+  builder.Finish(buffer);
+  ASSERT_EQ(buffer.size() - original_size, estimated_size);
+
+  DataBlockHashIndex index;
+  uint16_t map_offset;
+  index.Initialize(buffer.data(), static_cast<uint16_t>(buffer.size()),
+                   &map_offset);
+  ASSERT_EQ(map_offset, buffer.size() - estimated_size);
+
+  for (uint16_t i = 0; i < kNumRestarts; i++) {
+    ASSERT_TRUE(SearchForOffset(index, buffer.data(), map_offset,
+                                "key" + std::to_string(i), i));
+  }
+}
+
+// Checks that Seek() through the hash index gives the same results as the
+// binary search, for present and absent keys.
+void TestHashSeek(bool wide_buckets, int num_records) {
+  Random rnd(301);
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+
+  BlockBuilder hash_builder(1 /* block_restart_interval */,
+                            true /* use_delta_encoding */,
+                            false /* use_value_delta_encoding */,
+                            BlockBasedTableOptions::kDataBlockBinaryAndHash,
+                            0.75 /* data_block_hash_table_util_ratio */,
+                            false /* use_restart_key_prefixes */,
+                            false /* use_wide_column_section */,
+                            wide_buckets);
+  BlockBuilder binary_builder(1 /* block_restart_interval */);
+
+  GenerateRandomKVs(&keys, &values, 0, num_records, 1 /* step */,
+                    0 /* padding_size */, 2 /* keys_share_prefix */);
+  for (size_t i = 0; i < keys.size(); i++) {
+    // Two versions of each existing key
+    for (SequenceNumber seq : {SequenceNumber{20}, SequenceNumber{10}}) {
+      InternalKey ikey(keys[i] + "1" /* existing key marker */, seq,
+                       kTypeValue);
+      hash_builder.Add(ikey.Encode().ToString(), values[i]);
+      binary_builder.Add(ikey.Encode().ToString(), values[i]);
+    }
+  }
+
+  BlockContents hash_contents;
+  hash_contents.data = hash_builder.Finish();
+  Block hash_block(std::move(hash_contents));
+  ASSERT_EQ(hash_block.IndexType(),
+            BlockBasedTableOptions::kDataBlockBinaryAndHash);
+  BlockContents binary_contents;
+  binary_contents.data = binary_builder.Finish();
+  Block binary_block(std::move(binary_contents));
+  const InternalKeyComparator icmp(BytewiseComparator());
+
+  std::unique_ptr<DataBlockIter> hash_iter(hash_block.NewDataIterator(
+      icmp.user_comparator(), kDisableGlobalSequenceNumber));
+  std::unique_ptr<DataBlockIter> binary_iter(binary_block.NewDataIterator(
+      icmp.user_comparator(), kDisableGlobalSequenceNumber));
+  for (int i = 0; i < 2 * num_records; i++) {
+    const size_t index = rnd.Uniform(static_cast<int>(keys.size()));
+    const std::string marker = rnd.OneIn(2) ? "1" : "0";
+    const SequenceNumber seq = rnd.Uniform(30);
+    InternalKey ikey(keys[index] + marker, seq, kTypeValue);
+
+    hash_iter->Seek(ikey.Encode());
+    binary_iter->Seek(ikey.Encode());
+    ASSERT_OK(hash_iter->status());
+    ASSERT_EQ(binary_iter->Valid(), hash_iter->Valid());
+    if (binary_iter->Valid()) {
+      ASSERT_EQ(binary_iter->key(), hash_iter->key());
+      ASSERT_EQ(binary_iter->value(), hash_iter->value());
+      // The iterator can move on from the position set by the hash index
+      hash_iter->Next();
+      binary_iter->Next();
+      ASSERT_EQ(binary_iter->Valid(), hash_iter->Valid());
+      if (binary_iter->Valid()) {
+        ASSERT_EQ(binary_iter->key(), hash_iter->key());
+      }
+    }
+  }
+}
+
+// Each record makes 4 restart intervals, and the block must stay under 64KiB
+// for its hash index to be kept.
+TEST(DataBlockHashIndex, HashSeek) { TestHashSeek(false, 60); }
+
+TEST(DataBlockHashIndex, HashSeekWideBuckets) { TestHashSeek(true, 110); }
+
 TEST(DataBlockHashIndex, BlockRestartIndexExceedMax) {
   Options options = Options();
 
@@ -307,6 +408,51 @@ TEST(DataBlockHashIndex, BlockRestartIndexExceedMax) {
     ASSERT_EQ(reader.IndexType(),
               BlockBasedTableOptions::kDataBlockBinarySearch);
   }
+
+  // #restarts > 253 with wide buckets. HashIndex is used
+  BlockBuilder wide_builder(1 /* block_restart_interval */,
+                            true /* use_delta_encoding */,
+                            false /* use_value_delta_encoding */,
+                            BlockBasedTableOptions::kDataBlockBinaryAndHash,
+                            0.75 /* data_block_hash_table_util_ratio */,
+                            false /* use_restart_key_prefixes */,
+                            false /* use_wide_column_section */,
+                            true /* use_wide_hash_buckets */);
+  // Zero padded, so that the keys are added in order and seeks that fall
+  // back to binary search on hash collisions work too.
+  auto wide_key = [](int i) {
+    std::string digits = std::to_string(i);
+    return "key" + std::string(4 - digits.size(), '0') + digits;
+  };
+  for (int i = 0; i <= 1000; i++) {
+    std::string ukey = wide_key(i);
+    InternalKey ikey(ukey, 0, kTypeValue);
+    wide_builder.Add(ikey.Encode().ToString(), "value");
+  }
+
+  {
+    // read serialized contents of the block
+    Slice rawblock = wide_builder.Finish();
+
+    // create block reader
+    BlockContents contents;
+    contents.data = rawblock;
+    Block reader(std::move(contents));
+
+    ASSERT_EQ(reader.IndexType(),
+              BlockBasedTableOptions::kDataBlockBinaryAndHash);
+
+    const InternalKeyComparator icmp(BytewiseComparator());
+    std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+        icmp.user_comparator(), kDisableGlobalSequenceNumber));
+    for (int i = 0; i <= 1000; i++) {
+      std::string ukey = wide_key(i);
+      InternalKey ikey(ukey, 0, kTypeValue);
+      ASSERT_TRUE(iter->SeekForGet(ikey.Encode().ToString()));
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(ukey, ExtractUserKey(iter->key()).ToString());
+    }
+  }
 }
 
 TEST(DataBlockHashIndex, BlockSizeExceedMax) {
@@ -0,0 +1,185 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/data_block_wide_columns.h"
+
+#include <algorithm>
+
+#include "db/wide/wide_column_serialization.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// NUM_COLUMNS and SECTION_SIZE
+constexpr uint32_t kTrailerSize = 2 * sizeof(uint32_t);
+}  // namespace
+
+uint32_t DataBlockWideColumnsBuilder::GetOrAddColumn(const Slice& name) {
+  auto it = column_ids_.find(name.ToString());
+  if (it != column_ids_.end()) {
+    return it->second;
+  }
+  const uint32_t id = static_cast<uint32_t>(runs_.size());
+  column_ids_.emplace(name.ToString(), id);
+  name_offsets_.push_back(static_cast<uint32_t>(names_.size()));
+  names_.append(name.data(), name.size());
+  runs_.emplace_back();
+  // The name plus its entries in NAME_OFFSETS and RUN_OFFSETS
+  estimate_ += name.size() + 2 * sizeof(uint32_t);
+  return id;
+}
+
+void DataBlockWideColumnsBuilder::AddEntity(const Slice& entity,
+                                            std::string* row) {
+  if (num_entities_ == 0) {
+    // The final entries of NAME_OFFSETS and RUN_OFFSETS, and the trailer
+    estimate_ = 2 * sizeof(uint32_t) + kTrailerSize;
+  }
+  ++num_entities_;
+
+  Slice input = entity;
+  WideColumns columns;
+  if (!WideColumnSerialization::Deserialize(input, columns).ok()) {
+    // Keep the entity as-is; reads will report the same error as they would
+    // for a row-wise block.
+    PutVarint32(row, 0);
+    row->append(entity.data(), entity.size());
+    return;
+  }
+
+  PutVarint32(row, static_cast<uint32_t>(columns.size() + 1));
+  for (const WideColumn& column : columns) {
+    const uint32_t id = GetOrAddColumn(column.name());
+    std::string& run = runs_[id];
+    PutVarint32Varint32Varint32(row, id, static_cast<uint32_t>(run.size()),
+                                static_cast<uint32_t>(column.value().size()));
+    run.append(column.value().data(), column.value().size());
+    estimate_ += column.value().size();
+  }
+}
+
+void DataBlockWideColumnsBuilder::Finish(std::string& buffer) {
+  assert(!empty());
+  const size_t start = buffer.size();
+  buffer.append(names_);
+  std::vector<uint32_t> run_offsets;
+  run_offsets.reserve(runs_.size() + 1);
+  for (const std::string& run : runs_) {
+    run_offsets.push_back(static_cast<uint32_t>(buffer.size() - start));
+    buffer.append(run);
+  }
+  run_offsets.push_back(static_cast<uint32_t>(buffer.size() - start));
+
+  for (uint32_t offset : name_offsets_) {
+    PutFixed32(&buffer, offset);
+  }
+  PutFixed32(&buffer, static_cast<uint32_t>(names_.size()));
+  for (uint32_t offset : run_offsets) {
+    PutFixed32(&buffer, offset);
+  }
+  PutFixed32(&buffer, static_cast<uint32_t>(runs_.size()));
+  PutFixed32(&buffer,
+             static_cast<uint32_t>(buffer.size() + sizeof(uint32_t) - start));
+}
+
+void DataBlockWideColumnsBuilder::Reset() {
+  column_ids_.clear();
+  names_.clear();
+  name_offsets_.clear();
+  runs_.clear();
+  num_entities_ = 0;
+  estimate_ = 0;
+}
+
+uint32_t DataBlockWideColumns::NameOffset(uint32_t id) const {
+  return DecodeFixed32(data_ + offsets_ + id * sizeof(uint32_t));
+}
+
+uint32_t DataBlockWideColumns::RunOffset(uint32_t id) const {
+  return DecodeFixed32(data_ + offsets_ +
+                       (num_columns_ + 1 + id) * sizeof(uint32_t));
+}
+
+bool DataBlockWideColumns::Initialize(const char* end, size_t max_size,
+                                      uint32_t* section_size) {
+  data_ = nullptr;
+  if (max_size < kTrailerSize) {
+    return false;
+  }
+  const uint32_t size = DecodeFixed32(end - sizeof(uint32_t));
+  const uint32_t num_columns = DecodeFixed32(end - kTrailerSize);
+  const uint64_t offsets_size =
+      (uint64_t{num_columns} + 1) * 2 * sizeof(uint32_t);
+  if (size > max_size || offsets_size + kTrailerSize > size) {
+    return false;
+  }
+  data_ = end - size;
+  num_columns_ = num_columns;
+  offsets_ = static_cast<uint32_t>(size - kTrailerSize - offsets_size);
+
+  // Validate the offsets once so that accessors need no bounds checks.
+  bool ok = NameOffset(0) == 0 &&
+            NameOffset(num_columns_) == RunOffset(0) &&
+            RunOffset(num_columns_) == offsets_;
+  for (uint32_t id = 0; ok && id < num_columns_; ++id) {
+    ok = NameOffset(id) <= NameOffset(id + 1) &&
+         RunOffset(id) <= RunOffset(id + 1);
+  }
+  if (!ok) {
+    data_ = nullptr;
+    return false;
+  }
+  *section_size = size;
+  return true;
+}
+
+bool DataBlockWideColumns::DecodeRow(Slice row,
+                                     const std::vector<bool>* projection,
+                                     WideColumns* columns) const {
+  assert(Valid());
+  assert(!projection || projection->size() == num_columns_);
+  columns->clear();
+  uint32_t num_columns = 0;
+  if (!GetVarint32(&row, &num_columns)) {
+    return false;
+  }
+  if (num_columns == 0) {
+    return WideColumnSerialization::Deserialize(row, *columns).ok();
+  }
+  --num_columns;
+  columns->reserve(num_columns);
+  for (uint32_t i = 0; i < num_columns; ++i) {
+    uint32_t id = 0;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    if (!GetVarint32(&row, &id) || !GetVarint32(&row, &offset) ||
+        !GetVarint32(&row, &size) || id >= num_columns_) {
+      return false;
+    }
+    const uint32_t run_offset = RunOffset(id);
+    const uint32_t run_size = RunOffset(id + 1) - run_offset;
+    if (offset > run_size || size > run_size - offset) {
+      return false;
+    }
+    if (projection && !(*projection)[id]) {
+      continue;
+    }
+    columns->emplace_back(ColumnName(id),
+                          Slice(data_ + run_offset + offset, size));
+  }
+  return true;
+}
+
+void DataBlockWideColumns::Project(const std::vector<Slice>& column_names,
+                                   std::vector<bool>* projection) const {
+  projection->assign(num_columns_, false);
+  for (uint32_t id = 0; id < num_columns_; ++id) {
+    (*projection)[id] = std::find(column_names.begin(), column_names.end(),
+                                  ColumnName(id)) != column_names.end();
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
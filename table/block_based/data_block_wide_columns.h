@@ -0,0 +1,128 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/wide_columns.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// This is an experimental feature aiming to reduce the CPU and cache
+// footprint of reading a few columns of wide-column entities. It is only used
+// in data blocks (see BlockBasedTableOptions::data_block_columnar_entities).
+//
+// Instead of storing each entity's serialized columns inline, the block
+// stores the entities in a PAX (Partition Attributes Across) layout: the
+// column names of all entities of the block are stored once in a dictionary,
+// and the values of each column are stored together in a per-column run. The
+// value of an entity entry in the block is a row descriptor that refers to the
+// dictionary and the runs:
+//
+// ROW: [NUM_COLUMNS (ID OFFSET SIZE) (ID OFFSET SIZE) ...]
+//
+// NUM_COLUMNS: varint32, the number of columns of the entity plus one. Zero
+//              means that the serialized entity follows as-is (used for
+//              entities that could not be decoded when building the block).
+// ID:          varint32, the column's index in the dictionary.
+// OFFSET:      varint32, the offset of the column value in the column's run.
+// SIZE:        varint32, the size of the column value.
+//
+// The columns of a row are in the same order as in the original entity, so
+// the entity can be re-serialized without sorting.
+//
+// The column section is stored after the restart array (and the optional
+// restart key prefixes), and its presence is flagged in the block footer:
+//
+// DATA_BLOCK: [RI RI ... RI RI_IDX (PREFIXES) COLUMNS (HASH_IDX) FOOTER]
+//
+// COLUMNS: [NAMES RUNS NAME_OFFSETS RUN_OFFSETS NUM_COLUMNS SECTION_SIZE]
+//
+// NAMES:        the column names, concatenated.
+// RUNS:         the column value runs, concatenated in dictionary order.
+// NAME_OFFSETS: fixed32[NUM_COLUMNS + 1], offsets of the names in the
+//               section. Name i is [NAME_OFFSETS[i], NAME_OFFSETS[i + 1]).
+// RUN_OFFSETS:  fixed32[NUM_COLUMNS + 1], same for the runs.
+// NUM_COLUMNS:  fixed32, the number of distinct column names in the block.
+// SECTION_SIZE: fixed32, the size of COLUMNS including this field.
+//
+// Reading one column of an entity thus only decodes the row descriptor and
+// touches the value in that column's run, without decoding the names or
+// values of the other columns.
+class DataBlockWideColumnsBuilder {
+ public:
+  // Appends the row descriptor of the serialized entity `entity` to `row`,
+  // and adds its column values to the runs.
+  void AddEntity(const Slice& entity, std::string* row);
+
+  // Appends the column section to `buffer`.
+  // REQUIRES: !empty()
+  void Finish(std::string& buffer);
+
+  void Reset();
+
+  bool empty() const { return num_entities_ == 0; }
+
+  size_t EstimateSize() const { return empty() ? 0 : estimate_; }
+
+ private:
+  uint32_t GetOrAddColumn(const Slice& name);
+
+  std::unordered_map<std::string, uint32_t> column_ids_;
+  std::string names_;
+  std::vector<uint32_t> name_offsets_;
+  std::vector<std::string> runs_;
+  size_t num_entities_ = 0;
+  size_t estimate_ = 0;
+};
+
+// Reads the column section of a data block.
+class DataBlockWideColumns {
+ public:
+  // Initializes from the column section of a block, which ends right before
+  // `end`, with at most `max_size` bytes available for it. Returns false if
+  // the section is malformed. On success, `*section_size` is set to the size
+  // of the section.
+  bool Initialize(const char* end, size_t max_size, uint32_t* section_size);
+
+  bool Valid() const { return data_ != nullptr; }
+
+  uint32_t NumColumns() const { return num_columns_; }
+
+  Slice ColumnName(uint32_t id) const {
+    assert(id < num_columns_);
+    return Slice(data_ + NameOffset(id), NameOffset(id + 1) - NameOffset(id));
+  }
+
+  // Sets `*columns` to the columns of the entity with row descriptor `row`,
+  // pointing into the block. If `projection` is not null, columns whose id is
+  // not set in it are skipped (except for rows that store their serialized
+  // entity as-is, which are returned in full). Returns false if the row is
+  // malformed.
+  bool DecodeRow(Slice row, const std::vector<bool>* projection,
+                 WideColumns* columns) const;
+
+  // Sets `*projection` to the column ids of the block whose names are in
+  // `column_names`.
+  void Project(const std::vector<Slice>& column_names,
+               std::vector<bool>* projection) const;
+
+ private:
+  uint32_t NameOffset(uint32_t id) const;
+  uint32_t RunOffset(uint32_t id) const;
+
+  const char* data_ = nullptr;
+  uint32_t num_columns_ = 0;
+  // Offset in data_ of NAME_OFFSETS
+  uint32_t offsets_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
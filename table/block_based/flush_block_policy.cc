@@ -5,12 +5,15 @@
 
 #include "rocksdb/flush_block_policy.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <mutex>
 
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/utilities/customizable_util.h"
+#include "rocksdb/utilities/options_type.h"
 #include "table/block_based/block_based_table_reader.h"
 #include "table/block_based/block_builder.h"
 #include "table/block_based/flush_block_policy.h"
@@ -89,6 +92,66 @@ FlushBlockPolicy* FlushBlockBySizePolicyFactory::NewFlushBlockPolicy(
   return new FlushBlockBySizePolicy(size, deviation, false, data_block_builder);
 }
 
+static std::unordered_map<std::string, OptionTypeInfo>
+    adaptive_flush_block_policy_type_info = {
+        {"point_block_size",
+         {offsetof(struct AdaptiveFlushBlockPolicyOptions, point_block_size),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"scan_block_size",
+         {offsetof(struct AdaptiveFlushBlockPolicyOptions, scan_block_size),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"min_reads",
+         {offsetof(struct AdaptiveFlushBlockPolicyOptions, min_reads),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+};
+
+AdaptiveFlushBlockPolicyFactory::AdaptiveFlushBlockPolicyFactory(
+    const AdaptiveFlushBlockPolicyOptions& options)
+    : options_(options) {
+  RegisterOptions(&options_, &adaptive_flush_block_policy_type_info);
+}
+
+uint64_t AdaptiveFlushBlockPolicyFactory::ChooseBlockSize(
+    const FlushBlockPolicyContext& context,
+    const BlockBasedTableOptions& table_options) const {
+  const uint64_t num_reads =
+      context.num_point_reads + context.num_iterator_reads;
+  if (num_reads == 0 || num_reads < options_.min_reads ||
+      options_.point_block_size == 0 || options_.scan_block_size == 0) {
+    return table_options.block_size;
+  }
+  const double point_share =
+      static_cast<double>(context.num_point_reads) / num_reads;
+  const double log_point = std::log2(options_.point_block_size);
+  const double log_scan = std::log2(options_.scan_block_size);
+  const double log_size = log_scan + point_share * (log_point - log_scan);
+  const uint64_t size = uint64_t{1} << static_cast<int>(std::lround(log_size));
+  return std::clamp(
+      size, std::min(options_.point_block_size, options_.scan_block_size),
+      std::max(options_.point_block_size, options_.scan_block_size));
+}
+
+FlushBlockPolicy* AdaptiveFlushBlockPolicyFactory::NewFlushBlockPolicy(
+    const BlockBasedTableOptions& table_options,
+    const BlockBuilder& data_block_builder) const {
+  return NewFlushBlockPolicyWithContext(FlushBlockPolicyContext(),
+                                        table_options, data_block_builder);
+}
+
+FlushBlockPolicy*
+AdaptiveFlushBlockPolicyFactory::NewFlushBlockPolicyWithContext(
+    const FlushBlockPolicyContext& context,
+    const BlockBasedTableOptions& table_options,
+    const BlockBuilder& data_block_builder) const {
+  return new FlushBlockBySizePolicy(ChooseBlockSize(context, table_options),
+                                    table_options.block_size_deviation,
+                                    table_options.block_align,
+                                    data_block_builder);
+}
+
 static int RegisterFlushBlockPolicyFactories(ObjectLibrary& library,
                                              const std::string& /*arg*/) {
   library.AddFactory<FlushBlockPolicyFactory>(
@@ -107,7 +170,15 @@ static int RegisterFlushBlockPolicyFactories(ObjectLibrary& library,
         guard->reset(new FlushBlockEveryKeyPolicyFactory());
         return guard->get();
       });
-  return 2;
+  library.AddFactory<FlushBlockPolicyFactory>(
+      AdaptiveFlushBlockPolicyFactory::kClassName(),
+      [](const std::string& /*uri*/,
+         std::unique_ptr<FlushBlockPolicyFactory>* guard,
+         std::string* /* errmsg */) {
+        guard->reset(new AdaptiveFlushBlockPolicyFactory());
+        return guard->get();
+      });
+  return 3;
 }
 
 FlushBlockBySizePolicyFactory::FlushBlockBySizePolicyFactory()
@@ -0,0 +1,188 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/learned_index.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+
+#include "port/malloc.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+inline uint64_t DoubleToBits(double d) {
+  uint64_t bits;
+  static_assert(sizeof(bits) == sizeof(d), "unexpected double size");
+  memcpy(&bits, &d, sizeof(bits));
+  return bits;
+}
+
+inline double BitsToDouble(uint64_t bits) {
+  double d;
+  memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+
+}  // namespace
+
+Status LearnedIndexModel::Create(const Slice& contents,
+                                 std::unique_ptr<LearnedIndexModel>* model) {
+  Slice input = contents;
+  uint32_t max_error = 0;
+  uint32_t num_segments = 0;
+  if (!GetFixed32(&input, &max_error) || !GetFixed32(&input, &num_segments)) {
+    return Status::Corruption("Truncated learned index model header");
+  }
+  if (input.size() != static_cast<uint64_t>(num_segments) * kSegmentSize) {
+    return Status::Corruption("Learned index model size mismatch");
+  }
+  std::unique_ptr<LearnedIndexModel> result(new LearnedIndexModel());
+  result->max_error_ = max_error;
+  result->segments_.reserve(num_segments);
+  for (uint32_t i = 0; i < num_segments; ++i) {
+    Segment segment;
+    uint64_t slope_bits = 0;
+    GetFixed64(&input, &segment.first_key);
+    GetFixed64(&input, &slope_bits);
+    GetFixed32(&input, &segment.first_index);
+    segment.slope = BitsToDouble(slope_bits);
+    if (!(segment.slope >= 0) ||
+        (i > 0 && segment.first_key < result->segments_.back().first_key)) {
+      return Status::Corruption("Invalid learned index model segment");
+    }
+    result->segments_.push_back(segment);
+  }
+  *model = std::move(result);
+  return Status::OK();
+}
+
+void LearnedIndexModel::Predict(const Slice& target_user_key,
+                                uint32_t num_restarts, int64_t* left,
+                                int64_t* right) const {
+  assert(num_restarts > 0);
+  const int64_t last = static_cast<int64_t>(num_restarts) - 1;
+  if (segments_.empty()) {
+    *left = -1;
+    *right = last;
+    return;
+  }
+  const uint64_t key = DecodeBigEndianPrefix64(target_user_key);
+  auto it = std::upper_bound(
+      segments_.begin(), segments_.end(), key,
+      [](uint64_t k, const Segment& s) { return k < s.first_key; });
+  if (it != segments_.begin()) {
+    --it;
+  }
+  // Keys before the first segment are predicted at its first index.
+  const double delta =
+      key > it->first_key ? static_cast<double>(key - it->first_key) : 0.0;
+  const double predicted = it->first_index + it->slope * delta;
+  // A key before the next segment is also before all of its restart keys,
+  // so do not extrapolate past the segment (for keys between the last
+  // restart key of this segment and the first of the next).
+  int64_t limit = last;
+  if (std::next(it) != segments_.end() && key < std::next(it)->first_key) {
+    limit = std::min<int64_t>(
+        limit, static_cast<int64_t>(std::next(it)->first_index) - 1);
+  }
+  int64_t position;
+  if (!(predicted < static_cast<double>(limit))) {
+    // Also covers NaN and infinity
+    position = std::max<int64_t>(limit, 0);
+  } else {
+    position = static_cast<int64_t>(predicted);
+  }
+  // The last restart key not greater than the target lies within the error
+  // bound of the predictions for the restart keys around it, and predictions
+  // are monotonic within a segment.
+  const int64_t window = static_cast<int64_t>(max_error_) + 1;
+  *left = std::max<int64_t>(-1, position - window);
+  *right = std::min<int64_t>(last, position + window);
+}
+
+size_t LearnedIndexModel::ApproximateMemoryUsage() const {
+  size_t usage = 0;
+#ifdef ROCKSDB_MALLOC_USABLE_SIZE
+  usage += malloc_usable_size(const_cast<LearnedIndexModel*>(this));
+#else
+  usage += sizeof(*this);
+#endif  // ROCKSDB_MALLOC_USABLE_SIZE
+  usage += segments_.capacity() * sizeof(Segment);
+  return usage;
+}
+
+void LearnedIndexModelBuilder::Add(const Slice& user_key) {
+  const uint64_t key = DecodeBigEndianPrefix64(user_key);
+  const uint32_t index = num_keys_++;
+  if (index == 0) {
+    first_key_ = key;
+    first_index_ = index;
+    has_slope_bound_ = false;
+    return;
+  }
+  assert(key >= first_key_);
+  const double error = static_cast<double>(max_error_);
+  bool fits;
+  if (key == first_key_) {
+    // Predicted at the first index of the segment regardless of the slope.
+    fits = index - first_index_ <= max_error_;
+  } else {
+    const double dx = static_cast<double>(key - first_key_);
+    const double dy = static_cast<double>(index - first_index_);
+    // Predictions must not decrease with the key.
+    double low = std::max(0.0, (dy - error) / dx);
+    double high = (dy + error) / dx;
+    if (has_slope_bound_) {
+      low = std::max(low, slope_low_);
+      high = std::min(high, slope_high_);
+    }
+    fits = low <= high;
+    if (fits) {
+      slope_low_ = low;
+      slope_high_ = high;
+      has_slope_bound_ = true;
+    }
+  }
+  if (!fits) {
+    CloseSegment();
+    first_key_ = key;
+    first_index_ = index;
+    has_slope_bound_ = false;
+  }
+}
+
+void LearnedIndexModelBuilder::CloseSegment() {
+  LearnedIndexModel::Segment segment;
+  segment.first_key = first_key_;
+  segment.first_index = first_index_;
+  segment.slope = has_slope_bound_ ? (slope_low_ + slope_high_) / 2 : 0.0;
+  segments_.push_back(segment);
+}
+
+void LearnedIndexModelBuilder::Finish(std::string* dst) {
+  if (num_keys_ > 0) {
+    CloseSegment();
+  }
+  dst->reserve(dst->size() + EstimatedSize());
+  PutFixed32(dst, max_error_);
+  PutFixed32(dst, static_cast<uint32_t>(segments_.size()));
+  for (const auto& segment : segments_) {
+    PutFixed64(dst, segment.first_key);
+    PutFixed64(dst, DoubleToBits(segment.slope));
+    PutFixed32(dst, segment.first_index);
+  }
+}
+
+size_t LearnedIndexModelBuilder::EstimatedSize() const {
+  return 2 * sizeof(uint32_t) +
+         (segments_.size() + 1) * LearnedIndexModel::kSegmentSize;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,113 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A learned index is a piecewise-linear model over the restart keys of an
+// index block (see BlockBasedTableOptions::kLearnedIndexSearch). Each restart
+// key is mapped to a 64-bit integer made of the first 8 bytes of its user key,
+// loaded big-endian and zero padded, which preserves bytewise order. The model
+// predicts, for a seek target, the restart index of the last restart key that
+// is not greater than the target, within a maximum error fixed at build time.
+//
+// The model is stored as a meta block of the table:
+//
+// MODEL: [MAX_ERROR NUM_SEGMENTS SEGMENT ... SEGMENT]
+//
+// MAX_ERROR: fixed32, bound on |predicted - actual| restart index over all
+//            restart keys the model was trained on.
+// NUM_SEGMENTS: fixed32
+// SEGMENT: [FIRST_KEY SLOPE FIRST_INDEX], with FIRST_KEY a fixed64 integer
+//          key, SLOPE the fixed64 bit pattern of an IEEE 754 double and
+//          FIRST_INDEX a fixed32 restart index. Segments are ordered by
+//          FIRST_KEY, and a key is predicted by the last segment whose
+//          FIRST_KEY is not greater than it.
+//
+// Numeric-like keys (timestamps, sequential IDs) typically need few segments
+// to be fitted, so that a prediction costs a short search over the segments
+// and the index block seek only has to binary search a window of
+// 2 * MAX_ERROR + 3 restart keys. Since the model only looks at key prefixes,
+// predictions are hints: the index block iterator verifies the bounds of the
+// window and falls back to a full binary search when they do not hold.
+class LearnedIndexModel {
+ public:
+  // Parses a model from the contents of its meta block.
+  static Status Create(const Slice& contents,
+                       std::unique_ptr<LearnedIndexModel>* model);
+
+  // Computes a candidate range of restart indexes for a seek to
+  // `target_user_key` in an index block with `num_restarts` restart points,
+  // such that `-1 <= *left <= *right < num_restarts`. The caller must verify
+  // that the range is correct before narrowing its search to it.
+  void Predict(const Slice& target_user_key, uint32_t num_restarts,
+               int64_t* left, int64_t* right) const;
+
+  uint32_t max_error() const { return max_error_; }
+  size_t num_segments() const { return segments_.size(); }
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  friend class LearnedIndexModelBuilder;
+
+  struct Segment {
+    uint64_t first_key;
+    double slope;
+    uint32_t first_index;
+  };
+
+  static constexpr size_t kSegmentSize =
+      sizeof(uint64_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+  uint32_t max_error_ = 0;
+  std::vector<Segment> segments_;
+};
+
+// Fits a LearnedIndexModel to a sorted sequence of restart keys with a greedy
+// "shrinking cone" algorithm: a segment is extended as long as some slope
+// through its first point predicts every point it covers within the maximum
+// error, which makes building a single pass with O(1) state.
+class LearnedIndexModelBuilder {
+ public:
+  explicit LearnedIndexModelBuilder(uint32_t max_error)
+      : max_error_(max_error) {}
+
+  // Adds the user key of the next restart point. Keys must be added in
+  // bytewise order.
+  void Add(const Slice& user_key);
+
+  bool empty() const { return num_keys_ == 0; }
+
+  // Serializes the model into `dst`. No more keys may be added afterwards.
+  void Finish(std::string* dst);
+
+  // Size of the serialized model if Finish() were called now.
+  size_t EstimatedSize() const;
+
+ private:
+  void CloseSegment();
+
+  const uint32_t max_error_;
+  uint32_t num_keys_ = 0;
+  // State of the open segment
+  uint64_t first_key_ = 0;
+  uint32_t first_index_ = 0;
+  double slope_low_ = 0;
+  double slope_high_ = 0;
+  bool has_slope_bound_ = false;
+  std::vector<LearnedIndexModel::Segment> segments_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
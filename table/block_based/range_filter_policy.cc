@@ -0,0 +1,307 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/range_filter_policy.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/convenience.h"
+#include "rocksdb/utilities/object_registry.h"
+#include "util/bloom_impl.h"
+#include "util/coding.h"
+#include "util/hash.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+constexpr int kLevelBits = RosettaRangeFilterPolicy::kLevelBits;
+constexpr int kTopShift = 64 - kLevelBits;
+
+// Hash of the prefix `prefix` of a value, where `shift` is the number of low
+// bits dropped from the value.
+inline uint64_t PrefixHash(uint64_t prefix, int shift) {
+  char buf[sizeof(uint64_t)];
+  EncodeFixed64(buf, prefix);
+  return Hash64(buf, sizeof(buf), static_cast<uint64_t>(shift));
+}
+
+class RosettaRangeFilterBitsBuilder : public RangeFilterBitsBuilder {
+ public:
+  explicit RosettaRangeFilterBitsBuilder(int millibits_per_key)
+      : millibits_per_key_(millibits_per_key) {}
+
+  void AddKey(const Slice& user_key) override {
+    const uint64_t value = DecodeBigEndianPrefix64(user_key);
+    if (!values_.empty()) {
+      // Keys are added in bytewise order
+      assert(values_.back() <= value);
+      if (values_.back() == value) {
+        return;
+      }
+    }
+    values_.push_back(value);
+  }
+
+  Slice Finish(std::unique_ptr<const char[]>* buf) override {
+    if (values_.empty()) {
+      return Slice();
+    }
+
+    // Since the values are sorted, the values sharing a prefix are adjacent.
+    uint64_t num_entries = 0;
+    for (int shift = 0; shift <= kTopShift; shift += kLevelBits) {
+      for (size_t i = 0; i < values_.size(); ++i) {
+        if (i == 0 || values_[i - 1] >> shift != values_[i] >> shift) {
+          ++num_entries;
+        }
+      }
+    }
+
+    const uint64_t num_bits =
+        num_entries * static_cast<uint64_t>(millibits_per_key_) / 1000;
+    // Round up to whole cache lines, within the range FastLocalBloomImpl
+    // supports.
+    uint64_t num_cache_lines = std::max(uint64_t{1}, (num_bits + 511) / 512);
+    num_cache_lines = std::min(
+        num_cache_lines, uint64_t{std::numeric_limits<uint32_t>::max() >> 6});
+    const uint32_t len_bytes = static_cast<uint32_t>(num_cache_lines << 6);
+    const int num_probes =
+        FastLocalBloomImpl::ChooseNumProbes(millibits_per_key_);
+
+    const size_t total_len = len_bytes + RosettaRangeFilterPolicy::kMetadataLen;
+    std::unique_ptr<char[]> data(new char[total_len]);
+    memset(data.get(), 0, len_bytes);
+    for (int shift = 0; shift <= kTopShift; shift += kLevelBits) {
+      for (size_t i = 0; i < values_.size(); ++i) {
+        const uint64_t prefix = values_[i] >> shift;
+        if (i == 0 || values_[i - 1] >> shift != prefix) {
+          const uint64_t h = PrefixHash(prefix, shift);
+          FastLocalBloomImpl::AddHash(Lower32of64(h), Upper32of64(h),
+                                      len_bytes, num_probes, data.get());
+        }
+      }
+    }
+    data[len_bytes] = 0;  // FORMAT_VERSION
+    data[len_bytes + 1] = static_cast<char>(kLevelBits);
+    data[len_bytes + 2] = static_cast<char>(num_probes);
+
+    values_.clear();
+    Slice rv(data.get(), total_len);
+    *buf = std::move(data);
+    return rv;
+  }
+
+ private:
+  const int millibits_per_key_;
+  // Distinct values of the keys added, in order
+  std::vector<uint64_t> values_;
+};
+
+class RosettaRangeFilterBitsReader : public RangeFilterBitsReader {
+ public:
+  RosettaRangeFilterBitsReader(const char* data, uint32_t len_bytes,
+                               int num_probes)
+      : data_(data), len_bytes_(len_bytes), num_probes_(num_probes) {}
+
+  bool MayMatchRange(const Slice& lower, const Slice& upper) const override {
+    const uint64_t lo = DecodeBigEndianPrefix64(lower);
+    // Keys before `upper` may share its first 8 bytes, so hi is inclusive.
+    const uint64_t hi = DecodeBigEndianPrefix64(upper);
+    if (lo > hi) {
+      assert(false);
+      return true;
+    }
+    int budget = RosettaRangeFilterPolicy::kMaxProbesPerQuery;
+    for (uint64_t prefix = lo >> kTopShift; prefix <= hi >> kTopShift;
+         ++prefix) {
+      if (MayMatchPrefix(prefix, kTopShift, lo, hi, &budget)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  size_t ApproximateMemoryUsage() const override {
+    // The filter contents are owned by the caller
+    return sizeof(*this);
+  }
+
+ private:
+  bool PrefixMayMatch(uint64_t prefix, int shift) const {
+    const uint64_t h = PrefixHash(prefix, shift);
+    return FastLocalBloomImpl::HashMayMatch(Lower32of64(h), Upper32of64(h),
+                                            len_bytes_, num_probes_, data_);
+  }
+
+  // Returns whether some value in [lo, hi] that has the prefix `prefix` of
+  // `64 - shift` bits may have been added.
+  bool MayMatchPrefix(uint64_t prefix, int shift, uint64_t lo, uint64_t hi,
+                      int* budget) const {
+    if (*budget == 0) {
+      return true;
+    }
+    --*budget;
+    if (!PrefixMayMatch(prefix, shift)) {
+      return false;
+    }
+    const uint64_t first = prefix << shift;
+    const uint64_t last = first | ((uint64_t{1} << shift) - 1);
+    if (shift == 0 || (lo <= first && last <= hi)) {
+      return true;
+    }
+    const int child_shift = shift - kLevelBits;
+    const uint64_t last_child = std::min(last, hi) >> child_shift;
+    for (uint64_t child = std::max(first, lo) >> child_shift;; ++child) {
+      if (MayMatchPrefix(child, child_shift, lo, hi, budget)) {
+        return true;
+      }
+      // Not `child <= last_child` in the loop condition, which would never
+      // be false for the last value of the bottom level
+      if (child == last_child) {
+        return false;
+      }
+    }
+  }
+
+  const char* data_;
+  const uint32_t len_bytes_;
+  const int num_probes_;
+};
+
+// Used for filters that cannot be interpreted, e.g. from a newer version
+class AlwaysTrueRangeFilterBitsReader : public RangeFilterBitsReader {
+ public:
+  bool MayMatchRange(const Slice&, const Slice&) const override {
+    return true;
+  }
+
+  size_t ApproximateMemoryUsage() const override { return sizeof(*this); }
+};
+
+}  // namespace
+
+RosettaRangeFilterPolicy::RosettaRangeFilterPolicy(double bits_per_key) {
+  // Sanitized like BloomFilterPolicy
+  if (bits_per_key < 0.5) {
+    // Round down to no filter
+    bits_per_key = 0;
+  } else if (bits_per_key < 1.0) {
+    bits_per_key = 1.0;
+  } else if (!(bits_per_key < 100.0)) {  // including NaN
+    bits_per_key = 100.0;
+  }
+  millibits_per_key_ = static_cast<int>(bits_per_key * 1000.0 + 0.500001);
+}
+
+const char* RosettaRangeFilterPolicy::kClassName() {
+  return "rocksdb.RosettaRangeFilter";
+}
+
+std::string RosettaRangeFilterPolicy::GetId() const {
+  std::string rv = Name();
+  rv.push_back(':');
+  rv.append(std::to_string(millibits_per_key_ / 1000));
+  const int frac = millibits_per_key_ % 1000;
+  if (frac > 0) {
+    char buf[5];
+    snprintf(buf, sizeof(buf), ".%03d", frac);
+    rv.append(buf);
+    while (rv.back() == '0') {
+      rv.pop_back();
+    }
+  }
+  return rv;
+}
+
+RangeFilterBitsBuilder* RosettaRangeFilterPolicy::GetBuilderWithContext(
+    const FilterBuildingContext&) const {
+  if (millibits_per_key_ == 0) {
+    return nullptr;
+  }
+  return new RosettaRangeFilterBitsBuilder(millibits_per_key_);
+}
+
+RangeFilterBitsReader* RosettaRangeFilterPolicy::GetRangeFilterBitsReader(
+    const Slice& contents) const {
+  if (contents.size() <= kMetadataLen) {
+    return new AlwaysTrueRangeFilterBitsReader();
+  }
+  const size_t len_bytes = contents.size() - kMetadataLen;
+  const char* metadata = contents.data() + len_bytes;
+  const int num_probes = static_cast<uint8_t>(metadata[2]);
+  if (metadata[0] != 0 || metadata[1] != kLevelBits || len_bytes % 64 != 0 ||
+      len_bytes > std::numeric_limits<uint32_t>::max() || num_probes == 0) {
+    // Unknown format or corrupted filter
+    return new AlwaysTrueRangeFilterBitsReader();
+  }
+  return new RosettaRangeFilterBitsReader(
+      contents.data(), static_cast<uint32_t>(len_bytes), num_probes);
+}
+
+const RangeFilterPolicy* NewRosettaRangeFilterPolicy(double bits_per_key) {
+  return new RosettaRangeFilterPolicy(bits_per_key);
+}
+
+namespace {
+static int RegisterBuiltinRangeFilterPolicies(ObjectLibrary& library,
+                                              const std::string& /*arg*/) {
+  library.AddFactory<const RangeFilterPolicy>(
+      ObjectLibrary::PatternEntry(RosettaRangeFilterPolicy::kClassName(), false)
+          .AddNumber(":", false),
+      [](const std::string& uri,
+         std::unique_ptr<const RangeFilterPolicy>* guard,
+         std::string* /* errmsg */) {
+        const std::vector<std::string> vals = StringSplit(uri, ':');
+        guard->reset(NewRosettaRangeFilterPolicy(ParseDouble(vals[1])));
+        return guard->get();
+      });
+  size_t num_types;
+  return static_cast<int>(library.GetFactoryCount(&num_types));
+}
+}  // namespace
+
+Status RangeFilterPolicy::CreateFromString(
+    const ConfigOptions& options, const std::string& value,
+    std::shared_ptr<const RangeFilterPolicy>* policy) {
+  if (value == kNullptrString || value.empty()) {
+    policy->reset();
+    return Status::OK();
+  }
+
+  std::string id;
+  std::unordered_map<std::string, std::string> opt_map;
+  Status status =
+      Customizable::GetOptionsMap(options, policy->get(), value, &id, &opt_map);
+  if (!status.ok()) {  // GetOptionsMap failed
+    return status;
+  } else if (id.empty()) {  // We have no Id but have options.  Not good
+    return Status::NotSupported("Cannot reset object ", id);
+  } else {
+    static std::once_flag loaded;
+    std::call_once(loaded, [&]() {
+      RegisterBuiltinRangeFilterPolicies(*(ObjectLibrary::Default().get()), "");
+    });
+    status = options.registry->NewSharedObject(id, policy);
+  }
+  if (options.ignore_unsupported_options && status.IsNotSupported()) {
+    return Status::OK();
+  } else if (status.ok()) {
+    status = Customizable::ConfigureNewObject(
+        options, const_cast<RangeFilterPolicy*>(policy->get()), opt_map);
+  }
+  return status;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,66 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A range filter in the style of Rosetta (Luo et al., SIGMOD 2020).
+//
+// Each user key is mapped to a 64-bit value made of its first 8 bytes in
+// big-endian order, zero-padded, which preserves the bytewise order (up to
+// ties). The filter stores the prefixes of these values at granularities of
+// kLevelBits bits, from the 4 most significant bits down to the whole value,
+// in a single cache-local Bloom filter where the prefix length is part of the
+// hashed item.
+//
+// A range of values [lo, hi] is checked top-down: a prefix that covers part
+// of the range is probed, and only if it may be present are its children
+// covering the range probed in turn. A prefix fully inside the range that may
+// be present answers the query. The number of probes per query is bounded; a
+// query that exceeds the bound conservatively reports a possible match.
+//
+// Format:
+// [BLOOM_BITS FORMAT_VERSION LEVEL_BITS NUM_PROBES]
+//
+// BLOOM_BITS:     the Bloom filter, a multiple of 64 bytes (cache lines).
+// FORMAT_VERSION: uint8, currently 0.
+// LEVEL_BITS:     uint8, the number of bits between two granularities.
+// NUM_PROBES:     uint8, the number of Bloom filter probes per prefix.
+class RosettaRangeFilterPolicy : public RangeFilterPolicy {
+ public:
+  explicit RosettaRangeFilterPolicy(double bits_per_key);
+
+  static const char* kClassName();
+  const char* Name() const override { return kClassName(); }
+  std::string GetId() const override;
+
+  RangeFilterBitsBuilder* GetBuilderWithContext(
+      const FilterBuildingContext&) const override;
+
+  RangeFilterBitsReader* GetRangeFilterBitsReader(
+      const Slice& contents) const override;
+
+  int GetMillibitsPerKey() const { return millibits_per_key_; }
+
+  static constexpr int kLevelBits = 4;
+  static constexpr int kNumLevels = 64 / kLevelBits;
+  // Upper bound on the number of prefixes probed per query. Checking a range
+  // takes up to 2 * (2^kLevelBits - 1) probes per granularity below the
+  // longest common prefix of its bounds.
+  static constexpr int kMaxProbesPerQuery = 256;
+  static constexpr size_t kMetadataLen = 3;
+
+ private:
+  int millibits_per_key_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
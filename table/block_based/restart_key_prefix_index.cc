@@ -0,0 +1,172 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/restart_key_prefix_index.h"
+
+#include <cassert>
+
+#include "port/malloc.h"
+#include "port/port.h"
+#include "util/coding.h"
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+
+constexpr uint64_t kSignBit = uint64_t{1} << 63;
+
+// Windows no larger than this are resolved by a linear (SIMD) count rather
+// than by further binary search steps.
+constexpr uint32_t kLinearWindow = 32;
+
+inline int64_t LoadPrefix(const char* p, uint32_t i) {
+  return static_cast<int64_t>(
+      DecodeFixed64(p + i * RestartKeyPrefixIndex::kPrefixSize));
+}
+
+// Returns the number of elements of the sorted (encoded) array `p[0, n)` that
+// are strictly less than `t` (if `or_equal` is false) or less than or equal
+// to `t` (if `or_equal` is true).
+inline uint32_t CountBelow(const char* p, uint32_t n, int64_t t,
+                           bool or_equal) {
+  // Counts elements strictly on the other side of `t` (x > t when `or_equal`,
+  // x < t otherwise) so that only a single signed compare is needed.
+  uint32_t count = 0;
+  uint32_t i = 0;
+  // The vector loads reinterpret fixed64 (little-endian) encodings directly.
+  if (port::kLittleEndian) {
+#if defined(__AVX2__)
+    const __m256i tv = _mm256_set1_epi64x(t);
+    for (; i + 4 <= n; i += 4) {
+      __m256i xv = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(p + i * sizeof(int64_t)));
+      __m256i cmp = or_equal ? _mm256_cmpgt_epi64(xv, tv)
+                             : _mm256_cmpgt_epi64(tv, xv);
+      count += static_cast<uint32_t>(
+          __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(cmp))));
+    }
+#elif defined(__SSE4_2__)
+    const __m128i tv = _mm_set1_epi64x(t);
+    for (; i + 2 <= n; i += 2) {
+      __m128i xv = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(p + i * sizeof(int64_t)));
+      __m128i cmp =
+          or_equal ? _mm_cmpgt_epi64(xv, tv) : _mm_cmpgt_epi64(tv, xv);
+      count += static_cast<uint32_t>(
+          __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(cmp))));
+    }
+#endif
+  }
+  for (; i < n; ++i) {
+    int64_t x = LoadPrefix(p, i);
+    count += (or_equal ? x > t : x < t) ? 1 : 0;
+  }
+  return or_equal ? n - count : count;
+}
+
+// Returns the first index in [begin, end) whose element is >= `t` (or > `t`
+// if `upper` is true), or `end` if there is none.
+inline uint32_t Bound(const char* p, uint32_t begin, uint32_t end, int64_t t,
+                      bool upper) {
+  while (end - begin > kLinearWindow) {
+    uint32_t mid = begin + (end - begin) / 2;
+    int64_t x = LoadPrefix(p, mid);
+    if (x < t || (upper && x == t)) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return begin + CountBelow(p + begin * RestartKeyPrefixIndex::kPrefixSize,
+                            end - begin, t, upper);
+}
+
+}  // namespace
+
+void RestartKeyPrefixIndex::AppendPrefix(std::string* dst,
+                                         const Slice& user_key) {
+  PutFixed64(dst, DecodeBigEndianPrefix64(user_key) ^ kSignBit);
+}
+
+bool RestartKeyPrefixIndex::Initialize(const char* data,
+                                       uint32_t restart_offset,
+                                       uint32_t num_restarts) {
+  num_restarts_ = 0;
+  prefixes_ = nullptr;
+  owned_.reset();
+  if (num_restarts == 0) {
+    return false;
+  }
+  std::unique_ptr<char[]> owned(new char[num_restarts * kPrefixSize]);
+  const char* limit = data + restart_offset;
+  uint64_t last = 0;
+  for (uint32_t i = 0; i < num_restarts; ++i) {
+    uint32_t region_offset =
+        DecodeFixed32(data + restart_offset + i * sizeof(uint32_t));
+    if (region_offset >= restart_offset) {
+      return false;
+    }
+    uint32_t shared, non_shared, value_length;
+    const char* p = GetVarint32Ptr(data + region_offset, limit, &shared);
+    if (p != nullptr) {
+      p = GetVarint32Ptr(p, limit, &non_shared);
+    }
+    if (p != nullptr) {
+      p = GetVarint32Ptr(p, limit, &value_length);
+    }
+    // Restart keys are stored in full and are internal keys, so they carry
+    // an 8-byte footer after the user key.
+    if (p == nullptr || shared != 0 || non_shared < 8 ||
+        static_cast<uint32_t>(limit - p) < non_shared) {
+      return false;
+    }
+    uint64_t prefix = DecodeBigEndianPrefix64(Slice(p, non_shared - 8));
+    if (i > 0 && prefix < last) {
+      // Not ordered bytewise; this block cannot use the index.
+      return false;
+    }
+    last = prefix;
+    EncodeFixed64(owned.get() + i * kPrefixSize, prefix ^ kSignBit);
+  }
+  owned_ = std::move(owned);
+  prefixes_ = owned_.get();
+  num_restarts_ = num_restarts;
+  return true;
+}
+
+void RestartKeyPrefixIndex::InitializeFromBlock(const char* prefixes,
+                                                uint32_t num_restarts) {
+  owned_.reset();
+  prefixes_ = prefixes;
+  num_restarts_ = num_restarts;
+}
+
+void RestartKeyPrefixIndex::Narrow(const Slice& target_user_key, int64_t* left,
+                                   int64_t* right) const {
+  assert(Valid());
+  const int64_t t =
+      static_cast<int64_t>(DecodeBigEndianPrefix64(target_user_key) ^ kSignBit);
+  uint32_t lo = Bound(prefixes_, 0, num_restarts_, t, /*upper=*/false);
+  uint32_t hi = Bound(prefixes_, lo, num_restarts_, t, /*upper=*/true);
+  *left = static_cast<int64_t>(lo) - 1;
+  *right = static_cast<int64_t>(hi) - 1;
+}
+
+size_t RestartKeyPrefixIndex::ApproximateMemoryUsage() const {
+  if (!owned_) {
+    return 0;
+  }
+#ifdef ROCKSDB_MALLOC_USABLE_SIZE
+  return malloc_usable_size(owned_.get());
+#else
+  return num_restarts_ * kPrefixSize;
+#endif  // ROCKSDB_MALLOC_USABLE_SIZE
+}
+
+}  // namespace ROCKSDB_NAMESPACE
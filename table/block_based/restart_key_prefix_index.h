@@ -0,0 +1,87 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// RestartKeyPrefixIndex is a reader-side acceleration structure for seeking
+// within a data block whose keys are ordered by BytewiseComparator.
+//
+// For every restart point, the first 8 bytes of the restart key's user key
+// are loaded big-endian (zero padded when shorter) into a dense array of
+// 64-bit integers. Because truncation followed by zero padding preserves
+// bytewise order, a strictly smaller (larger) prefix implies a strictly
+// smaller (larger) user key and thus internal key. A seek can therefore
+// narrow the restart binary search to the run of restart keys whose prefix
+// equals the target's prefix without decoding any varint or calling the
+// comparator. When the prefixes are distinct, the narrowed range collapses to
+// a single restart interval and no key comparison is needed at all.
+//
+// The array either lives in memory, built from the restart array when the
+// block is parsed (see BlockBasedTableOptions::restart_key_prefix_seek), or
+// is persisted in the block itself right after the restart array (see
+// BlockBasedTableOptions::data_block_restart_key_prefixes):
+//
+// DATA_BLOCK: [RI RI ... RI RI_IDX PREFIXES [HASH_IDX] FOOTER]
+//
+// PREFIXES: [P P ... P], one fixed64 per restart point, in the order of
+//           RI_IDX. Each P is the prefix with its sign bit flipped, so that
+//           unsigned prefix order matches signed 64-bit order as needed by
+//           the SIMD compare instructions.
+//
+// In both cases, searching only touches the dense prefix array instead of
+// the cache lines holding restart entries and their values.
+//
+// The narrowing is done with a short scalar binary search over the dense
+// array followed by a SIMD count over a small window (AVX2 or SSE4.2 when
+// the binary is compiled for them, portable scalar code otherwise).
+class RestartKeyPrefixIndex {
+ public:
+  RestartKeyPrefixIndex() : prefixes_(nullptr), num_restarts_(0) {}
+
+  // Builds the prefix array for a data block with internal keys. `data` is the
+  // block contents, `restart_offset` the offset of the restart array and
+  // `num_restarts` its length. Returns false and leaves the index invalid if
+  // any restart entry fails to decode.
+  bool Initialize(const char* data, uint32_t restart_offset,
+                  uint32_t num_restarts);
+
+  // Uses a prefix array persisted in the block at `prefixes`, which must stay
+  // valid for the lifetime of this object.
+  void InitializeFromBlock(const char* prefixes, uint32_t num_restarts);
+
+  bool Valid() const { return num_restarts_ != 0; }
+
+  // Given the user key of a seek target, computes the range of candidate
+  // restart indexes for `BlockIter::BinarySeek()`: every restart key at an
+  // index <= `*left` is strictly less than the target, and every restart key
+  // at an index > `*right` is strictly greater than the target. `*left` may be
+  // -1, meaning no restart key is known to be smaller than the target.
+  void Narrow(const Slice& target_user_key, int64_t* left,
+              int64_t* right) const;
+
+  // Memory owned by this object, i.e. zero for persisted prefixes.
+  size_t ApproximateMemoryUsage() const;
+
+  // Appends the persisted form of `user_key`'s prefix to `dst`.
+  static void AppendPrefix(std::string* dst, const Slice& user_key);
+
+  static constexpr size_t kPrefixSize = sizeof(uint64_t);
+
+ private:
+  // Encoded (fixed64) prefixes; points into `owned_` or into the block.
+  const char* prefixes_;
+  std::unique_ptr<char[]> owned_;
+  uint32_t num_restarts_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
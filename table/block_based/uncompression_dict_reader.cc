@@ -84,6 +84,7 @@ Status UncompressionDictReader::GetOrReadUncompressionDictionary(
 
   if (!uncompression_dict_.IsEmpty()) {
     uncompression_dict->SetUnownedValue(uncompression_dict_.GetValue());
+    SetCacheCompressionDict(*uncompression_dict->GetValue());
     return Status::OK();
   }
 
@@ -93,9 +94,26 @@ Status UncompressionDictReader::GetOrReadUncompressionDictionary(
   }
   read_options.verify_checksums = verify_checksums;
 
-  return ReadUncompressionDictionary(table_, prefetch_buffer, read_options,
-                                     cache_dictionary_blocks(), get_context,
-                                     lookup_context, uncompression_dict);
+  const Status s = ReadUncompressionDictionary(
+      table_, prefetch_buffer, read_options, cache_dictionary_blocks(),
+      get_context, lookup_context, uncompression_dict);
+  if (s.ok() && uncompression_dict->GetValue() != nullptr) {
+    SetCacheCompressionDict(*uncompression_dict->GetValue());
+  }
+  return s;
+}
+
+void UncompressionDictReader::SetCacheCompressionDict(
+    const UncompressionDict& dict) const {
+  if (cache_compression_dict_set_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  cache_compression_dict_set_.store(true, std::memory_order_relaxed);
+  const BlockBasedTable::Rep* const rep = table_->get_rep();
+  if (rep->table_options.block_cache && !dict.GetRawDict().empty()) {
+    rep->table_options.block_cache->SetCompressionDict(
+        rep->base_cache_key.CommonPrefixSlice(), dict.GetRawDict());
+  }
 }
 
 size_t UncompressionDictReader::ApproximateMemoryUsage() const {
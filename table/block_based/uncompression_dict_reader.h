@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
 
 #include "table/block_based/cachable_entry.h"
@@ -47,6 +48,10 @@ class UncompressionDictReader {
 
   bool cache_dictionary_blocks() const;
 
+  // Passes the dictionary to the block cache, once, for its secondary cache
+  // to compress the blocks of this table with it
+  void SetCacheCompressionDict(const UncompressionDict& dict) const;
+
   static Status ReadUncompressionDictionary(
       const BlockBasedTable* table, FilePrefetchBuffer* prefetch_buffer,
       const ReadOptions& read_options, bool use_cache, GetContext* get_context,
@@ -55,6 +60,8 @@ class UncompressionDictReader {
 
   const BlockBasedTable* table_;
   CachableEntry<UncompressionDict> uncompression_dict_;
+  // Sent only once, as the secondary cache pins the dictionary
+  mutable std::atomic<bool> cache_compression_dict_set_{false};
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -118,7 +118,15 @@ inline uint32_t GetCompressFormatForVersion(uint32_t format_version) {
   return format_version >= 2 ? 2 : 1;
 }
 
-constexpr uint32_t kLatestFormatVersion = 5;
+// As of format_version 6, data blocks may persist the prefixes of their
+// restart keys (see BlockBasedTableOptions::data_block_restart_key_prefixes).
+// Earlier versions never interpret the flag for them in the block footer.
+// DO NOT CHANGE THIS FUNCTION, it affects disk format
+inline bool FormatVersionAllowsRestartKeyPrefixes(uint32_t format_version) {
+  return format_version >= 6;
+}
+
+constexpr uint32_t kLatestFormatVersion = 6;
 
 inline bool IsSupportedFormatVersion(uint32_t version) {
   return version <= kLatestFormatVersion;
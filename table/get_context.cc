@@ -110,6 +110,18 @@ void GetContext::SaveValue(const Slice& value, SequenceNumber /*seq*/) {
   }
 }
 
+const std::vector<Slice>* GetContext::NeededWideColumns(
+    const std::vector<Slice>* projection) const {
+  if (replay_log_ != nullptr) {
+    return nullptr;
+  }
+  if (columns_ != nullptr) {
+    return projection;
+  }
+  static const std::vector<Slice> kDefaultColumnOnly{kDefaultWideColumnName};
+  return &kDefaultColumnOnly;
+}
+
 void GetContext::ReportCounters() {
   if (get_context_stats_.num_cache_hit > 0) {
     RecordTick(statistics_, BLOCK_CACHE_HIT, get_context_stats_.num_cache_hit);
@@ -178,6 +178,14 @@ class GetContext {
 
   bool has_callback() const { return callback_ != nullptr; }
 
+  // Returns the names of the wide columns of entities that SaveValue() needs,
+  // or nullptr if it needs all of them: entity lookups need the columns in
+  // `projection`, other lookups only the default column, and lookups recorded
+  // in a replay log (for the row cache) the whole entity. Table readers may
+  // skip decoding the other columns.
+  const std::vector<Slice>* NeededWideColumns(
+      const std::vector<Slice>* projection) const;
+
   const Slice& ukey_to_get_blob_value() const {
     if (!ukey_with_ts_found_.empty()) {
       return ukey_with_ts_found_;
@@ -115,6 +115,12 @@ void PropertyBlockBuilder::AddTableProperty(const TableProperties& props) {
     Add(TablePropertiesNames::kFastCompressionEstimatedDataSize,
         props.fast_compression_estimated_data_size);
   }
+  if (props.num_point_reads > 0) {
+    Add(TablePropertiesNames::kNumPointReads, props.num_point_reads);
+  }
+  if (props.num_iterator_reads > 0) {
+    Add(TablePropertiesNames::kNumIteratorReads, props.num_iterator_reads);
+  }
   if (!props.db_id.empty()) {
     Add(TablePropertiesNames::kDbId, props.db_id);
   }
@@ -307,6 +313,10 @@ Status ReadTablePropertiesHelper(
        &new_table_properties->slow_compression_estimated_data_size},
       {TablePropertiesNames::kFastCompressionEstimatedDataSize,
        &new_table_properties->fast_compression_estimated_data_size},
+      {TablePropertiesNames::kNumPointReads,
+       &new_table_properties->num_point_reads},
+      {TablePropertiesNames::kNumIteratorReads,
+       &new_table_properties->num_iterator_reads},
   };
 
   std::string last_key;
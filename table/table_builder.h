@@ -144,6 +144,10 @@ struct TableBuilderOptions {
   // in the table options of the ioptions.table_factory
   bool skip_filters = false;
   const uint64_t cur_file_num;
+  // Estimated reads of the files this table is compacted from, see
+  // TableProperties::num_point_reads and num_iterator_reads
+  uint64_t num_point_reads = 0;
+  uint64_t num_iterator_reads = 0;
 };
 
 // TableBuilder provides the interface used to build a Table
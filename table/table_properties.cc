@@ -142,6 +142,10 @@ std::string TableProperties::ToString(const std::string& prop_delim,
                  slow_compression_estimated_data_size, prop_delim, kv_delim);
   AppendProperty(result, "fast compression estimated data size",
                  fast_compression_estimated_data_size, prop_delim, kv_delim);
+  AppendProperty(result, "# point reads of compaction inputs",
+                 num_point_reads, prop_delim, kv_delim);
+  AppendProperty(result, "# iterator reads of compaction inputs",
+                 num_iterator_reads, prop_delim, kv_delim);
 
   // DB identity and DB session ID
   AppendProperty(result, "DB identity", db_id, prop_delim, kv_delim);
@@ -187,6 +191,8 @@ void TableProperties::Add(const TableProperties& tp) {
       tp.slow_compression_estimated_data_size;
   fast_compression_estimated_data_size +=
       tp.fast_compression_estimated_data_size;
+  num_point_reads += tp.num_point_reads;
+  num_iterator_reads += tp.num_iterator_reads;
 }
 
 std::map<std::string, uint64_t>
@@ -209,6 +215,8 @@ TableProperties::GetAggregatablePropertiesAsMap() const {
       slow_compression_estimated_data_size;
   rv["fast_compression_estimated_data_size"] =
       fast_compression_estimated_data_size;
+  rv["num_point_reads"] = num_point_reads;
+  rv["num_iterator_reads"] = num_iterator_reads;
   return rv;
 }
 
@@ -301,6 +309,10 @@ const std::string TablePropertiesNames::kSlowCompressionEstimatedDataSize =
     "rocksdb.sample_for_compression.slow.data.size";
 const std::string TablePropertiesNames::kFastCompressionEstimatedDataSize =
     "rocksdb.sample_for_compression.fast.data.size";
+const std::string TablePropertiesNames::kNumPointReads =
+    "rocksdb.num.point.reads";
+const std::string TablePropertiesNames::kNumIteratorReads =
+    "rocksdb.num.iterator.reads";
 const std::string TablePropertiesNames::kSequenceNumberTimeMapping =
     "rocksdb.seqno.time.map";
 
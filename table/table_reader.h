@@ -101,6 +101,18 @@ class TableReader {
     return Status::NotSupported("ApproximateKeyAnchors() not supported.");
   }
 
+  // Loads the data blocks identified by `block_ids`, sorted ascending, into
+  // the block cache. The ids are those of the blocks' block cache keys, as
+  // recovered with OffsetableCacheKey::GetOffset(); ids not matching a data
+  // block of this table are ignored. Adds the number of blocks and bytes
+  // read from the file to `*num_blocks` and `*num_bytes`.
+  virtual Status WarmUpBlockCache(const ReadOptions& /*read_options*/,
+                                  const std::vector<uint64_t>& /*block_ids*/,
+                                  uint64_t* /*num_blocks*/,
+                                  uint64_t* /*num_bytes*/) {
+    return Status::NotSupported("WarmUpBlockCache() not supported.");
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
@@ -11,6 +11,9 @@ int main() {
 }
 #else
 
+#include <cinttypes>
+#include <cstring>
+
 #include "db/db_impl/db_impl.h"
 #include "db/dbformat.h"
 #include "file/random_access_file_reader.h"
@@ -29,6 +32,13 @@ int main() {
 #include "test_util/testutil.h"
 #include "util/gflags_compat.h"
 
+#ifdef OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 using GFLAGS_NAMESPACE::SetUsageMessage;
 
@@ -54,6 +64,63 @@ static std::string MakeKey(int i, int j, bool through_db) {
 uint64_t Now(SystemClock* clock, bool measured_by_nanosecond) {
   return measured_by_nanosecond ? clock->NowNanos() : clock->NowMicros();
 }
+
+// Counts last-level cache misses of the calling thread through the Linux
+// perf_event interface. Reports nothing where unavailable (other platforms,
+// or perf events restricted by kernel.perf_event_paranoid).
+class LlcMissCounter {
+ public:
+  LlcMissCounter() {
+#ifdef OS_LINUX
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0 /* pid */,
+                                   -1 /* cpu */, -1 /* group_fd */,
+                                   0 /* flags */));
+#endif
+  }
+
+  ~LlcMissCounter() {
+#ifdef OS_LINUX
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+#endif
+  }
+
+  bool Available() const { return fd_ >= 0; }
+
+  void Start() {
+#ifdef OS_LINUX
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  uint64_t Stop() {
+    uint64_t count = 0;
+#ifdef OS_LINUX
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+        count = 0;
+      }
+    }
+#endif
+    return count;
+  }
+
+ private:
+  int fd_ = -1;
+};
 }  // namespace
 
 // A very simple benchmark that.
@@ -155,6 +222,8 @@ void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
   Random rnd(301);
   std::string result;
   HistogramImpl hist;
+  LlcMissCounter llc_misses;
+  llc_misses.Start();
 
   for (int it = 0; it < num_iter; it++) {
     for (int i = 0; i < num_keys1; i++) {
@@ -251,6 +320,12 @@ void TableReaderBenchmark(Options& opts, EnvOptions& env_options,
       for_iterator ? "iterator" : (if_query_empty_keys ? "empty" : "non_empty"),
       measured_by_nanosecond ? "nanosecond" : "microsecond",
       hist.ToString().c_str());
+  uint64_t num_llc_misses = llc_misses.Stop();
+  if (llc_misses.Available()) {
+    uint64_t num_ops = static_cast<uint64_t>(num_iter) * num_keys1 * num_keys2;
+    fprintf(stderr, "LLC misses: %" PRIu64 " (%.2f per op)\n", num_llc_misses,
+            num_ops == 0 ? 0.0 : static_cast<double>(num_llc_misses) / num_ops);
+  }
   if (!through_db) {
     env->DeleteFile(file_name);
   } else {
@@ -276,6 +351,10 @@ DEFINE_bool(mmap_read, true, "Whether use mmap read");
 DEFINE_string(table_factory, "block_based",
               "Table factory to use: `block_based` (default), `plain_table` or "
               "`cuckoo_hash`.");
+DEFINE_bool(restart_key_prefix_seek, false,
+            "Sets BlockBasedTableOptions::restart_key_prefix_seek");
+DEFINE_bool(data_block_restart_key_prefixes, false,
+            "Sets BlockBasedTableOptions::data_block_restart_key_prefixes");
 DEFINE_string(time_unit, "microsecond",
               "The time unit used for measuring performance. User can specify "
               "`microsecond` (default) or `nanosecond`");
@@ -315,7 +394,11 @@ int main(int argc, char** argv) {
     options.prefix_extractor.reset(
         ROCKSDB_NAMESPACE::NewFixedPrefixTransform(FLAGS_prefix_len));
   } else if (FLAGS_table_factory == "block_based") {
-    tf.reset(new ROCKSDB_NAMESPACE::BlockBasedTableFactory());
+    ROCKSDB_NAMESPACE::BlockBasedTableOptions table_options;
+    table_options.restart_key_prefix_seek = FLAGS_restart_key_prefix_seek;
+    table_options.data_block_restart_key_prefixes =
+        FLAGS_data_block_restart_key_prefixes;
+    tf.reset(new ROCKSDB_NAMESPACE::BlockBasedTableFactory(table_options));
   } else {
     fprintf(stderr, "Invalid table type %s\n", FLAGS_table_factory.c_str());
   }
@@ -71,6 +71,7 @@
 #include "util/coding_lean.h"
 #include "util/compression.h"
 #include "util/file_checksum_helper.h"
+#include "util/math.h"
 #include "util/random.h"
 #include "util/string_util.h"
 #include "utilities/memory_allocators.h"
@@ -2636,6 +2637,143 @@ TEST_P(BlockBasedTableTest, HashIndexTest) {
   IndexTest(table_options);
 }
 
+TEST_P(BlockBasedTableTest, LearnedIndexTest) {
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.index_type = BlockBasedTableOptions::kLearnedIndexSearch;
+  IndexTest(table_options);
+}
+
+TEST_P(BlockBasedTableTest, LearnedIndexSeek) {
+  // Big-endian IDs, either growing linearly or quadratically so that the
+  // model needs several segments.
+  for (bool quadratic : {false, true}) {
+    for (int restart_interval : {1, 4}) {
+      TableConstructor c(BytewiseComparator(),
+                         true /* convert_to_internal_key_ */);
+      const uint64_t kNumKeys = 5000;
+      auto id_key = [](uint64_t id) {
+        std::string key;
+        PutFixed64(&key, EndianSwapValue(id));
+        return key + "suffix";
+      };
+      auto id_of = [&](uint64_t i) { return quadratic ? i * i : i * 10; };
+      for (uint64_t i = 0; i < kNumKeys; ++i) {
+        c.Add(id_key(id_of(i)), "value" + std::to_string(i));
+      }
+
+      BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+      table_options.index_type = BlockBasedTableOptions::kLearnedIndexSearch;
+      table_options.index_block_restart_interval = restart_interval;
+      table_options.block_size = 256;
+      Options options;
+      options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+      const ImmutableOptions ioptions(options);
+      const MutableCFOptions moptions(options);
+      std::vector<std::string> keys;
+      stl_wrappers::KVMap kvmap;
+      // Seek targets are internal keys for seek, so use the real ordering
+      const InternalKeyComparator internal_comparator(options.comparator);
+      c.Finish(options, ioptions, moptions, table_options, internal_comparator,
+               &keys, &kvmap);
+      ASSERT_GT(c.GetTableReader()->GetTableProperties()->num_data_blocks,
+                100u);
+
+      int fallbacks = 0;
+      SyncPoint::GetInstance()->SetCallBack(
+          "IndexBlockIter::LearnedSeek:Fallback",
+          [&](void* /*arg*/) { ++fallbacks; });
+      SyncPoint::GetInstance()->EnableProcessing();
+
+      std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(
+          ReadOptions(), moptions.prefix_extractor.get(), /*arena=*/nullptr,
+          /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+      for (uint64_t i = 0; i < kNumKeys; ++i) {
+        // Exact match
+        iter->Seek(InternalKey(id_key(id_of(i)), kMaxSequenceNumber,
+                               kValueTypeForSeek)
+                       .Encode());
+        ASSERT_OK(iter->status());
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ("value" + std::to_string(i), iter->value().ToString());
+        // Between keys
+        iter->Seek(InternalKey(id_key(id_of(i) + 1), kMaxSequenceNumber,
+                               kValueTypeForSeek)
+                       .Encode());
+        ASSERT_OK(iter->status());
+        if (i + 1 < kNumKeys) {
+          ASSERT_TRUE(iter->Valid());
+          ASSERT_EQ("value" + std::to_string(i + 1),
+                    iter->value().ToString());
+        } else {
+          ASSERT_FALSE(iter->Valid());
+        }
+      }
+      // Before the first key
+      iter->Seek(InternalKey("", kMaxSequenceNumber, kValueTypeForSeek)
+                     .Encode());
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ("value0", iter->value().ToString());
+
+      SyncPoint::GetInstance()->DisableProcessing();
+      SyncPoint::GetInstance()->ClearAllCallBacks();
+      // The model stays within its error bound on the keys it was built from.
+      ASSERT_EQ(0, fallbacks);
+      c.ResetTableReader();
+    }
+  }
+}
+
+TEST_P(BlockBasedTableTest, PoolUncachedBlockBuffers) {
+  TableConstructor c(BytewiseComparator(), true /* convert_to_internal_key_ */);
+  Random rnd(301);
+  for (int i = 0; i < 2000; ++i) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%06d", i);
+    c.Add(key, rnd.RandomString(100));
+  }
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.pool_uncached_block_buffers = true;
+  table_options.block_size = 1024;
+  Options options;
+  if (Snappy_Supported()) {
+    options.compression = kSnappyCompression;
+  }
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableOptions ioptions(options);
+  const MutableCFOptions moptions(options);
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  c.Finish(options, ioptions, moptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  const uint64_t num_data_blocks =
+      c.GetTableReader()->GetTableProperties()->num_data_blocks;
+
+  SetPerfLevel(PerfLevel::kEnableCount);
+  get_perf_context()->Reset();
+  ReadOptions read_options;
+  read_options.fill_cache = false;
+  for (int pass = 0; pass < 2; ++pass) {
+    std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(
+        read_options, moptions.prefix_extractor.get(), /*arena=*/nullptr,
+        /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+    auto kv = kvmap.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++kv) {
+      ASSERT_NE(kv, kvmap.end());
+      ASSERT_EQ(kv->first, ExtractUserKey(iter->key()).ToString());
+      ASSERT_EQ(kv->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kv, kvmap.end());
+  }
+  // Every data block read went through the pool, and buffers released by
+  // the first pass are reused by the second one.
+  EXPECT_GE(get_perf_context()->block_buffer_pool_hit_count +
+                get_perf_context()->block_buffer_pool_miss_count,
+            2 * num_data_blocks);
+  EXPECT_GT(get_perf_context()->block_buffer_pool_hit_count, 0u);
+  c.ResetTableReader();
+}
+
 TEST_P(BlockBasedTableTest, PartitionIndexTest) {
   const int max_index_keys = 5;
   const int est_max_index_key_value_size = 32;
@@ -5216,6 +5354,49 @@ TEST_P(BlockBasedTableTest, DataBlockHashIndex) {
   }
 }
 
+// Restart key prefixes are only persisted in data blocks, and recognized by
+// readers, for format_version >= 6.
+TEST_P(BlockBasedTableTest, DataBlockRestartKeyPrefixes) {
+  uint64_t data_size[2];
+  for (bool restart_key_prefixes : {false, true}) {
+    BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+    table_options.data_block_restart_key_prefixes = restart_key_prefixes;
+    Options options;
+    options.compression = kNoCompression;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+    TableConstructor c(BytewiseComparator(),
+                       true /* convert_to_internal_key_ */);
+    Random rnd(301);
+    for (int i = 0; i < 1000; ++i) {
+      c.Add(rnd.RandomString(16), rnd.RandomString(10));
+    }
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    const ImmutableOptions ioptions(options);
+    const MutableCFOptions moptions(options);
+    c.Finish(options, ioptions, moptions, table_options,
+             GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+    data_size[restart_key_prefixes] =
+        c.GetTableReader()->GetTableProperties()->data_size;
+
+    std::unique_ptr<InternalIterator> iter(
+        c.NewIterator(moptions.prefix_extractor.get()));
+    for (const auto& kv : kvmap) {
+      iter->Seek(kv.first);
+      ASSERT_OK(iter->status());
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(iter->key(), kv.first);
+      ASSERT_EQ(iter->value(), kv.second);
+    }
+  }
+  if (FormatVersionAllowsRestartKeyPrefixes(GetParam())) {
+    ASSERT_GT(data_size[1], data_size[0]);
+  } else {
+    ASSERT_EQ(data_size[1], data_size[0]);
+  }
+}
+
 // BlockBasedTableIterator should invalidate itself and return
 // OutOfBound()=true immediately after Seek(), to allow LevelIterator
 // filter out corresponding level.
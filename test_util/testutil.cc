@@ -339,6 +339,9 @@ void RandomInitCFOptions(ColumnFamilyOptions* cf_opt, DBOptions& db_options,
   cf_opt->force_consistency_checks = rnd->Uniform(2);
   cf_opt->compaction_options_fifo.allow_compaction = rnd->Uniform(2);
   cf_opt->memtable_whole_key_filtering = rnd->Uniform(2);
+  cf_opt->memtable_point_lookup_index = rnd->Uniform(2);
+  cf_opt->experimental_mempurge_frozen_output = rnd->Uniform(2);
+  cf_opt->experimental_frozen_memtable_spill = rnd->Uniform(2);
   cf_opt->enable_blob_files = rnd->Uniform(2);
   cf_opt->enable_blob_garbage_collection = rnd->Uniform(2);
 
@@ -35,7 +35,8 @@ DEFINE_string(
     "The config file path. One cache configuration per line. The format of a "
     "cache configuration is "
     "cache_name,num_shard_bits,ghost_capacity,cache_capacity_1,...,cache_"
-    "capacity_N. Supported cache names are lru, lru_priority, lru_hybrid, and "
+    "capacity_N. Supported cache names are lru, lru_tinylfu (LRU with TinyLFU "
+    "admission), lru_priority, lru_hybrid, and "
     "lru_hybrid_no_insert_on_row_miss. User may also add a prefix 'ghost_' to "
     "a cache_name to add a ghost cache in front of the real cache. "
     "ghost_capacity and cache_capacity can be xK, xM or xG where x is a "
@@ -50,6 +50,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/filter_policy.h"
+#include "rocksdb/flush_block_policy.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/options.h"
 #include "rocksdb/perf_context.h"
@@ -593,6 +594,34 @@ static enum ROCKSDB_NAMESPACE::CompressionType
     FLAGS_compressed_secondary_cache_compression_type_e =
         ROCKSDB_NAMESPACE::kLZ4Compression;
 
+DEFINE_double(tiered_cache_compressed_ratio, 0.0,
+              "If > 0.0 with lru_cache, use a tiered cache (NewTieredCache)"
+              " in which this fraction of cache_size is given to a compressed"
+              " secondary tier. Uses the compressed_secondary_cache_*"
+              " compression options.");
+
+DEFINE_bool(cache_tiny_lfu_admission, false,
+            "Use the TinyLFU admission policy in the block cache (lru_cache "
+            "and hyper_clock_cache types)");
+
+DEFINE_bool(cache_use_read_buffer, false,
+            "Record block cache lookup hits in a read buffer instead of "
+            "taking the shard mutex (lru_cache type)");
+
+DEFINE_bool(cache_cost_aware_eviction, false,
+            "Weigh block cache evictions by the estimated cost of a miss, "
+            "from the block type and file read latency (lru_cache and "
+            "hyper_clock_cache types, see NewCacheEvictionCostPolicy())");
+
+DEFINE_int32(cache_numa_nodes, -1,
+             "If >= 0, use a NUMA-aware block cache (lru_cache type) with "
+             "one cache per NUMA node, 0 for the number of nodes of the host "
+             "(see NewNumaAwareCache())");
+
+DEFINE_bool(cache_numa_promote_remote_hits, false,
+            "With --cache_numa_nodes, copy the entries found in the cache of "
+            "another NUMA node into the cache of the local node");
+
 DEFINE_uint32(
     compressed_secondary_cache_compress_format_version, 2,
     "compress_format_version can have two values: "
@@ -601,6 +630,14 @@ DEFINE_uint32(
     "compress_format_version == 2 -- decompressed size is included"
     " in the block header in varint32 format.");
 
+DEFINE_bool(compressed_secondary_cache_use_compression_dict, false,
+            "Compress the blocks of table files compressed with a dictionary "
+            "with that dictionary in the compressed secondary cache");
+
+DEFINE_int32(compressed_secondary_cache_compression_threads, 0,
+             "If positive, number of background threads compressing the "
+             "entries of the compressed secondary cache");
+
 DEFINE_int64(simcache_size, -1,
              "Number of bytes to use as a simcache of "
              "uncompressed data. Nagative value disables simcache.");
@@ -621,6 +658,9 @@ DEFINE_bool(partition_index, false, "Partition index blocks");
 
 DEFINE_bool(index_with_first_key, false, "Include first key in the index");
 
+DEFINE_bool(learned_index, false,
+            "Use BlockBasedTableOptions::kLearnedIndexSearch as index type");
+
 DEFINE_bool(
     optimize_filters_for_memory,
     ROCKSDB_NAMESPACE::BlockBasedTableOptions().optimize_filters_for_memory,
@@ -652,6 +692,11 @@ DEFINE_int32(block_size,
                  ROCKSDB_NAMESPACE::BlockBasedTableOptions().block_size),
              "Number of bytes in a block.");
 
+DEFINE_bool(adaptive_block_size, false,
+            "Use AdaptiveFlushBlockPolicyFactory, which chooses the block size "
+            "of compaction outputs from how their inputs were read, using "
+            "--block_size for the other files.");
+
 DEFINE_int32(format_version,
              static_cast<int32_t>(
                  ROCKSDB_NAMESPACE::BlockBasedTableOptions().format_version),
@@ -695,6 +740,30 @@ DEFINE_double(data_block_hash_table_util_ratio, 0.75,
               "This is only valid if use_data_block_hash_index is "
               "set to true");
 
+DEFINE_bool(data_block_hash_index_wide_buckets,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .data_block_hash_index_wide_buckets,
+            "Sets BlockBasedTableOptions::data_block_hash_index_wide_buckets");
+
+DEFINE_bool(restart_key_prefix_seek,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions().restart_key_prefix_seek,
+            "Sets BlockBasedTableOptions::restart_key_prefix_seek");
+
+DEFINE_bool(data_block_restart_key_prefixes,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .data_block_restart_key_prefixes,
+            "Sets BlockBasedTableOptions::data_block_restart_key_prefixes");
+
+DEFINE_bool(data_block_columnar_entities,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .data_block_columnar_entities,
+            "Sets BlockBasedTableOptions::data_block_columnar_entities");
+
+DEFINE_bool(pool_uncached_block_buffers,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .pool_uncached_block_buffers,
+            "Sets BlockBasedTableOptions::pool_uncached_block_buffers");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -725,6 +794,10 @@ DEFINE_int32(bloom_bits, -1,
              "Bloom filter bits per key. Negative means use default."
              "Zero disables.");
 
+DEFINE_double(range_filter_bits, 0,
+              "Bits per stored prefix of the Rosetta range filter (see "
+              "BlockBasedTableOptions::range_filter_policy). Zero disables.");
+
 DEFINE_bool(use_ribbon_filter, false, "Use Ribbon instead of Bloom filter");
 
 DEFINE_double(memtable_bloom_size_ratio, 0,
@@ -732,6 +805,9 @@ DEFINE_double(memtable_bloom_size_ratio, 0,
               "filter.");
 DEFINE_bool(memtable_whole_key_filtering, false,
             "Try to use whole key bloom filter in memtables.");
+DEFINE_bool(memtable_point_lookup_index, false,
+            "Index the newest entry of each key in memtables for point "
+            "lookups.");
 DEFINE_bool(memtable_use_huge_page, false,
             "Try to use huge page in memtables.");
 
@@ -1393,6 +1469,11 @@ DEFINE_uint64(delayed_write_rate, 8388608u,
 DEFINE_bool(enable_pipelined_write, true,
             "Allow WAL and memtable writes to be pipelined");
 
+DEFINE_bool(enable_pipelined_wal_sync,
+            ROCKSDB_NAMESPACE::Options().enable_pipelined_wal_sync,
+            "With enable_pipelined_write, sync the WAL for sync writes in the "
+            "memtable writer queue so WAL appends overlap WAL syncs");
+
 DEFINE_bool(
     unordered_write, false,
     "Enable the unordered write feature, which provides higher throughput but "
@@ -1401,10 +1482,22 @@ DEFINE_bool(
 DEFINE_bool(allow_concurrent_memtable_write, true,
             "Allow multi-writers to update mem tables in parallel.");
 
+DEFINE_bool(sorted_memtable_insert,
+            ROCKSDB_NAMESPACE::Options().sorted_memtable_insert,
+            "Insert the records of a write group into the memtables in key "
+            "order");
+
 DEFINE_double(experimental_mempurge_threshold, 0.0,
               "Maximum useful payload ratio estimate that triggers a mempurge "
               "(memtable garbage collection).");
 
+DEFINE_bool(experimental_mempurge_frozen_output, false,
+            "Store the output of mempurge in a frozen memtable.");
+
+DEFINE_bool(experimental_frozen_memtable_spill, false,
+            "Convert memtables into a frozen memtable kept in memory instead "
+            "of flushing them when the write buffer manager asks for it.");
+
 DEFINE_bool(inplace_update_support,
             ROCKSDB_NAMESPACE::Options().inplace_update_support,
             "Support in-place memtable update for smaller or same-size values");
@@ -1654,6 +1747,12 @@ DEFINE_uint64(stats_history_buffer_size,
 DEFINE_bool(avoid_flush_during_recovery,
             ROCKSDB_NAMESPACE::Options().avoid_flush_during_recovery,
             "If true, avoids flushing the recovered WAL data where possible.");
+DEFINE_bool(block_cache_warmup, ROCKSDB_NAMESPACE::Options().block_cache_warmup,
+            "If true, reload the block cache contents saved at the last clean "
+            "shutdown when opening the DB.");
+DEFINE_int32(block_cache_warmup_threads,
+             ROCKSDB_NAMESPACE::Options().block_cache_warmup_threads,
+             "Number of threads loading blocks for --block_cache_warmup");
 DEFINE_int64(multiread_stride, 0,
              "Stride length for the keys in a MultiGet batch");
 DEFINE_bool(multiread_batched, false, "Use the new MultiGet API");
@@ -1744,6 +1843,9 @@ static Status CreateMemTableRepFactory(
   } else if (!strcasecmp(FLAGS_memtablerep.c_str(),
                          VectorRepFactory::kNickName())) {
     factory->reset(new VectorRepFactory());
+  } else if (!strcasecmp(FLAGS_memtablerep.c_str(),
+                         BTreeRepFactory::kNickName())) {
+    factory->reset(new BTreeRepFactory());
   } else if (!strcasecmp(FLAGS_memtablerep.c_str(), "hash_linkedlist")) {
     factory->reset(NewHashLinkListRepFactory(FLAGS_hash_bucket_count));
   } else {
@@ -3006,16 +3108,34 @@ class Benchmark {
       fprintf(stderr, "Old clock cache implementation has been removed.\n");
       exit(1);
     } else if (FLAGS_cache_type == "hyper_clock_cache") {
-      return HyperClockCacheOptions(static_cast<size_t>(capacity),
-                                    FLAGS_block_size /*estimated_entry_charge*/,
-                                    FLAGS_cache_numshardbits)
-          .MakeSharedCache();
+      HyperClockCacheOptions opts(static_cast<size_t>(capacity),
+                                  FLAGS_block_size /*estimated_entry_charge*/,
+                                  FLAGS_cache_numshardbits);
+      opts.tiny_lfu_admission = FLAGS_cache_tiny_lfu_admission;
+      if (FLAGS_cache_cost_aware_eviction) {
+        opts.eviction_cost_policy = NewCacheEvictionCostPolicy();
+      }
+      return opts.MakeSharedCache();
+    } else if (FLAGS_cache_type == "auto_hyper_clock_cache") {
+      HyperClockCacheOptions opts(static_cast<size_t>(capacity),
+                                  0 /*estimated_entry_charge*/,
+                                  FLAGS_cache_numshardbits);
+      opts.tiny_lfu_admission = FLAGS_cache_tiny_lfu_admission;
+      if (FLAGS_cache_cost_aware_eviction) {
+        opts.eviction_cost_policy = NewCacheEvictionCostPolicy();
+      }
+      return opts.MakeSharedCache();
     } else if (FLAGS_cache_type == "lru_cache") {
       LRUCacheOptions opts(
           static_cast<size_t>(capacity), FLAGS_cache_numshardbits,
           false /*strict_capacity_limit*/, FLAGS_cache_high_pri_pool_ratio,
           GetCacheAllocator(), kDefaultToAdaptiveMutex,
           kDefaultCacheMetadataChargePolicy, FLAGS_cache_low_pri_pool_ratio);
+      opts.tiny_lfu_admission = FLAGS_cache_tiny_lfu_admission;
+      opts.use_read_buffer = FLAGS_cache_use_read_buffer;
+      if (FLAGS_cache_cost_aware_eviction) {
+        opts.eviction_cost_policy = NewCacheEvictionCostPolicy();
+      }
 
       if (!FLAGS_secondary_cache_uri.empty()) {
         Status s = SecondaryCache::CreateFromString(
@@ -3043,10 +3163,40 @@ class Benchmark {
             FLAGS_compressed_secondary_cache_compression_type_e;
         secondary_cache_opts.compress_format_version =
             FLAGS_compressed_secondary_cache_compress_format_version;
+        secondary_cache_opts.use_compression_dict =
+            FLAGS_compressed_secondary_cache_use_compression_dict;
+        secondary_cache_opts.compression_threads =
+            FLAGS_compressed_secondary_cache_compression_threads;
         opts.secondary_cache =
             NewCompressedSecondaryCache(secondary_cache_opts);
       }
 
+      if (FLAGS_tiered_cache_compressed_ratio > 0.0) {
+        TieredCacheOptions tiered_opts;
+        tiered_opts.cache_opts = opts;
+        tiered_opts.total_capacity = static_cast<size_t>(capacity);
+        tiered_opts.compressed_secondary_ratio =
+            FLAGS_tiered_cache_compressed_ratio;
+        tiered_opts.comp_cache_opts.compression_type =
+            FLAGS_compressed_secondary_cache_compression_type_e;
+        tiered_opts.comp_cache_opts.compress_format_version =
+            FLAGS_compressed_secondary_cache_compress_format_version;
+        tiered_opts.comp_cache_opts.use_compression_dict =
+            FLAGS_compressed_secondary_cache_use_compression_dict;
+        tiered_opts.comp_cache_opts.compression_threads =
+            FLAGS_compressed_secondary_cache_compression_threads;
+        tiered_opts.statistics = dbstats;
+        return NewTieredCache(tiered_opts);
+      }
+
+      if (FLAGS_cache_numa_nodes >= 0) {
+        NumaAwareCacheOptions numa_opts;
+        numa_opts.cache_opts = opts;
+        numa_opts.num_nodes = FLAGS_cache_numa_nodes;
+        numa_opts.promote_remote_hits = FLAGS_cache_numa_promote_remote_hits;
+        return NewNumaAwareCache(numa_opts);
+      }
+
       return NewLRUCache(opts);
     } else {
       fprintf(stderr, "Cache type not supported.");
@@ -4059,6 +4209,8 @@ class Benchmark {
     options.stats_history_buffer_size =
         static_cast<size_t>(FLAGS_stats_history_buffer_size);
     options.avoid_flush_during_recovery = FLAGS_avoid_flush_during_recovery;
+    options.block_cache_warmup = FLAGS_block_cache_warmup;
+    options.block_cache_warmup_threads = FLAGS_block_cache_warmup_threads;
 
     options.compression_opts.level = FLAGS_compression_level;
     options.compression_opts.max_dict_bytes = FLAGS_compression_max_dict_bytes;
@@ -4117,6 +4269,7 @@ class Benchmark {
     options.memtable_huge_page_size = FLAGS_memtable_use_huge_page ? 2048 : 0;
     options.memtable_prefix_bloom_size_ratio = FLAGS_memtable_bloom_size_ratio;
     options.memtable_whole_key_filtering = FLAGS_memtable_whole_key_filtering;
+    options.memtable_point_lookup_index = FLAGS_memtable_point_lookup_index;
     if (FLAGS_memtable_insert_with_hint_prefix_size > 0) {
       options.memtable_insert_with_hint_prefix_extractor.reset(
           NewCappedPrefixTransform(
@@ -4219,6 +4372,9 @@ class Benchmark {
       } else if (FLAGS_index_with_first_key) {
         block_based_options.index_type =
             BlockBasedTableOptions::kBinarySearchWithFirstKey;
+      } else if (FLAGS_learned_index) {
+        block_based_options.index_type =
+            BlockBasedTableOptions::kLearnedIndexSearch;
       }
       BlockBasedTableOptions::IndexShorteningMode index_shortening =
           block_based_options.index_shortening;
@@ -4287,6 +4443,10 @@ class Benchmark {
                 ? CacheEntryRoleOptions::Decision::kEnabled
                 : CacheEntryRoleOptions::Decision::kDisabled}});
       block_based_options.block_size = FLAGS_block_size;
+      if (FLAGS_adaptive_block_size) {
+        block_based_options.flush_block_policy_factory =
+            std::make_shared<AdaptiveFlushBlockPolicyFactory>();
+      }
       block_based_options.block_restart_interval = FLAGS_block_restart_interval;
       block_based_options.index_block_restart_interval =
           FLAGS_index_block_restart_interval;
@@ -4327,6 +4487,16 @@ class Benchmark {
       }
       block_based_options.data_block_hash_table_util_ratio =
           FLAGS_data_block_hash_table_util_ratio;
+      block_based_options.data_block_hash_index_wide_buckets =
+          FLAGS_data_block_hash_index_wide_buckets;
+      block_based_options.restart_key_prefix_seek =
+          FLAGS_restart_key_prefix_seek;
+      block_based_options.data_block_restart_key_prefixes =
+          FLAGS_data_block_restart_key_prefixes;
+      block_based_options.data_block_columnar_entities =
+          FLAGS_data_block_columnar_entities;
+      block_based_options.pool_uncached_block_buffers =
+          FLAGS_pool_uncached_block_buffers;
       if (FLAGS_read_cache_path != "") {
         Status rc_status;
 
@@ -4457,13 +4627,19 @@ class Benchmark {
     options.delayed_write_rate = FLAGS_delayed_write_rate;
     options.allow_concurrent_memtable_write =
         FLAGS_allow_concurrent_memtable_write;
+    options.sorted_memtable_insert = FLAGS_sorted_memtable_insert;
     options.experimental_mempurge_threshold =
         FLAGS_experimental_mempurge_threshold;
+    options.experimental_mempurge_frozen_output =
+        FLAGS_experimental_mempurge_frozen_output;
+    options.experimental_frozen_memtable_spill =
+        FLAGS_experimental_frozen_memtable_spill;
     options.inplace_update_support = FLAGS_inplace_update_support;
     options.inplace_update_num_locks = FLAGS_inplace_update_num_locks;
     options.enable_write_thread_adaptive_yield =
         FLAGS_enable_write_thread_adaptive_yield;
     options.enable_pipelined_write = FLAGS_enable_pipelined_write;
+    options.enable_pipelined_wal_sync = FLAGS_enable_pipelined_wal_sync;
     options.unordered_write = FLAGS_unordered_write;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
@@ -4606,6 +4782,11 @@ class Benchmark {
                                       : NewBloomFilterPolicy(FLAGS_bloom_bits));
         }
       }
+      if (table_options->range_filter_policy == nullptr &&
+          FLAGS_range_filter_bits > 0) {
+        table_options->range_filter_policy.reset(
+            NewRosettaRangeFilterPolicy(FLAGS_range_filter_bits));
+      }
     }
 
     if (options.row_cache == nullptr) {
@@ -1162,6 +1162,88 @@ TEST(RibbonTest, RibbonTestLevelThreshold) {
   }
 }
 
+namespace {
+// Keys in the order of i, with i in the first 8 bytes
+std::string RangeFilterTestKey(uint64_t i) {
+  std::string key;
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key.push_back(static_cast<char>(i >> shift));
+  }
+  key.append("suffix");
+  return key;
+}
+}  // namespace
+
+TEST(RangeFilterTest, Rosetta) {
+  BlockBasedTableOptions opts;
+  FilterBuildingContext ctx(opts);
+  std::unique_ptr<const RangeFilterPolicy> policy(
+      NewRosettaRangeFilterPolicy(FLAGS_bits_per_key));
+  std::unique_ptr<RangeFilterBitsBuilder> builder(
+      policy->GetBuilderWithContext(ctx));
+  ASSERT_NE(builder, nullptr);
+
+  // No keys, no filter
+  std::unique_ptr<const char[]> buf;
+  ASSERT_TRUE(builder->Finish(&buf).empty());
+
+  constexpr uint64_t kNumKeys = 10000;
+  constexpr uint64_t kGap = 1000;
+  for (uint64_t i = 1; i <= kNumKeys; ++i) {
+    const std::string key = RangeFilterTestKey(i * kGap);
+    builder->AddKey(key);
+    // Duplicates are possible
+    builder->AddKey(key);
+  }
+  const Slice contents = builder->Finish(&buf);
+  ASSERT_FALSE(contents.empty());
+  std::unique_ptr<RangeFilterBitsReader> reader(
+      policy->GetRangeFilterBitsReader(contents));
+
+  size_t fp = 0;
+  for (uint64_t i = 1; i <= kNumKeys; ++i) {
+    const std::string key = RangeFilterTestKey(i * kGap);
+    // No false negatives
+    ASSERT_TRUE(reader->MayMatchRange(key, RangeFilterTestKey(i * kGap + 1)));
+    ASSERT_TRUE(reader->MayMatchRange(RangeFilterTestKey(i * kGap - kGap / 2),
+                                      RangeFilterTestKey(i * kGap + 1)));
+    ASSERT_TRUE(reader->MayMatchRange(RangeFilterTestKey(i * kGap - 1), key));
+    ASSERT_TRUE(reader->MayMatchRange(
+        key.substr(0, 5), RangeFilterTestKey(i * kGap + kGap * 10)));
+    // Ranges between two keys
+    if (reader->MayMatchRange(RangeFilterTestKey(i * kGap + 1),
+                              RangeFilterTestKey(i * kGap + kGap / 2))) {
+      ++fp;
+    }
+  }
+  if (kVerbose >= 1) {
+    fprintf(stderr, "Range filter: %.2f%% FP, %.2f bits/key\n",
+            100.0 * fp / kNumKeys, contents.size() * 8.0 / kNumKeys);
+  }
+  ASSERT_LT(fp, kNumKeys / 10);
+
+  // Filters of unknown formats match everything
+  std::string bad = contents.ToString();
+  bad[bad.size() - 3] = 1;
+  reader.reset(policy->GetRangeFilterBitsReader(bad));
+  ASSERT_TRUE(reader->MayMatchRange(RangeFilterTestKey(kNumKeys * kGap + 1),
+                                    RangeFilterTestKey(kNumKeys * kGap * 2)));
+}
+
+TEST(RangeFilterTest, CreateFromString) {
+  ConfigOptions config_options;
+  std::shared_ptr<const RangeFilterPolicy> policy;
+  ASSERT_OK(RangeFilterPolicy::CreateFromString(
+      config_options, "rocksdb.RosettaRangeFilter:12.5", &policy));
+  ASSERT_NE(policy, nullptr);
+  ASSERT_EQ(policy->GetId(), "rocksdb.RosettaRangeFilter:12.5");
+  ASSERT_OK(RangeFilterPolicy::CreateFromString(config_options, "nullptr",
+                                                &policy));
+  ASSERT_EQ(policy, nullptr);
+  ASSERT_NOK(RangeFilterPolicy::CreateFromString(config_options,
+                                                 "NoSuchRangeFilter", &policy));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -69,6 +69,11 @@ extern Slice GetLengthPrefixedSlice(const char* data);
 
 extern Slice GetSliceUntil(Slice* slice, char delimiter);
 
+// Returns the first 8 bytes of `key` as a big-endian integer, zero padded
+// if `key` is shorter, so that the integers of keys are ordered like the
+// keys under BytewiseComparator (up to ties).
+extern uint64_t DecodeBigEndianPrefix64(const Slice& key);
+
 // Borrowed from
 // https://github.com/facebook/fbthrift/blob/449a5f77f9f9bae72c9eb5e78093247eef185c04/thrift/lib/cpp/util/VarintUtils-inl.h#L202-L208
 constexpr inline uint64_t i64ToZigzag(const int64_t l) {
@@ -350,6 +355,15 @@ inline Slice GetSliceUntil(Slice* slice, char delimiter) {
   return ret;
 }
 
+inline uint64_t DecodeBigEndianPrefix64(const Slice& key) {
+  uint64_t value = 0;
+  const size_t n = std::min(key.size(), sizeof(value));
+  for (size_t i = 0; i < n; ++i) {
+    value |= uint64_t{static_cast<uint8_t>(key[i])} << (56 - 8 * i);
+  }
+  return value;
+}
+
 template <class T>
 #ifdef ROCKSDB_UBSAN_RUN
 #if defined(__clang__)